@@ -0,0 +1,238 @@
+/*
+ * Copyright 2020 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file gnss_session.c
+ * @brief GNSS session layer for the XPLR-IOT-1 Kit.
+ *
+ * Rather than adding, powering-on, removing and powering-off the M10 receiver
+ * for every location request, the session keeps the GNSS instance and UART
+ * open and, between requests, puts the receiver into backup mode with
+ * UBX-RXM-PMREQ while the backup supply (V_BCKP) stays applied.  Ephemeris,
+ * time and the battery-backed configuration survive, so the next request is
+ * a hot start and the message output configuration does not need to be sent
+ * again.
+ */
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "ubxlib.h"
+#include "u_cfg_app_platform_specific.h"
+
+#include <zephyr.h>
+#include <sys/printk.h>
+
+#include "module_config.h"
+#include "gnss_session.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+//Flags to Enable/Disable Messages
+#define GNSS_SESSION_MSG_ENABLE 1
+#define GNSS_SESSION_MSG_DISABLE 0
+
+// Layers the message configuration is written to: RAM so that it applies
+// now, battery-backed RAM so that it is restored on wake-up from backup
+#define GNSS_SESSION_CFG_LAYERS (U_GNSS_CFG_VAL_LAYER_RAM | U_GNSS_CFG_VAL_LAYER_BBRAM)
+
+
+/* ------------------------------------------------------------------------------
+ * GLOBALS
+ * -----------------------------------------------------------------------------*/
+
+static int32_t sessionUartHandle = -1;
+static uDeviceHandle_t sessionDevHandle = NULL;
+// true while the receiver is in backup mode between requests
+static bool sessionParked = false;
+// Configuration key of the message currently switched on, 0 if none
+static uint32_t sessionMsgKeyId = 0;
+
+static gnssSessionStats_t sessionStats = {0};
+
+
+/* ------------------------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -----------------------------------------------------------------------------*/
+
+// Bring the receiver up from nothing.
+static int32_t sessionOpenCold(void)
+{
+    uGnssTransportHandle_t gnssUartHandle;
+    int32_t errorCode;
+
+    max10Enable();
+    max10SafeBootDisable();
+    // Keep V_BCKP applied for the lifetime of the session, that
+    // is what lets the receiver retain its state while parked
+    max10BackupSupplyEnable();
+    max10NoraCommEnable();
+
+    sessionUartHandle = uPortUartOpen(U_CFG_APP_GNSS_UART,
+                                      U_GNSS_UART_BAUD_RATE, NULL,
+                                      U_GNSS_UART_BUFFER_LENGTH_BYTES,
+                                      -1,
+                                      -1,
+                                      -1,
+                                      -1);
+    errorCode = sessionUartHandle;
+    if (sessionUartHandle >= 0) {
+        gnssUartHandle.uart = sessionUartHandle;
+        errorCode = uGnssAdd(U_GNSS_MODULE_TYPE_M10,
+                             U_GNSS_TRANSPORT_UART, gnssUartHandle,
+                             EN_MAX_PIN, false, &sessionDevHandle);
+        if (errorCode == 0) {
+            uGnssSetUbxMessagePrint(sessionDevHandle, false);
+            errorCode = uGnssPwrOn(sessionDevHandle);
+        }
+    }
+
+    sessionMsgKeyId = 0;
+    sessionParked = false;
+    if (errorCode != 0) {
+        gnssSessionClose();
+    }
+
+    return errorCode;
+}
+
+
+/* ------------------------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -----------------------------------------------------------------------------*/
+
+int32_t gnssSessionAcquire(uDeviceHandle_t *pDevHandle, gnssSessionStart_t *pStart)
+{
+    int32_t errorCode = -1;
+    gnssSessionStart_t start = GNSS_SESSION_START_COLD;
+
+    if ((sessionDevHandle != NULL) && sessionParked) {
+        // Powering back on wakes the receiver from backup; uGnssPwrOn()
+        // only asks for a controlled hot start so ephemeris is kept
+        errorCode = uGnssPwrOn(sessionDevHandle);
+        if (errorCode == 0) {
+            sessionParked = false;
+            start = GNSS_SESSION_START_WARM;
+            // Don't let anything received before parking be mistaken
+            // for a fresh measurement
+            uGnssMsgReceiveFlush(sessionDevHandle, false);
+        } else {
+            printk("Unable to wake GNSS from backup (%d), restarting it\r\n", errorCode);
+            gnssSessionClose();
+        }
+    } else if (sessionDevHandle != NULL) {
+        // Already up, e.g. a previous request did not release it
+        errorCode = 0;
+        start = GNSS_SESSION_START_WARM;
+    }
+
+    if (errorCode != 0) {
+        errorCode = sessionOpenCold();
+    }
+
+    if (errorCode == 0) {
+        *pDevHandle = sessionDevHandle;
+        if (pStart != NULL) {
+            *pStart = start;
+        }
+        printk("Gnss Powered on (%s start)\r\n", gnssSessionStartName(start));
+    }
+
+    return errorCode;
+}
+
+int32_t gnssSessionSetMessage(uint32_t keyId)
+{
+    int32_t errorCode = -1;
+
+    if (sessionDevHandle != NULL) {
+        errorCode = 0;
+        if (keyId != sessionMsgKeyId) {
+            if (sessionMsgKeyId != 0) {
+                uGnssCfgValSet(sessionDevHandle, sessionMsgKeyId, GNSS_SESSION_MSG_DISABLE,
+                               U_GNSS_CFG_VAL_TRANSACTION_NONE, GNSS_SESSION_CFG_LAYERS);
+                sessionMsgKeyId = 0;
+            }
+            errorCode = uGnssCfgValSet(sessionDevHandle, keyId, GNSS_SESSION_MSG_ENABLE,
+                                       U_GNSS_CFG_VAL_TRANSACTION_NONE, GNSS_SESSION_CFG_LAYERS);
+            if (errorCode == 0) {
+                sessionMsgKeyId = keyId;
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+void gnssSessionRelease(void)
+{
+    if ((sessionDevHandle != NULL) && !sessionParked) {
+        if (uGnssPwrOffBackup(sessionDevHandle) == 0) {
+            sessionParked = true;
+            printk("Gnss parked in backup mode\r\n");
+        } else {
+            printk("Unable to park GNSS, powering it off\r\n");
+            gnssSessionClose();
+        }
+    }
+}
+
+void gnssSessionClose(void)
+{
+    if (sessionDevHandle != NULL) {
+        uGnssPwrOff(sessionDevHandle);
+        uGnssRemove(sessionDevHandle);
+        sessionDevHandle = NULL;
+    }
+    if (sessionUartHandle >= 0) {
+        uPortUartClose(sessionUartHandle);
+        sessionUartHandle = -1;
+    }
+    max10BackupSupplyDisable();
+    sessionParked = false;
+    sessionMsgKeyId = 0;
+}
+
+void gnssSessionRecordFirstValid(gnssSessionStart_t start, int32_t elapsedMs)
+{
+    if (start < GNSS_SESSION_START_MAX_NUM) {
+        if ((sessionStats.count[start] == 0) || (elapsedMs < sessionStats.minMs[start])) {
+            sessionStats.minMs[start] = elapsedMs;
+        }
+        if (elapsedMs > sessionStats.maxMs[start]) {
+            sessionStats.maxMs[start] = elapsedMs;
+        }
+        sessionStats.lastMs[start] = elapsedMs;
+        sessionStats.totalMs[start] += elapsedMs;
+        sessionStats.count[start]++;
+    }
+}
+
+void gnssSessionGetStats(gnssSessionStats_t *pStats)
+{
+    memcpy(pStats, &sessionStats, sizeof(*pStats));
+}
+
+const char *gnssSessionStartName(gnssSessionStart_t start)
+{
+    return (start == GNSS_SESSION_START_WARM) ? "warm" : "cold";
+}
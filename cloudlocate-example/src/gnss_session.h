@@ -0,0 +1,115 @@
+/*
+ * Copyright 2020 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file gnss_session.h
+ * @brief GNSS session layer for the XPLR-IOT-1 Kit: keeps the M10 receiver
+ * configured across location requests and parks it in backup mode in between,
+ * so that all but the first request start hot.
+ */
+
+#ifndef _GNSS_SESSION_H_
+#define _GNSS_SESSION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ubxlib.h"
+
+/* ------------------------------------------------------------------------------
+ * TYPE DEFINITIONS
+ * -----------------------------------------------------------------------------*/
+
+/*! \enum gnssSessionStart_t
+ * @brief How the receiver was brought up for the current request
+ */
+typedef enum {
+    GNSS_SESSION_START_COLD,  /**< first request: receiver powered from scratch. */
+    GNSS_SESSION_START_WARM,  /**< receiver woken from backup with ephemeris retained. */
+    GNSS_SESSION_START_MAX_NUM
+} gnssSessionStart_t;
+
+/*! \struct gnssSessionStats_t
+ * @brief Time-to-first-valid-measurement statistics, per start type
+ */
+typedef struct {
+    int32_t count[GNSS_SESSION_START_MAX_NUM];
+    int32_t lastMs[GNSS_SESSION_START_MAX_NUM];
+    int32_t minMs[GNSS_SESSION_START_MAX_NUM];
+    int32_t maxMs[GNSS_SESSION_START_MAX_NUM];
+    int64_t totalMs[GNSS_SESSION_START_MAX_NUM];
+} gnssSessionStats_t;
+
+
+/* ------------------------------------------------------------------------------
+ * FUNCTION DECLARATIONS
+ * -----------------------------------------------------------------------------*/
+
+/** \fn int32_t gnssSessionAcquire(uDeviceHandle_t *pDevHandle, gnssSessionStart_t *pStart)
+ * @brief Get the GNSS receiver ready for a request.  The first call powers
+ * the receiver up from cold, opens the UART and adds the GNSS instance; later
+ * calls re-use the instance and wake the receiver from backup mode.
+ * @param[out] pDevHandle filled in with the GNSS device handle
+ * @param[out] pStart     filled in with how the receiver was started, may be NULL
+ * @return zero on success else negative error code
+*/
+int32_t gnssSessionAcquire(uDeviceHandle_t *pDevHandle, gnssSessionStart_t *pStart);
+
+/** \fn int32_t gnssSessionSetMessage(uint32_t keyId)
+ * @brief Make sure that the message with the given configuration key is the
+ * one being output.  The configuration is written to RAM and battery-backed
+ * RAM so that it survives parking; nothing is sent if the message is already
+ * configured.  A previously configured message is switched off.
+ * @param keyId the U_GNSS_CFG_VAL_KEY_ID_MSGOUT_xxx key of the message
+ * @return zero on success else negative error code
+*/
+int32_t gnssSessionSetMessage(uint32_t keyId);
+
+/** \fn void gnssSessionRelease(void)
+ * @brief Park the receiver in backup mode until the next request.  The GNSS
+ * instance and UART are kept and the backup supply stays on so that
+ * ephemeris, time and configuration are retained.
+*/
+void gnssSessionRelease(void);
+
+/** \fn void gnssSessionClose(void)
+ * @brief Power the receiver fully off and free the GNSS instance and UART;
+ * the next request will be a cold start.
+*/
+void gnssSessionClose(void);
+
+/** \fn void gnssSessionRecordFirstValid(gnssSessionStart_t start, int32_t elapsedMs)
+ * @brief Record the time it took to get the first valid measurement.
+ * @param start     how the receiver was started for this request
+ * @param elapsedMs milliseconds from acquire to first valid measurement
+*/
+void gnssSessionRecordFirstValid(gnssSessionStart_t start, int32_t elapsedMs);
+
+/** \fn void gnssSessionGetStats(gnssSessionStats_t *pStats)
+ * @brief Get a copy of the time-to-first-valid-measurement statistics.
+ * @param[out] pStats place to put the statistics
+*/
+void gnssSessionGetStats(gnssSessionStats_t *pStats);
+
+/** \fn const char *gnssSessionStartName(gnssSessionStart_t start)
+ * @brief Printable name for a start type.
+ * @param start the start type
+ * @return "cold" or "warm"
+*/
+const char *gnssSessionStartName(gnssSessionStart_t start);
+
+#endif // _GNSS_SESSION_H_
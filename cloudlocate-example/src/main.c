@@ -40,6 +40,7 @@
 #include <console/console.h>
 
 #include "module_config.h"
+#include "gnss_session.h"
 
 #include <shell/shell.h>
 #include <shell/shell_uart.h> 
@@ -48,10 +49,6 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
-//Flags to Enable/Disable Messages 
-#define U_GNSS_CFG_ENABLE_MSG 1
-#define U_GNSS_CFG_DISABLE_MSG 0
-
 // Thingstream Broker URL
 #define BROKER_NAME "mqtt.thingstream.io"
 
@@ -65,6 +62,19 @@
 #define PASSWORD_MAXLEN 50
 #define SUB_TOPIC_MAXLEN 100
 
+// Stack size and priority of the task that brings up the network and MQTT connection
+#define NETWORK_TASK_STACK_SIZE_BYTES (1024 * 4)
+#define NETWORK_TASK_PRIORITY U_CFG_OS_APP_TASK_PRIORITY
+
+// Scratch memory of a location request, taken from requestArena
+#define GNSS_COMPACT_MESSAGE_MAXLEN 1000
+#define RECEIVED_MSG_MAXLEN 250
+#define RECEIVED_MSG_TOPIC_MAXLEN 200
+#define REQUEST_ARENA_SIZE_BYTES (U_ARENA_ALLOC_SIZE_BYTES(GNSS_COMPACT_MESSAGE_MAXLEN) + \
+                                  U_ARENA_ALLOC_SIZE_BYTES(RECEIVED_MSG_MAXLEN) + \
+                                  U_ARENA_ALLOC_SIZE_BYTES(RECEIVED_MSG_TOPIC_MAXLEN) + \
+                                  U_ARENA_ALIGNMENT_BYTES)
+
 #define VERIFY(cond, fail_msg) \
     if (!(cond)) {\
         failed(fail_msg); \
@@ -97,6 +107,21 @@ typedef struct {
 } measCfg_t; 
 
 
+/*! \struct networkSession_t
+ * @brief Everything brought up by the network task for a location request
+ */
+typedef struct {
+    int32_t uartHandle;
+    uAtClientHandle_t atClientHandle;
+    uDeviceHandle_t devHandle;
+    uMqttClientContext_t *pContext;
+    volatile bool messagesAvailable;
+    int32_t errorCode;      /**< zero once registered, connected and subscribed. */
+    int32_t readyTimeMs;    /**< tick time at which the network task finished. */
+    uPortSemaphoreHandle_t readySemaphore;
+} networkSession_t;
+
+
 /* ------------------------------------------------------------------------------
  * CALLBACK DECLERATIONS
  * -----------------------------------------------------------------------------*/
@@ -140,6 +165,13 @@ void printUBXMessageinHex(char *pBuffer, int32_t bufferLenght);
 */
 int32_t getMeasMessageFromGNSS(char *pBuffer, int32_t bufferLength, messageType_t msgType);
 
+/** \fn static void networkConnectTask(void *pParam)
+ * @brief Task to register with the cellular network, connect to the MQTT broker and subscribe,
+ * run in parallel with GNSS measurement
+ * @param[in] pParam pointer to the networkSession_t to fill in
+*/
+static void networkConnectTask(void *pParam);
+
 /** \fn int32_t getLocationFromCloudLocate(const struct shell *shell, size_t argc, char **argv)
  * @brief Function to request position from CloudLocate service
  * @param[in] shell pointer to shell instance
@@ -164,6 +196,22 @@ static int getConfigParameters(const struct shell *shell, size_t argc, char **ar
 */
 static int setConfigParameters(const struct shell *shell, size_t argc, char **argv);
 
+/** \fn static int getGnssSessionStats(const struct shell *shell, size_t argc, char **argv)
+ * @brief Function to print time-to-first-valid-message for cold and warm GNSS starts
+ * @param[in] shell pointer to shell instance
+ * @param[in] argc count of arguments
+ * @param[in] argv pointer to array of arguments passed. 
+*/
+static int getGnssSessionStats(const struct shell *shell, size_t argc, char **argv);
+
+/** \fn static int closeGnssSession(const struct shell *shell, size_t argc, char **argv)
+ * @brief Function to switch the GNSS receiver fully off, the next request will be a cold start
+ * @param[in] shell pointer to shell instance
+ * @param[in] argc count of arguments
+ * @param[in] argv pointer to array of arguments passed. 
+*/
+static int closeGnssSession(const struct shell *shell, size_t argc, char **argv);
+
 
 /* ------------------------------------------------------------------------------
  * GLOBALS
@@ -186,9 +234,16 @@ int32_t fallbackTimeoutInSecs = 80;
 
 int32_t cellSearchstartTimeMs;
 bool isCellConnectAborted = false;
+// flag to stop network registration early when the GNSS part of a request has failed
+volatile bool networkAbortRequested = false;
 // flag to indicate whether the configuration is done or not 
 bool configurationDone = false;
 
+// All of the scratch memory of a location request comes from this arena,
+// which is reset at the end of each request, rather than from the shell stack
+static char requestArenaBuffer[REQUEST_ARENA_SIZE_BYTES];
+static uArena_t requestArena;
+
 /*! 
  * @brief A struct array containing messageIds and KeyIds for all meas messages
  * Reference: U-blox M10 Spg 5.10 Document (https://www.u-blox.com/docs/UBX-21035062)
@@ -214,7 +269,8 @@ static void messageIndicationCallback(int32_t numUnread, void *pParam)
 
 static bool continueCellSearchCallback(uDeviceHandle_t deviceHandle)
 {
-    bool shouldCellSearchContinue = (uPortGetTickTimeMs() - cellSearchstartTimeMs < (cellRegistrationTimeout*1000));
+    bool shouldCellSearchContinue = !networkAbortRequested &&
+                                    (uPortGetTickTimeMs() - cellSearchstartTimeMs < (cellRegistrationTimeout*1000));
 	if (!shouldCellSearchContinue){
         isCellConnectAborted = true;
     }
@@ -242,221 +298,168 @@ void printUBXMessageinHex(char *pBuffer, int32_t bufferLenght)
 
 int32_t getMeasMessageFromGNSS(char *pBuffer, int32_t bufferLength, messageType_t msgType)
 {
-    int32_t uartHandle;
-    uGnssTransportHandle_t gnssUartHandle;
     uDeviceHandle_t gnssDeviceHandle;
+    gnssSessionStart_t start;
     
     int count = 0;
     int32_t length = 0;
     uGnssMessageId_t messageId = {0};
     bool validMessage = false;
+    int32_t acquireTimeMs;
     int32_t startTimeMs;
-
-    max10Enable();
-    max10SafeBootDisable();
-    max10BackupSupplyDisable();
-    max10NoraCommEnable();
-
-      
-
-    uartHandle = uPortUartOpen(U_CFG_APP_GNSS_UART,
-                               U_GNSS_UART_BAUD_RATE, NULL,
-                               U_GNSS_UART_BUFFER_LENGTH_BYTES,
-                               -1,
-                               -1,
-                               -1,
-                               -1);
-
-    
-    gnssUartHandle.uart = uartHandle;
-
-    if (uGnssAdd(U_GNSS_MODULE_TYPE_M10,
-                 U_GNSS_TRANSPORT_UART, gnssUartHandle,
-                 EN_MAX_PIN, false, &gnssDeviceHandle) == U_ERROR_COMMON_SUCCESS) 
-    {
-        uGnssSetUbxMessagePrint(gnssDeviceHandle, false);
-
-        if (uGnssPwrOn(gnssDeviceHandle) == 0) {
-            printk("Gnss Powered on\r\n");
+    int32_t firstMessageWaitMs;
+
+    acquireTimeMs = uPortGetTickTimeMs();
+    if (gnssSessionAcquire(&gnssDeviceHandle, &start) == 0) {
+        // For the selected message type in configuration, enabling that message on GNSS receiver;
+        // on a warm start the receiver already has it configured so nothing is sent
+        if(gnssSessionSetMessage(msgInfo[msgType].keyId) == 0) {
+            startTimeMs = uPortGetTickTimeMs();     
+            printk("Enabled compact message.\r\n");
+
+            // The first-message wait is there to let a cold receiver settle on its
+            // satellites; a warm receiver is tracking already so no need to wait
+            firstMessageWaitMs = (start == GNSS_SESSION_START_COLD) ? numOfSecondsToWaitForFirstMessage*1000 : 0;
+
+            messageId.type = U_GNSS_PROTOCOL_UBX;
+            messageId.id.ubx = msgInfo[msgType].messageId; 
+            printk("Waiting for compact message. Timer values TimeToWaitForFirstMessage: %d, CompactMessageTimeout: %d\r\n", firstMessageWaitMs/1000,compactMsgTimeoutInSecs);
             
-            // For the selected message type in configuration, enabling that message on GNSS receiver 
-            if(uGnssCfgValSet(gnssDeviceHandle, msgInfo[msgType].keyId, U_GNSS_CFG_ENABLE_MSG, U_GNSS_CFG_VAL_TRANSACTION_NONE,U_GNSS_CFG_VAL_LAYER_RAM) == 0) {
-                startTimeMs = uPortGetTickTimeMs();     
-                printk("Enabled compact message.\r\n");
+            // Waiting for compact message within the given timer values
+            while(!validMessage && ((uPortGetTickTimeMs() - startTimeMs) < (compactMsgTimeoutInSecs*1000))  ) //timer is expired
+            {
+                length = uGnssMsgReceive(gnssDeviceHandle, &messageId, &pBuffer, bufferLength, compactMsgTimeoutInSecs*1000, NULL);
+                     
+                if (length > 0 && ((uPortGetTickTimeMs() - startTimeMs) >= firstMessageWaitMs) ) //added check for the first message wait
+                {       
+                    // MEASX is generated even if there is no satellite information so adding a length check
+                    // so we know that whatever we are sending have atleast some satellite information in it
+                    if(msgType == MEASX && length > 300)
+                    {
+                        validMessage = true;        
+                    }
 
+                    //CloudLocate service expects compact message(MEAS50 and MEAS20) without header and checksum so stripping down the message
+                    if(msgType == MEAS20 || msgType == MEAS50 )
+                    {
+                        unsigned char strippedMessage[50];
+                        memcpy(strippedMessage,pBuffer+6,length-8);
+                        memset(pBuffer,0,length);
+                        length  = length - 8; // removing the length for header and checksum
+                        memcpy(pBuffer, strippedMessage, length);
+                        validMessage = true;
+                        printk("Compact message found\n");   
+                    }
 
-                messageId.type = U_GNSS_PROTOCOL_UBX;
-                messageId.id.ubx = msgInfo[msgType].messageId; 
-                printk("Waiting for compact message. Timer values TimeToWaitForFirstMessage: %d, CompactMessageTimeout: %d\r\n", numOfSecondsToWaitForFirstMessage,compactMsgTimeoutInSecs);
+                    if (validMessage)
+                    {
+                        acquireTimeMs = uPortGetTickTimeMs() - acquireTimeMs;
+                        gnssSessionRecordFirstValid(start, acquireTimeMs);
+                        printk("Time to first valid message: %d ms (%s start)\n",
+                               acquireTimeMs, gnssSessionStartName(start));
+                    }
+                }    
+            }
+            if (validMessage == false && fallbackNavpvtEnabled == true ){
+                printk("No compact message found. FallBack configuration is enabled so looking for NAVPVT msg.. \n");
+                startTimeMs = uPortGetTickTimeMs();
+                gnssSessionSetMessage(msgInfo[(messageType_t)NAVPVT].keyId);
                 
-                // Waiting for compact message within the given timer values
-                while(!validMessage && ((uPortGetTickTimeMs() - startTimeMs) < (compactMsgTimeoutInSecs*1000))  ) //timer is expired
-                {
-                    length = uGnssMsgReceive(gnssDeviceHandle, &messageId, &pBuffer, bufferLength, compactMsgTimeoutInSecs*1000, NULL);
-                         
-                    if (length > 0 && ((uPortGetTickTimeMs() - startTimeMs) >= (numOfSecondsToWaitForFirstMessage*1000)) ) //added check for the first message wait
-                    {       
-                        // MEASX is generated even if there is no satellite information so adding a length check
-                        // so we know that whatever we are sending have atleast some satellite information in it
-                        if(msgType == MEASX && length > 300)
-                        {
-                            validMessage = true;        
-                        }
-
-                        //CloudLocate service expects compact message(MEAS50 and MEAS20) without header and checksum so stripping down the message
-                        if(msgType == MEAS20 || msgType == MEAS50 )
-                        {
-                            unsigned char strippedMessage[50];
-                            memcpy(strippedMessage,pBuffer+6,length-8);
-                            memset(pBuffer,0,length);
-                            length  = length - 8; // removing the length for header and checksum
-                            memcpy(pBuffer, strippedMessage, length);
-                            validMessage = true;
-                            printk("Compact message found\n");   
-                        }
-                        
-                    }    
-                }
-                if (validMessage == false && fallbackNavpvtEnabled == true ){
-                    printk("No compact message found. FallBack configuration is enabled so looking for NAVPVT msg.. \n");
-                    startTimeMs = uPortGetTickTimeMs();
-                    uGnssCfgValSet(gnssDeviceHandle, msgInfo[(messageType_t)NAVPVT].keyId, U_GNSS_CFG_ENABLE_MSG, U_GNSS_CFG_VAL_TRANSACTION_NONE,U_GNSS_CFG_VAL_LAYER_RAM);
-                    
-                    messageId.id.ubx = msgInfo[(messageType_t)NAVPVT].messageId;
-                    
-                    //Waiting for a valid NAVPVT message within the given fallback timeout
-                    while(!validMessage && ((uPortGetTickTimeMs() - startTimeMs) < (fallbackTimeoutInSecs*1000))){
-                            length = uGnssMsgReceive(gnssDeviceHandle, &messageId, &pBuffer, bufferLength, fallbackTimeoutInSecs*1000, NULL);
-                            if (length > 0 ){
-                                if ((pBuffer[27] & 0x01) && (pBuffer[26] == 0x02 || pBuffer[26] == 0x03)) // Fix only valid when it is 2d or 3d fix and also GNSSFixOk flag is set 
-                                {
-                                    printk("Valid NAVPVT message found\n"); 
-                                    validMessage = true;
-                                }
+                messageId.id.ubx = msgInfo[(messageType_t)NAVPVT].messageId;
+                
+                //Waiting for a valid NAVPVT message within the given fallback timeout
+                while(!validMessage && ((uPortGetTickTimeMs() - startTimeMs) < (fallbackTimeoutInSecs*1000))){
+                        length = uGnssMsgReceive(gnssDeviceHandle, &messageId, &pBuffer, bufferLength, fallbackTimeoutInSecs*1000, NULL);
+                        if (length > 0 ){
+                            if ((pBuffer[27] & 0x01) && (pBuffer[26] == 0x02 || pBuffer[26] == 0x03)) // Fix only valid when it is 2d or 3d fix and also GNSSFixOk flag is set 
+                            {
+                                printk("Valid NAVPVT message found\n"); 
+                                validMessage = true;
                             }
+                        }
 
-                    }   
-                }
-
-                if(validMessage)
-                {
-                    printk("Final message :    ");        
-					printUBXMessageinHex(pBuffer, length) ;
-					count = length;
-                }
+                }   
             }
-            else
+
+            if(validMessage)
             {
-                printk("Error in enabling meas message\r\n");
+                printk("Final message :    ");        
+                printUBXMessageinHex(pBuffer, length) ;
+                count = length;
             }
         }
-        else{
-            printk("Could not power on GNSS\r\n");
+        else
+        {
+            printk("Error in enabling meas message\r\n");
         }
+        // Park the receiver rather than switching it off so that the next request starts hot
+        gnssSessionRelease();
+    }
+    else{
+        printk("Could not power on GNSS\r\n");
     }
-    uGnssRemove(gnssDeviceHandle);
-    uPortUartClose(uartHandle);
-    uGnssPwrOff(gnssDeviceHandle);
 	return count;
 
 }
 
-int32_t getLocationFromCloudLocate(const struct shell *shell, size_t argc, char **argv){
-    
-    if (configurationDone == false){
-        shell_print(shell, "Before requesting location please complete the parameter configurtion using config command\r\n");
-        return 1;
-    }
-    unsigned char gnssCompactMessage[1000];
-    int32_t gnssCompactMessageLength;
-    uDeviceHandle_t devHandle;
-    int32_t cellResponse;
-    int32_t uartHandle;
-    uAtClientHandle_t atClientHandle;
-    uMqttClientContext_t *pContext = NULL;
+static void networkConnectTask(void *pParam)
+{
+    networkSession_t *pSession = (networkSession_t *) pParam;
     uMqttClientConnection_t connection = U_MQTT_CLIENT_CONNECTION_DEFAULT;
-    char receivedMsg[250];
-    size_t receivedMsgSize;
-    char receivedMsgTopic[200];
-    volatile bool messagesAvailable = false;
-    int32_t startTimeMs;
     int32_t numofRetries = 2;
     int32_t errorCode = -1;
-    messageType_t msgType; 
-
-    if (strcmp("measx", argv[1]) == 0)
-    {
-        msgType = MEASX;
-    }
-    else if (strcmp("meas50", argv[1]) == 0)
-    {
-        msgType = MEAS50;
-    }
-    else if ((strcmp("meas20", argv[1]) == 0))
-    {
-        msgType = MEAS20;
-    }
-    else {
-        printk("Invalid message type: %s\n", argv[1]);
-        return 1;
-    }
-
-    gnssCompactMessageLength = getMeasMessageFromGNSS(gnssCompactMessage, sizeof(gnssCompactMessage), msgType );
-    if (gnssCompactMessageLength <= 0 )
-    {
-        printk("Unable to get message from GNSS. Please adjust timer values in configuration parameters\n");  
-        return 1;
-    }
 
-    uartHandle = uPortUartOpen(2,
-                               115200, NULL,
-                               U_CELL_UART_BUFFER_LENGTH_BYTES,
-                               -1,
-                               -1,
-                               -1,
-                               -1);
-
-    atClientHandle = uAtClientAdd(uartHandle,
-                                  U_AT_CLIENT_STREAM_TYPE_UART,
-                                  NULL,
-                                  U_CELL_AT_BUFFER_LENGTH_BYTES);
-
-    cellResponse = uCellAdd(U_CELL_MODULE_TYPE_SARA_R5,
-                          atClientHandle,
-                          -1,
-                          -1,
-                          -1, false, &devHandle);
+    pSession->uartHandle = uPortUartOpen(2,
+                                         115200, NULL,
+                                         U_CELL_UART_BUFFER_LENGTH_BYTES,
+                                         -1,
+                                         -1,
+                                         -1,
+                                         -1);
+
+    pSession->atClientHandle = uAtClientAdd(pSession->uartHandle,
+                                            U_AT_CLIENT_STREAM_TYPE_UART,
+                                            NULL,
+                                            U_CELL_AT_BUFFER_LENGTH_BYTES);
+
+    uCellAdd(U_CELL_MODULE_TYPE_SARA_R5,
+             pSession->atClientHandle,
+             -1,
+             -1,
+             -1, false, &pSession->devHandle);
 
     
-    uAtClientPrintAtSet(atClientHandle, true);
-    uAtClientLock(atClientHandle);
+    uAtClientPrintAtSet(pSession->atClientHandle, true);
+    uAtClientLock(pSession->atClientHandle);
     
     //  AT command To disable echo
-    uAtClientCommandStart(atClientHandle, "ATE0");
-    uAtClientCommandStopReadResponse(atClientHandle);
+    uAtClientCommandStart(pSession->atClientHandle, "ATE0");
+    uAtClientCommandStopReadResponse(pSession->atClientHandle);
 
     // AT+CMEE AT command enable or disable the use of result code
     // Enable +CME ERROR: result code and use verbose values
-    uAtClientCommandStart(atClientHandle, "AT+CMEE=2");
-    uAtClientCommandStopReadResponse(atClientHandle);
-    uAtClientUnlock(atClientHandle);    
+    uAtClientCommandStart(pSession->atClientHandle, "AT+CMEE=2");
+    uAtClientCommandStopReadResponse(pSession->atClientHandle);
+    uAtClientUnlock(pSession->atClientHandle);    
     
     // Bring up the network interface
     printk("Bringing up the network...\n");
+    isCellConnectAborted = false;
 	cellSearchstartTimeMs = uPortGetTickTimeMs();
-    for (int i= 0; i< numofRetries && errorCode!= 0; i++){
-        errorCode = uCellNetConnect(devHandle, NULL, APN, NULL, NULL, continueCellSearchCallback);
+    for (int i= 0; i< numofRetries && errorCode!= 0 && !networkAbortRequested; i++){
+        errorCode = uCellNetConnect(pSession->devHandle, NULL, APN, NULL, NULL, continueCellSearchCallback);
         uPortTaskBlock (500);
     }
     //Refers to cellRegistrationTimeout
-	if (isCellConnectAborted)
+	if (isCellConnectAborted && !networkAbortRequested)
 	{
 		printk("Network registration aborted because it took more than cellRegistrationTimeout(s): %d. Please check if you have good network coverage \r\n", cellRegistrationTimeout );
 	}
 
     if (errorCode == 0) {
-        pContext = pUMqttClientOpen(devHandle, NULL);
-        if (pContext != NULL) {
+        errorCode = -1;
+        pSession->pContext = pUMqttClientOpen(pSession->devHandle, NULL);
+        if (pSession->pContext != NULL) {
             connection.pBrokerNameStr = BROKER_NAME;
             connection.pClientIdStr = clientId;
             connection.pUserNameStr = username;
@@ -464,69 +467,166 @@ int32_t getLocationFromCloudLocate(const struct shell *shell, size_t argc, char
 
             // Connect to the MQTT broker
             printk("Connecting to MQTT broker \"%s\"...\n", BROKER_NAME);
-            if (uMqttClientConnect(pContext, &connection) == 0) {
+            if (uMqttClientConnect(pSession->pContext, &connection) == 0) {
 
                 // Set up a callback to be called when new messages are available
-                uMqttClientSetMessageCallback(pContext,
+                uMqttClientSetMessageCallback(pSession->pContext,
                                               messageIndicationCallback,
-                                              (void *) &messagesAvailable);
+                                              (void *) &pSession->messagesAvailable);
 
                 // Subscribe to the topic on the broker
                 printk("Subscribing to topic \"%s\"...\n", subTopic);
-                if (uMqttClientSubscribe(pContext, subTopic,
-                                         U_MQTT_QOS_EXACTLY_ONCE)) {
-
-                    // Publish our message to our topic on the MQTT broker
-                    printk("Publishing \"%s\" to topic \"%s\"...\n",
-                             gnssCompactMessage, PUB_TOPIC);
-                    startTimeMs = uPortGetTickTimeMs();
-                    if (uMqttClientPublish(pContext, PUB_TOPIC, gnssCompactMessage,
-                                           gnssCompactMessageLength,
-                                           U_MQTT_QOS_EXACTLY_ONCE,
-                                           false) == 0) {
-
-                        // Wait for us to be notified that our new
-                        // message is available on the broker
-                        while (!messagesAvailable &&
-                               (uPortGetTickTimeMs() - startTimeMs < 10000)) {
-                            uPortTaskBlock(1000);
-                        }
-
-                        // Read the new message from the broker
-                        while (uMqttClientGetUnread(pContext) > 0) {
-                            receivedMsgSize = sizeof(receivedMsg);
-                            if (uMqttClientMessageRead(pContext, receivedMsgTopic,
-                                                       sizeof(receivedMsgTopic),
-                                                       receivedMsg, &receivedMsgSize,
-                                                       NULL) == 0) {
-                                printk("CloudLocate response:  \"%.*s\"\n",receivedMsgSize, receivedMsg);
-                            }
-                        }
-                    } else {
-                        printk("Unable to publish our message \"%s\"!\n",
-                                 gnssCompactMessage);
-                    }
+                if (uMqttClientSubscribe(pSession->pContext, subTopic,
+                                         U_MQTT_QOS_EXACTLY_ONCE) >= 0) {
+                    errorCode = 0;
                 } else {
                     printk("Unable to subscribe to topic \"%s\"!\n", subTopic);
                 }
-                uMqttClientDisconnect(pContext);
             } else {
                 printk("Unable to connect to MQTT broker \"%s\"!\n",BROKER_NAME);
             }
         } else {
             printk("Unable to create MQTT instance!\n");
         }
-
-        uMqttClientClose(pContext);
-        printk("Taking down network...\n");
     } 
     else {
       printk("Unable to bring up the network!\n");
     }
+
+    pSession->errorCode = errorCode;
+    pSession->readyTimeMs = uPortGetTickTimeMs();
+    uPortSemaphoreGive(pSession->readySemaphore);
+    uPortTaskDelete(NULL);
+}
+
+int32_t getLocationFromCloudLocate(const struct shell *shell, size_t argc, char **argv){
+    
+    if (configurationDone == false){
+        shell_print(shell, "Before requesting location please complete the parameter configurtion using config command\r\n");
+        return 1;
+    }
+    unsigned char *gnssCompactMessage;
+    int32_t gnssCompactMessageLength;
+    networkSession_t session = {0};
+    uPortTaskHandle_t networkTaskHandle;
+    char *receivedMsg;
+    size_t receivedMsgSize;
+    char *receivedMsgTopic;
+    int32_t requestStartTimeMs;
+    int32_t gnssReadyTimeMs;
+    int32_t startTimeMs;
+    messageType_t msgType; 
+
+    if (strcmp("measx", argv[1]) == 0)
+    {
+        msgType = MEASX;
+    }
+    else if (strcmp("meas50", argv[1]) == 0)
+    {
+        msgType = MEAS50;
+    }
+    else if ((strcmp("meas20", argv[1]) == 0))
+    {
+        msgType = MEAS20;
+    }
+    else {
+        printk("Invalid message type: %s\n", argv[1]);
+        return 1;
+    }
+
+    gnssCompactMessage = (unsigned char *) pUArenaAlloc(&requestArena, GNSS_COMPACT_MESSAGE_MAXLEN);
+    receivedMsg = (char *) pUArenaAlloc(&requestArena, RECEIVED_MSG_MAXLEN);
+    receivedMsgTopic = (char *) pUArenaAlloc(&requestArena, RECEIVED_MSG_TOPIC_MAXLEN);
+    if ((gnssCompactMessage == NULL) || (receivedMsg == NULL) || (receivedMsgTopic == NULL)) {
+        printk("Unable to allocate request memory!\n");
+        uArenaReset(&requestArena);
+        return 1;
+    }
+
+    if (uPortSemaphoreCreate(&session.readySemaphore, 0, 1) != 0) {
+        printk("Unable to create network semaphore!\n");
+        uArenaReset(&requestArena);
+        return 1;
+    }
+
+    // Network registration and the MQTT connection are brought up on their
+    // own task while this one gets the measurement from GNSS, so that the
+    // request takes as long as the slower of the two rather than their sum
+    requestStartTimeMs = uPortGetTickTimeMs();
+    session.uartHandle = -1;
+    session.errorCode = -1;
+    networkAbortRequested = false;
+    if (uPortTaskCreate(networkConnectTask, "networkConnect",
+                        NETWORK_TASK_STACK_SIZE_BYTES, (void *) &session,
+                        NETWORK_TASK_PRIORITY, &networkTaskHandle) != 0) {
+        printk("Unable to start network task!\n");
+        uPortSemaphoreDelete(session.readySemaphore);
+        uArenaReset(&requestArena);
+        return 1;
+    }
+
+    gnssCompactMessageLength = getMeasMessageFromGNSS(gnssCompactMessage, GNSS_COMPACT_MESSAGE_MAXLEN, msgType );
+    gnssReadyTimeMs = uPortGetTickTimeMs();
+    if (gnssCompactMessageLength <= 0 )
+    {
+        printk("Unable to get message from GNSS. Please adjust timer values in configuration parameters\n");  
+        // No point in carrying on registering
+        networkAbortRequested = true;
+    }
+
+    // Wait for the network task to be done, successfully or otherwise
+    uPortSemaphoreTake(session.readySemaphore);
+    printk("GNSS ready after %d ms, network ready after %d ms, request ready after %d ms\n",
+           gnssReadyTimeMs - requestStartTimeMs, session.readyTimeMs - requestStartTimeMs,
+           uPortGetTickTimeMs() - requestStartTimeMs);
+
+    if (gnssCompactMessageLength > 0 && session.errorCode == 0) {
+        // Publish our message to our topic on the MQTT broker
+        printk("Publishing \"%s\" to topic \"%s\"...\n",
+                 gnssCompactMessage, PUB_TOPIC);
+        startTimeMs = uPortGetTickTimeMs();
+        if (uMqttClientPublish(session.pContext, PUB_TOPIC, gnssCompactMessage,
+                               gnssCompactMessageLength,
+                               U_MQTT_QOS_EXACTLY_ONCE,
+                               false) == 0) {
+
+            // Wait for us to be notified that our new
+            // message is available on the broker
+            while (!session.messagesAvailable &&
+                   (uPortGetTickTimeMs() - startTimeMs < 10000)) {
+                uPortTaskBlock(1000);
+            }
+
+            // Read the new message from the broker
+            while (uMqttClientGetUnread(session.pContext) > 0) {
+                receivedMsgSize = RECEIVED_MSG_MAXLEN;
+                if (uMqttClientMessageRead(session.pContext, receivedMsgTopic,
+                                           RECEIVED_MSG_TOPIC_MAXLEN,
+                                           receivedMsg, &receivedMsgSize,
+                                           NULL) == 0) {
+                    printk("CloudLocate response:  \"%.*s\"\n",receivedMsgSize, receivedMsg);
+                }
+            }
+        } else {
+            printk("Unable to publish our message \"%s\"!\n",
+                     gnssCompactMessage);
+        }
+    }
+
+    if (session.pContext != NULL) {
+        if (uMqttClientIsConnected(session.pContext)) {
+            uMqttClientDisconnect(session.pContext);
+        }
+        uMqttClientClose(session.pContext);
+        printk("Taking down network...\n");
+    }
     
-    uCellRemove(devHandle);
-    uAtClientRemove(atClientHandle);
-    uPortUartClose(uartHandle);
+    uCellRemove(session.devHandle);
+    uAtClientRemove(session.atClientHandle);
+    uPortUartClose(session.uartHandle);
+    uPortSemaphoreDelete(session.readySemaphore);
+    // Release all of the request's scratch memory in one go
+    uArenaReset(&requestArena);
     return 0;
 }
 
@@ -618,6 +718,33 @@ static int setConfigParameters(const struct shell *shell, size_t argc, char **ar
 }
 
 
+static int getGnssSessionStats(const struct shell *shell, size_t argc, char **argv)
+{
+    gnssSessionStats_t stats;
+
+    gnssSessionGetStats(&stats);
+    for (int i = 0; i < GNSS_SESSION_START_MAX_NUM; i++) {
+        if (stats.count[i] > 0) {
+            shell_print(shell, "%s start: %d request(s), time to first valid message last %d ms, min %d ms, max %d ms, average %d ms\r\n",
+                        gnssSessionStartName((gnssSessionStart_t) i), stats.count[i], stats.lastMs[i],
+                        stats.minMs[i], stats.maxMs[i], (int32_t) (stats.totalMs[i] / stats.count[i]));
+        } else {
+            shell_print(shell, "%s start: no requests yet\r\n", gnssSessionStartName((gnssSessionStart_t) i));
+        }
+    }
+
+    return 0;
+}
+
+static int closeGnssSession(const struct shell *shell, size_t argc, char **argv)
+{
+    gnssSessionClose();
+    shell_print(shell, "GNSS switched off, the next location request will be a cold start\r\n");
+
+    return 0;
+}
+
+
 /* ------------------------------------------------------------------------------
  * SHELL COMMANDS
  * 1- config
@@ -625,6 +752,9 @@ static int setConfigParameters(const struct shell *shell, size_t argc, char **ar
  * 	1b- config get
  * 2- location MsgType 
  * MsgType refers to meas20, meas50 or measx 
+ * 3- gnss
+ * 	3a- gnss stats
+ * 	3b- gnss off
  * -----------------------------------------------------------------------------*/
 
 //2nd Level of options - Config Subcommands
@@ -636,10 +766,20 @@ SHELL_STATIC_SUBCMD_SET_CREATE(config_sub_cmd,
         SHELL_CMD(set,   NULL, "set configuration parameters: <MqttUsername> <MqttPassword> <DeviceId> <APN> <CellRegistrationTimeout(s)> <TimeToWaitForFirstMessage(s)> <CompactMessageTimeout(s)> <FallbackNavpvtStatus> <FallbackTimeout(s)>", setConfigParameters),
         SHELL_SUBCMD_SET_END
 );
+//2nd Level of options - GNSS session Subcommands
+SHELL_STATIC_SUBCMD_SET_CREATE(gnss_sub_cmd,
+        //Command to print time to first valid message for cold and warm starts
+        SHELL_CMD(stats, NULL, "print time to first valid message for cold and warm GNSS starts", getGnssSessionStats),
+        //Command to switch the GNSS receiver fully off
+        SHELL_CMD(off,   NULL, "switch GNSS fully off, the next location request will be a cold start", closeGnssSession),
+        SHELL_SUBCMD_SET_END
+);
 // Command to get the location based on the configured parameters
 SHELL_CMD_REGISTER(location, NULL, "Get location from CloudLocate using measx/meas20/meas50", getLocationFromCloudLocate);
 // 1st level of options - Configuration of parameters
 SHELL_CMD_REGISTER(config, &config_sub_cmd, "Configuration of parameters", NULL);
+// 1st level of options - GNSS session
+SHELL_CMD_REGISTER(gnss, &gnss_sub_cmd, "GNSS session statistics and control", NULL);
 
 
 /* ----------------------------------------------------------------
@@ -653,6 +793,8 @@ void main(void)
     uAtClientInit();
     uCellInit();
     uGnssInit(); 
+    VERIFY(uArenaCreate(&requestArena, requestArenaBuffer, sizeof(requestArenaBuffer)) == 0,
+           "uArenaCreate failed\n");
     
     // Cellular network is required to publish gnss measurements to CloudLocate Service
     printk("Turning on SARA-R5..\r\n");
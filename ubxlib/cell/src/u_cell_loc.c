@@ -300,8 +300,7 @@ static void UULOC_urc(uAtClientHandle_t atHandle, void *pParam)
     int32_t length;
     size_t offset;
     int32_t numParameters = 0;
-    int32_t months;
-    int32_t year;
+    uTimeDate_t date = {0};
     int64_t timeUtc = LONG_MIN;
     int32_t latitudeX1e7 = INT_MIN;
     int32_t longitudeX1e7 = INT_MIN;
@@ -319,22 +318,18 @@ static void UULOC_urc(uAtClientHandle_t atHandle, void *pParam)
     length = uAtClientReadString(atHandle, buffer, sizeof(buffer), false);
     if (length > 0) {
         offset = 0;
-        timeUtc = 0;
         // Day (1 to 31)
         buffer[offset + 2] = 0;
-        timeUtc += (int64_t) (strtol(&(buffer[offset]), NULL, 10) - 1) * 3600 * 24;
-        // Months converted to months since January
+        date.day = strtol(&(buffer[offset]), NULL, 10);
+        // Month (1 to 12)
         offset = 3;
         buffer[offset + 2] = 0;
-        // Month (1 to 12), so take away 1 to make it zero-based
-        months = strtol(&(buffer[offset]), NULL, 10) - 1;
-        // Four digit year converted to years since 1970
+        date.month = strtol(&(buffer[offset]), NULL, 10);
+        // Four digit year
         offset = 6;
         buffer[offset + 4] = 0;
-        year = strtol(&(buffer[offset]), NULL, 10) - 1970;
-        months += year * 12;
-        // Work out the number of seconds due to the year/month count
-        timeUtc += uTimeMonthsToSecondsUtc(months);
+        date.year = strtol(&(buffer[offset]), NULL, 10);
+        timeUtc = uTimeDateToEpoch(&date);
         numParameters++;
     }
     // Time is of the form 10:48:43.000
@@ -343,15 +338,16 @@ static void UULOC_urc(uAtClientHandle_t atHandle, void *pParam)
         // Hours since midnight
         offset = 0;
         buffer[offset + 2] = 0;
-        timeUtc += (int64_t) strtol(&(buffer[offset]), NULL, 10) * 3600;
+        date.hours = strtol(&(buffer[offset]), NULL, 10);
         // Minutes after the hour
         offset = 3;
         buffer[offset + 2] = 0;
-        timeUtc += (int64_t) strtol(&(buffer[offset]), NULL, 10) * 60;
+        date.minutes = strtol(&(buffer[offset]), NULL, 10);
         // Seconds after the hour
         offset = 6;
         buffer[offset + 2] = 0;
-        timeUtc += (int64_t) strtol(&(buffer[offset]), NULL, 10);
+        date.seconds = strtol(&(buffer[offset]), NULL, 10);
+        timeUtc = uTimeDateToEpoch(&date);
         numParameters++;
     }
 
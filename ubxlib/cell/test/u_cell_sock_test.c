@@ -55,6 +55,8 @@
 
 #include "u_at_client.h"
 
+#include "u_slab.h"
+
 #include "u_sock.h"
 
 #include "u_cell_module_type.h"
@@ -1065,6 +1067,7 @@ U_PORT_TEST_FUNCTION("[cellSock]", "cellSockOptionSetGet")
 U_PORT_TEST_FUNCTION("[cellSock]", "cellSockCleanUp")
 {
     int32_t x;
+    uSlabStats_t slabStats;
 
     uCellSockDeinit();
     uCellTestPrivateCleanup(&gHandles);
@@ -1078,6 +1081,13 @@ U_PORT_TEST_FUNCTION("[cellSock]", "cellSockCleanUp")
 
     uPortDeinit();
 
+    // Everything taken from the slab allocator should have been
+    // given back by now
+    for (int32_t y = 0; y < U_SLAB_NUM_SIZE_CLASSES; y++) {
+        U_PORT_TEST_ASSERT(uSlabGetStats(y, &slabStats) == 0);
+        U_PORT_TEST_ASSERT(slabStats.usedBlockCount == 0);
+    }
+
     x = uPortGetHeapMinFree();
     if (x >= 0) {
         U_TEST_PRINT_LINE("heap had a minimum of %d byte(s) free"
@@ -86,6 +86,57 @@
 # define U_PACKED_STRUCT(NAME) struct __attribute__((packed)) NAME
 #endif
 
+/** U_ATOMIC_LOAD_ACQUIRE_PTR/U_ATOMIC_STORE_RELEASE_PTR: read/write
+ * a pointer variable, passed in by address, that is shared between
+ * two threads of execution without a lock: no memory access that
+ * follows the load in program order may be moved before it and no
+ * memory access that precedes the store may be moved after it.
+ */
+#ifdef _MSC_VER
+/** Microsoft Visual C++ definition: with the default /volatile:ms
+ * a volatile read has acquire semantics and a volatile write has
+ * release semantics.
+ */
+# define U_ATOMIC_LOAD_ACQUIRE_PTR(ppX) (*(void *volatile *) (ppX))
+# define U_ATOMIC_STORE_RELEASE_PTR(ppX, pValue) (*(void *volatile *) (ppX) = (void *) (pValue))
+#else
+/** Default (GCC) definition.
+ */
+# define U_ATOMIC_LOAD_ACQUIRE_PTR(ppX) __atomic_load_n(ppX, __ATOMIC_ACQUIRE)
+# define U_ATOMIC_STORE_RELEASE_PTR(ppX, pValue) __atomic_store_n(ppX, pValue, __ATOMIC_RELEASE)
+#endif
+
+/** U_ATOMIC_LOAD_ACQUIRE/U_ATOMIC_STORE_RELEASE/U_ATOMIC_COMPARE_AND_SWAP/
+ * U_ATOMIC_ADD_FETCH: operations on a 32-bit integer variable, passed
+ * in by address, that may be modified by any number of threads of
+ * execution without a lock.  U_ATOMIC_STORE_RELEASE() is for a
+ * variable that another thread may be reading at the same time with
+ * U_ATOMIC_LOAD_ACQUIRE().  U_ATOMIC_COMPARE_AND_SWAP() writes desired to
+ * the variable only if it still contains expected, returning true
+ * if it did so; U_ATOMIC_ADD_FETCH() adds value to the variable and
+ * returns the result; these two are full barriers.
+ */
+#ifdef _MSC_VER
+/** Microsoft Visual C++ definition, using the Interlocked intrinsics.
+ */
+# include <intrin.h>
+# define U_ATOMIC_LOAD_ACQUIRE(pX) (*(volatile long *) (pX))
+# define U_ATOMIC_STORE_RELEASE(pX, value) (*(volatile long *) (pX) = (long) (value))
+# define U_ATOMIC_COMPARE_AND_SWAP(pX, expected, desired)                         \
+    (_InterlockedCompareExchange((volatile long *) (pX), (long) (desired),       \
+                                 (long) (expected)) == (long) (expected))
+# define U_ATOMIC_ADD_FETCH(pX, value)                                            \
+    (_InterlockedExchangeAdd((volatile long *) (pX), (long) (value)) + (long) (value))
+#else
+/** Default (GCC) definition.
+ */
+# define U_ATOMIC_LOAD_ACQUIRE(pX) __atomic_load_n(pX, __ATOMIC_ACQUIRE)
+# define U_ATOMIC_STORE_RELEASE(pX, value) __atomic_store_n(pX, value, __ATOMIC_RELEASE)
+# define U_ATOMIC_COMPARE_AND_SWAP(pX, expected, desired) \
+    __sync_bool_compare_and_swap(pX, expected, desired)
+# define U_ATOMIC_ADD_FETCH(pX, value) __atomic_add_fetch(pX, value, __ATOMIC_SEQ_CST)
+#endif
+
 #endif // _U_COMPILER_H_
 
 
@@ -29,7 +29,6 @@
 # include "u_cfg_override.h" // For a customer's configuration override
 #endif
 
-#include "stdlib.h"    // free()
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
@@ -40,6 +39,8 @@
 
 #include "u_port_os.h"
 
+#include "u_slab.h"
+
 #include "u_cell_loc.h"
 
 #include "u_gnss_pos.h"
@@ -134,8 +135,8 @@ static void gnssPosCallback(uDeviceHandle_t devHandle,
             }
             pEntry->pCallback(devHandle, errorCode, &location);
         }
-        // It is legal C to free a NULL pointer
-        free(pEntry);
+        // uSlabFree() is fine with a NULL pointer
+        uSlabFree(pEntry);
 
         U_PORT_MUTEX_UNLOCK(gULocationMutex);
     }
@@ -178,8 +179,8 @@ static void cellLocCallback(uDeviceHandle_t devHandle,
                 pEntry->pCallback(devHandle, errorCode, NULL);
             }
         }
-        // It is legal C to free a NULL pointer
-        free(pEntry);
+        // uSlabFree() is fine with a NULL pointer
+        uSlabFree(pEntry);
 
         U_PORT_MUTEX_UNLOCK(gULocationMutex);
     }
@@ -318,7 +319,7 @@ int32_t uLocationGetStart(uDeviceHandle_t devHandle, uLocationType_t type,
                     if (errorCode == 0) {
                         errorCode = uCellLocGetStart(devHandle, cellLocCallback);
                         if (errorCode != 0) {
-                            free(pULocationSharedRequestPop(U_LOCATION_TYPE_CLOUD_CELL_LOCATE));
+                            uSlabFree(pULocationSharedRequestPop(U_LOCATION_TYPE_CLOUD_CELL_LOCATE));
                         }
                     }
                 }
@@ -337,7 +338,7 @@ int32_t uLocationGetStart(uDeviceHandle_t devHandle, uLocationType_t type,
             if (errorCode == 0) {
                 errorCode = uGnssPosGetStart(devHandle, gnssPosCallback);
                 if (errorCode != 0) {
-                    free(pULocationSharedRequestPop(U_LOCATION_TYPE_GNSS));
+                    uSlabFree(pULocationSharedRequestPop(U_LOCATION_TYPE_GNSS));
                 }
             }
         }
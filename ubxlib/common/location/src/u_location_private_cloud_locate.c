@@ -47,6 +47,7 @@
 #include "u_port_debug.h"
 
 #include "u_time.h"
+#include "u_arena.h"
 
 #include "u_gnss_pos.h"
 
@@ -95,8 +96,7 @@
 /** The size of buffer to use for the subscribe topic.  Must be larger
  * enough for  U_LOCATION_PRIVATE_CLOUD_LOCATE_MQTT_SUBSCRIBE_TOPIC_PREFIX
  * plus U_LOCATION_PRIVATE_CLOUD_LOCATE_MQTT_SUBSCRIBE_TOPIC_POSTFIX plus
- * the longest pClientIdStr plus 1 for the terminator.  Note that this is
- * stored on the stack so it also shouldn't be too big.
+ * the longest pClientIdStr plus 1 for the terminator.
  */
 # define U_LOCATION_PRIVATE_CLOUD_LOCATE_SUBSCRIBE_TOPIC_LENGTH_BYTES 128
 #endif
@@ -108,6 +108,31 @@
 # define U_LOCATION_PRIVATE_CLOUD_LOCATE_READ_MESSAGE_LENGTH_BYTES 512
 #endif
 
+/** The part of the arena used while waiting for the location to
+ * come back: a read buffer for the topic and one for the message,
+ * +1 to allow a terminator to be added to the message.
+ */
+#define U_LOCATION_PRIVATE_CLOUD_LOCATE_ARENA_READ_BYTES                           \
+    (U_ARENA_ALLOC_SIZE_BYTES(U_LOCATION_PRIVATE_CLOUD_LOCATE_SUBSCRIBE_TOPIC_LENGTH_BYTES) + \
+     U_ARENA_ALLOC_SIZE_BYTES(U_LOCATION_PRIVATE_CLOUD_LOCATE_READ_MESSAGE_LENGTH_BYTES + 1))
+
+#ifndef U_LOCATION_PRIVATE_CLOUD_LOCATE_ARENA_SIZE_BYTES
+/** The size of the arena from which all of the buffers of a Cloud
+ * Locate request are taken; this is the one heap allocation made
+ * per request.  The subscribe topic is held for the whole request
+ * while the RRLP buffer and, later, the read buffers share the
+ * remainder, plus #U_ARENA_ALIGNMENT_BYTES in case malloc() aligns
+ * less strictly than the arena.
+ */
+# define U_LOCATION_PRIVATE_CLOUD_LOCATE_ARENA_SIZE_BYTES                              \
+    (U_ARENA_ALLOC_SIZE_BYTES(U_LOCATION_PRIVATE_CLOUD_LOCATE_SUBSCRIBE_TOPIC_LENGTH_BYTES) +    \
+     (U_ARENA_ALLOC_SIZE_BYTES(U_LOCATION_PRIVATE_CLOUD_LOCATE_BUFFER_LENGTH_BYTES) >           \
+      U_LOCATION_PRIVATE_CLOUD_LOCATE_ARENA_READ_BYTES ?                                        \
+      U_ARENA_ALLOC_SIZE_BYTES(U_LOCATION_PRIVATE_CLOUD_LOCATE_BUFFER_LENGTH_BYTES) :           \
+      U_LOCATION_PRIVATE_CLOUD_LOCATE_ARENA_READ_BYTES) +                                       \
+     U_ARENA_ALIGNMENT_BYTES)
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -236,8 +261,7 @@ static int32_t parseLocation(char *pStr, uLocation_t *pLocation)
 {
     char *pSaved;
     int32_t x;
-    int32_t year;
-    int32_t months;
+    uTimeDate_t date = {0};
 
     pStr = pFindItem(pStr, "\"Lat\"");
     if (pStr != NULL) {
@@ -283,39 +307,37 @@ static int32_t parseLocation(char *pStr, uLocation_t *pLocation)
         pStr = strtok_r(pStr, "-", &pSaved);
         // Skip the opening quote
         pStr++;
-        // Four digit year converted to years since 1970
-        year = strtol(pStr, NULL, 10) - 1970;
-        if (year >= 2021 - 1970) {
+        // Four digit year
+        date.year = strtol(pStr, NULL, 10);
+        if (date.year >= 2021) {
             // Move pStr to the start of the month
             pStr = strtok_r(NULL, "-", &pSaved);
             if (pStr != NULL) {
-                // Month (1 to 12), so take away 1 to make it zero-based
-                months = strtol(pStr, NULL, 10) - 1;
-                months += year * 12;
-                // Work out the number of seconds due to the year/month count
-                pLocation->timeUtc = uTimeMonthsToSecondsUtc(months);
+                // Month (1 to 12)
+                date.month = strtol(pStr, NULL, 10);
             }
             // Move pStr to the start of the day and tokenize-out the "T"
             pStr = strtok_r(NULL, "T", &pSaved);
             if (pStr != NULL) {
                 // Day (1 to 31)
-                pLocation->timeUtc += (int64_t) (strtol(pStr, NULL, 10) - 1) * 3600 * 24;
+                date.day = strtol(pStr, NULL, 10);
             }
             // Move pStr to the start of the hours and tokenize-out the ":"
             pStr = strtok_r(NULL, ":", &pSaved);
             if (pStr != NULL) {
                 // Hours since midnight
-                pLocation->timeUtc  += (int64_t) strtol(pStr, NULL, 10) * 3600;
+                date.hours = strtol(pStr, NULL, 10);
             }
             // Move pStr to Minutes after the hour
             pStr = strtok_r(NULL, ":", &pSaved);
             if (pStr != NULL) {
-                pLocation->timeUtc  += (int64_t) strtol(pStr, NULL, 10) * 60;
+                date.minutes = strtol(pStr, NULL, 10);
             }
             // Move pStr to Seconds after the hour, which ends at the final quotation mark
             pStr = strtok_r(NULL, ":", &pSaved);
             if (pStr != NULL) {
-                pLocation->timeUtc += (int64_t) strtol(pStr, NULL, 10);
+                date.seconds = strtol(pStr, NULL, 10);
+                pLocation->timeUtc = uTimeDateToEpoch(&date);
             }
         } else {
             pStr = NULL;
@@ -342,8 +364,10 @@ int32_t uLocationPrivateCloudLocate(uDeviceHandle_t devHandle,
                                     bool (*pKeepGoingCallback) (uDeviceHandle_t))
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uArena_t arena;
+    size_t arenaMark;
     char *pBuffer;
-    char topicBuffer[U_LOCATION_PRIVATE_CLOUD_LOCATE_SUBSCRIBE_TOPIC_LENGTH_BYTES];
+    char *pTopicBuffer;
     char *pTopicBufferRead;
     char *pMessageRead;
     int32_t startTimeMs = uPortGetTickTimeMs();
@@ -352,60 +376,71 @@ int32_t uLocationPrivateCloudLocate(uDeviceHandle_t devHandle,
 
     if ((gnssDevHandle != NULL) && (pMqttClientContext != NULL) &&
         ((pLocation == NULL) || (pClientIdStr != NULL))) {
-        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-        // Allocate memory to store the RRLP information
-        pBuffer = (char *) malloc(U_LOCATION_PRIVATE_CLOUD_LOCATE_BUFFER_LENGTH_BYTES);
-        if (pBuffer != NULL) {
-            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-            if ((pClientIdStr != NULL) && (pLocation != NULL)) {
-                // If the device also wanted the location, assemble the name
-                // of the subscribe topic and subscribe to it
-                strncpy(topicBuffer, U_LOCATION_PRIVATE_CLOUD_LOCATE_MQTT_SUBSCRIBE_TOPIC_PREFIX,
-                        sizeof(topicBuffer));
-                strncat(topicBuffer, pClientIdStr,
-                        sizeof(topicBuffer) - strlen(topicBuffer) - 1); // -1 to allow room for terminator
-                strncat(topicBuffer, U_LOCATION_PRIVATE_CLOUD_LOCATE_MQTT_SUBSCRIBE_TOPIC_POSTFIX,
-                        sizeof(topicBuffer) - strlen(topicBuffer) - 1); // -1 to allow room for terminator
-                errorCode = uMqttClientSubscribe(pMqttClientContext, topicBuffer, U_MQTT_QOS_EXACTLY_ONCE);
-                subscribed = (errorCode >= 0);
-            }
+        // All of the memory for this request comes from one arena,
+        // a single heap allocation, released in one go at the end
+        errorCode = uArenaCreate(&arena, NULL, U_LOCATION_PRIVATE_CLOUD_LOCATE_ARENA_SIZE_BYTES);
+        if (errorCode == 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            // The subscribe topic is needed throughout
+            pTopicBuffer = (char *) pUArenaAlloc(&arena,
+                                                 U_LOCATION_PRIVATE_CLOUD_LOCATE_SUBSCRIBE_TOPIC_LENGTH_BYTES);
+            // Memory to store the RRLP information, which is
+            // given back to the arena once it has been sent
+            arenaMark = uArenaGetMark(&arena);
+            pBuffer = (char *) pUArenaAlloc(&arena, U_LOCATION_PRIVATE_CLOUD_LOCATE_BUFFER_LENGTH_BYTES);
+            if ((pTopicBuffer != NULL) && (pBuffer != NULL)) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                if ((pClientIdStr != NULL) && (pLocation != NULL)) {
+                    // If the device also wanted the location, assemble the name
+                    // of the subscribe topic and subscribe to it
+                    strncpy(pTopicBuffer, U_LOCATION_PRIVATE_CLOUD_LOCATE_MQTT_SUBSCRIBE_TOPIC_PREFIX,
+                            U_LOCATION_PRIVATE_CLOUD_LOCATE_SUBSCRIBE_TOPIC_LENGTH_BYTES);
+                    // -1 to allow room for terminator
+                    strncat(pTopicBuffer, pClientIdStr,
+                            U_LOCATION_PRIVATE_CLOUD_LOCATE_SUBSCRIBE_TOPIC_LENGTH_BYTES - strlen(pTopicBuffer) - 1);
+                    strncat(pTopicBuffer, U_LOCATION_PRIVATE_CLOUD_LOCATE_MQTT_SUBSCRIBE_TOPIC_POSTFIX,
+                            U_LOCATION_PRIVATE_CLOUD_LOCATE_SUBSCRIBE_TOPIC_LENGTH_BYTES - strlen(pTopicBuffer) - 1);
+                    errorCode = uMqttClientSubscribe(pMqttClientContext, pTopicBuffer, U_MQTT_QOS_EXACTLY_ONCE);
+                    subscribed = (errorCode >= 0);
+                }
 
-            if (errorCode >= 0) { // >= 0 since uMqttClientSubscribe() returns QoS
-                // Get the RRLP data from the GNSS chip
-                errorCode = uGnssPosGetRrlp(gnssDevHandle, pBuffer,
-                                            U_LOCATION_PRIVATE_CLOUD_LOCATE_BUFFER_LENGTH_BYTES,
-                                            svsThreshold, cNoThreshold, multipathIndexLimit,
-                                            pseudorangeRmsErrorIndexLimit,
-                                            pKeepGoingCallback);
-                if (errorCode >= 0) {
-                    // Send the RRLP data to the Cloud Locate service using MQTT
-                    errorCode = uMqttClientPublish(pMqttClientContext,
-                                                   U_LOCATION_PRIVATE_CLOUD_LOCATE_MQTT_PUBLISH_TOPIC,
-                                                   pBuffer, errorCode,
-                                                   U_MQTT_QOS_EXACTLY_ONCE, false);
+                if (errorCode >= 0) { // >= 0 since uMqttClientSubscribe() returns QoS
+                    // Get the RRLP data from the GNSS chip
+                    errorCode = uGnssPosGetRrlp(gnssDevHandle, pBuffer,
+                                                U_LOCATION_PRIVATE_CLOUD_LOCATE_BUFFER_LENGTH_BYTES,
+                                                svsThreshold, cNoThreshold, multipathIndexLimit,
+                                                pseudorangeRmsErrorIndexLimit,
+                                                pKeepGoingCallback);
+                    if (errorCode >= 0) {
+                        // Send the RRLP data to the Cloud Locate service using MQTT
+                        errorCode = uMqttClientPublish(pMqttClientContext,
+                                                       U_LOCATION_PRIVATE_CLOUD_LOCATE_MQTT_PUBLISH_TOPIC,
+                                                       pBuffer, errorCode,
+                                                       U_MQTT_QOS_EXACTLY_ONCE, false);
+                    }
                 }
-            }
 
-            // Free memory
-            free(pBuffer);
-
-            if ((errorCode == 0) && (pClientIdStr != NULL) && (pLocation != NULL)) {
-                // If all of that was successful, and after we've
-                // freed memory, if the user wanted the location
-                // wait for it to turn up
-                pLocation->latitudeX1e7 = 0;
-                pLocation->longitudeX1e7 = 0;
-                pLocation->altitudeMillimetres = INT_MIN;
-                pLocation->radiusMillimetres = -1;
-                pLocation->speedMillimetresPerSecond = INT_MIN;
-                pLocation->svs = -1;
-                pLocation->timeUtc = -1;
-                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-                pTopicBufferRead = (char *) malloc(U_LOCATION_PRIVATE_CLOUD_LOCATE_SUBSCRIBE_TOPIC_LENGTH_BYTES);
-                if (pTopicBufferRead != NULL) {
+                // Give the RRLP memory back so that the read
+                // buffers can use it
+                uArenaRewind(&arena, arenaMark);
+
+                if ((errorCode == 0) && (pClientIdStr != NULL) && (pLocation != NULL)) {
+                    // If all of that was successful, if the user wanted
+                    // the location wait for it to turn up
+                    pLocation->latitudeX1e7 = 0;
+                    pLocation->longitudeX1e7 = 0;
+                    pLocation->altitudeMillimetres = INT_MIN;
+                    pLocation->radiusMillimetres = -1;
+                    pLocation->speedMillimetresPerSecond = INT_MIN;
+                    pLocation->svs = -1;
+                    pLocation->timeUtc = -1;
+                    errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                    pTopicBufferRead = (char *) pUArenaAlloc(&arena,
+                                                             U_LOCATION_PRIVATE_CLOUD_LOCATE_SUBSCRIBE_TOPIC_LENGTH_BYTES);
                     // +1 to allow us to insert a terminator
-                    pMessageRead = (char *) malloc(U_LOCATION_PRIVATE_CLOUD_LOCATE_READ_MESSAGE_LENGTH_BYTES + 1);
-                    if (pMessageRead != NULL) {
+                    pMessageRead = (char *) pUArenaAlloc(&arena,
+                                                         U_LOCATION_PRIVATE_CLOUD_LOCATE_READ_MESSAGE_LENGTH_BYTES + 1);
+                    if ((pTopicBufferRead != NULL) && (pMessageRead != NULL)) {
                         errorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
                         uPortLog("U_LOCATION_PRIVATE_CLOUD_LOCATE: RRLP sent, waiting for"
                                  " location from server...\n");
@@ -424,10 +459,8 @@ int32_t uLocationPrivateCloudLocate(uDeviceHandle_t devHandle,
                                     // Add a terminator to make the message a string so that
                                     // parseLocation() can parse it later
                                     *(pMessageRead + z) = 0;
-                                    //lint -esym(645, topicBuffer) Suppress warning about
-                                    // topicBuffer not being initialised: it is but it is
-                                    // too difficult for Lint to track
-                                    if (strncmp(pTopicBufferRead, topicBuffer, sizeof(topicBuffer)) != 0) {
+                                    if (strncmp(pTopicBufferRead, pTopicBuffer,
+                                                U_LOCATION_PRIVATE_CLOUD_LOCATE_SUBSCRIBE_TOPIC_LENGTH_BYTES) != 0) {
                                         // Not our topic, keep the timeout
                                         errorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
                                     }
@@ -442,20 +475,17 @@ int32_t uLocationPrivateCloudLocate(uDeviceHandle_t devHandle,
                             // Parse the location out of the MQTT message
                             errorCode = parseLocation(pMessageRead, pLocation);
                         }
-
-                        // Free message memory
-                        free(pMessageRead);
                     }
+                }
 
-                    // Free topic memory
-                    free(pTopicBufferRead);
+                if (subscribed) {
+                    // Unsubscribe from the topic, for neatness
+                    uMqttClientUnsubscribe(pMqttClientContext, pTopicBuffer);
                 }
             }
 
-            if (subscribed) {
-                // Unsubscribe from the topic, for neatness
-                uMqttClientUnsubscribe(pMqttClientContext, topicBuffer);
-            }
+            // Free all of the memory in one go
+            uArenaDelete(&arena);
         }
     }
 
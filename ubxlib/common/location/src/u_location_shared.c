@@ -31,7 +31,6 @@
 # include "u_cfg_override.h" // For a customer's configuration override
 #endif
 
-#include "stdlib.h"    // malloc()/free().
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
@@ -40,6 +39,8 @@
 
 #include "u_port_os.h"
 
+#include "u_slab.h"
+
 #include "u_location.h"
 #include "u_location_shared.h"
 
@@ -103,7 +104,7 @@ void uLocationSharedDeinit()
              x < (int32_t) U_LOCATION_TYPE_MAX_NUM;
              x++) {
             while ((pEntry = pULocationSharedRequestPop((uLocationType_t) x)) != NULL) {
-                free(pEntry);
+                uSlabFree(pEntry);
             }
         }
         U_PORT_MUTEX_UNLOCK(gULocationMutex);
@@ -147,7 +148,7 @@ int32_t uLocationSharedRequestPush(uDeviceHandle_t devHandle,
     if (ppThis != NULL) {
         errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
         // Add the new entry at the start of the list
-        *ppThis = (uLocationSharedFifoEntry_t *) malloc(sizeof(**ppThis));
+        *ppThis = (uLocationSharedFifoEntry_t *) pUSlabAlloc(sizeof(**ppThis));
         if (*ppThis != NULL) {
             (*ppThis)->devHandle = devHandle;
             (*ppThis)->pCallback = pCallback;
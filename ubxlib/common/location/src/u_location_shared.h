@@ -101,7 +101,8 @@ int32_t uLocationSharedRequestPush(uDeviceHandle_t devHandle,
  * @param type the request type.
  * @return     the entry pointer: it is removed from the list and
  *             hence it is up to the calling task to free the pointer
- *             when done; NULL is returned if the FIFO is empty.
+ *             with uSlabFree() when done; NULL is returned if the
+ *             FIFO is empty.
  */
 uLocationSharedFifoEntry_t *pULocationSharedRequestPop(uLocationType_t type);
 
@@ -49,6 +49,8 @@
 #include "u_port_os.h"
 #include "u_port_i2c.h"
 
+#include "u_slab.h"
+
 #include "u_network.h"
 #include "u_network_test_shared_cfg.h"
 
@@ -494,6 +496,7 @@ U_PORT_TEST_FUNCTION("[location]", "locationBasic")
 U_PORT_TEST_FUNCTION("[location]", "locationCleanUp")
 {
     int32_t x;
+    uSlabStats_t slabStats;
 
     if (gpLocationCfg != NULL) {
         // Free the memory from the location configuration copy
@@ -518,6 +521,13 @@ U_PORT_TEST_FUNCTION("[location]", "locationCleanUp")
     uPortI2cDeinit();
     uPortDeinit();
 
+    // Everything taken from the slab allocator should have been
+    // given back by now
+    for (int32_t y = 0; y < U_SLAB_NUM_SIZE_CLASSES; y++) {
+        U_PORT_TEST_ASSERT(uSlabGetStats(y, &slabStats) == 0);
+        U_PORT_TEST_ASSERT(slabStats.usedBlockCount == 0);
+    }
+
     x = uPortGetHeapMinFree();
     if (x >= 0) {
         U_TEST_PRINT_LINE("heap had a minimum of %d byte(s) free at"
@@ -37,7 +37,6 @@
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
 #include "string.h"    // strlen(), strtol()
-#include "time.h"      // struct tm
 #include "ctype.h"     // isprint(), isblank()
 
 #include "u_cfg_sw.h"
@@ -45,10 +44,11 @@
 #include "u_error_common.h"
 
 #include "u_port_clib_platform_specific.h" // isblank() in some cases
-#include "u_port_clib_mktime64.h"
 #include "u_port.h"
 #include "u_port_os.h"
 
+#include "u_time.h"
+
 #include "u_at_client.h"
 
 #include "u_device_shared.h"
@@ -268,27 +268,27 @@ static int32_t credentialListGetRemove(uSecurityCredential_t *pCredential)
 static int64_t parseTimestampString(char *pStr)
 {
     int64_t utc = 0;
-    struct tm timeStruct = {0};
+    uTimeDate_t date;
 
     // Do sanity checks
     if ((strlen(pStr) == 19) && (*(pStr + 4) == '/') &&
         (*(pStr + 7) == '/') && (*(pStr + 10) == ' ') &&
         (*(pStr + 13) == ':') && (*(pStr + 16) == ':')) {
 
-        // Populate the time structure
-        timeStruct.tm_sec = strtol(pStr + 17, NULL, 10);
+        // Populate the date
+        date.seconds = strtol(pStr + 17, NULL, 10);
         *(pStr + 16) = 0;
-        timeStruct.tm_min = strtol(pStr + 14, NULL, 10);
+        date.minutes = strtol(pStr + 14, NULL, 10);
         *(pStr + 13) = 0;
-        timeStruct.tm_hour = strtol(pStr + 11, NULL, 10);
+        date.hours = strtol(pStr + 11, NULL, 10);
         *(pStr + 10) = 0;
-        timeStruct.tm_mday = strtol(pStr + 8, NULL, 10);
+        date.day = strtol(pStr + 8, NULL, 10);
         *(pStr + 7) = 0;
-        timeStruct.tm_mon = strtol(pStr + 5, NULL, 10) - 1;
+        date.month = strtol(pStr + 5, NULL, 10);
         *(pStr + 4) = 0;
-        timeStruct.tm_year = strtol(pStr, NULL, 10) - 1900;
+        date.year = strtol(pStr, NULL, 10);
 
-        utc = mktime64(&timeStruct);
+        utc = uTimeDateToEpoch(&date);
     }
 
     return utc;
@@ -39,6 +39,7 @@
 #include "u_port_event_queue.h"
 #include "u_port_uart.h"
 #include "u_port_debug.h"
+#include "u_slab.h"
 #include "u_at_client.h"
 #include "u_short_range_pbuf.h"
 #include "u_short_range_module_type.h"
@@ -854,8 +855,8 @@ static int32_t edmSend(const uShortRangeEdmStreamInstance_t *pEdmStream)
     size_t written = 0;
     int32_t sizeOrError = (int32_t) U_ERROR_COMMON_NO_MEMORY;
 
-    pPacket = (char *) malloc(U_SHORT_RANGE_EDM_STREAM_AT_COMMAND_LENGTH +
-                              U_SHORT_RANGE_EDM_REQUEST_OVERHEAD);
+    pPacket = (char *) pUSlabAlloc(U_SHORT_RANGE_EDM_STREAM_AT_COMMAND_LENGTH +
+                                   U_SHORT_RANGE_EDM_REQUEST_OVERHEAD);
     if (pPacket != NULL) {
         sizeOrError = uShortRangeEdmRequest(pEdmStream->pAtCommandBuffer,
                                             pEdmStream->atCommandCurrent,
@@ -871,7 +872,7 @@ static int32_t edmSend(const uShortRangeEdmStreamInstance_t *pEdmStream)
                                      (uint32_t) sizeOrError - written);
             }
         }
-        free(pPacket);
+        uSlabFree(pPacket);
     }
 
     return sizeOrError;
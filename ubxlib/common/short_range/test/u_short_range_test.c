@@ -48,6 +48,8 @@
 #include "u_at_client.h"
 #include "u_short_range_module_type.h"
 #include "u_short_range.h"
+
+#include "u_slab.h"
 #if (U_CFG_TEST_UART_A >= 0) || defined(U_CFG_TEST_SHORT_RANGE_MODULE_TYPE)
 #include "u_port_debug.h"
 #endif
@@ -316,7 +318,16 @@ U_PORT_TEST_FUNCTION("[shortRange]", "shortRangeResetToDefaultSettings")
  */
 U_PORT_TEST_FUNCTION("[shortRange]", "shortRangeCleanUp")
 {
+    uSlabStats_t slabStats;
+
     uShortRangeTestPrivateCleanup(&gHandles);
+
+    // Everything taken from the slab allocator should have been
+    // given back by now
+    for (int32_t y = 0; y < U_SLAB_NUM_SIZE_CLASSES; y++) {
+        U_PORT_TEST_ASSERT(uSlabGetStats(y, &slabStats) == 0);
+        U_PORT_TEST_ASSERT(slabStats.usedBlockCount == 0);
+    }
 }
 
 #endif
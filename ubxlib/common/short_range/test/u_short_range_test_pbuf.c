@@ -63,6 +63,20 @@
  */
 #define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
 
+/** The number of EDM packets to push through the pbuf pools when
+ * measuring receive throughput.
+ */
+#ifndef U_SHORT_RANGE_PBUF_TEST_THROUGHPUT_NUM_PACKETS
+# define U_SHORT_RANGE_PBUF_TEST_THROUGHPUT_NUM_PACKETS 1000
+#endif
+
+/** The number of blocks in each EDM packet when measuring receive
+ * throughput.
+ */
+#ifndef U_SHORT_RANGE_PBUF_TEST_THROUGHPUT_NUM_BLOCKS
+# define U_SHORT_RANGE_PBUF_TEST_THROUGHPUT_NUM_BLOCKS 8
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -262,4 +276,68 @@ U_PORT_TEST_FUNCTION("[pbuf]", "pbufPktList")
     U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
 }
 
+U_PORT_TEST_FUNCTION("[pbuf]", "pbufThroughput")
+{
+    int32_t errCode;
+    uShortRangePbufList_t *pPbufList;
+    uShortRangePbuf_t *pBuf;
+    int32_t heapUsed;
+    char *pBuffer;
+    size_t copiedLen = 0;
+    int32_t timeMs;
+    //lint -e{679} suppress loss of precision
+    //lint -e{647} suppress suspicious truncation
+    size_t packetLen = U_SHORT_RANGE_PBUF_TEST_THROUGHPUT_NUM_BLOCKS *
+                       U_SHORT_RANGE_EDM_BLK_SIZE;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+
+    errCode = uShortRangeMemPoolInit();
+    U_PORT_TEST_ASSERT(errCode == (int32_t)U_ERROR_COMMON_SUCCESS);
+
+    pBuffer = (char *)malloc(packetLen);
+    U_PORT_TEST_ASSERT(pBuffer != NULL);
+
+    // Do what the EDM receive path does for each packet: allocate
+    // a pbuf list, fill pbufs and append them to it, then copy the
+    // data out and free the lot
+    timeMs = uPortGetTickTimeMs();
+    for (size_t x = 0; x < U_SHORT_RANGE_PBUF_TEST_THROUGHPUT_NUM_PACKETS; x++) {
+        pPbufList = pUShortRangePbufListAlloc();
+        U_PORT_TEST_ASSERT(pPbufList != NULL);
+        for (size_t y = 0; y < U_SHORT_RANGE_PBUF_TEST_THROUGHPUT_NUM_BLOCKS; y++) {
+            errCode = uShortRangePbufAlloc(&pBuf);
+            U_PORT_TEST_ASSERT(errCode == U_SHORT_RANGE_EDM_BLK_SIZE);
+            memset(pBuf->data, (int) (x + y), errCode);
+            pBuf->length = (uint16_t) errCode;
+            errCode = uShortRangePbufListAppend(pPbufList, pBuf);
+            U_PORT_TEST_ASSERT(errCode == (int32_t)U_ERROR_COMMON_SUCCESS);
+        }
+        copiedLen += uShortRangePbufListConsumeData(pPbufList, pBuffer, packetLen);
+        U_PORT_TEST_ASSERT(*(pBuffer + packetLen - 1) ==
+                           (char) (x + U_SHORT_RANGE_PBUF_TEST_THROUGHPUT_NUM_BLOCKS - 1));
+        uShortRangePbufListFree(pPbufList);
+    }
+    timeMs = uPortGetTickTimeMs() - timeMs;
+    U_PORT_TEST_ASSERT(copiedLen == packetLen * U_SHORT_RANGE_PBUF_TEST_THROUGHPUT_NUM_PACKETS);
+    U_TEST_PRINT_LINE("%d byte(s) received through pbufs in %d ms.", (int) copiedLen, timeMs);
+    if (timeMs > 0) {
+        U_TEST_PRINT_LINE("that's %d kbytes/s.", (int) (copiedLen / timeMs));
+    }
+
+    uShortRangeMemPoolDeInit();
+    free(pBuffer);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
 // End of file
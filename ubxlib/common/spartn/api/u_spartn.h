@@ -60,6 +60,59 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** A validated SPARTN message, as passed to the callback of a
+ * framer, see uSpartnFramerAddData().
+ */
+typedef struct {
+    const char *pMessage; /**< the entire message, TF001 to TF018,
+                               still encrypted; this points either
+                               into the data passed to
+                               uSpartnFramerAddData() or, if the
+                               message arrived in more than one
+                               piece, into the framer, and is valid
+                               only for the duration of the callback. */
+    size_t size;          /**< the number of bytes at pMessage. */
+    int32_t type;         /**< the message type (TF002). */
+    int32_t subType;      /**< the message sub-type (TF007). */
+} uSpartnMessage_t;
+
+/** Callback that is given each validated message by
+ * uSpartnFramerAddData().
+ *
+ * @param[in] pMessage       the message, which may not be modified.
+ * @param[in] pCallbackParam the pCallbackParam that was passed to
+ *                           uSpartnFramerAddData().
+ */
+typedef void (*uSpartnFramerCallback_t)(const uSpartnMessage_t *pMessage,
+                                        void *pCallbackParam);
+
+/** A SPARTN framer: finds and validates the SPARTN messages in a
+ * stream of data that arrives in chunks of any size, e.g. from MQTT
+ * or extracted from the UBX-RXM-PMP messages of a NEO-D9S, holding
+ * on to the start of any message that is not yet complete.  This
+ * includes a buffer of #U_SPARTN_MESSAGE_LENGTH_MAX_BYTES so you
+ * may want to allocate it statically or with malloc() rather than
+ * put it on the stack.  Other than the counts, which may be read,
+ * the contents should not be accessed directly.
+ */
+typedef struct {
+    char buffer[U_SPARTN_MESSAGE_LENGTH_MAX_BYTES]; /**< the part of a
+                                                         message held
+                                                         over. */
+    size_t bufferLength;                /**< the number of bytes in buffer. */
+    size_t messageLength;               /**< the length of the message in
+                                             buffer, zero if not yet known. */
+    int32_t messageCrcType;             /**< the message CRC type of the
+                                             message in buffer, a
+                                             uSpartnCrcType_t. */
+    int32_t messageCount;               /**< the number of valid messages
+                                             found. */
+    int32_t crcErrorCount;              /**< the number of messages that
+                                             failed the message CRC check. */
+    int32_t discardedBytes;             /**< the number of bytes that were
+                                             not part of a valid message. */
+} uSpartnFramer_t;
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -145,6 +198,42 @@ int32_t uSpartnDetect(const char *pBuffer, size_t bufferLengthBytes,
 int32_t uSpartnValidate(const char *pBuffer, size_t bufferLengthBytes,
                         const char **ppMessage);
 
+/** Initialise a SPARTN framer, or reset one, throwing away any
+ * message it is holding and zeroing the counts.
+ *
+ * @param[out] pFramer a pointer to the framer, cannot be NULL.
+ * @return             zero on success else negative error code.
+ */
+int32_t uSpartnFramerInit(uSpartnFramer_t *pFramer);
+
+/** Add a chunk of data to a SPARTN framer.  Each SPARTN message that
+ * is completed by the data, and passes both the frame CRC and the
+ * message CRC checks, is passed to pCallback, in order, before this
+ * function returns.  Where a message is entirely within the chunk,
+ * which is the usual case, the callback is given a pointer into
+ * the chunk itself: the data is not copied.  Anything that is not
+ * part of a valid message is skipped.  Note that rubbish which
+ * happens to pass the frame CRC check will hold up the messages that
+ * follow it until enough data has arrived to fail its message CRC
+ * check.
+ *
+ * @param[in] pFramer        a pointer to the framer, which must have
+ *                           been initialised with uSpartnFramerInit().
+ * @param[in] pData          a pointer to the data; may be NULL only
+ *                           if size is zero.
+ * @param size               the number of bytes at pData.
+ * @param[in] pCallback      the function to call with each message;
+ *                           may be NULL, e.g. to just count messages.
+ * @param[in] pCallbackParam a parameter that will be passed to
+ *                           pCallback; may be NULL.
+ * @return                   the number of messages passed to pCallback
+ *                           else negative error code.
+ */
+int32_t uSpartnFramerAddData(uSpartnFramer_t *pFramer,
+                             const char *pData, size_t size,
+                             uSpartnFramerCallback_t pCallback,
+                             void *pCallbackParam);
+
 #ifdef __cplusplus
 }
 #endif
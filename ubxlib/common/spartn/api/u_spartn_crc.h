@@ -62,6 +62,16 @@ typedef enum {
     U_SPARTN_CRC_TYPE_NONE
 } uSpartnCrcType_t;
 
+/** Context for a CRC worked out in pieces with uSpartnCrcInit(),
+ * uSpartnCrcUpdate() and uSpartnCrcFinal(), e.g. over a message
+ * that is split across the wrap of a ring buffer or arrives in
+ * several chunks; the contents should not be accessed directly.
+ */
+typedef struct {
+    uSpartnCrcType_t type;
+    uint32_t remainder;
+} uSpartnCrcContext_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -102,6 +112,19 @@ uint16_t uSpartnCrc16(const char *pData, size_t size);
  */
 uint32_t uSpartnCrc24(const char *pData, size_t size);
 
+/** Continue a CRC24 Radix 64 calculation with another block of
+ * data, e.g. where a message is split across the two halves of
+ * a ring buffer.  This is the same polynomial, with the same zero
+ * initial value, as the CRC-24Q of RTCM 3; for a complete RTCM 3
+ * frame, including its CRC, the result will be zero.
+ *
+ * @param crc    the CRC so far, zero for the first block.
+ * @param pData  a pointer to the data to be checked.
+ * @param size   the number of bytes pointed to by pData.
+ * @return       the CRC.
+ */
+uint32_t uSpartnCrc24Update(uint32_t crc, const char *pData, size_t size);
+
 /** Perform a CRC32 calculation on a block of data.
  *
  * @param pData  a pointer to the data to be checked.
@@ -110,6 +133,36 @@ uint32_t uSpartnCrc24(const char *pData, size_t size);
  */
 uint32_t uSpartnCrc32(const char *pData, size_t size);
 
+/** Start a CRC calculation that is to be performed in pieces.
+ *
+ * @param[out] pContext a pointer to the context, cannot be NULL.
+ * @param type          the CRC type; #U_SPARTN_CRC_TYPE_MAX_NUM
+ *                      and #U_SPARTN_CRC_TYPE_NONE are not
+ *                      allowed.
+ * @return              zero on success else negative error code.
+ */
+int32_t uSpartnCrcInit(uSpartnCrcContext_t *pContext, uSpartnCrcType_t type);
+
+/** Add a block of data to a CRC calculation started with
+ * uSpartnCrcInit(); this may be called any number of times.
+ *
+ * @param[in,out] pContext a pointer to the context, cannot be NULL.
+ * @param pData            a pointer to the data to be checked.
+ * @param size             the number of bytes pointed to by pData.
+ */
+void uSpartnCrcUpdate(uSpartnCrcContext_t *pContext, const char *pData,
+                      size_t size);
+
+/** Get the result of a CRC calculation, the same as that of the
+ * one-shot function for the type (e.g. uSpartnCrc16()) over all of
+ * the data passed to uSpartnCrcUpdate(). The context is not changed,
+ * so more data may be added afterwards.
+ *
+ * @param[in] pContext a pointer to the context, cannot be NULL.
+ * @return             the CRC.
+ */
+uint32_t uSpartnCrcFinal(const uSpartnCrcContext_t *pContext);
+
 #ifdef __cplusplus
 }
 #endif
@@ -94,7 +94,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // memcpy()
+#include "string.h"    // memchr(), memcpy(), memmove()
 
 #include "u_error_common.h"
 
@@ -111,6 +111,12 @@
  */
 #define U_SPARTN_HEADER_LENGTH_MIN_BYTES (4 + 4)
 
+/** The maximum length of a SPARTN message header: FRAME START +
+ * largest PAYLOAD DESCRIPTION (i.e. 32-bit GNSS time tag and
+ * ENCRYPT/AUTH).
+ */
+#define U_SPARTN_HEADER_LENGTH_MAX_BYTES (4 + 6 + 2)
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -119,12 +125,80 @@
  * VARIABLES
  * -------------------------------------------------------------- */
 
+/** The frame CRC (TF006) is a CRC-4 over the 20 bits of TF002 to
+ * TF005, which starts from zero and so is linear: it can be made
+ * up from the contributions of the three bytes after the preamble
+ * separately.  These tables give those contributions, the one for
+ * the third byte being XORed with the frame CRC in its lower four
+ * bits, so that the frame CRC is good if the three, XORed together,
+ * come to zero; they are generated from u8Crc4Table in
+ * u_spartn_crc.c.
+ */
+static const uint8_t gFrameCrcByte1[] = {
+    0x00U, 0x0CU, 0x0BU, 0x07U, 0x05U, 0x09U, 0x0EU, 0x02U, 0x0AU, 0x06U, 0x01U, 0x0DU, 0x0FU, 0x03U, 0x04U, 0x08U,
+    0x07U, 0x0BU, 0x0CU, 0x00U, 0x02U, 0x0EU, 0x09U, 0x05U, 0x0DU, 0x01U, 0x06U, 0x0AU, 0x08U, 0x04U, 0x03U, 0x0FU,
+    0x0EU, 0x02U, 0x05U, 0x09U, 0x0BU, 0x07U, 0x00U, 0x0CU, 0x04U, 0x08U, 0x0FU, 0x03U, 0x01U, 0x0DU, 0x0AU, 0x06U,
+    0x09U, 0x05U, 0x02U, 0x0EU, 0x0CU, 0x00U, 0x07U, 0x0BU, 0x03U, 0x0FU, 0x08U, 0x04U, 0x06U, 0x0AU, 0x0DU, 0x01U,
+    0x0FU, 0x03U, 0x04U, 0x08U, 0x0AU, 0x06U, 0x01U, 0x0DU, 0x05U, 0x09U, 0x0EU, 0x02U, 0x00U, 0x0CU, 0x0BU, 0x07U,
+    0x08U, 0x04U, 0x03U, 0x0FU, 0x0DU, 0x01U, 0x06U, 0x0AU, 0x02U, 0x0EU, 0x09U, 0x05U, 0x07U, 0x0BU, 0x0CU, 0x00U,
+    0x01U, 0x0DU, 0x0AU, 0x06U, 0x04U, 0x08U, 0x0FU, 0x03U, 0x0BU, 0x07U, 0x00U, 0x0CU, 0x0EU, 0x02U, 0x05U, 0x09U,
+    0x06U, 0x0AU, 0x0DU, 0x01U, 0x03U, 0x0FU, 0x08U, 0x04U, 0x0CU, 0x00U, 0x07U, 0x0BU, 0x09U, 0x05U, 0x02U, 0x0EU,
+    0x0DU, 0x01U, 0x06U, 0x0AU, 0x08U, 0x04U, 0x03U, 0x0FU, 0x07U, 0x0BU, 0x0CU, 0x00U, 0x02U, 0x0EU, 0x09U, 0x05U,
+    0x0AU, 0x06U, 0x01U, 0x0DU, 0x0FU, 0x03U, 0x04U, 0x08U, 0x00U, 0x0CU, 0x0BU, 0x07U, 0x05U, 0x09U, 0x0EU, 0x02U,
+    0x03U, 0x0FU, 0x08U, 0x04U, 0x06U, 0x0AU, 0x0DU, 0x01U, 0x09U, 0x05U, 0x02U, 0x0EU, 0x0CU, 0x00U, 0x07U, 0x0BU,
+    0x04U, 0x08U, 0x0FU, 0x03U, 0x01U, 0x0DU, 0x0AU, 0x06U, 0x0EU, 0x02U, 0x05U, 0x09U, 0x0BU, 0x07U, 0x00U, 0x0CU,
+    0x02U, 0x0EU, 0x09U, 0x05U, 0x07U, 0x0BU, 0x0CU, 0x00U, 0x08U, 0x04U, 0x03U, 0x0FU, 0x0DU, 0x01U, 0x06U, 0x0AU,
+    0x05U, 0x09U, 0x0EU, 0x02U, 0x00U, 0x0CU, 0x0BU, 0x07U, 0x0FU, 0x03U, 0x04U, 0x08U, 0x0AU, 0x06U, 0x01U, 0x0DU,
+    0x0CU, 0x00U, 0x07U, 0x0BU, 0x09U, 0x05U, 0x02U, 0x0EU, 0x06U, 0x0AU, 0x0DU, 0x01U, 0x03U, 0x0FU, 0x08U, 0x04U,
+    0x0BU, 0x07U, 0x00U, 0x0CU, 0x0EU, 0x02U, 0x05U, 0x09U, 0x01U, 0x0DU, 0x0AU, 0x06U, 0x04U, 0x08U, 0x0FU, 0x03U
+};
+
+static const uint8_t gFrameCrcByte2[] = {
+    0x00U, 0x09U, 0x01U, 0x08U, 0x02U, 0x0BU, 0x03U, 0x0AU, 0x04U, 0x0DU, 0x05U, 0x0CU, 0x06U, 0x0FU, 0x07U, 0x0EU,
+    0x08U, 0x01U, 0x09U, 0x00U, 0x0AU, 0x03U, 0x0BU, 0x02U, 0x0CU, 0x05U, 0x0DU, 0x04U, 0x0EU, 0x07U, 0x0FU, 0x06U,
+    0x03U, 0x0AU, 0x02U, 0x0BU, 0x01U, 0x08U, 0x00U, 0x09U, 0x07U, 0x0EU, 0x06U, 0x0FU, 0x05U, 0x0CU, 0x04U, 0x0DU,
+    0x0BU, 0x02U, 0x0AU, 0x03U, 0x09U, 0x00U, 0x08U, 0x01U, 0x0FU, 0x06U, 0x0EU, 0x07U, 0x0DU, 0x04U, 0x0CU, 0x05U,
+    0x06U, 0x0FU, 0x07U, 0x0EU, 0x04U, 0x0DU, 0x05U, 0x0CU, 0x02U, 0x0BU, 0x03U, 0x0AU, 0x00U, 0x09U, 0x01U, 0x08U,
+    0x0EU, 0x07U, 0x0FU, 0x06U, 0x0CU, 0x05U, 0x0DU, 0x04U, 0x0AU, 0x03U, 0x0BU, 0x02U, 0x08U, 0x01U, 0x09U, 0x00U,
+    0x05U, 0x0CU, 0x04U, 0x0DU, 0x07U, 0x0EU, 0x06U, 0x0FU, 0x01U, 0x08U, 0x00U, 0x09U, 0x03U, 0x0AU, 0x02U, 0x0BU,
+    0x0DU, 0x04U, 0x0CU, 0x05U, 0x0FU, 0x06U, 0x0EU, 0x07U, 0x09U, 0x00U, 0x08U, 0x01U, 0x0BU, 0x02U, 0x0AU, 0x03U,
+    0x0CU, 0x05U, 0x0DU, 0x04U, 0x0EU, 0x07U, 0x0FU, 0x06U, 0x08U, 0x01U, 0x09U, 0x00U, 0x0AU, 0x03U, 0x0BU, 0x02U,
+    0x04U, 0x0DU, 0x05U, 0x0CU, 0x06U, 0x0FU, 0x07U, 0x0EU, 0x00U, 0x09U, 0x01U, 0x08U, 0x02U, 0x0BU, 0x03U, 0x0AU,
+    0x0FU, 0x06U, 0x0EU, 0x07U, 0x0DU, 0x04U, 0x0CU, 0x05U, 0x0BU, 0x02U, 0x0AU, 0x03U, 0x09U, 0x00U, 0x08U, 0x01U,
+    0x07U, 0x0EU, 0x06U, 0x0FU, 0x05U, 0x0CU, 0x04U, 0x0DU, 0x03U, 0x0AU, 0x02U, 0x0BU, 0x01U, 0x08U, 0x00U, 0x09U,
+    0x0AU, 0x03U, 0x0BU, 0x02U, 0x08U, 0x01U, 0x09U, 0x00U, 0x0EU, 0x07U, 0x0FU, 0x06U, 0x0CU, 0x05U, 0x0DU, 0x04U,
+    0x02U, 0x0BU, 0x03U, 0x0AU, 0x00U, 0x09U, 0x01U, 0x08U, 0x06U, 0x0FU, 0x07U, 0x0EU, 0x04U, 0x0DU, 0x05U, 0x0CU,
+    0x09U, 0x00U, 0x08U, 0x01U, 0x0BU, 0x02U, 0x0AU, 0x03U, 0x0DU, 0x04U, 0x0CU, 0x05U, 0x0FU, 0x06U, 0x0EU, 0x07U,
+    0x01U, 0x08U, 0x00U, 0x09U, 0x03U, 0x0AU, 0x02U, 0x0BU, 0x05U, 0x0CU, 0x04U, 0x0DU, 0x07U, 0x0EU, 0x06U, 0x0FU
+};
+
+static const uint8_t gFrameCrcByte3[] = {
+    0x00U, 0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U, 0x08U, 0x09U, 0x0AU, 0x0BU, 0x0CU, 0x0DU, 0x0EU, 0x0FU,
+    0x0EU, 0x0FU, 0x0CU, 0x0DU, 0x0AU, 0x0BU, 0x08U, 0x09U, 0x06U, 0x07U, 0x04U, 0x05U, 0x02U, 0x03U, 0x00U, 0x01U,
+    0x0FU, 0x0EU, 0x0DU, 0x0CU, 0x0BU, 0x0AU, 0x09U, 0x08U, 0x07U, 0x06U, 0x05U, 0x04U, 0x03U, 0x02U, 0x01U, 0x00U,
+    0x01U, 0x00U, 0x03U, 0x02U, 0x05U, 0x04U, 0x07U, 0x06U, 0x09U, 0x08U, 0x0BU, 0x0AU, 0x0DU, 0x0CU, 0x0FU, 0x0EU,
+    0x0DU, 0x0CU, 0x0FU, 0x0EU, 0x09U, 0x08U, 0x0BU, 0x0AU, 0x05U, 0x04U, 0x07U, 0x06U, 0x01U, 0x00U, 0x03U, 0x02U,
+    0x03U, 0x02U, 0x01U, 0x00U, 0x07U, 0x06U, 0x05U, 0x04U, 0x0BU, 0x0AU, 0x09U, 0x08U, 0x0FU, 0x0EU, 0x0DU, 0x0CU,
+    0x02U, 0x03U, 0x00U, 0x01U, 0x06U, 0x07U, 0x04U, 0x05U, 0x0AU, 0x0BU, 0x08U, 0x09U, 0x0EU, 0x0FU, 0x0CU, 0x0DU,
+    0x0CU, 0x0DU, 0x0EU, 0x0FU, 0x08U, 0x09U, 0x0AU, 0x0BU, 0x04U, 0x05U, 0x06U, 0x07U, 0x00U, 0x01U, 0x02U, 0x03U,
+    0x09U, 0x08U, 0x0BU, 0x0AU, 0x0DU, 0x0CU, 0x0FU, 0x0EU, 0x01U, 0x00U, 0x03U, 0x02U, 0x05U, 0x04U, 0x07U, 0x06U,
+    0x07U, 0x06U, 0x05U, 0x04U, 0x03U, 0x02U, 0x01U, 0x00U, 0x0FU, 0x0EU, 0x0DU, 0x0CU, 0x0BU, 0x0AU, 0x09U, 0x08U,
+    0x06U, 0x07U, 0x04U, 0x05U, 0x02U, 0x03U, 0x00U, 0x01U, 0x0EU, 0x0FU, 0x0CU, 0x0DU, 0x0AU, 0x0BU, 0x08U, 0x09U,
+    0x08U, 0x09U, 0x0AU, 0x0BU, 0x0CU, 0x0DU, 0x0EU, 0x0FU, 0x00U, 0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U,
+    0x04U, 0x05U, 0x06U, 0x07U, 0x00U, 0x01U, 0x02U, 0x03U, 0x0CU, 0x0DU, 0x0EU, 0x0FU, 0x08U, 0x09U, 0x0AU, 0x0BU,
+    0x0AU, 0x0BU, 0x08U, 0x09U, 0x0EU, 0x0FU, 0x0CU, 0x0DU, 0x02U, 0x03U, 0x00U, 0x01U, 0x06U, 0x07U, 0x04U, 0x05U,
+    0x0BU, 0x0AU, 0x09U, 0x08U, 0x0FU, 0x0EU, 0x0DU, 0x0CU, 0x03U, 0x02U, 0x01U, 0x00U, 0x07U, 0x06U, 0x05U, 0x04U,
+    0x05U, 0x04U, 0x07U, 0x06U, 0x01U, 0x00U, 0x03U, 0x02U, 0x0DU, 0x0CU, 0x0FU, 0x0EU, 0x09U, 0x08U, 0x0BU, 0x0AU
+};
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
 // Look for a SPARTN message header in a buffer and supply its position,
-// plus the message CRC position and type.
+// plus the message CRC position and type; the position is also
+// supplied if U_ERROR_COMMON_TIMEOUT is returned, i.e. if the buffer
+// ends with what might be the start of a header.
 static int32_t decodeHeader(const char *pBuffer, size_t bufferLengthBytes,
                             const char **ppMessage,
                             const char **ppMessageCrcStart,
@@ -134,7 +208,6 @@ static int32_t decodeHeader(const char *pBuffer, size_t bufferLengthBytes,
     // Use a uint8_t pointer for maths, more certain of its behaviour than char
     const uint8_t *pInput = (const uint8_t *) pBuffer;
     const uint8_t *pMessage = NULL;
-    uint8_t frameBuffer[4];
     size_t lengthHeader;
     size_t lengthBeyondHeader;
     size_t crcType;
@@ -143,29 +216,26 @@ static int32_t decodeHeader(const char *pBuffer, size_t bufferLengthBytes,
         sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
         while ((sizeOrErrorCode < 0) && (sizeOrErrorCode != (int32_t) U_ERROR_COMMON_TIMEOUT) &&
                (bufferLengthBytes > 0)) {
-            if (*pInput == 0x73) {
+            // Skip to the next preamble (TF001)
+            pMessage = (const uint8_t *) memchr(pInput, 0x73, bufferLengthBytes);
+            if (pMessage != NULL) {
+                bufferLengthBytes -= pMessage - pInput;
+                pInput = pMessage;
                 // Potentially a FRAME START
                 sizeOrErrorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
-                pMessage = pInput;
                 if (bufferLengthBytes >= U_SPARTN_HEADER_LENGTH_MIN_BYTES) {
                     // Have enough data to work on the header; confirm that this
-                    // is a FRAME START by doing a frame CRC check on it
-                    // Copy everything from FRAME START except TF001 into a buffer
-                    memcpy(&frameBuffer, pInput + 1, 3);
-                    frameBuffer[3] = 0;
-
-                    // frameBuffer now contains, in order of bit-arrival:
+                    // is a FRAME START by doing a frame CRC check on it.
+                    // The three bytes after TF001 contain, in order of bit-arrival:
                     //
-                    // bytes:    |      0     |     1     |      2      |     3     |
-                    // contents: |<---T7---><-----L10------->E1-MCT2-FC4|           |
-                    // meaning:  |M       L M |           |L    M L  M L|           |
-
-                    // Remove the frame CRC that is in the lower four
-                    // bits of byte 2, giving us 20 bits in the buffer with
-                    // zero-fill elsewhere
-                    frameBuffer[2] &= 0xf0;
-                    // Compute the CRC-4 over 24 bits and check it against the frame CRC (TF006)
-                    if (uSpartnCrc4((const char *) frameBuffer, 3) == (*(pInput + 3) & 0x0f)) {
+                    // bytes:    |      1     |     2     |      3      |
+                    // contents: |<---T7---><-----L10------->E1-MCT2-FC4|
+                    // meaning:  |M       L M |           |L    M L  M L|
+                    //
+                    // Check the CRC-4 over the 20 bits up to FC4 against the
+                    // frame CRC (TF006) in one go
+                    if ((gFrameCrcByte1[*(pInput + 1)] ^ gFrameCrcByte2[*(pInput + 2)] ^
+                         gFrameCrcByte3[*(pInput + 3)]) == 0) {
                         lengthHeader = U_SPARTN_HEADER_LENGTH_MIN_BYTES;
                         // So far so good, now parse the PAYLOAD DESCRIPTION to work out
                         // how long it is; check if the TF008 (GNSS time tag type) bit is set
@@ -175,22 +245,22 @@ static int32_t decodeHeader(const char *pBuffer, size_t bufferLengthBytes,
                         }
                         // Work out the length beyond the message header
                         // First the length of the payload from the 10-bit TF003 field,
-                        // which is splattered across the three bytes of frameBuffer
-                        lengthBeyondHeader = ((((size_t) frameBuffer[0]) & 0x01) << 9) +
-                                             (((size_t) frameBuffer[1]) << 1) +
-                                             ((((size_t) frameBuffer[2]) & 0x80) >> 7);
+                        // which is splattered across the three bytes after TF001
+                        lengthBeyondHeader = ((((size_t) * (pInput + 1)) & 0x01) << 9) +
+                                             (((size_t) * (pInput + 2)) << 1) +
+                                             ((((size_t) * (pInput + 3)) & 0x80) >> 7);
                         // Add the length of the message CRC by looking at
                         // the 2-bit message CRC type field (TF005).  Since we have
                         // 0: CRC-8, 1: CRC-16, 2: CRC-24, 3: CRC-32 it is easy
                         // to calculate
-                        crcType = (frameBuffer[2] & 0x30) >> 4;
+                        crcType = (*(pInput + 3) & 0x30) >> 4;
                         lengthBeyondHeader += crcType + 1;
                         if (pMessageCrcType != NULL) {
                             *pMessageCrcType = (uSpartnCrcType_t) crcType;
                         }
                         // Work out the additions as a consequence of encryption/authentication
                         // being switched on
-                        if (frameBuffer[2] & 0x40) {
+                        if (*(pInput + 3) & 0x40) {
                             // TF004 is set, so we need the ENCRYPT/AUTH fields to work
                             // out the message length; see if they are in the buffer
                             if ((int32_t) bufferLengthBytes - (int32_t) lengthHeader >= 2) {
@@ -258,21 +328,152 @@ static int32_t decodeHeader(const char *pBuffer, size_t bufferLengthBytes,
                     // length; leave sizeOrErrorCode at U_ERROR_COMMON_TIMEOUT
                     // so that the caller knows we need more data
                 }
+                // Move along
+                pInput++;
+                bufferLengthBytes--;
+            } else {
+                // No preamble in the rest of the buffer
+                bufferLengthBytes = 0;
             }
-
-            // Move along
-            pInput++;
-            bufferLengthBytes--;
         }
     }
 
-    if ((sizeOrErrorCode >= 0) && (ppMessage != NULL)) {
+    if (((sizeOrErrorCode >= 0) || (sizeOrErrorCode == (int32_t) U_ERROR_COMMON_TIMEOUT)) &&
+        (ppMessage != NULL)) {
         *ppMessage = (const char *) pMessage;
     }
 
     return sizeOrErrorCode;
 }
 
+// Check the message CRC of a complete SPARTN message.
+static bool messageCrcIsGood(const char *pMessage, size_t messageLength,
+                             uSpartnCrcType_t messageCrcType)
+{
+    bool isGood = false;
+    size_t crcSize = ((size_t) messageCrcType) + 1;
+    // The message CRC is over the whole message, except
+    // the first byte, up to the start of the CRC and the
+    // CRC value is MSB first like all the others
+    const uint8_t *pMessageCrcStart = (const uint8_t *) pMessage + messageLength - crcSize;
+    size_t crcLength = messageLength - crcSize - 1;
+    uint32_t crcFromMessage = 0;
+
+    for (size_t x = 0; x < crcSize; x++) {
+        crcFromMessage = (crcFromMessage << 8) + *(pMessageCrcStart + x);
+    }
+    switch (messageCrcType) {
+        case U_SPARTN_CRC_TYPE_8:
+            isGood = (uSpartnCrc8(pMessage + 1, crcLength) == crcFromMessage);
+            break;
+        case U_SPARTN_CRC_TYPE_16:
+            isGood = (uSpartnCrc16(pMessage + 1, crcLength) == crcFromMessage);
+            break;
+        case U_SPARTN_CRC_TYPE_24:
+            isGood = (uSpartnCrc24(pMessage + 1, crcLength) == crcFromMessage);
+            break;
+        case U_SPARTN_CRC_TYPE_32:
+            isGood = (uSpartnCrc32(pMessage + 1, crcLength) == crcFromMessage);
+            break;
+        default:
+            break;
+    }
+
+    return isGood;
+}
+
+// Hand a validated message to the user of a framer.
+static void framerEmit(uSpartnFramer_t *pFramer, const char *pMessage,
+                       size_t messageLength, uSpartnFramerCallback_t pCallback,
+                       void *pCallbackParam)
+{
+    uSpartnMessage_t message;
+
+    message.pMessage = pMessage;
+    message.size = messageLength;
+    // TF002 is the upper seven bits of the second byte and TF007
+    // the upper four bits of the fifth byte
+    message.type = (*((const uint8_t *) pMessage + 1) >> 1) & 0x7f;
+    message.subType = *((const uint8_t *) pMessage + 4) >> 4;
+    pFramer->messageCount++;
+    if (pCallback != NULL) {
+        pCallback(&message, pCallbackParam);
+    }
+}
+
+// Find, check and emit the messages in a linear region of data,
+// which may be the framer's own buffer; anything left over that
+// might be the start of a message is moved to the start of the
+// framer's buffer.  Returns the number of messages emitted.
+static int32_t framerProcessLinear(uSpartnFramer_t *pFramer,
+                                   const char *pData, size_t size,
+                                   uSpartnFramerCallback_t pCallback,
+                                   void *pCallbackParam)
+{
+    int32_t count = 0;
+    int32_t sizeOrErrorCode;
+    const char *pMessage = NULL;
+    uSpartnCrcType_t messageCrcType = U_SPARTN_CRC_TYPE_NONE;
+
+    while (size > 0) {
+        sizeOrErrorCode = decodeHeader(pData, size, &pMessage, NULL, &messageCrcType);
+        if ((sizeOrErrorCode > 0) || (sizeOrErrorCode == (int32_t) U_ERROR_COMMON_TIMEOUT)) {
+            // Skip anything before the (possible) start of the message
+            pFramer->discardedBytes += pMessage - pData;
+            size -= pMessage - pData;
+            pData = pMessage;
+        }
+        if ((sizeOrErrorCode > 0) && ((size_t) sizeOrErrorCode <= size)) {
+            // A whole message is here: check it and, if it is good,
+            // emit it straight from where it is
+            if (messageCrcIsGood(pData, sizeOrErrorCode, messageCrcType)) {
+                framerEmit(pFramer, pData, sizeOrErrorCode, pCallback, pCallbackParam);
+                count++;
+                pData += sizeOrErrorCode;
+                size -= sizeOrErrorCode;
+            } else {
+                // Not a message after all, look again from the next byte
+                pFramer->crcErrorCount++;
+                pFramer->discardedBytes++;
+                pData++;
+                size--;
+            }
+        } else if ((sizeOrErrorCode > 0) || (sizeOrErrorCode == (int32_t) U_ERROR_COMMON_TIMEOUT)) {
+            // The start of a message: keep it until the rest arrives
+            memmove(pFramer->buffer, pData, size);
+            pFramer->bufferLength = size;
+            pFramer->messageLength = 0;
+            if (sizeOrErrorCode > 0) {
+                pFramer->messageLength = sizeOrErrorCode;
+                pFramer->messageCrcType = (int32_t) messageCrcType;
+            }
+            size = 0;
+        } else {
+            // Nothing here
+            pFramer->discardedBytes += size;
+            size = 0;
+        }
+    }
+
+    return count;
+}
+
+// Give up on the message at the start of the framer's buffer and
+// look again through what follows it.
+static int32_t framerResync(uSpartnFramer_t *pFramer,
+                            uSpartnFramerCallback_t pCallback,
+                            void *pCallbackParam)
+{
+    size_t size = pFramer->bufferLength - 1;
+
+    pFramer->discardedBytes++;
+    pFramer->bufferLength = 0;
+    pFramer->messageLength = 0;
+
+    return framerProcessLinear(pFramer, pFramer->buffer + 1, size,
+                               pCallback, pCallbackParam);
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -281,7 +482,15 @@ static int32_t decodeHeader(const char *pBuffer, size_t bufferLengthBytes,
 int32_t uSpartnDetect(const char *pBuffer, size_t bufferLengthBytes,
                       const char **ppMessage)
 {
-    return decodeHeader(pBuffer, bufferLengthBytes, ppMessage, NULL, NULL);
+    int32_t sizeOrErrorCode;
+    const char *pMessage = NULL;
+
+    sizeOrErrorCode = decodeHeader(pBuffer, bufferLengthBytes, &pMessage, NULL, NULL);
+    if ((sizeOrErrorCode >= 0) && (ppMessage != NULL)) {
+        *ppMessage = pMessage;
+    }
+
+    return sizeOrErrorCode;
 }
 
 // Validate a SPARTN message.
@@ -291,57 +500,18 @@ int32_t uSpartnValidate(const char *pBuffer, size_t bufferLengthBytes,
     int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
     int32_t messageLength;
     const char *pMessage = NULL;
-    const uint8_t *pMessageCrcStart = NULL;
     uSpartnCrcType_t messageCrcType = U_SPARTN_CRC_TYPE_NONE;
-    size_t crcLength;
-    uint32_t crcFromMessage;
 
     messageLength = decodeHeader(pBuffer, bufferLengthBytes, &pMessage,
-                                 (const char **) &pMessageCrcStart, &messageCrcType);
+                                 NULL, &messageCrcType);
     if (messageLength > 0) {
         sizeOrErrorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
-        if (((int32_t) bufferLengthBytes - (pMessage - pBuffer) >= messageLength) &&
-            (pMessageCrcStart != NULL)) {
+        if ((int32_t) bufferLengthBytes - (pMessage - pBuffer) >= messageLength) {
             sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
             // Got a header and enough room for the whole body
             // to be contained, let's see if the body is valid
-            // The message CRC is over the whole message, except
-            // the first byte, up to the start of the CRC and the
-            // CRC value is MSB first like all the others
-            crcLength = ((const char *) pMessageCrcStart) - pMessage - 1;
-            switch (messageCrcType) {
-                case U_SPARTN_CRC_TYPE_8:
-                    crcFromMessage = *pMessageCrcStart;
-                    if (uSpartnCrc8(pMessage + 1, crcLength) == crcFromMessage) {
-                        sizeOrErrorCode = messageLength;
-                    }
-                    break;
-                case U_SPARTN_CRC_TYPE_16:
-                    crcFromMessage = (((uint32_t) * pMessageCrcStart) << 8) +
-                                     (uint32_t) * (pMessageCrcStart + 1);
-                    if (uSpartnCrc16(pMessage + 1, crcLength) == crcFromMessage) {
-                        sizeOrErrorCode = messageLength;
-                    }
-                    break;
-                case U_SPARTN_CRC_TYPE_24:
-                    crcFromMessage = (((uint32_t) * pMessageCrcStart) << 16) +
-                                     ((uint32_t) * (pMessageCrcStart + 1) << 8) +
-                                     (uint32_t) * (pMessageCrcStart + 2);
-                    if (uSpartnCrc24(pMessage + 1, crcLength) == crcFromMessage) {
-                        sizeOrErrorCode = messageLength;
-                    }
-                    break;
-                case U_SPARTN_CRC_TYPE_32:
-                    crcFromMessage = (((uint32_t) * pMessageCrcStart) << 24) +
-                                     ((uint32_t) * (pMessageCrcStart + 1) << 16) +
-                                     ((uint32_t) * (pMessageCrcStart + 2) << 8) +
-                                     (uint32_t) * (pMessageCrcStart + 3);
-                    if (uSpartnCrc32(pMessage + 1, crcLength) == crcFromMessage) {
-                        sizeOrErrorCode = messageLength;
-                    }
-                    break;
-                default:
-                    break;
+            if (messageCrcIsGood(pMessage, messageLength, messageCrcType)) {
+                sizeOrErrorCode = messageLength;
             }
         }
     }
@@ -353,4 +523,106 @@ int32_t uSpartnValidate(const char *pBuffer, size_t bufferLengthBytes,
     return sizeOrErrorCode;
 }
 
+// Initialise a SPARTN framer.
+int32_t uSpartnFramerInit(uSpartnFramer_t *pFramer)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pFramer != NULL) {
+        pFramer->bufferLength = 0;
+        pFramer->messageLength = 0;
+        pFramer->messageCrcType = (int32_t) U_SPARTN_CRC_TYPE_NONE;
+        pFramer->messageCount = 0;
+        pFramer->crcErrorCount = 0;
+        pFramer->discardedBytes = 0;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Add data to a SPARTN framer.
+int32_t uSpartnFramerAddData(uSpartnFramer_t *pFramer,
+                             const char *pData, size_t size,
+                             uSpartnFramerCallback_t pCallback,
+                             void *pCallbackParam)
+{
+    int32_t countOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int32_t sizeOrErrorCode;
+    const char *pMessage;
+    uSpartnCrcType_t messageCrcType = U_SPARTN_CRC_TYPE_NONE;
+    size_t length;
+    size_t leftover;
+
+    if ((pFramer != NULL) && ((pData != NULL) || (size == 0))) {
+        countOrErrorCode = 0;
+        while ((size > 0) || ((pFramer->messageLength > 0) &&
+                              (pFramer->bufferLength >= pFramer->messageLength))) {
+            if (pFramer->bufferLength == 0) {
+                // Nothing held over: work directly on the new data
+                countOrErrorCode += framerProcessLinear(pFramer, pData, size,
+                                                        pCallback, pCallbackParam);
+                size = 0;
+            } else {
+                // Part of a message is held over: add just enough of
+                // the new data to complete the header or the message
+                length = U_SPARTN_HEADER_LENGTH_MAX_BYTES;
+                if (pFramer->messageLength > 0) {
+                    length = pFramer->messageLength;
+                }
+                if (length > pFramer->bufferLength) {
+                    length -= pFramer->bufferLength;
+                    if (length > size) {
+                        length = size;
+                    }
+                    memcpy(pFramer->buffer + pFramer->bufferLength, pData, length);
+                    pFramer->bufferLength += length;
+                    pData += length;
+                    size -= length;
+                }
+                if (pFramer->messageLength == 0) {
+                    pMessage = NULL;
+                    sizeOrErrorCode = decodeHeader(pFramer->buffer, pFramer->bufferLength,
+                                                   &pMessage, NULL, &messageCrcType);
+                    if (pMessage != pFramer->buffer) {
+                        // What was held over is not a header after all
+                        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+                    }
+                    if (sizeOrErrorCode > 0) {
+                        pFramer->messageLength = sizeOrErrorCode;
+                        pFramer->messageCrcType = (int32_t) messageCrcType;
+                    } else if (sizeOrErrorCode != (int32_t) U_ERROR_COMMON_TIMEOUT) {
+                        countOrErrorCode += framerResync(pFramer, pCallback, pCallbackParam);
+                    }
+                }
+                if ((pFramer->messageLength > 0) &&
+                    (pFramer->bufferLength >= pFramer->messageLength)) {
+                    // Have the whole message
+                    length = pFramer->messageLength;
+                    if (messageCrcIsGood(pFramer->buffer, length,
+                                         (uSpartnCrcType_t) pFramer->messageCrcType)) {
+                        framerEmit(pFramer, pFramer->buffer, length,
+                                   pCallback, pCallbackParam);
+                        countOrErrorCode++;
+                        // Look through anything that came after it
+                        // (only possible for a very short message)
+                        leftover = pFramer->bufferLength - length;
+                        pFramer->bufferLength = 0;
+                        pFramer->messageLength = 0;
+                        countOrErrorCode += framerProcessLinear(pFramer,
+                                                                pFramer->buffer + length,
+                                                                leftover,
+                                                                pCallback, pCallbackParam);
+                    } else {
+                        pFramer->crcErrorCount++;
+                        countOrErrorCode += framerResync(pFramer, pCallback, pCallbackParam);
+                    }
+                }
+            }
+        }
+    }
+
+    return countOrErrorCode;
+}
+
 // End of file
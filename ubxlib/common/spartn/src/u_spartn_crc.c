@@ -33,12 +33,30 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 
+#include "u_error_common.h"
+
 #include "u_spartn_crc.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+/** The 16, 24 and 32 bit CRCs are worked out four bytes at a time
+ * ("slice-by-4"), which needs three more tables for each, 7.5 kbytes
+ * of constant data in all; define U_SPARTN_CRC_NO_SLICING to work
+ * them out a byte at a time, with only the original tables, instead.
+ */
+#ifndef U_SPARTN_CRC_NO_SLICING
+# define U_SPARTN_CRC_SLICE_BY_4
+#endif
+
+/** Load four bytes, most significant first, into a uint32_t.
+ */
+#define U_SPARTN_CRC_UINT32_BE(pU8) (((uint32_t) *(pU8) << 24) |       \
+                                     ((uint32_t) *((pU8) + 1) << 16) | \
+                                     ((uint32_t) *((pU8) + 2) << 8) |  \
+                                     (uint32_t) *((pU8) + 3))
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -222,104 +240,518 @@ static const uint32_t u32Crc32Table[] = {
     0xAFB010B1U, 0xAB710D06U, 0xA6322BDFU, 0xA2F33668U, 0xBCB4666DU, 0xB8757BDAU, 0xB5365D03U, 0xB1F740B4U
 };
 
-/* ----------------------------------------------------------------
- * STATIC FUNCTIONS
- * -------------------------------------------------------------- */
+#ifdef U_SPARTN_CRC_SLICE_BY_4
+
+// For slice-by-4, table N gives the effect of a byte followed by
+// N zero bytes; table 0 is the one above.
+
+static const uint16_t u16Crc16Table1[] = {
+    0x0000U, 0x3331U, 0x6662U, 0x5553U, 0xCCC4U, 0xFFF5U, 0xAAA6U, 0x9997U,
+    0x89A9U, 0xBA98U, 0xEFCBU, 0xDCFAU, 0x456DU, 0x765CU, 0x230FU, 0x103EU,
+    0x0373U, 0x3042U, 0x6511U, 0x5620U, 0xCFB7U, 0xFC86U, 0xA9D5U, 0x9AE4U,
+    0x8ADAU, 0xB9EBU, 0xECB8U, 0xDF89U, 0x461EU, 0x752FU, 0x207CU, 0x134DU,
+    0x06E6U, 0x35D7U, 0x6084U, 0x53B5U, 0xCA22U, 0xF913U, 0xAC40U, 0x9F71U,
+    0x8F4FU, 0xBC7EU, 0xE92DU, 0xDA1CU, 0x438BU, 0x70BAU, 0x25E9U, 0x16D8U,
+    0x0595U, 0x36A4U, 0x63F7U, 0x50C6U, 0xC951U, 0xFA60U, 0xAF33U, 0x9C02U,
+    0x8C3CU, 0xBF0DU, 0xEA5EU, 0xD96FU, 0x40F8U, 0x73C9U, 0x269AU, 0x15ABU,
+    0x0DCCU, 0x3EFDU, 0x6BAEU, 0x589FU, 0xC108U, 0xF239U, 0xA76AU, 0x945BU,
+    0x8465U, 0xB754U, 0xE207U, 0xD136U, 0x48A1U, 0x7B90U, 0x2EC3U, 0x1DF2U,
+    0x0EBFU, 0x3D8EU, 0x68DDU, 0x5BECU, 0xC27BU, 0xF14AU, 0xA419U, 0x9728U,
+    0x8716U, 0xB427U, 0xE174U, 0xD245U, 0x4BD2U, 0x78E3U, 0x2DB0U, 0x1E81U,
+    0x0B2AU, 0x381BU, 0x6D48U, 0x5E79U, 0xC7EEU, 0xF4DFU, 0xA18CU, 0x92BDU,
+    0x8283U, 0xB1B2U, 0xE4E1U, 0xD7D0U, 0x4E47U, 0x7D76U, 0x2825U, 0x1B14U,
+    0x0859U, 0x3B68U, 0x6E3BU, 0x5D0AU, 0xC49DU, 0xF7ACU, 0xA2FFU, 0x91CEU,
+    0x81F0U, 0xB2C1U, 0xE792U, 0xD4A3U, 0x4D34U, 0x7E05U, 0x2B56U, 0x1867U,
+    0x1B98U, 0x28A9U, 0x7DFAU, 0x4ECBU, 0xD75CU, 0xE46DU, 0xB13EU, 0x820FU,
+    0x9231U, 0xA100U, 0xF453U, 0xC762U, 0x5EF5U, 0x6DC4U, 0x3897U, 0x0BA6U,
+    0x18EBU, 0x2BDAU, 0x7E89U, 0x4DB8U, 0xD42FU, 0xE71EU, 0xB24DU, 0x817CU,
+    0x9142U, 0xA273U, 0xF720U, 0xC411U, 0x5D86U, 0x6EB7U, 0x3BE4U, 0x08D5U,
+    0x1D7EU, 0x2E4FU, 0x7B1CU, 0x482DU, 0xD1BAU, 0xE28BU, 0xB7D8U, 0x84E9U,
+    0x94D7U, 0xA7E6U, 0xF2B5U, 0xC184U, 0x5813U, 0x6B22U, 0x3E71U, 0x0D40U,
+    0x1E0DU, 0x2D3CU, 0x786FU, 0x4B5EU, 0xD2C9U, 0xE1F8U, 0xB4ABU, 0x879AU,
+    0x97A4U, 0xA495U, 0xF1C6U, 0xC2F7U, 0x5B60U, 0x6851U, 0x3D02U, 0x0E33U,
+    0x1654U, 0x2565U, 0x7036U, 0x4307U, 0xDA90U, 0xE9A1U, 0xBCF2U, 0x8FC3U,
+    0x9FFDU, 0xACCCU, 0xF99FU, 0xCAAEU, 0x5339U, 0x6008U, 0x355BU, 0x066AU,
+    0x1527U, 0x2616U, 0x7345U, 0x4074U, 0xD9E3U, 0xEAD2U, 0xBF81U, 0x8CB0U,
+    0x9C8EU, 0xAFBFU, 0xFAECU, 0xC9DDU, 0x504AU, 0x637BU, 0x3628U, 0x0519U,
+    0x10B2U, 0x2383U, 0x76D0U, 0x45E1U, 0xDC76U, 0xEF47U, 0xBA14U, 0x8925U,
+    0x991BU, 0xAA2AU, 0xFF79U, 0xCC48U, 0x55DFU, 0x66EEU, 0x33BDU, 0x008CU,
+    0x13C1U, 0x20F0U, 0x75A3U, 0x4692U, 0xDF05U, 0xEC34U, 0xB967U, 0x8A56U,
+    0x9A68U, 0xA959U, 0xFC0AU, 0xCF3BU, 0x56ACU, 0x659DU, 0x30CEU, 0x03FFU
+};
+
+static const uint16_t u16Crc16Table2[] = {
+    0x0000U, 0x3730U, 0x6E60U, 0x5950U, 0xDCC0U, 0xEBF0U, 0xB2A0U, 0x8590U,
+    0xA9A1U, 0x9E91U, 0xC7C1U, 0xF0F1U, 0x7561U, 0x4251U, 0x1B01U, 0x2C31U,
+    0x4363U, 0x7453U, 0x2D03U, 0x1A33U, 0x9FA3U, 0xA893U, 0xF1C3U, 0xC6F3U,
+    0xEAC2U, 0xDDF2U, 0x84A2U, 0xB392U, 0x3602U, 0x0132U, 0x5862U, 0x6F52U,
+    0x86C6U, 0xB1F6U, 0xE8A6U, 0xDF96U, 0x5A06U, 0x6D36U, 0x3466U, 0x0356U,
+    0x2F67U, 0x1857U, 0x4107U, 0x7637U, 0xF3A7U, 0xC497U, 0x9DC7U, 0xAAF7U,
+    0xC5A5U, 0xF295U, 0xABC5U, 0x9CF5U, 0x1965U, 0x2E55U, 0x7705U, 0x4035U,
+    0x6C04U, 0x5B34U, 0x0264U, 0x3554U, 0xB0C4U, 0x87F4U, 0xDEA4U, 0xE994U,
+    0x1DADU, 0x2A9DU, 0x73CDU, 0x44FDU, 0xC16DU, 0xF65DU, 0xAF0DU, 0x983DU,
+    0xB40CU, 0x833CU, 0xDA6CU, 0xED5CU, 0x68CCU, 0x5FFCU, 0x06ACU, 0x319CU,
+    0x5ECEU, 0x69FEU, 0x30AEU, 0x079EU, 0x820EU, 0xB53EU, 0xEC6EU, 0xDB5EU,
+    0xF76FU, 0xC05FU, 0x990FU, 0xAE3FU, 0x2BAFU, 0x1C9FU, 0x45CFU, 0x72FFU,
+    0x9B6BU, 0xAC5BU, 0xF50BU, 0xC23BU, 0x47ABU, 0x709BU, 0x29CBU, 0x1EFBU,
+    0x32CAU, 0x05FAU, 0x5CAAU, 0x6B9AU, 0xEE0AU, 0xD93AU, 0x806AU, 0xB75AU,
+    0xD808U, 0xEF38U, 0xB668U, 0x8158U, 0x04C8U, 0x33F8U, 0x6AA8U, 0x5D98U,
+    0x71A9U, 0x4699U, 0x1FC9U, 0x28F9U, 0xAD69U, 0x9A59U, 0xC309U, 0xF439U,
+    0x3B5AU, 0x0C6AU, 0x553AU, 0x620AU, 0xE79AU, 0xD0AAU, 0x89FAU, 0xBECAU,
+    0x92FBU, 0xA5CBU, 0xFC9BU, 0xCBABU, 0x4E3BU, 0x790BU, 0x205BU, 0x176BU,
+    0x7839U, 0x4F09U, 0x1659U, 0x2169U, 0xA4F9U, 0x93C9U, 0xCA99U, 0xFDA9U,
+    0xD198U, 0xE6A8U, 0xBFF8U, 0x88C8U, 0x0D58U, 0x3A68U, 0x6338U, 0x5408U,
+    0xBD9CU, 0x8AACU, 0xD3FCU, 0xE4CCU, 0x615CU, 0x566CU, 0x0F3CU, 0x380CU,
+    0x143DU, 0x230DU, 0x7A5DU, 0x4D6DU, 0xC8FDU, 0xFFCDU, 0xA69DU, 0x91ADU,
+    0xFEFFU, 0xC9CFU, 0x909FU, 0xA7AFU, 0x223FU, 0x150FU, 0x4C5FU, 0x7B6FU,
+    0x575EU, 0x606EU, 0x393EU, 0x0E0EU, 0x8B9EU, 0xBCAEU, 0xE5FEU, 0xD2CEU,
+    0x26F7U, 0x11C7U, 0x4897U, 0x7FA7U, 0xFA37U, 0xCD07U, 0x9457U, 0xA367U,
+    0x8F56U, 0xB866U, 0xE136U, 0xD606U, 0x5396U, 0x64A6U, 0x3DF6U, 0x0AC6U,
+    0x6594U, 0x52A4U, 0x0BF4U, 0x3CC4U, 0xB954U, 0x8E64U, 0xD734U, 0xE004U,
+    0xCC35U, 0xFB05U, 0xA255U, 0x9565U, 0x10F5U, 0x27C5U, 0x7E95U, 0x49A5U,
+    0xA031U, 0x9701U, 0xCE51U, 0xF961U, 0x7CF1U, 0x4BC1U, 0x1291U, 0x25A1U,
+    0x0990U, 0x3EA0U, 0x67F0U, 0x50C0U, 0xD550U, 0xE260U, 0xBB30U, 0x8C00U,
+    0xE352U, 0xD462U, 0x8D32U, 0xBA02U, 0x3F92U, 0x08A2U, 0x51F2U, 0x66C2U,
+    0x4AF3U, 0x7DC3U, 0x2493U, 0x13A3U, 0x9633U, 0xA103U, 0xF853U, 0xCF63U
+};
+
+static const uint16_t u16Crc16Table3[] = {
+    0x0000U, 0x76B4U, 0xED68U, 0x9BDCU, 0xCAF1U, 0xBC45U, 0x2799U, 0x512DU,
+    0x85C3U, 0xF377U, 0x68ABU, 0x1E1FU, 0x4F32U, 0x3986U, 0xA25AU, 0xD4EEU,
+    0x1BA7U, 0x6D13U, 0xF6CFU, 0x807BU, 0xD156U, 0xA7E2U, 0x3C3EU, 0x4A8AU,
+    0x9E64U, 0xE8D0U, 0x730CU, 0x05B8U, 0x5495U, 0x2221U, 0xB9FDU, 0xCF49U,
+    0x374EU, 0x41FAU, 0xDA26U, 0xAC92U, 0xFDBFU, 0x8B0BU, 0x10D7U, 0x6663U,
+    0xB28DU, 0xC439U, 0x5FE5U, 0x2951U, 0x787CU, 0x0EC8U, 0x9514U, 0xE3A0U,
+    0x2CE9U, 0x5A5DU, 0xC181U, 0xB735U, 0xE618U, 0x90ACU, 0x0B70U, 0x7DC4U,
+    0xA92AU, 0xDF9EU, 0x4442U, 0x32F6U, 0x63DBU, 0x156FU, 0x8EB3U, 0xF807U,
+    0x6E9CU, 0x1828U, 0x83F4U, 0xF540U, 0xA46DU, 0xD2D9U, 0x4905U, 0x3FB1U,
+    0xEB5FU, 0x9DEBU, 0x0637U, 0x7083U, 0x21AEU, 0x571AU, 0xCCC6U, 0xBA72U,
+    0x753BU, 0x038FU, 0x9853U, 0xEEE7U, 0xBFCAU, 0xC97EU, 0x52A2U, 0x2416U,
+    0xF0F8U, 0x864CU, 0x1D90U, 0x6B24U, 0x3A09U, 0x4CBDU, 0xD761U, 0xA1D5U,
+    0x59D2U, 0x2F66U, 0xB4BAU, 0xC20EU, 0x9323U, 0xE597U, 0x7E4BU, 0x08FFU,
+    0xDC11U, 0xAAA5U, 0x3179U, 0x47CDU, 0x16E0U, 0x6054U, 0xFB88U, 0x8D3CU,
+    0x4275U, 0x34C1U, 0xAF1DU, 0xD9A9U, 0x8884U, 0xFE30U, 0x65ECU, 0x1358U,
+    0xC7B6U, 0xB102U, 0x2ADEU, 0x5C6AU, 0x0D47U, 0x7BF3U, 0xE02FU, 0x969BU,
+    0xDD38U, 0xAB8CU, 0x3050U, 0x46E4U, 0x17C9U, 0x617DU, 0xFAA1U, 0x8C15U,
+    0x58FBU, 0x2E4FU, 0xB593U, 0xC327U, 0x920AU, 0xE4BEU, 0x7F62U, 0x09D6U,
+    0xC69FU, 0xB02BU, 0x2BF7U, 0x5D43U, 0x0C6EU, 0x7ADAU, 0xE106U, 0x97B2U,
+    0x435CU, 0x35E8U, 0xAE34U, 0xD880U, 0x89ADU, 0xFF19U, 0x64C5U, 0x1271U,
+    0xEA76U, 0x9CC2U, 0x071EU, 0x71AAU, 0x2087U, 0x5633U, 0xCDEFU, 0xBB5BU,
+    0x6FB5U, 0x1901U, 0x82DDU, 0xF469U, 0xA544U, 0xD3F0U, 0x482CU, 0x3E98U,
+    0xF1D1U, 0x8765U, 0x1CB9U, 0x6A0DU, 0x3B20U, 0x4D94U, 0xD648U, 0xA0FCU,
+    0x7412U, 0x02A6U, 0x997AU, 0xEFCEU, 0xBEE3U, 0xC857U, 0x538BU, 0x253FU,
+    0xB3A4U, 0xC510U, 0x5ECCU, 0x2878U, 0x7955U, 0x0FE1U, 0x943DU, 0xE289U,
+    0x3667U, 0x40D3U, 0xDB0FU, 0xADBBU, 0xFC96U, 0x8A22U, 0x11FEU, 0x674AU,
+    0xA803U, 0xDEB7U, 0x456BU, 0x33DFU, 0x62F2U, 0x1446U, 0x8F9AU, 0xF92EU,
+    0x2DC0U, 0x5B74U, 0xC0A8U, 0xB61CU, 0xE731U, 0x9185U, 0x0A59U, 0x7CEDU,
+    0x84EAU, 0xF25EU, 0x6982U, 0x1F36U, 0x4E1BU, 0x38AFU, 0xA373U, 0xD5C7U,
+    0x0129U, 0x779DU, 0xEC41U, 0x9AF5U, 0xCBD8U, 0xBD6CU, 0x26B0U, 0x5004U,
+    0x9F4DU, 0xE9F9U, 0x7225U, 0x0491U, 0x55BCU, 0x2308U, 0xB8D4U, 0xCE60U,
+    0x1A8EU, 0x6C3AU, 0xF7E6U, 0x8152U, 0xD07FU, 0xA6CBU, 0x3D17U, 0x4BA3U
+};
+
+static const uint32_t u32Crc24Table1[] = {
+    0x00000000U, 0x00668F48U, 0x00CD1E90U, 0x00AB91D8U, 0x001C71DBU, 0x007AFE93U, 0x00D16F4BU, 0x00B7E003U,
+    0x0038E3B6U, 0x005E6CFEU, 0x00F5FD26U, 0x0093726EU, 0x0024926DU, 0x00421D25U, 0x00E98CFDU, 0x008F03B5U,
+    0x0071C76CU, 0x00174824U, 0x00BCD9FCU, 0x00DA56B4U, 0x006DB6B7U, 0x000B39FFU, 0x00A0A827U, 0x00C6276FU,
+    0x004924DAU, 0x002FAB92U, 0x00843A4AU, 0x00E2B502U, 0x00555501U, 0x0033DA49U, 0x00984B91U, 0x00FEC4D9U,
+    0x00E38ED8U, 0x00850190U, 0x002E9048U, 0x00481F00U, 0x00FFFF03U, 0x0099704BU, 0x0032E193U, 0x00546EDBU,
+    0x00DB6D6EU, 0x00BDE226U, 0x001673FEU, 0x0070FCB6U, 0x00C71CB5U, 0x00A193FDU, 0x000A0225U, 0x006C8D6DU,
+    0x009249B4U, 0x00F4C6FCU, 0x005F5724U, 0x0039D86CU, 0x008E386FU, 0x00E8B727U, 0x004326FFU, 0x0025A9B7U,
+    0x00AAAA02U, 0x00CC254AU, 0x0067B492U, 0x00013BDAU, 0x00B6DBD9U, 0x00D05491U, 0x007BC549U, 0x001D4A01U,
+    0x0041514BU, 0x0027DE03U, 0x008C4FDBU, 0x00EAC093U, 0x005D2090U, 0x003BAFD8U, 0x00903E00U, 0x00F6B148U,
+    0x0079B2FDU, 0x001F3DB5U, 0x00B4AC6DU, 0x00D22325U, 0x0065C326U, 0x00034C6EU, 0x00A8DDB6U, 0x00CE52FEU,
+    0x00309627U, 0x0056196FU, 0x00FD88B7U, 0x009B07FFU, 0x002CE7FCU, 0x004A68B4U, 0x00E1F96CU, 0x00877624U,
+    0x00087591U, 0x006EFAD9U, 0x00C56B01U, 0x00A3E449U, 0x0014044AU, 0x00728B02U, 0x00D91ADAU, 0x00BF9592U,
+    0x00A2DF93U, 0x00C450DBU, 0x006FC103U, 0x00094E4BU, 0x00BEAE48U, 0x00D82100U, 0x0073B0D8U, 0x00153F90U,
+    0x009A3C25U, 0x00FCB36DU, 0x005722B5U, 0x0031ADFDU, 0x00864DFEU, 0x00E0C2B6U, 0x004B536EU, 0x002DDC26U,
+    0x00D318FFU, 0x00B597B7U, 0x001E066FU, 0x00788927U, 0x00CF6924U, 0x00A9E66CU, 0x000277B4U, 0x0064F8FCU,
+    0x00EBFB49U, 0x008D7401U, 0x0026E5D9U, 0x00406A91U, 0x00F78A92U, 0x009105DAU, 0x003A9402U, 0x005C1B4AU,
+    0x0082A296U, 0x00E42DDEU, 0x004FBC06U, 0x0029334EU, 0x009ED34DU, 0x00F85C05U, 0x0053CDDDU, 0x00354295U,
+    0x00BA4120U, 0x00DCCE68U, 0x00775FB0U, 0x0011D0F8U, 0x00A630FBU, 0x00C0BFB3U, 0x006B2E6BU, 0x000DA123U,
+    0x00F365FAU, 0x0095EAB2U, 0x003E7B6AU, 0x0058F422U, 0x00EF1421U, 0x00899B69U, 0x00220AB1U, 0x004485F9U,
+    0x00CB864CU, 0x00AD0904U, 0x000698DCU, 0x00601794U, 0x00D7F797U, 0x00B178DFU, 0x001AE907U, 0x007C664FU,
+    0x00612C4EU, 0x0007A306U, 0x00AC32DEU, 0x00CABD96U, 0x007D5D95U, 0x001BD2DDU, 0x00B04305U, 0x00D6CC4DU,
+    0x0059CFF8U, 0x003F40B0U, 0x0094D168U, 0x00F25E20U, 0x0045BE23U, 0x0023316BU, 0x0088A0B3U, 0x00EE2FFBU,
+    0x0010EB22U, 0x0076646AU, 0x00DDF5B2U, 0x00BB7AFAU, 0x000C9AF9U, 0x006A15B1U, 0x00C18469U, 0x00A70B21U,
+    0x00280894U, 0x004E87DCU, 0x00E51604U, 0x0083994CU, 0x0034794FU, 0x0052F607U, 0x00F967DFU, 0x009FE897U,
+    0x00C3F3DDU, 0x00A57C95U, 0x000EED4DU, 0x00686205U, 0x00DF8206U, 0x00B90D4EU, 0x00129C96U, 0x007413DEU,
+    0x00FB106BU, 0x009D9F23U, 0x00360EFBU, 0x005081B3U, 0x00E761B0U, 0x0081EEF8U, 0x002A7F20U, 0x004CF068U,
+    0x00B234B1U, 0x00D4BBF9U, 0x007F2A21U, 0x0019A569U, 0x00AE456AU, 0x00C8CA22U, 0x00635BFAU, 0x0005D4B2U,
+    0x008AD707U, 0x00EC584FU, 0x0047C997U, 0x002146DFU, 0x0096A6DCU, 0x00F02994U, 0x005BB84CU, 0x003D3704U,
+    0x00207D05U, 0x0046F24DU, 0x00ED6395U, 0x008BECDDU, 0x003C0CDEU, 0x005A8396U, 0x00F1124EU, 0x00979D06U,
+    0x00189EB3U, 0x007E11FBU, 0x00D58023U, 0x00B30F6BU, 0x0004EF68U, 0x00626020U, 0x00C9F1F8U, 0x00AF7EB0U,
+    0x0051BA69U, 0x00373521U, 0x009CA4F9U, 0x00FA2BB1U, 0x004DCBB2U, 0x002B44FAU, 0x0080D522U, 0x00E65A6AU,
+    0x006959DFU, 0x000FD697U, 0x00A4474FU, 0x00C2C807U, 0x00752804U, 0x0013A74CU, 0x00B83694U, 0x00DEB9DCU
+};
+
+static const uint32_t u32Crc24Table2[] = {
+    0x00000000U, 0x008309D7U, 0x00805F55U, 0x00035682U, 0x0086F251U, 0x0005FB86U, 0x0006AD04U, 0x0085A4D3U,
+    0x008BA859U, 0x0008A18EU, 0x000BF70CU, 0x0088FEDBU, 0x000D5A08U, 0x008E53DFU, 0x008D055DU, 0x000E0C8AU,
+    0x00911C49U, 0x0012159EU, 0x0011431CU, 0x00924ACBU, 0x0017EE18U, 0x0094E7CFU, 0x0097B14DU, 0x0014B89AU,
+    0x001AB410U, 0x0099BDC7U, 0x009AEB45U, 0x0019E292U, 0x009C4641U, 0x001F4F96U, 0x001C1914U, 0x009F10C3U,
+    0x00A47469U, 0x00277DBEU, 0x00242B3CU, 0x00A722EBU, 0x00228638U, 0x00A18FEFU, 0x00A2D96DU, 0x0021D0BAU,
+    0x002FDC30U, 0x00ACD5E7U, 0x00AF8365U, 0x002C8AB2U, 0x00A92E61U, 0x002A27B6U, 0x00297134U, 0x00AA78E3U,
+    0x00356820U, 0x00B661F7U, 0x00B53775U, 0x00363EA2U, 0x00B39A71U, 0x003093A6U, 0x0033C524U, 0x00B0CCF3U,
+    0x00BEC079U, 0x003DC9AEU, 0x003E9F2CU, 0x00BD96FBU, 0x00383228U, 0x00BB3BFFU, 0x00B86D7DU, 0x003B64AAU,
+    0x00CEA429U, 0x004DADFEU, 0x004EFB7CU, 0x00CDF2ABU, 0x00485678U, 0x00CB5FAFU, 0x00C8092DU, 0x004B00FAU,
+    0x00450C70U, 0x00C605A7U, 0x00C55325U, 0x00465AF2U, 0x00C3FE21U, 0x0040F7F6U, 0x0043A174U, 0x00C0A8A3U,
+    0x005FB860U, 0x00DCB1B7U, 0x00DFE735U, 0x005CEEE2U, 0x00D94A31U, 0x005A43E6U, 0x00591564U, 0x00DA1CB3U,
+    0x00D41039U, 0x005719EEU, 0x00544F6CU, 0x00D746BBU, 0x0052E268U, 0x00D1EBBFU, 0x00D2BD3DU, 0x0051B4EAU,
+    0x006AD040U, 0x00E9D997U, 0x00EA8F15U, 0x006986C2U, 0x00EC2211U, 0x006F2BC6U, 0x006C7D44U, 0x00EF7493U,
+    0x00E17819U, 0x006271CEU, 0x0061274CU, 0x00E22E9BU, 0x00678A48U, 0x00E4839FU, 0x00E7D51DU, 0x0064DCCAU,
+    0x00FBCC09U, 0x0078C5DEU, 0x007B935CU, 0x00F89A8BU, 0x007D3E58U, 0x00FE378FU, 0x00FD610DU, 0x007E68DAU,
+    0x00706450U, 0x00F36D87U, 0x00F03B05U, 0x007332D2U, 0x00F69601U, 0x00759FD6U, 0x0076C954U, 0x00F5C083U,
+    0x001B04A9U, 0x00980D7EU, 0x009B5BFCU, 0x0018522BU, 0x009DF6F8U, 0x001EFF2FU, 0x001DA9ADU, 0x009EA07AU,
+    0x0090ACF0U, 0x0013A527U, 0x0010F3A5U, 0x0093FA72U, 0x00165EA1U, 0x00955776U, 0x009601F4U, 0x00150823U,
+    0x008A18E0U, 0x00091137U, 0x000A47B5U, 0x00894E62U, 0x000CEAB1U, 0x008FE366U, 0x008CB5E4U, 0x000FBC33U,
+    0x0001B0B9U, 0x0082B96EU, 0x0081EFECU, 0x0002E63BU, 0x008742E8U, 0x00044B3FU, 0x00071DBDU, 0x0084146AU,
+    0x00BF70C0U, 0x003C7917U, 0x003F2F95U, 0x00BC2642U, 0x00398291U, 0x00BA8B46U, 0x00B9DDC4U, 0x003AD413U,
+    0x0034D899U, 0x00B7D14EU, 0x00B487CCU, 0x00378E1BU, 0x00B22AC8U, 0x0031231FU, 0x0032759DU, 0x00B17C4AU,
+    0x002E6C89U, 0x00AD655EU, 0x00AE33DCU, 0x002D3A0BU, 0x00A89ED8U, 0x002B970FU, 0x0028C18DU, 0x00ABC85AU,
+    0x00A5C4D0U, 0x0026CD07U, 0x00259B85U, 0x00A69252U, 0x00233681U, 0x00A03F56U, 0x00A369D4U, 0x00206003U,
+    0x00D5A080U, 0x0056A957U, 0x0055FFD5U, 0x00D6F602U, 0x005352D1U, 0x00D05B06U, 0x00D30D84U, 0x00500453U,
+    0x005E08D9U, 0x00DD010EU, 0x00DE578CU, 0x005D5E5BU, 0x00D8FA88U, 0x005BF35FU, 0x0058A5DDU, 0x00DBAC0AU,
+    0x0044BCC9U, 0x00C7B51EU, 0x00C4E39CU, 0x0047EA4BU, 0x00C24E98U, 0x0041474FU, 0x004211CDU, 0x00C1181AU,
+    0x00CF1490U, 0x004C1D47U, 0x004F4BC5U, 0x00CC4212U, 0x0049E6C1U, 0x00CAEF16U, 0x00C9B994U, 0x004AB043U,
+    0x0071D4E9U, 0x00F2DD3EU, 0x00F18BBCU, 0x0072826BU, 0x00F726B8U, 0x00742F6FU, 0x007779EDU, 0x00F4703AU,
+    0x00FA7CB0U, 0x00797567U, 0x007A23E5U, 0x00F92A32U, 0x007C8EE1U, 0x00FF8736U, 0x00FCD1B4U, 0x007FD863U,
+    0x00E0C8A0U, 0x0063C177U, 0x006097F5U, 0x00E39E22U, 0x00663AF1U, 0x00E53326U, 0x00E665A4U, 0x00656C73U,
+    0x006B60F9U, 0x00E8692EU, 0x00EB3FACU, 0x0068367BU, 0x00ED92A8U, 0x006E9B7FU, 0x006DCDFDU, 0x00EEC42AU
+};
+
+static const uint32_t u32Crc24Table3[] = {
+    0x00000000U, 0x00360952U, 0x006C12A4U, 0x005A1BF6U, 0x00D82548U, 0x00EE2C1AU, 0x00B437ECU, 0x00823EBEU,
+    0x0036066BU, 0x00000F39U, 0x005A14CFU, 0x006C1D9DU, 0x00EE2323U, 0x00D82A71U, 0x00823187U, 0x00B438D5U,
+    0x006C0CD6U, 0x005A0584U, 0x00001E72U, 0x00361720U, 0x00B4299EU, 0x008220CCU, 0x00D83B3AU, 0x00EE3268U,
+    0x005A0ABDU, 0x006C03EFU, 0x00361819U, 0x0000114BU, 0x00822FF5U, 0x00B426A7U, 0x00EE3D51U, 0x00D83403U,
+    0x00D819ACU, 0x00EE10FEU, 0x00B40B08U, 0x0082025AU, 0x00003CE4U, 0x003635B6U, 0x006C2E40U, 0x005A2712U,
+    0x00EE1FC7U, 0x00D81695U, 0x00820D63U, 0x00B40431U, 0x00363A8FU, 0x000033DDU, 0x005A282BU, 0x006C2179U,
+    0x00B4157AU, 0x00821C28U, 0x00D807DEU, 0x00EE0E8CU, 0x006C3032U, 0x005A3960U, 0x00002296U, 0x00362BC4U,
+    0x00821311U, 0x00B41A43U, 0x00EE01B5U, 0x00D808E7U, 0x005A3659U, 0x006C3F0BU, 0x003624FDU, 0x00002DAFU,
+    0x00367FA3U, 0x000076F1U, 0x005A6D07U, 0x006C6455U, 0x00EE5AEBU, 0x00D853B9U, 0x0082484FU, 0x00B4411DU,
+    0x000079C8U, 0x0036709AU, 0x006C6B6CU, 0x005A623EU, 0x00D85C80U, 0x00EE55D2U, 0x00B44E24U, 0x00824776U,
+    0x005A7375U, 0x006C7A27U, 0x003661D1U, 0x00006883U, 0x0082563DU, 0x00B45F6FU, 0x00EE4499U, 0x00D84DCBU,
+    0x006C751EU, 0x005A7C4CU, 0x000067BAU, 0x00366EE8U, 0x00B45056U, 0x00825904U, 0x00D842F2U, 0x00EE4BA0U,
+    0x00EE660FU, 0x00D86F5DU, 0x008274ABU, 0x00B47DF9U, 0x00364347U, 0x00004A15U, 0x005A51E3U, 0x006C58B1U,
+    0x00D86064U, 0x00EE6936U, 0x00B472C0U, 0x00827B92U, 0x0000452CU, 0x00364C7EU, 0x006C5788U, 0x005A5EDAU,
+    0x00826AD9U, 0x00B4638BU, 0x00EE787DU, 0x00D8712FU, 0x005A4F91U, 0x006C46C3U, 0x00365D35U, 0x00005467U,
+    0x00B46CB2U, 0x008265E0U, 0x00D87E16U, 0x00EE7744U, 0x006C49FAU, 0x005A40A8U, 0x00005B5EU, 0x0036520CU,
+    0x006CFF46U, 0x005AF614U, 0x0000EDE2U, 0x0036E4B0U, 0x00B4DA0EU, 0x0082D35CU, 0x00D8C8AAU, 0x00EEC1F8U,
+    0x005AF92DU, 0x006CF07FU, 0x0036EB89U, 0x0000E2DBU, 0x0082DC65U, 0x00B4D537U, 0x00EECEC1U, 0x00D8C793U,
+    0x0000F390U, 0x0036FAC2U, 0x006CE134U, 0x005AE866U, 0x00D8D6D8U, 0x00EEDF8AU, 0x00B4C47CU, 0x0082CD2EU,
+    0x0036F5FBU, 0x0000FCA9U, 0x005AE75FU, 0x006CEE0DU, 0x00EED0B3U, 0x00D8D9E1U, 0x0082C217U, 0x00B4CB45U,
+    0x00B4E6EAU, 0x0082EFB8U, 0x00D8F44EU, 0x00EEFD1CU, 0x006CC3A2U, 0x005ACAF0U, 0x0000D106U, 0x0036D854U,
+    0x0082E081U, 0x00B4E9D3U, 0x00EEF225U, 0x00D8FB77U, 0x005AC5C9U, 0x006CCC9BU, 0x0036D76DU, 0x0000DE3FU,
+    0x00D8EA3CU, 0x00EEE36EU, 0x00B4F898U, 0x0082F1CAU, 0x0000CF74U, 0x0036C626U, 0x006CDDD0U, 0x005AD482U,
+    0x00EEEC57U, 0x00D8E505U, 0x0082FEF3U, 0x00B4F7A1U, 0x0036C91FU, 0x0000C04DU, 0x005ADBBBU, 0x006CD2E9U,
+    0x005A80E5U, 0x006C89B7U, 0x00369241U, 0x00009B13U, 0x0082A5ADU, 0x00B4ACFFU, 0x00EEB709U, 0x00D8BE5BU,
+    0x006C868EU, 0x005A8FDCU, 0x0000942AU, 0x00369D78U, 0x00B4A3C6U, 0x0082AA94U, 0x00D8B162U, 0x00EEB830U,
+    0x00368C33U, 0x00008561U, 0x005A9E97U, 0x006C97C5U, 0x00EEA97BU, 0x00D8A029U, 0x0082BBDFU, 0x00B4B28DU,
+    0x00008A58U, 0x0036830AU, 0x006C98FCU, 0x005A91AEU, 0x00D8AF10U, 0x00EEA642U, 0x00B4BDB4U, 0x0082B4E6U,
+    0x00829949U, 0x00B4901BU, 0x00EE8BEDU, 0x00D882BFU, 0x005ABC01U, 0x006CB553U, 0x0036AEA5U, 0x0000A7F7U,
+    0x00B49F22U, 0x00829670U, 0x00D88D86U, 0x00EE84D4U, 0x006CBA6AU, 0x005AB338U, 0x0000A8CEU, 0x0036A19CU,
+    0x00EE959FU, 0x00D89CCDU, 0x0082873BU, 0x00B48E69U, 0x0036B0D7U, 0x0000B985U, 0x005AA273U, 0x006CAB21U,
+    0x00D893F4U, 0x00EE9AA6U, 0x00B48150U, 0x00828802U, 0x0000B6BCU, 0x0036BFEEU, 0x006CA418U, 0x005AAD4AU
+};
+
+static const uint32_t u32Crc32Table1[] = {
+    0x00000000U, 0xD219C1DCU, 0xA0F29E0FU, 0x72EB5FD3U, 0x452421A9U, 0x973DE075U, 0xE5D6BFA6U, 0x37CF7E7AU,
+    0x8A484352U, 0x5851828EU, 0x2ABADD5DU, 0xF8A31C81U, 0xCF6C62FBU, 0x1D75A327U, 0x6F9EFCF4U, 0xBD873D28U,
+    0x10519B13U, 0xC2485ACFU, 0xB0A3051CU, 0x62BAC4C0U, 0x5575BABAU, 0x876C7B66U, 0xF58724B5U, 0x279EE569U,
+    0x9A19D841U, 0x4800199DU, 0x3AEB464EU, 0xE8F28792U, 0xDF3DF9E8U, 0x0D243834U, 0x7FCF67E7U, 0xADD6A63BU,
+    0x20A33626U, 0xF2BAF7FAU, 0x8051A829U, 0x524869F5U, 0x6587178FU, 0xB79ED653U, 0xC5758980U, 0x176C485CU,
+    0xAAEB7574U, 0x78F2B4A8U, 0x0A19EB7BU, 0xD8002AA7U, 0xEFCF54DDU, 0x3DD69501U, 0x4F3DCAD2U, 0x9D240B0EU,
+    0x30F2AD35U, 0xE2EB6CE9U, 0x9000333AU, 0x4219F2E6U, 0x75D68C9CU, 0xA7CF4D40U, 0xD5241293U, 0x073DD34FU,
+    0xBABAEE67U, 0x68A32FBBU, 0x1A487068U, 0xC851B1B4U, 0xFF9ECFCEU, 0x2D870E12U, 0x5F6C51C1U, 0x8D75901DU,
+    0x41466C4CU, 0x935FAD90U, 0xE1B4F243U, 0x33AD339FU, 0x04624DE5U, 0xD67B8C39U, 0xA490D3EAU, 0x76891236U,
+    0xCB0E2F1EU, 0x1917EEC2U, 0x6BFCB111U, 0xB9E570CDU, 0x8E2A0EB7U, 0x5C33CF6BU, 0x2ED890B8U, 0xFCC15164U,
+    0x5117F75FU, 0x830E3683U, 0xF1E56950U, 0x23FCA88CU, 0x1433D6F6U, 0xC62A172AU, 0xB4C148F9U, 0x66D88925U,
+    0xDB5FB40DU, 0x094675D1U, 0x7BAD2A02U, 0xA9B4EBDEU, 0x9E7B95A4U, 0x4C625478U, 0x3E890BABU, 0xEC90CA77U,
+    0x61E55A6AU, 0xB3FC9BB6U, 0xC117C465U, 0x130E05B9U, 0x24C17BC3U, 0xF6D8BA1FU, 0x8433E5CCU, 0x562A2410U,
+    0xEBAD1938U, 0x39B4D8E4U, 0x4B5F8737U, 0x994646EBU, 0xAE893891U, 0x7C90F94DU, 0x0E7BA69EU, 0xDC626742U,
+    0x71B4C179U, 0xA3AD00A5U, 0xD1465F76U, 0x035F9EAAU, 0x3490E0D0U, 0xE689210CU, 0x94627EDFU, 0x467BBF03U,
+    0xFBFC822BU, 0x29E543F7U, 0x5B0E1C24U, 0x8917DDF8U, 0xBED8A382U, 0x6CC1625EU, 0x1E2A3D8DU, 0xCC33FC51U,
+    0x828CD898U, 0x50951944U, 0x227E4697U, 0xF067874BU, 0xC7A8F931U, 0x15B138EDU, 0x675A673EU, 0xB543A6E2U,
+    0x08C49BCAU, 0xDADD5A16U, 0xA83605C5U, 0x7A2FC419U, 0x4DE0BA63U, 0x9FF97BBFU, 0xED12246CU, 0x3F0BE5B0U,
+    0x92DD438BU, 0x40C48257U, 0x322FDD84U, 0xE0361C58U, 0xD7F96222U, 0x05E0A3FEU, 0x770BFC2DU, 0xA5123DF1U,
+    0x189500D9U, 0xCA8CC105U, 0xB8679ED6U, 0x6A7E5F0AU, 0x5DB12170U, 0x8FA8E0ACU, 0xFD43BF7FU, 0x2F5A7EA3U,
+    0xA22FEEBEU, 0x70362F62U, 0x02DD70B1U, 0xD0C4B16DU, 0xE70BCF17U, 0x35120ECBU, 0x47F95118U, 0x95E090C4U,
+    0x2867ADECU, 0xFA7E6C30U, 0x889533E3U, 0x5A8CF23FU, 0x6D438C45U, 0xBF5A4D99U, 0xCDB1124AU, 0x1FA8D396U,
+    0xB27E75ADU, 0x6067B471U, 0x128CEBA2U, 0xC0952A7EU, 0xF75A5404U, 0x254395D8U, 0x57A8CA0BU, 0x85B10BD7U,
+    0x383636FFU, 0xEA2FF723U, 0x98C4A8F0U, 0x4ADD692CU, 0x7D121756U, 0xAF0BD68AU, 0xDDE08959U, 0x0FF94885U,
+    0xC3CAB4D4U, 0x11D37508U, 0x63382ADBU, 0xB121EB07U, 0x86EE957DU, 0x54F754A1U, 0x261C0B72U, 0xF405CAAEU,
+    0x4982F786U, 0x9B9B365AU, 0xE9706989U, 0x3B69A855U, 0x0CA6D62FU, 0xDEBF17F3U, 0xAC544820U, 0x7E4D89FCU,
+    0xD39B2FC7U, 0x0182EE1BU, 0x7369B1C8U, 0xA1707014U, 0x96BF0E6EU, 0x44A6CFB2U, 0x364D9061U, 0xE45451BDU,
+    0x59D36C95U, 0x8BCAAD49U, 0xF921F29AU, 0x2B383346U, 0x1CF74D3CU, 0xCEEE8CE0U, 0xBC05D333U, 0x6E1C12EFU,
+    0xE36982F2U, 0x3170432EU, 0x439B1CFDU, 0x9182DD21U, 0xA64DA35BU, 0x74546287U, 0x06BF3D54U, 0xD4A6FC88U,
+    0x6921C1A0U, 0xBB38007CU, 0xC9D35FAFU, 0x1BCA9E73U, 0x2C05E009U, 0xFE1C21D5U, 0x8CF77E06U, 0x5EEEBFDAU,
+    0xF33819E1U, 0x2121D83DU, 0x53CA87EEU, 0x81D34632U, 0xB61C3848U, 0x6405F994U, 0x16EEA647U, 0xC4F7679BU,
+    0x79705AB3U, 0xAB699B6FU, 0xD982C4BCU, 0x0B9B0560U, 0x3C547B1AU, 0xEE4DBAC6U, 0x9CA6E515U, 0x4EBF24C9U
+};
+
+static const uint32_t u32Crc32Table2[] = {
+    0x00000000U, 0x01D8AC87U, 0x03B1590EU, 0x0269F589U, 0x0762B21CU, 0x06BA1E9BU, 0x04D3EB12U, 0x050B4795U,
+    0x0EC56438U, 0x0F1DC8BFU, 0x0D743D36U, 0x0CAC91B1U, 0x09A7D624U, 0x087F7AA3U, 0x0A168F2AU, 0x0BCE23ADU,
+    0x1D8AC870U, 0x1C5264F7U, 0x1E3B917EU, 0x1FE33DF9U, 0x1AE87A6CU, 0x1B30D6EBU, 0x19592362U, 0x18818FE5U,
+    0x134FAC48U, 0x129700CFU, 0x10FEF546U, 0x112659C1U, 0x142D1E54U, 0x15F5B2D3U, 0x179C475AU, 0x1644EBDDU,
+    0x3B1590E0U, 0x3ACD3C67U, 0x38A4C9EEU, 0x397C6569U, 0x3C7722FCU, 0x3DAF8E7BU, 0x3FC67BF2U, 0x3E1ED775U,
+    0x35D0F4D8U, 0x3408585FU, 0x3661ADD6U, 0x37B90151U, 0x32B246C4U, 0x336AEA43U, 0x31031FCAU, 0x30DBB34DU,
+    0x269F5890U, 0x2747F417U, 0x252E019EU, 0x24F6AD19U, 0x21FDEA8CU, 0x2025460BU, 0x224CB382U, 0x23941F05U,
+    0x285A3CA8U, 0x2982902FU, 0x2BEB65A6U, 0x2A33C921U, 0x2F388EB4U, 0x2EE02233U, 0x2C89D7BAU, 0x2D517B3DU,
+    0x762B21C0U, 0x77F38D47U, 0x759A78CEU, 0x7442D449U, 0x714993DCU, 0x70913F5BU, 0x72F8CAD2U, 0x73206655U,
+    0x78EE45F8U, 0x7936E97FU, 0x7B5F1CF6U, 0x7A87B071U, 0x7F8CF7E4U, 0x7E545B63U, 0x7C3DAEEAU, 0x7DE5026DU,
+    0x6BA1E9B0U, 0x6A794537U, 0x6810B0BEU, 0x69C81C39U, 0x6CC35BACU, 0x6D1BF72BU, 0x6F7202A2U, 0x6EAAAE25U,
+    0x65648D88U, 0x64BC210FU, 0x66D5D486U, 0x670D7801U, 0x62063F94U, 0x63DE9313U, 0x61B7669AU, 0x606FCA1DU,
+    0x4D3EB120U, 0x4CE61DA7U, 0x4E8FE82EU, 0x4F5744A9U, 0x4A5C033CU, 0x4B84AFBBU, 0x49ED5A32U, 0x4835F6B5U,
+    0x43FBD518U, 0x4223799FU, 0x404A8C16U, 0x41922091U, 0x44996704U, 0x4541CB83U, 0x47283E0AU, 0x46F0928DU,
+    0x50B47950U, 0x516CD5D7U, 0x5305205EU, 0x52DD8CD9U, 0x57D6CB4CU, 0x560E67CBU, 0x54679242U, 0x55BF3EC5U,
+    0x5E711D68U, 0x5FA9B1EFU, 0x5DC04466U, 0x5C18E8E1U, 0x5913AF74U, 0x58CB03F3U, 0x5AA2F67AU, 0x5B7A5AFDU,
+    0xEC564380U, 0xED8EEF07U, 0xEFE71A8EU, 0xEE3FB609U, 0xEB34F19CU, 0xEAEC5D1BU, 0xE885A892U, 0xE95D0415U,
+    0xE29327B8U, 0xE34B8B3FU, 0xE1227EB6U, 0xE0FAD231U, 0xE5F195A4U, 0xE4293923U, 0xE640CCAAU, 0xE798602DU,
+    0xF1DC8BF0U, 0xF0042777U, 0xF26DD2FEU, 0xF3B57E79U, 0xF6BE39ECU, 0xF766956BU, 0xF50F60E2U, 0xF4D7CC65U,
+    0xFF19EFC8U, 0xFEC1434FU, 0xFCA8B6C6U, 0xFD701A41U, 0xF87B5DD4U, 0xF9A3F153U, 0xFBCA04DAU, 0xFA12A85DU,
+    0xD743D360U, 0xD69B7FE7U, 0xD4F28A6EU, 0xD52A26E9U, 0xD021617CU, 0xD1F9CDFBU, 0xD3903872U, 0xD24894F5U,
+    0xD986B758U, 0xD85E1BDFU, 0xDA37EE56U, 0xDBEF42D1U, 0xDEE40544U, 0xDF3CA9C3U, 0xDD555C4AU, 0xDC8DF0CDU,
+    0xCAC91B10U, 0xCB11B797U, 0xC978421EU, 0xC8A0EE99U, 0xCDABA90CU, 0xCC73058BU, 0xCE1AF002U, 0xCFC25C85U,
+    0xC40C7F28U, 0xC5D4D3AFU, 0xC7BD2626U, 0xC6658AA1U, 0xC36ECD34U, 0xC2B661B3U, 0xC0DF943AU, 0xC10738BDU,
+    0x9A7D6240U, 0x9BA5CEC7U, 0x99CC3B4EU, 0x981497C9U, 0x9D1FD05CU, 0x9CC77CDBU, 0x9EAE8952U, 0x9F7625D5U,
+    0x94B80678U, 0x9560AAFFU, 0x97095F76U, 0x96D1F3F1U, 0x93DAB464U, 0x920218E3U, 0x906BED6AU, 0x91B341EDU,
+    0x87F7AA30U, 0x862F06B7U, 0x8446F33EU, 0x859E5FB9U, 0x8095182CU, 0x814DB4ABU, 0x83244122U, 0x82FCEDA5U,
+    0x8932CE08U, 0x88EA628FU, 0x8A839706U, 0x8B5B3B81U, 0x8E507C14U, 0x8F88D093U, 0x8DE1251AU, 0x8C39899DU,
+    0xA168F2A0U, 0xA0B05E27U, 0xA2D9ABAEU, 0xA3010729U, 0xA60A40BCU, 0xA7D2EC3BU, 0xA5BB19B2U, 0xA463B535U,
+    0xAFAD9698U, 0xAE753A1FU, 0xAC1CCF96U, 0xADC46311U, 0xA8CF2484U, 0xA9178803U, 0xAB7E7D8AU, 0xAAA6D10DU,
+    0xBCE23AD0U, 0xBD3A9657U, 0xBF5363DEU, 0xBE8BCF59U, 0xBB8088CCU, 0xBA58244BU, 0xB831D1C2U, 0xB9E97D45U,
+    0xB2275EE8U, 0xB3FFF26FU, 0xB19607E6U, 0xB04EAB61U, 0xB545ECF4U, 0xB49D4073U, 0xB6F4B5FAU, 0xB72C197DU
+};
+
+static const uint32_t u32Crc32Table3[] = {
+    0x00000000U, 0xDC6D9AB7U, 0xBC1A28D9U, 0x6077B26EU, 0x7CF54C05U, 0xA098D6B2U, 0xC0EF64DCU, 0x1C82FE6BU,
+    0xF9EA980AU, 0x258702BDU, 0x45F0B0D3U, 0x999D2A64U, 0x851FD40FU, 0x59724EB8U, 0x3905FCD6U, 0xE5686661U,
+    0xF7142DA3U, 0x2B79B714U, 0x4B0E057AU, 0x97639FCDU, 0x8BE161A6U, 0x578CFB11U, 0x37FB497FU, 0xEB96D3C8U,
+    0x0EFEB5A9U, 0xD2932F1EU, 0xB2E49D70U, 0x6E8907C7U, 0x720BF9ACU, 0xAE66631BU, 0xCE11D175U, 0x127C4BC2U,
+    0xEAE946F1U, 0x3684DC46U, 0x56F36E28U, 0x8A9EF49FU, 0x961C0AF4U, 0x4A719043U, 0x2A06222DU, 0xF66BB89AU,
+    0x1303DEFBU, 0xCF6E444CU, 0xAF19F622U, 0x73746C95U, 0x6FF692FEU, 0xB39B0849U, 0xD3ECBA27U, 0x0F812090U,
+    0x1DFD6B52U, 0xC190F1E5U, 0xA1E7438BU, 0x7D8AD93CU, 0x61082757U, 0xBD65BDE0U, 0xDD120F8EU, 0x017F9539U,
+    0xE417F358U, 0x387A69EFU, 0x580DDB81U, 0x84604136U, 0x98E2BF5DU, 0x448F25EAU, 0x24F89784U, 0xF8950D33U,
+    0xD1139055U, 0x0D7E0AE2U, 0x6D09B88CU, 0xB164223BU, 0xADE6DC50U, 0x718B46E7U, 0x11FCF489U, 0xCD916E3EU,
+    0x28F9085FU, 0xF49492E8U, 0x94E32086U, 0x488EBA31U, 0x540C445AU, 0x8861DEEDU, 0xE8166C83U, 0x347BF634U,
+    0x2607BDF6U, 0xFA6A2741U, 0x9A1D952FU, 0x46700F98U, 0x5AF2F1F3U, 0x869F6B44U, 0xE6E8D92AU, 0x3A85439DU,
+    0xDFED25FCU, 0x0380BF4BU, 0x63F70D25U, 0xBF9A9792U, 0xA31869F9U, 0x7F75F34EU, 0x1F024120U, 0xC36FDB97U,
+    0x3BFAD6A4U, 0xE7974C13U, 0x87E0FE7DU, 0x5B8D64CAU, 0x470F9AA1U, 0x9B620016U, 0xFB15B278U, 0x277828CFU,
+    0xC2104EAEU, 0x1E7DD419U, 0x7E0A6677U, 0xA267FCC0U, 0xBEE502ABU, 0x6288981CU, 0x02FF2A72U, 0xDE92B0C5U,
+    0xCCEEFB07U, 0x108361B0U, 0x70F4D3DEU, 0xAC994969U, 0xB01BB702U, 0x6C762DB5U, 0x0C019FDBU, 0xD06C056CU,
+    0x3504630DU, 0xE969F9BAU, 0x891E4BD4U, 0x5573D163U, 0x49F12F08U, 0x959CB5BFU, 0xF5EB07D1U, 0x29869D66U,
+    0xA6E63D1DU, 0x7A8BA7AAU, 0x1AFC15C4U, 0xC6918F73U, 0xDA137118U, 0x067EEBAFU, 0x660959C1U, 0xBA64C376U,
+    0x5F0CA517U, 0x83613FA0U, 0xE3168DCEU, 0x3F7B1779U, 0x23F9E912U, 0xFF9473A5U, 0x9FE3C1CBU, 0x438E5B7CU,
+    0x51F210BEU, 0x8D9F8A09U, 0xEDE83867U, 0x3185A2D0U, 0x2D075CBBU, 0xF16AC60CU, 0x911D7462U, 0x4D70EED5U,
+    0xA81888B4U, 0x74751203U, 0x1402A06DU, 0xC86F3ADAU, 0xD4EDC4B1U, 0x08805E06U, 0x68F7EC68U, 0xB49A76DFU,
+    0x4C0F7BECU, 0x9062E15BU, 0xF0155335U, 0x2C78C982U, 0x30FA37E9U, 0xEC97AD5EU, 0x8CE01F30U, 0x508D8587U,
+    0xB5E5E3E6U, 0x69887951U, 0x09FFCB3FU, 0xD5925188U, 0xC910AFE3U, 0x157D3554U, 0x750A873AU, 0xA9671D8DU,
+    0xBB1B564FU, 0x6776CCF8U, 0x07017E96U, 0xDB6CE421U, 0xC7EE1A4AU, 0x1B8380FDU, 0x7BF43293U, 0xA799A824U,
+    0x42F1CE45U, 0x9E9C54F2U, 0xFEEBE69CU, 0x22867C2BU, 0x3E048240U, 0xE26918F7U, 0x821EAA99U, 0x5E73302EU,
+    0x77F5AD48U, 0xAB9837FFU, 0xCBEF8591U, 0x17821F26U, 0x0B00E14DU, 0xD76D7BFAU, 0xB71AC994U, 0x6B775323U,
+    0x8E1F3542U, 0x5272AFF5U, 0x32051D9BU, 0xEE68872CU, 0xF2EA7947U, 0x2E87E3F0U, 0x4EF0519EU, 0x929DCB29U,
+    0x80E180EBU, 0x5C8C1A5CU, 0x3CFBA832U, 0xE0963285U, 0xFC14CCEEU, 0x20795659U, 0x400EE437U, 0x9C637E80U,
+    0x790B18E1U, 0xA5668256U, 0xC5113038U, 0x197CAA8FU, 0x05FE54E4U, 0xD993CE53U, 0xB9E47C3DU, 0x6589E68AU,
+    0x9D1CEBB9U, 0x4171710EU, 0x2106C360U, 0xFD6B59D7U, 0xE1E9A7BCU, 0x3D843D0BU, 0x5DF38F65U, 0x819E15D2U,
+    0x64F673B3U, 0xB89BE904U, 0xD8EC5B6AU, 0x0481C1DDU, 0x18033FB6U, 0xC46EA501U, 0xA419176FU, 0x78748DD8U,
+    0x6A08C61AU, 0xB6655CADU, 0xD612EEC3U, 0x0A7F7474U, 0x16FD8A1FU, 0xCA9010A8U, 0xAAE7A2C6U, 0x768A3871U,
+    0x93E25E10U, 0x4F8FC4A7U, 0x2FF876C9U, 0xF395EC7EU, 0xEF171215U, 0x337A88A2U, 0x530D3ACCU, 0x8F60A07BU
+};
+
+#endif // #ifdef U_SPARTN_CRC_SLICE_BY_4
 
 /* ----------------------------------------------------------------
- * PUBLIC FUNCTIONS
+ * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
-uint8_t uSpartnCrc4(const char *pData, size_t size)
+// Continue a CRC16 calculation: no initial value or final XOR.
+static uint16_t crc16Update(uint16_t u16Remainder, const uint8_t *pU8Msg,
+                            size_t size)
 {
-    // Initialize local variables
-    uint8_t u8TableRemainder;
-    uint8_t u8Remainder = 0; // Initial remainder
-    const uint8_t *pU8Msg = (uint8_t *) pData;
+    uint16_t u16TableRemainder;
+#ifdef U_SPARTN_CRC_SLICE_BY_4
+    uint32_t u32Data;
+
+    // Four bytes at a time: all of the remainder is shifted
+    // out, leaving the sum of the effects of each byte
+    for (; size >= 4; size -= 4) {
+        u32Data = U_SPARTN_CRC_UINT32_BE(pU8Msg) ^ ((uint32_t) u16Remainder << 16);
+        u16Remainder = u16Crc16Table3[u32Data >> 24] ^
+                       u16Crc16Table2[(u32Data >> 16) & 0xFF] ^
+                       u16Crc16Table1[(u32Data >> 8) & 0xFF] ^
+                       u16Crc16Table[u32Data & 0xFF];
+        pU8Msg += 4;
+    }
+#endif
 
-    // Compute the CRC value
     // Divide each byte of the message by the corresponding polynomial
     for (size_t x = 0; x < size; x++) {
-        u8TableRemainder = pU8Msg[x] ^ u8Remainder;
-        u8Remainder = u8Crc4Table[u8TableRemainder];
+        u16TableRemainder = pU8Msg[x] ^ (u16Remainder >> 8);
+        u16Remainder = u16Crc16Table[u16TableRemainder] ^ (uint16_t) (u16Remainder << 8);
     }
 
-    return u8Remainder;
+    return u16Remainder;
 }
 
-uint8_t uSpartnCrc8(const char *pData, size_t size)
+// Continue a CRC24 calculation.
+static uint32_t crc24Update(uint32_t u32Remainder, const uint8_t *pU8Msg,
+                            size_t size)
 {
-    // Initialize local variables
-    uint8_t u8TableRemainder;
-    uint8_t u8Remainder = 0; // Initial remainder
-    const uint8_t *pU8Msg = (uint8_t *) pData;
+    uint32_t u32TableRemainder;
+#ifdef U_SPARTN_CRC_SLICE_BY_4
+    uint32_t u32Data;
+
+    for (; size >= 4; size -= 4) {
+        u32Data = U_SPARTN_CRC_UINT32_BE(pU8Msg) ^ (u32Remainder << 8);
+        u32Remainder = u32Crc24Table3[u32Data >> 24] ^
+                       u32Crc24Table2[(u32Data >> 16) & 0xFF] ^
+                       u32Crc24Table1[(u32Data >> 8) & 0xFF] ^
+                       u32Crc24Table[u32Data & 0xFF];
+        pU8Msg += 4;
+    }
+#endif
 
-    // Compute the CRC value
-    // Divide each byte of the message by the corresponding polynomial
     for (size_t x = 0; x < size; x++) {
-        u8TableRemainder = pU8Msg[x] ^ u8Remainder;
-        u8Remainder = u8Crc8Table[u8TableRemainder];
+        u32TableRemainder = pU8Msg[x] ^ (u32Remainder >> 16);
+        u32Remainder = u32Crc24Table[u32TableRemainder] ^ (u32Remainder << 8);
+        u32Remainder = u32Remainder & 0x00FFFFFF; // Only interested in 24 bits
     }
 
-    return u8Remainder;
+    return u32Remainder;
 }
 
-uint16_t uSpartnCrc16(const char *pData, size_t size)
+// Continue a CRC32 calculation: no initial value or final XOR.
+static uint32_t crc32Update(uint32_t u32Remainder, const uint8_t *pU8Msg,
+                            size_t size)
 {
-    // Initialize local variables
-    uint16_t u16TableRemainder;
-    uint16_t u16Remainder = 0; // Initial remainder
-    uint8_t  u8NumBitsInCrc = (8 * sizeof(uint16_t));
-    const uint8_t  *pU8Msg = (uint8_t *) pData;
+    uint32_t u32TableRemainder;
+#ifdef U_SPARTN_CRC_SLICE_BY_4
+    uint32_t u32Data;
+
+    for (; size >= 4; size -= 4) {
+        u32Data = U_SPARTN_CRC_UINT32_BE(pU8Msg) ^ u32Remainder;
+        u32Remainder = u32Crc32Table3[u32Data >> 24] ^
+                       u32Crc32Table2[(u32Data >> 16) & 0xFF] ^
+                       u32Crc32Table1[(u32Data >> 8) & 0xFF] ^
+                       u32Crc32Table[u32Data & 0xFF];
+        pU8Msg += 4;
+    }
+#endif
 
-    // Compute the CRC value
-    // Divide each byte of the message by the corresponding polynomial
     for (size_t x = 0; x < size; x++) {
-        u16TableRemainder = pU8Msg[x] ^ (u16Remainder >> (u8NumBitsInCrc - 8));
-        u16Remainder = u16Crc16Table[u16TableRemainder] ^ (u16Remainder << 8);
+        u32TableRemainder = pU8Msg[x] ^ (u32Remainder >> 24);
+        u32Remainder = u32Crc32Table[u32TableRemainder] ^ (u32Remainder << 8);
     }
 
-    return u16Remainder;
+    return u32Remainder;
 }
 
-uint32_t uSpartnCrc24(const char *pData, size_t size)
+// Continue a CRC calculation with a byte-wide table.
+static uint8_t crc8BitUpdate(const uint8_t *pTable, uint8_t u8Remainder,
+                             const uint8_t *pU8Msg, size_t size)
 {
-    // Initialize local variables
-    uint32_t u32TableRemainder;
-    uint32_t u32Remainder = 0; // Initial remainder
-    uint8_t u8NumBitsInCrc = (8 * sizeof(uint8_t) * 3);
-    const uint8_t *pU8Msg = (uint8_t *) pData;
-
-    // Compute the CRC value
-    // Divide each byte of the message by the corresponding polynomial
     for (size_t x = 0; x < size; x++) {
-        u32TableRemainder = pU8Msg[x] ^ (u32Remainder >> (u8NumBitsInCrc - 8));
-        u32Remainder = u32Crc24Table[u32TableRemainder] ^ (u32Remainder << 8);
-        u32Remainder = u32Remainder & 0x00FFFFFF; // Only interested in 24 bits
+        u8Remainder = pTable[pU8Msg[x] ^ u8Remainder];
     }
 
-    return u32Remainder;
+    return u8Remainder;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+uint8_t uSpartnCrc4(const char *pData, size_t size)
+{
+    return crc8BitUpdate(u8Crc4Table, 0, (const uint8_t *) pData, size);
+}
+
+uint8_t uSpartnCrc8(const char *pData, size_t size)
+{
+    return crc8BitUpdate(u8Crc8Table, 0, (const uint8_t *) pData, size);
+}
+
+uint16_t uSpartnCrc16(const char *pData, size_t size)
+{
+    return crc16Update(0, (const uint8_t *) pData, size);
+}
+
+uint32_t uSpartnCrc24(const char *pData, size_t size)
+{
+    return uSpartnCrc24Update(0, pData, size);
+}
+
+uint32_t uSpartnCrc24Update(uint32_t crc, const char *pData, size_t size)
+{
+    return crc24Update(crc & 0x00FFFFFF, (const uint8_t *) pData, size);
 }
 
 uint32_t uSpartnCrc32(const char *pData, size_t size)
 {
-    // Initialize local variables
-    uint32_t u32TableRemainder;
-    uint32_t u32Remainder = 0xFFFFFFFFU; // Initial remainder
-    uint8_t u8NumBitsInCrc = (8 * sizeof(uint32_t));
-    uint32_t u32FinalXORValue = 0xFFFFFFFFU;
-    const uint8_t *pU8Msg = (uint8_t *) pData;
+    return crc32Update(0xFFFFFFFFU, (const uint8_t *) pData, size) ^ 0xFFFFFFFFU;
+}
 
-    // Compute the CRC value
-    // Divide each byte of the message by the corresponding polynomial
-    for (size_t x = 0; x < size; x++) {
-        u32TableRemainder = pU8Msg[x] ^ (u32Remainder >> (u8NumBitsInCrc - 8));
-        u32Remainder = u32Crc32Table[u32TableRemainder] ^ (u32Remainder << 8);
+int32_t uSpartnCrcInit(uSpartnCrcContext_t *pContext, uSpartnCrcType_t type)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pContext != NULL) &&
+        ((type == U_SPARTN_CRC_TYPE_4) || (type == U_SPARTN_CRC_TYPE_8) ||
+         (type == U_SPARTN_CRC_TYPE_16) || (type == U_SPARTN_CRC_TYPE_24) ||
+         (type == U_SPARTN_CRC_TYPE_32))) {
+        pContext->type = type;
+        pContext->remainder = 0;
+        if (type == U_SPARTN_CRC_TYPE_32) {
+            pContext->remainder = 0xFFFFFFFFU;
+        }
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
     }
 
-    u32Remainder = u32Remainder ^ u32FinalXORValue;
+    return errorCode;
+}
 
-    return u32Remainder;
+void uSpartnCrcUpdate(uSpartnCrcContext_t *pContext, const char *pData,
+                      size_t size)
+{
+    const uint8_t *pU8Msg = (const uint8_t *) pData;
+
+    switch (pContext->type) {
+        case U_SPARTN_CRC_TYPE_4:
+            pContext->remainder = crc8BitUpdate(u8Crc4Table,
+                                                (uint8_t) pContext->remainder,
+                                                pU8Msg, size);
+            break;
+        case U_SPARTN_CRC_TYPE_8:
+            pContext->remainder = crc8BitUpdate(u8Crc8Table,
+                                                (uint8_t) pContext->remainder,
+                                                pU8Msg, size);
+            break;
+        case U_SPARTN_CRC_TYPE_16:
+            pContext->remainder = crc16Update((uint16_t) pContext->remainder,
+                                              pU8Msg, size);
+            break;
+        case U_SPARTN_CRC_TYPE_24:
+            pContext->remainder = crc24Update(pContext->remainder, pU8Msg, size);
+            break;
+        case U_SPARTN_CRC_TYPE_32:
+            pContext->remainder = crc32Update(pContext->remainder, pU8Msg, size);
+            break;
+        default:
+            break;
+    }
+}
+
+uint32_t uSpartnCrcFinal(const uSpartnCrcContext_t *pContext)
+{
+    uint32_t crc = pContext->remainder;
+
+    if (pContext->type == U_SPARTN_CRC_TYPE_32) {
+        crc ^= 0xFFFFFFFFU;
+    }
+
+    return crc;
 }
 
 // End of file
@@ -80,6 +80,42 @@
 # define U_SPARTN_TEST_BUFFER_SIZE_BYTES (U_SPARTN_MESSAGE_LENGTH_MAX_BYTES + U_SPARTN_TEST_BUFFER_EXTRA_SIZE_BYTES)
 #endif
 
+#ifndef U_SPARTN_TEST_RTCM_MSM7_NUM_FRAMES
+/** The number of RTCM 3 frames in an epoch of the CRC benchmark:
+ * MSM7 for GPS, GLONASS, Galileo and BeiDou.
+ */
+# define U_SPARTN_TEST_RTCM_MSM7_NUM_FRAMES 4
+#endif
+
+#ifndef U_SPARTN_TEST_RTCM_MSM7_FRAME_LENGTH_BYTES
+/** The length of each RTCM 3 frame in the CRC benchmark: the
+ * maximum (1023 bytes of payload plus 6 bytes of overhead), i.e.
+ * a worst-case multi-constellation MSM7 epoch.
+ */
+# define U_SPARTN_TEST_RTCM_MSM7_FRAME_LENGTH_BYTES 1029
+#endif
+
+#ifndef U_SPARTN_TEST_RTCM_BENCHMARK_EPOCHS
+/** The number of epochs of RTCM 3 to CRC in the benchmark, i.e.
+ * the number of seconds of a 1 Hz stream.
+ */
+# define U_SPARTN_TEST_RTCM_BENCHMARK_EPOCHS 60
+#endif
+
+#ifndef U_SPARTN_TEST_FRAMER_CHUNK_MAX_BYTES
+/** The largest chunk of data to give to the SPARTN framer in one go
+ * when testing it; chunks are of a random length up to this.
+ */
+# define U_SPARTN_TEST_FRAMER_CHUNK_MAX_BYTES 512
+#endif
+
+#ifndef U_SPARTN_TEST_FRAMER_BENCHMARK_LOOPS
+/** The number of times to pass the SPARTN test data through the
+ * framer when measuring its throughput.
+ */
+# define U_SPARTN_TEST_FRAMER_BENCHMARK_LOOPS 50
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -93,6 +129,17 @@ typedef struct {
     uint32_t result;
 } uSpartnTestCrc_t;
 
+/** Context for the SPARTN framer test callback.
+ */
+typedef struct {
+    const char *pExpected;  /**< where the next message should be found
+                                 in the expected data. */
+    const char *pEnd;       /**< the end of the expected data. */
+    int32_t count;          /**< the number of messages received. */
+    int32_t errorCount;     /**< the number of messages that were
+                                 not as expected. */
+} uSpartnTestFramerContext_t;
+
 /** Struct to hold the test data for a SPARTN message.
  */
 typedef struct {
@@ -177,6 +224,15 @@ static const uSpartnTestCrc_t gCrc32Ccitt = {
     .result = 0xE92E0360
 };
 
+/** An RTCM 3 message type 1005 frame, including the CRC-24Q,
+ * as given in the RTCM 10403.3 standard.
+ */
+static const char gRtcmMessage[] = {0xD3, 0x00, 0x13, 0x3E, 0xD7, 0xD3, 0x02, 0x02,
+                                    0x98, 0x0E, 0xDE, 0xEF, 0x34, 0xB4, 0xBD, 0x62,
+                                    0xAC, 0x09, 0x41, 0x98, 0x6F, 0x33, 0x36, 0x0B,
+                                    0x98
+                                   };
+
 /** Array of the CRC test data.
  */
 static const uSpartnTestCrc_t *gpTestData[] = {&gCrc4Ccitt, &gCrc8Ccitt, &gCrc16Ccitt, &gCrc32Ccitt};
@@ -247,6 +303,105 @@ static crc24 crc_octets(unsigned char *octets, size_t len)
     return crc & 0xFFFFFFL;
 }
 
+// A bit at a time, most significant bit first, CRC of up to 32 bits,
+// to check the table-driven versions against.
+static uint32_t crcBitwise(size_t width, uint32_t poly, uint32_t init,
+                           const char *pData, size_t size)
+{
+    uint32_t topBit = 1UL << (width - 1);
+    uint32_t mask = (uint32_t) ((((uint64_t) 1) << width) - 1);
+    uint32_t crc = init;
+
+    for (size_t x = 0; x < size; x++) {
+        crc ^= ((uint32_t) (uint8_t) * (pData + x)) << (width - 8);
+        for (size_t y = 0; y < 8; y++) {
+            if (crc & topBit) {
+                crc = (crc << 1) ^ poly;
+            } else {
+                crc <<= 1;
+            }
+        }
+        crc &= mask;
+    }
+
+    return crc;
+}
+
+// Perform the one-shot CRC of the given type.
+static uint32_t crcOneShot(uSpartnCrcType_t type, const char *pData, size_t size)
+{
+    uint32_t crc = 0;
+
+    switch (type) {
+        case U_SPARTN_CRC_TYPE_4:
+            crc = uSpartnCrc4(pData, size);
+            break;
+        case U_SPARTN_CRC_TYPE_8:
+            crc = uSpartnCrc8(pData, size);
+            break;
+        case U_SPARTN_CRC_TYPE_16:
+            crc = uSpartnCrc16(pData, size);
+            break;
+        case U_SPARTN_CRC_TYPE_24:
+            crc = uSpartnCrc24(pData, size);
+            break;
+        case U_SPARTN_CRC_TYPE_32:
+            crc = uSpartnCrc32(pData, size);
+            break;
+        default:
+            break;
+    }
+
+    return crc;
+}
+
+#ifndef __ZEPHYR__
+
+// Callback for the SPARTN framer: check that each message is the
+// next valid one in the expected data.
+static void framerCallback(const uSpartnMessage_t *pMessage, void *pCallbackParam)
+{
+    uSpartnTestFramerContext_t *pContext = (uSpartnTestFramerContext_t *) pCallbackParam;
+    const char *pExpected = NULL;
+    int32_t size;
+
+    pContext->count++;
+    size = uSpartnValidate(pContext->pExpected, pContext->pEnd - pContext->pExpected,
+                           &pExpected);
+    if ((size == (int32_t) pMessage->size) &&
+        (memcmp(pMessage->pMessage, pExpected, size) == 0) &&
+        (pMessage->type == ((*((const uint8_t *) pExpected + 1) >> 1) & 0x7f)) &&
+        (pMessage->subType == (*((const uint8_t *) pExpected + 4) >> 4))) {
+        pContext->pExpected = pExpected + size;
+    } else {
+        pContext->errorCount++;
+    }
+}
+
+// Pass data to a SPARTN framer in chunks of random length.
+static int32_t framerAddDataInChunks(uSpartnFramer_t *pFramer,
+                                     const char *pData, size_t size,
+                                     uSpartnTestFramerContext_t *pContext)
+{
+    int32_t count = 0;
+    size_t length;
+
+    while (size > 0) {
+        length = (rand() % U_SPARTN_TEST_FRAMER_CHUNK_MAX_BYTES) + 1;
+        if (length > size) {
+            length = size;
+        }
+        count += uSpartnFramerAddData(pFramer, pData, length,
+                                      framerCallback, pContext);
+        pData += length;
+        size -= length;
+    }
+
+    return count;
+}
+
+#endif // __ZEPHYR__
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: TESTS
  * -------------------------------------------------------------- */
@@ -315,6 +470,150 @@ U_PORT_TEST_FUNCTION("[spartn]", "spartnCrc")
     U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
 }
 
+/** Test that the CRC-24 Radix 64 code, used for CRC-24Q in RTCM 3,
+ * works when fed in pieces, and measure how long it takes to check
+ * a worst-case 1 Hz multi-constellation MSM7 stream.
+ */
+U_PORT_TEST_FUNCTION("[spartn]", "spartnCrc24Rtcm")
+{
+    int32_t heapUsed;
+    char *pBuffer;
+    char *pFrame;
+    uint32_t crc;
+    int32_t startTimeMs;
+    int32_t durationMs;
+    size_t size = U_SPARTN_TEST_RTCM_MSM7_NUM_FRAMES * U_SPARTN_TEST_RTCM_MSM7_FRAME_LENGTH_BYTES;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    U_TEST_PRINT_LINE("testing CRC-24 on RTCM 3.");
+
+    // A complete frame, including its CRC, should give zero,
+    // however it is split up
+    U_PORT_TEST_ASSERT(uSpartnCrc24(gRtcmMessage, sizeof(gRtcmMessage) - 3) == 0x360B98);
+    U_PORT_TEST_ASSERT(uSpartnCrc24(gRtcmMessage, sizeof(gRtcmMessage)) == 0);
+    for (size_t x = 0; x <= sizeof(gRtcmMessage); x++) {
+        crc = uSpartnCrc24Update(0, gRtcmMessage, x);
+        crc = uSpartnCrc24Update(crc, gRtcmMessage + x, sizeof(gRtcmMessage) - x);
+        U_PORT_TEST_ASSERT(crc == 0);
+    }
+
+    // Make up an epoch of frames with valid CRCs
+    pBuffer = (char *) malloc(size);
+    U_PORT_TEST_ASSERT(pBuffer != NULL);
+    pFrame = pBuffer;
+    for (size_t x = 0; x < U_SPARTN_TEST_RTCM_MSM7_NUM_FRAMES; x++) {
+        for (size_t y = 0; y < U_SPARTN_TEST_RTCM_MSM7_FRAME_LENGTH_BYTES - 3; y++) {
+            *(pFrame + y) = (char) (x + y);
+        }
+        crc = uSpartnCrc24(pFrame, U_SPARTN_TEST_RTCM_MSM7_FRAME_LENGTH_BYTES - 3);
+        pFrame += U_SPARTN_TEST_RTCM_MSM7_FRAME_LENGTH_BYTES - 3;
+        *pFrame++ = (char) (crc >> 16);
+        *pFrame++ = (char) (crc >> 8);
+        *pFrame++ = (char) crc;
+    }
+
+    startTimeMs = uPortGetTickTimeMs();
+    for (size_t x = 0; x < U_SPARTN_TEST_RTCM_BENCHMARK_EPOCHS; x++) {
+        pFrame = pBuffer;
+        for (size_t y = 0; y < U_SPARTN_TEST_RTCM_MSM7_NUM_FRAMES; y++) {
+            U_PORT_TEST_ASSERT(uSpartnCrc24(pFrame, U_SPARTN_TEST_RTCM_MSM7_FRAME_LENGTH_BYTES) == 0);
+            pFrame += U_SPARTN_TEST_RTCM_MSM7_FRAME_LENGTH_BYTES;
+        }
+    }
+    durationMs = uPortGetTickTimeMs() - startTimeMs;
+    U_TEST_PRINT_LINE("checking %d second(s) of a 1 Hz %d-frame MSM7 stream"
+                      " (%d byte(s)) took %d ms.", U_SPARTN_TEST_RTCM_BENCHMARK_EPOCHS,
+                      U_SPARTN_TEST_RTCM_MSM7_NUM_FRAMES,
+                      (int) (size * U_SPARTN_TEST_RTCM_BENCHMARK_EPOCHS), durationMs);
+    // Must be able to keep up with the stream, by a long way
+    U_PORT_TEST_ASSERT(durationMs < (U_SPARTN_TEST_RTCM_BENCHMARK_EPOCHS * 1000) / 10);
+
+    // A single corrupted bit must be caught
+    *(pBuffer + 10) ^= 0x01;
+    U_PORT_TEST_ASSERT(uSpartnCrc24(pBuffer, U_SPARTN_TEST_RTCM_MSM7_FRAME_LENGTH_BYTES) != 0);
+
+    free(pBuffer);
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
+/** Test that the 16, 24 and 32 bit CRCs, which work four bytes at
+ * a time, match a bit-at-a-time version for every length and
+ * alignment, and that the incremental CRC API gives the same answer
+ * as the one-shot functions however the data is split.
+ */
+U_PORT_TEST_FUNCTION("[spartn]", "spartnCrcIncremental")
+{
+    int32_t heapUsed;
+    char buffer[300];
+    uSpartnCrcContext_t context;
+    uSpartnCrcType_t type;
+    uint32_t crc;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+
+    U_TEST_PRINT_LINE("testing sliced and incremental CRCs.");
+
+    for (size_t x = 0; x < sizeof(buffer); x++) {
+        buffer[x] = (char) ((x * 37) + (x >> 3));
+    }
+
+    for (size_t offset = 0; offset < 4; offset++) {
+        for (size_t size = 0; size < 70; size++) {
+            U_PORT_TEST_ASSERT(uSpartnCrc16(buffer + offset, size) ==
+                               crcBitwise(16, 0x1021, 0, buffer + offset, size));
+            U_PORT_TEST_ASSERT(uSpartnCrc24(buffer + offset, size) ==
+                               crcBitwise(24, 0x864CFB, 0, buffer + offset, size));
+            U_PORT_TEST_ASSERT(uSpartnCrc32(buffer + offset, size) ==
+                               (crcBitwise(32, 0x04C11DB7, 0xFFFFFFFF,
+                                           buffer + offset, size) ^ 0xFFFFFFFF));
+        }
+    }
+
+    U_PORT_TEST_ASSERT(uSpartnCrcInit(NULL, U_SPARTN_CRC_TYPE_8) < 0);
+    U_PORT_TEST_ASSERT(uSpartnCrcInit(&context, U_SPARTN_CRC_TYPE_MAX_NUM) < 0);
+    U_PORT_TEST_ASSERT(uSpartnCrcInit(&context, U_SPARTN_CRC_TYPE_NONE) < 0);
+    for (int32_t t = (int32_t) U_SPARTN_CRC_TYPE_8; t <= (int32_t) U_SPARTN_CRC_TYPE_4; t++) {
+        type = (uSpartnCrcType_t) t;
+        if (type != U_SPARTN_CRC_TYPE_MAX_NUM) {
+            crc = crcOneShot(type, buffer, sizeof(buffer));
+            // Split in two at every point, with the middle byte
+            // on its own as well
+            for (size_t x = 0; x < sizeof(buffer); x++) {
+                U_PORT_TEST_ASSERT(uSpartnCrcInit(&context, type) == 0);
+                uSpartnCrcUpdate(&context, buffer, x);
+                U_PORT_TEST_ASSERT(uSpartnCrcFinal(&context) == crcOneShot(type, buffer, x));
+                uSpartnCrcUpdate(&context, buffer + x, 1);
+                uSpartnCrcUpdate(&context, buffer + x + 1, sizeof(buffer) - x - 1);
+                U_PORT_TEST_ASSERT(uSpartnCrcFinal(&context) == crc);
+            }
+        }
+    }
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
 #ifndef __ZEPHYR__
 
 /** Testing of the SPARTN protocol utility functions against
@@ -451,6 +750,161 @@ U_PORT_TEST_FUNCTION("[spartn]", "spartnMessage")
     U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
 }
 
+/** Test the SPARTN framer on the SPARTN test data, and on SPARTN
+ * messages mixed with rubbish, passed to it in chunks of random
+ * size, and measure its throughput.
+ */
+U_PORT_TEST_FUNCTION("[spartn]", "spartnFramer")
+{
+    int32_t heapUsed;
+    uSpartnFramer_t *pFramer;
+    uSpartnTestFramerContext_t context;
+    char *pBuffer;
+    int32_t *pMessageLength;
+    const char *pMessage;
+    size_t y;
+    int32_t startTimeMs;
+    int32_t durationMs;
+    int32_t count;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    U_TEST_PRINT_LINE("testing SPARTN framer.");
+
+    pFramer = (uSpartnFramer_t *) malloc(sizeof(*pFramer));
+    U_PORT_TEST_ASSERT(pFramer != NULL);
+    U_PORT_TEST_ASSERT(uSpartnFramerInit(NULL) < 0);
+    U_PORT_TEST_ASSERT(uSpartnFramerInit(pFramer) == 0);
+    U_PORT_TEST_ASSERT(uSpartnFramerAddData(NULL, gUSpartnTestData, 1, NULL, NULL) < 0);
+    U_PORT_TEST_ASSERT(uSpartnFramerAddData(pFramer, NULL, 1, NULL, NULL) < 0);
+    U_PORT_TEST_ASSERT(uSpartnFramerAddData(pFramer, NULL, 0, NULL, NULL) == 0);
+
+    // All of the test data, a byte at a time and in random chunks
+    for (size_t x = 0; x < 2; x++) {
+        memset(&context, 0, sizeof(context));
+        context.pExpected = gUSpartnTestData;
+        context.pEnd = gUSpartnTestData + gUSpartnTestDataSize;
+        U_PORT_TEST_ASSERT(uSpartnFramerInit(pFramer) == 0);
+        if (x == 0) {
+            count = 0;
+            for (y = 0; y < gUSpartnTestDataSize; y++) {
+                count += uSpartnFramerAddData(pFramer, gUSpartnTestData + y, 1,
+                                              framerCallback, &context);
+            }
+        } else {
+            count = framerAddDataInChunks(pFramer, gUSpartnTestData,
+                                          gUSpartnTestDataSize, &context);
+        }
+        U_PORT_TEST_ASSERT(count == (int32_t) gUSpartnTestDataNumMessages);
+        U_PORT_TEST_ASSERT(context.count == count);
+        U_PORT_TEST_ASSERT(context.errorCount == 0);
+        U_PORT_TEST_ASSERT(pFramer->messageCount == count);
+        U_PORT_TEST_ASSERT(pFramer->crcErrorCount == 0);
+    }
+
+    // A valid message in amongst random rubbish, which may contain
+    // things that look like the start of a message, must be found
+    pBuffer = (char *) malloc(U_SPARTN_TEST_BUFFER_SIZE_BYTES);
+    U_PORT_TEST_ASSERT(pBuffer != NULL);
+    for (size_t z = 0; z < 1000; z++) {
+        for (size_t x = 0; x < U_SPARTN_TEST_BUFFER_SIZE_BYTES; x++) {
+            *(pBuffer + x) = (char) rand();
+        }
+        y = rand() % U_SPARTN_TEST_BUFFER_EXTRA_SIZE_BYTES;
+        memcpy(pBuffer + y, gpSpartnMessage, sizeof(gpSpartnMessage));
+        memset(&context, 0, sizeof(context));
+        context.pExpected = pBuffer + y;
+        context.pEnd = pBuffer + y + sizeof(gpSpartnMessage);
+        U_PORT_TEST_ASSERT(uSpartnFramerInit(pFramer) == 0);
+        framerAddDataInChunks(pFramer, pBuffer, U_SPARTN_TEST_BUFFER_SIZE_BYTES, &context);
+        // The message must have been found, anything else
+        // would be random data that happened to pass both CRCs
+        U_PORT_TEST_ASSERT(context.pExpected == context.pEnd);
+    }
+
+    // Measure throughput
+    memset(&context, 0, sizeof(context));
+    U_PORT_TEST_ASSERT(uSpartnFramerInit(pFramer) == 0);
+    count = 0;
+    startTimeMs = uPortGetTickTimeMs();
+    for (size_t x = 0; x < U_SPARTN_TEST_FRAMER_BENCHMARK_LOOPS; x++) {
+        context.pExpected = gUSpartnTestData;
+        context.pEnd = gUSpartnTestData + gUSpartnTestDataSize;
+        count += framerAddDataInChunks(pFramer, gUSpartnTestData,
+                                       gUSpartnTestDataSize, &context);
+    }
+    durationMs = uPortGetTickTimeMs() - startTimeMs;
+    U_PORT_TEST_ASSERT(count == (int32_t) (gUSpartnTestDataNumMessages *
+                                           U_SPARTN_TEST_FRAMER_BENCHMARK_LOOPS));
+    U_PORT_TEST_ASSERT(context.errorCount == 0);
+    if (durationMs <= 0) {
+        durationMs = 1;
+    }
+    U_TEST_PRINT_LINE("framed %d message(s), %d byte(s), in chunks of up to %d"
+                      " byte(s) in %d ms, %d kbytes/s.", count,
+                      (int) (gUSpartnTestDataSize * U_SPARTN_TEST_FRAMER_BENCHMARK_LOOPS),
+                      U_SPARTN_TEST_FRAMER_CHUNK_MAX_BYTES, durationMs,
+                      (int) ((((int64_t) gUSpartnTestDataSize) *
+                              U_SPARTN_TEST_FRAMER_BENCHMARK_LOOPS) / durationMs));
+
+    // Measure the rate at which messages are found in a noisy
+    // stream: each message preceded by as much random rubbish
+    for (size_t x = 0; x < U_SPARTN_TEST_BUFFER_SIZE_BYTES; x++) {
+        *(pBuffer + x) = (char) rand();
+    }
+    pMessageLength = (int32_t *) malloc(gUSpartnTestDataNumMessages * sizeof(int32_t));
+    U_PORT_TEST_ASSERT(pMessageLength != NULL);
+    pMessage = gUSpartnTestData;
+    for (size_t x = 0; x < gUSpartnTestDataNumMessages; x++) {
+        *(pMessageLength + x) = uSpartnValidate(pMessage, gUSpartnTestData + gUSpartnTestDataSize -
+                                                pMessage, &pMessage);
+        U_PORT_TEST_ASSERT(*(pMessageLength + x) > 0);
+        pMessage += *(pMessageLength + x);
+    }
+    U_PORT_TEST_ASSERT(uSpartnFramerInit(pFramer) == 0);
+    count = 0;
+    startTimeMs = uPortGetTickTimeMs();
+    for (size_t x = 0; x < U_SPARTN_TEST_FRAMER_BENCHMARK_LOOPS; x++) {
+        pMessage = gUSpartnTestData;
+        for (size_t z = 0; z < gUSpartnTestDataNumMessages; z++) {
+            uSpartnFramerAddData(pFramer, pBuffer + (rand() % U_SPARTN_TEST_BUFFER_EXTRA_SIZE_BYTES),
+                                 *(pMessageLength + z), NULL, NULL);
+            count += uSpartnFramerAddData(pFramer, pMessage, *(pMessageLength + z),
+                                          NULL, NULL);
+            pMessage += *(pMessageLength + z);
+        }
+    }
+    durationMs = uPortGetTickTimeMs() - startTimeMs;
+    if (durationMs <= 0) {
+        durationMs = 1;
+    }
+    U_TEST_PRINT_LINE("found %d message(s) out of %d in a stream that is 50%% rubbish"
+                      " in %d ms, %d messages/s.", count,
+                      (int) (gUSpartnTestDataNumMessages * U_SPARTN_TEST_FRAMER_BENCHMARK_LOOPS),
+                      durationMs, (int) (((int64_t) count * 1000) / durationMs));
+    // Rubbish that happens to pass the frame CRC check can hide
+    // a message that follows it, but only rarely
+    U_PORT_TEST_ASSERT(count > (int32_t) ((gUSpartnTestDataNumMessages *
+                                           U_SPARTN_TEST_FRAMER_BENCHMARK_LOOPS * 9) / 10));
+
+    free(pMessageLength);
+    free(pBuffer);
+    free(pFramer);
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
 #endif // __ZEPHYR__
 
 /** Clean-up to be run at the end of this round of tests, just
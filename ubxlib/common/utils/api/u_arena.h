@@ -0,0 +1,183 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_ARENA_H_
+#define _U_ARENA_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup __utils
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines an arena allocator: a linear buffer,
+ * sized once, from which memory is handed out by moving a pointer
+ * forward.  Nothing is freed individually, instead the whole arena
+ * (or everything allocated since a mark, see uArenaGetMark()) is
+ * released in one call.  It is intended for the scratch memory of
+ * a single operation, e.g. a location request, which would otherwise
+ * make several malloc()/free() calls of different sizes each time
+ * and so fragment the heap of a long-running device.
+ * The API functions are NOT thread-safe: an arena should belong to
+ * a single task at any one time.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_ARENA_ALIGNMENT_BYTES
+/** The alignment of each allocation from an arena, must be a
+ * power of two.
+ */
+# define U_ARENA_ALIGNMENT_BYTES 8
+#endif
+
+/** The number of bytes an allocation of size bytes occupies in an
+ * arena, including alignment padding; useful when sizing an arena.
+ */
+#define U_ARENA_ALLOC_SIZE_BYTES(size) (((size) + U_ARENA_ALIGNMENT_BYTES - 1) & \
+                                        ~((size_t) U_ARENA_ALIGNMENT_BYTES - 1))
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** An arena; the contents should not be accessed directly,
+ * only through the API functions.
+ */
+typedef struct {
+    char *pBuffer;         /**< the start of the usable, aligned, part
+                                of the linear buffer. */
+    size_t size;           /**< the usable size of the linear buffer. */
+    size_t used;           /**< the number of bytes currently allocated,
+                                including alignment padding. */
+    size_t highWaterMark;  /**< the largest value used has taken since
+                                the arena was created. */
+    int32_t allocFailCount; /**< the number of allocations that failed
+                                 because the arena was full. */
+    void *pMalloced;       /**< the malloc()ed linear buffer, NULL if
+                                the linear buffer was provided by the
+                                caller. */
+} uArena_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Create an arena.
+ *
+ * @param[in] pArena        a pointer to the arena, cannot be NULL.
+ * @param[in] pLinearBuffer a pointer to the linear buffer to allocate
+ *                          from; if this is NULL then size bytes will
+ *                          be allocated with malloc(), that being
+ *                          the only heap allocation the arena makes,
+ *                          and freed again by uArenaDelete().
+ * @param size              the size of the linear buffer in bytes;
+ *                          if pLinearBuffer is not aligned to
+ *                          #U_ARENA_ALIGNMENT_BYTES then up to
+ *                          #U_ARENA_ALIGNMENT_BYTES - 1 bytes will
+ *                          be lost at the start.
+ * @return                  zero on success else negative error code.
+ */
+int32_t uArenaCreate(uArena_t *pArena, char *pLinearBuffer, size_t size);
+
+/** Delete an arena, freeing the linear buffer if it was allocated
+ * by uArenaCreate(); any memory allocated from the arena must no
+ * longer be used.
+ *
+ * @param[in] pArena a pointer to the arena, may be NULL.
+ */
+void uArenaDelete(uArena_t *pArena);
+
+/** Allocate memory from an arena.  The memory is aligned to
+ * #U_ARENA_ALIGNMENT_BYTES and is NOT initialised.
+ *
+ * @param[in] pArena a pointer to the arena, cannot be NULL.
+ * @param size       the number of bytes required.
+ * @return           a pointer to the memory or NULL if there is
+ *                   not enough room left in the arena; must NOT
+ *                   be passed to free().
+ */
+void *pUArenaAlloc(uArena_t *pArena, size_t size);
+
+/** Get a mark for the current fill level of an arena, which can
+ * later be passed to uArenaRewind().
+ *
+ * @param[in] pArena a pointer to the arena, cannot be NULL.
+ * @return           the mark.
+ */
+size_t uArenaGetMark(const uArena_t *pArena);
+
+/** Release everything allocated from an arena since a mark was
+ * obtained with uArenaGetMark(); the memory concerned must no
+ * longer be used.  A mark beyond the current fill level is ignored.
+ *
+ * @param[in] pArena a pointer to the arena, cannot be NULL.
+ * @param mark       the mark returned by uArenaGetMark().
+ */
+void uArenaRewind(uArena_t *pArena, size_t mark);
+
+/** Release everything allocated from an arena; the memory
+ * concerned must no longer be used.  The high water mark and
+ * failure count are retained.
+ *
+ * @param[in] pArena a pointer to the arena, cannot be NULL.
+ */
+void uArenaReset(uArena_t *pArena);
+
+/** Get the number of bytes currently allocated from an arena,
+ * including alignment padding.
+ *
+ * @param[in] pArena a pointer to the arena, cannot be NULL.
+ * @return           the number of bytes in use.
+ */
+size_t uArenaGetUsed(const uArena_t *pArena);
+
+/** Get the largest number of bytes that have been allocated from
+ * an arena at any one time since it was created, including
+ * alignment padding; use this to size an arena.
+ *
+ * @param[in] pArena a pointer to the arena, cannot be NULL.
+ * @return           the high water mark in bytes.
+ */
+size_t uArenaGetHighWaterMark(const uArena_t *pArena);
+
+/** Get the number of calls to pUArenaAlloc() that have failed
+ * because an arena was full since it was created.
+ *
+ * @param[in] pArena a pointer to the arena, cannot be NULL.
+ * @return           the number of failed allocations.
+ */
+int32_t uArenaGetAllocFailCount(const uArena_t *pArena);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_ARENA_H_
+
+// End of file
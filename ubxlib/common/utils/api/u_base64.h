@@ -27,7 +27,10 @@
  */
 
 /** @file
- * @brief This header file defines base64 encode and decode functions.
+ * @brief This header file defines base64 encode and decode functions,
+ * both for a whole buffer at once and, for data that will not fit
+ * into RAM in one go (e.g. a large credential or a file transfer),
+ * chunk by chunk.
  */
 
 #ifdef __cplusplus
@@ -38,10 +41,44 @@ extern "C" {
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+/** The number of bytes that binaryLengthBytes of binary data will
+ * occupy when base 64 encoded, including padding; this is also
+ * enough room for the output of uBase64EncodeUpdate() when it is
+ * given binaryLengthBytes.
+ */
+#define U_BASE64_ENCODED_LENGTH_BYTES(binaryLengthBytes) ((((binaryLengthBytes) + 2) / 3) * 4)
+
+/** The maximum number of bytes that base64LengthBytes of base 64
+ * data can decode to; this is also enough room for the output of
+ * uBase64DecodeUpdate() when it is given base64LengthBytes.
+ */
+#define U_BASE64_DECODED_LENGTH_MAX_BYTES(base64LengthBytes) ((((base64LengthBytes) + 3) / 4) * 3)
+
+/** The amount of room that uBase64EncodeFinish() needs.
+ */
+#define U_BASE64_ENCODE_FINISH_LENGTH_BYTES 4
+
+/** The amount of room that uBase64DecodeFinish() needs.
+ */
+#define U_BASE64_DECODE_FINISH_LENGTH_BYTES 2
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Context for a chunked base 64 encode or decode; the contents
+ * should not be accessed directly, only through the API functions.
+ */
+typedef struct {
+    char buffer[4];      /**< input held over from the last chunk:
+                              up to two bytes of binary when
+                              encoding, up to three characters of
+                              base 64 when decoding. */
+    size_t bufferLength; /**< the number of bytes in buffer. */
+    bool padded;         /**< set when decoding has reached padding,
+                              after which no more data is allowed. */
+} uBase64Context_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -50,7 +87,8 @@ extern "C" {
  * FUNCTIONS
  * -------------------------------------------------------------- */
 
-/** Perform a base 64 encode.
+/** Perform a base 64 encode.  The input is read once; see
+ * #U_BASE64_ENCODED_LENGTH_BYTES for the output length.
  *
  * @param pBinary           the binary data to be encoded.
  * @param binaryLengthBytes the amount of binary data.
@@ -67,7 +105,7 @@ extern "C" {
 int32_t uBase64Encode(const char *pBinary, size_t binaryLengthBytes,
                       char *pBase64, size_t base64LengthBytes);
 
-/** Perform a base 64 decode.
+/** Perform a base 64 decode.  The input is read once.
  *
  * @param pBase64           the base 64 data to be decoded.
  * @param base64LengthBytes the amount of base 64 data to decode.
@@ -82,11 +120,102 @@ int32_t uBase64Encode(const char *pBinary, size_t binaryLengthBytes,
  * @param binaryLengthBytes the amount of storage at pBinary.
  * @return                  the number of bytes stored at pBinary
  *                          or the number of bytes that _would_ be
- *                          stored at pBinary if it were not NULL.
+ *                          stored at pBinary if it were not NULL
+ *                          (or if binaryLengthBytes is too small),
+ *                          else negative error code if pBase64
+ *                          contains characters that are not base 64
+ *                          or is of a length that base 64 cannot be
+ *                          (e.g. a single character).
  */
 int32_t uBase64Decode(const char *pBase64, size_t base64LengthBytes,
                       char *pBinary, size_t binaryLengthBytes);
 
+/** Start a chunked base 64 encode: call this, then call
+ * uBase64EncodeUpdate() with each chunk of binary data, then call
+ * uBase64EncodeFinish().  The concatenated output is the same
+ * as that of uBase64Encode() on the concatenated input.
+ *
+ * @param pContext a pointer to the context, cannot be NULL.
+ */
+void uBase64EncodeStart(uBase64Context_t *pContext);
+
+/** Encode a chunk of binary data; any bytes that do not make up a
+ * whole group of three are held in the context until the next call.
+ *
+ * @param pContext          a pointer to the context, cannot be NULL.
+ * @param pBinary           the chunk of binary data.
+ * @param binaryLengthBytes the amount of binary data.
+ * @param pBase64           a place to store the base 64 encoded
+ *                          data; no null-terminator is included.
+ * @param base64LengthBytes the amount of storage at pBase64,
+ *                          #U_BASE64_ENCODED_LENGTH_BYTES of
+ *                          binaryLengthBytes is always enough.
+ * @return                  the number of bytes stored at pBase64,
+ *                          else negative error code, in which case
+ *                          nothing has been consumed.
+ */
+int32_t uBase64EncodeUpdate(uBase64Context_t *pContext,
+                            const char *pBinary, size_t binaryLengthBytes,
+                            char *pBase64, size_t base64LengthBytes);
+
+/** Finish a chunked base 64 encode, writing out any bytes held
+ * in the context, with padding.
+ *
+ * @param pContext          a pointer to the context, cannot be NULL.
+ * @param pBase64           a place to store the base 64 encoded
+ *                          data; no null-terminator is included.
+ * @param base64LengthBytes the amount of storage at pBase64, at
+ *                          least #U_BASE64_ENCODE_FINISH_LENGTH_BYTES.
+ * @return                  the number of bytes stored at pBase64,
+ *                          else negative error code.
+ */
+int32_t uBase64EncodeFinish(uBase64Context_t *pContext,
+                            char *pBase64, size_t base64LengthBytes);
+
+/** Start a chunked base 64 decode: call this, then call
+ * uBase64DecodeUpdate() with each chunk of base 64 data, then
+ * call uBase64DecodeFinish().  The chunks may be split anywhere.
+ *
+ * @param pContext a pointer to the context, cannot be NULL.
+ */
+void uBase64DecodeStart(uBase64Context_t *pContext);
+
+/** Decode a chunk of base 64 data; any characters that do not make
+ * up a whole group of four are held in the context until the next
+ * call.
+ *
+ * @param pContext          a pointer to the context, cannot be NULL.
+ * @param pBase64           the chunk of base 64 data.
+ * @param base64LengthBytes the amount of base 64 data.
+ * @param pBinary           a place to store the decoded data.
+ * @param binaryLengthBytes the amount of storage at pBinary,
+ *                          #U_BASE64_DECODED_LENGTH_MAX_BYTES of
+ *                          base64LengthBytes is always enough.
+ * @return                  the number of bytes stored at pBinary,
+ *                          else negative error code, e.g. if the
+ *                          data contains characters that are not
+ *                          base 64 or there is data after padding;
+ *                          after an error the decode should be
+ *                          abandoned.
+ */
+int32_t uBase64DecodeUpdate(uBase64Context_t *pContext,
+                            const char *pBase64, size_t base64LengthBytes,
+                            char *pBinary, size_t binaryLengthBytes);
+
+/** Finish a chunked base 64 decode, decoding any unpadded
+ * characters held in the context.
+ *
+ * @param pContext          a pointer to the context, cannot be NULL.
+ * @param pBinary           a place to store the decoded data.
+ * @param binaryLengthBytes the amount of storage at pBinary, at
+ *                          least #U_BASE64_DECODE_FINISH_LENGTH_BYTES.
+ * @return                  the number of bytes stored at pBinary,
+ *                          else negative error code, e.g. if the
+ *                          data ended part-way through a byte.
+ */
+int32_t uBase64DecodeFinish(uBase64Context_t *pContext,
+                            char *pBinary, size_t binaryLengthBytes);
+
 #ifdef __cplusplus
 }
 #endif
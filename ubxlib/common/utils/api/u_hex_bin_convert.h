@@ -51,7 +51,7 @@ extern "C" {
  * FUNCTIONS
  * -------------------------------------------------------------- */
 
-/** Convert a buffer into the ASCII hex equivalent.
+/** Convert a buffer into the ASCII hex equivalent, upper case.
  *
  * @param pBin      a pointer to the binary buffer.
  * @param binLength the number of bytes pointed to by pBin.
@@ -61,15 +61,18 @@ extern "C" {
  */
 size_t uBinToHex(const char *pBin, size_t binLength, char *pHex);
 
-/** Convert a buffer of ASCII hex into the binary equivalent.
- * If it is not possible to convert character (e.g. because
- * it is not valid ASCII hex) then conversion stops there.
+/** Convert a buffer of ASCII hex, upper or lower case, into the
+ * binary equivalent.  If it is not possible to convert a character
+ * (e.g. because it is not valid ASCII hex) then conversion stops
+ * there.  pBin may be the same as pHex, i.e. the conversion may be
+ * done in place.
  *
  * @param pHex      a pointer to the ASCII hex data.
  * @param hexLength the number of bytes pointed to by pHex.
  * @param pBin      a pointer to a buffer of length half hexLength
  *                  bytes to store the binary version.
- * @return          the number of bytes at pBin.
+ * @return          the number of bytes at pBin, i.e. the number
+ *                  converted before any invalid character.
  */
 size_t uHexToBin(const char *pHex, size_t hexLength, char *pBin);
 
@@ -29,8 +29,11 @@
 /** @file
  * @brief This header file defines a memory pool API, used internally by the short range
  * API for efficient EDM transport.  The API functions are thread-safe except for the
- * uMemPoolInit() and uMemPoolDeinit() APIs, which should not be called while any
- * of the other API calls are in progress.
+ * uMemPoolInit(), uMemPoolDeinit() and uMemPoolFreeAllMem() APIs, which should not be
+ * called while any of the other API calls are in progress.  uMemPoolAllocMem() and
+ * uMemPoolFreeMem() do not take a mutex (other than on the very first allocation,
+ * when the pool buffer is allocated) and do not log, so they may be used freely
+ * in a data path.
  */
 #ifdef __cplusplus
 extern "C" {
@@ -40,6 +43,43 @@ extern "C" {
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+/** The maximum number of blocks in a memory pool: the free list
+ * is held as a block index and a tag in a single 32-bit word.
+ */
+#define U_MEMPOOL_MAX_NUM_BLOCKS 0xFFFF
+
+/** Configuration value if a "fence" should be added between
+ * the mempool buffer chunks for detecting buffer overflows.
+ * Since this only adds 2 bytes per chunk it is enabled by default.
+ */
+#ifndef U_MEMPOOL_USE_BUF_FENCE
+# define U_MEMPOOL_USE_BUF_FENCE 1
+#endif
+
+/** The alignment of each block in a memory pool.
+ */
+#define U_MEMPOOL_ALIGNMENT_BYTES 8
+
+/** The number of bytes a block of blockSize actually occupies in
+ * the buffer of a memory pool, including any fence and padding to
+ * keep the next block aligned.
+ */
+#if U_MEMPOOL_USE_BUF_FENCE
+# define U_MEMPOOL_BLOCK_SIZE_BYTES(blockSize)                         \
+    ((((blockSize) + sizeof(uint16_t)) + (U_MEMPOOL_ALIGNMENT_BYTES - 1)) & \
+     ~((size_t) U_MEMPOOL_ALIGNMENT_BYTES - 1))
+#else
+# define U_MEMPOOL_BLOCK_SIZE_BYTES(blockSize)                   \
+    (((blockSize) + (U_MEMPOOL_ALIGNMENT_BYTES - 1)) &            \
+     ~((size_t) U_MEMPOOL_ALIGNMENT_BYTES - 1))
+#endif
+
+/** The size of buffer required for a memory pool of numOfBlks
+ * blocks of blockSize, e.g. for uMemPoolInitWithBuffer().
+ */
+#define U_MEMPOOL_BUFFER_SIZE_BYTES(blockSize, numOfBlks) \
+    (U_MEMPOOL_BLOCK_SIZE_BYTES(blockSize) * (numOfBlks))
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -48,11 +88,30 @@ typedef struct {
     uint32_t blockSize; /**< the size of each block. */
     int32_t usedBlockCount; /**< the number of currently used blocks. */
     int32_t totalBlockCount; /**< the total number of blocks. */
-    struct uMemPoolFree *pFreeList; /**< linked list of free blocks. */
+    uint32_t freeListHead; /**< the index plus one of the first free block
+                                in the lower 16 bits, zero if there
+                                is none, with a tag in the upper 16 bits
+                                that changes on every update. */
+    int32_t maxUsedBlockCount; /**< the high-water mark of usedBlockCount. */
+    int32_t allocFailCount; /**< the number of calls to uMemPoolAllocMem()
+                                 that returned NULL. */
     uint8_t *pBuffer; /**< data buffer (sub-divided into blocks). */
-    uPortMutexHandle_t mutex; /**< mutex for thread protection. */
+    bool bufferIsExternal; /**< true if pBuffer was passed in to
+                                uMemPoolInitWithBuffer(). */
+    uPortMutexHandle_t mutex; /**< mutex for thread protection while the
+                                   data buffer is allocated and freed. */
 } uMemPoolDesc_t;
 
+/** Statistics for a memory pool, see uMemPoolGetStats().
+ */
+typedef struct {
+    int32_t usedBlockCount; /**< the number of blocks currently in use. */
+    int32_t maxUsedBlockCount; /**< the largest number of blocks that
+                                    have been in use at any one time. */
+    int32_t allocFailCount; /**< the number of times an allocation has
+                                 failed because the pool was empty. */
+} uMemPoolStats_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -61,12 +120,32 @@ typedef struct {
  *
  * @param pMemPool      pointer to empty memory pool.
  * @param blockSize     size of each block.
- * @param numOfBlks     Number of blocks each of blockSize.
+ * @param numOfBlks     Number of blocks each of blockSize, at most
+ *                      #U_MEMPOOL_MAX_NUM_BLOCKS.
  *
  * @return              zero on success else negative error code.
  */
 int32_t uMemPoolInit(uMemPoolDesc_t *pMemPool, uint32_t blockSize, int32_t numOfBlks);
 
+/** Initialize a memory pool that uses a buffer provided by the caller,
+ *  e.g. a static array, rather than one taken from the heap on the first
+ *  allocation.  Such a pool needs no OS resources, so this may be called
+ *  before uPortInit(), and uMemPoolDeinit() will not free the buffer.
+ *  The buffer must be aligned to #U_MEMPOOL_ALIGNMENT_BYTES.
+ *
+ * @param pMemPool      pointer to empty memory pool.
+ * @param blockSize     size of each block.
+ * @param numOfBlks     Number of blocks each of blockSize, at most
+ *                      #U_MEMPOOL_MAX_NUM_BLOCKS.
+ * @param pBuffer       the buffer, at least
+ *                      U_MEMPOOL_BUFFER_SIZE_BYTES(blockSize, numOfBlks)
+ *                      bytes in size.
+ *
+ * @return              zero on success else negative error code.
+ */
+int32_t uMemPoolInitWithBuffer(uMemPoolDesc_t *pMemPool, uint32_t blockSize,
+                               int32_t numOfBlks, uint8_t *pBuffer);
+
 /** Deinitialize memory pool. This API will free all the references to the block
  *  and the pool itself.
  *
@@ -98,6 +177,16 @@ void uMemPoolFreeMem(uMemPoolDesc_t *pMemPool, void *ptr);
  */
 void uMemPoolFreeAllMem(uMemPoolDesc_t *pMemPool);
 
+/** Get the statistics of the given pool.  The statistics are
+ * reset by uMemPoolInit(); uMemPoolFreeAllMem() sets the number
+ * of blocks in use back to zero but leaves the rest alone.
+ *
+ * @param pMemPool      pointer to the memory pool.
+ * @param pStats        a place to put the statistics.
+ * @return              zero on success else negative error code.
+ */
+int32_t uMemPoolGetStats(const uMemPoolDesc_t *pMemPool, uMemPoolStats_t *pStats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -74,6 +74,18 @@ typedef struct {
     size_t maxNumReadPointers;      /**< will always be at least 1 for the
                                          "normal" read case. */
     uint64_t dataReadLockBitmap;
+    int32_t slowestReadIndex;       /**< the index into pDataRead of the
+                                         read pointer with the most data
+                                         waiting, of those that count
+                                         towards uRingBufferAvailableSize(),
+                                         -1 if there are none; kept up to
+                                         date as the read pointers move so
+                                         that the free space can be found
+                                         without looking at them all. */
+    int32_t slowestLockedReadIndex; /**< as slowestReadIndex but only
+                                         for locked read pointers, i.e.
+                                         those that count towards
+                                         uRingBufferAvailableSizeMax(). */
     bool isMalloced;                /**< true if pDataRead was malloc()ed. */
     char *pDataWrite;
     size_t size;
@@ -84,6 +96,8 @@ typedef struct {
     bool readHandleRequired;        /**< true to ONLY allow uRingBufferReadHandle()/
                                          uRingBufferPeekHandle(); uRingBufferRead()/
                                          uRingBufferPeek() will return nothing. */
+    bool lockFree;                  /**< true if the ring buffer was created
+                                         with uRingBufferCreateLockFree(). */
     size_t statReadLossNormalBytes; /**< storage for the bytes lost as a
                                          result of forced add pushing
                                          data out of the "normal" read
@@ -99,6 +113,25 @@ typedef struct {
                                          as a result of add or forced add
                                          being unable to write into the
                                          ring buffer. */
+    size_t statFillMaxNormalBytes;  /**< storage for the largest amount
+                                         of data held for the "normal"
+                                         read pointer. */
+    size_t *statFillMaxBytes;       /**< storage for the largest amount
+                                         of data held for each of the read
+                                         pointers, named this way so that
+                                         we naturally treat it as an array
+                                         of type size_t in the code; the
+                                         zeroth entry of this storage is
+                                         unused. */
+    size_t writeReservedLength;     /**< the number of bytes reserved by
+                                         uRingBufferWriteReserve() or
+                                         uRingBufferForceWriteReserve() and
+                                         not yet committed with
+                                         uRingBufferWriteCommit(), zero if
+                                         there is no reservation outstanding. */
+    bool writeReservedForced;       /**< true if the outstanding reservation
+                                         was made by
+                                         uRingBufferForceWriteReserve(). */
 } uRingBuffer_t;
 
 typedef void *uParseHandle_t; //!< Parser handle.
@@ -148,6 +181,40 @@ void uRingBufferDump(uRingBuffer_t *pRingBuffer);
 int32_t uRingBufferCreate(uRingBuffer_t *pRingBuffer, char *pLinearBuffer,
                           size_t size);
 
+/** Create a ring buffer, as uRingBufferCreate(), for the case where
+ * there is exactly one task adding data and exactly one task reading
+ * it; uRingBufferAdd(), uRingBufferRead(), uRingBufferPeek(),
+ * uRingBufferDataSize(), uRingBufferAvailableSize() and
+ * uRingBufferFlush() then hand over between the two without taking
+ * the ring buffer's mutex, which is much cheaper.  The rules are:
+ *
+ * - only the adding task may call uRingBufferAdd(),
+ *   uRingBufferForceAdd(), uRingBufferWriteReserve() or
+ *   uRingBufferWriteCommit(); uRingBufferForceAdd() behaves exactly
+ *   as uRingBufferAdd() since only the reading task may move the
+ *   read pointer,
+ * - only the reading task may call uRingBufferRead(),
+ *   uRingBufferPeek(), uRingBufferReadSpans(), uRingBufferConsume()
+ *   or uRingBufferFlush(),
+ * - uRingBufferForceWriteReserve() and uRingBufferResize() are not
+ *   supported,
+ * - uRingBufferReset() and uRingBufferDelete() may only be called
+ *   while neither task is using the ring buffer.
+ *
+ * Read handles are not available on a ring buffer of this type: if
+ * you have more than one reader, use uRingBufferCreateWithReadHandle().
+ *
+ * @param[in] pRingBuffer   a pointer to a ring buffer, cannot be NULL.
+ * @param[in] pLinearBuffer a pointer to the linear buffer.
+ * @param size              the size of the linear buffer in bytes; the
+ *                          ring buffer will be of maximum size this
+ *                          number minus one as one byte is used to
+ *                          prevent pointer-wrap.
+ * @return                  zero on success else negative error code.
+ */
+int32_t uRingBufferCreateLockFree(uRingBuffer_t *pRingBuffer, char *pLinearBuffer,
+                                  size_t size);
+
 /** Delete a ring buffer.
  *
  * @param[in] pRingBuffer   a pointer to the ring buffer, cannot be NULL.
@@ -182,6 +249,101 @@ bool uRingBufferAdd(uRingBuffer_t *pRingBuffer, const char *pData,
 bool uRingBufferForceAdd(uRingBuffer_t *pRingBuffer, const char *pData,
                          size_t length);
 
+/** Reserve space in a ring buffer so that data can be written
+ * directly into it, e.g. by a UART or I2C driver, rather than
+ * being assembled elsewhere and copied in with uRingBufferAdd().
+ * This is the equivalent of uRingBufferAdd(): only the space that
+ * is free for all read pointers can be reserved, nothing is lost
+ * (see uRingBufferForceWriteReserve() for the alternative).  The
+ * reserved space is returned as up to two spans, the second being
+ * needed when the space wraps around the end of the buffer.  Once
+ * the data has been written, call uRingBufferWriteCommit() to make
+ * it available to readers.  Only one reservation can be outstanding
+ * at a time and, while it is outstanding,
+ * uRingBufferAdd()/uRingBufferForceAdd() will fail.
+ *
+ * @param[in] pRingBuffer     a pointer to the ring buffer, cannot be NULL.
+ * @param length              the amount of space wanted.
+ * @param[out] ppSpan1        a place to put a pointer to the first span
+ *                            of reserved space, set to NULL if nothing
+ *                            could be reserved; cannot be NULL.
+ * @param[out] pSpan1Length   a place to put the length of the first span;
+ *                            cannot be NULL.
+ * @param[out] ppSpan2        a place to put a pointer to the second span
+ *                            of reserved space, NULL if there isn't one;
+ *                            may be NULL, in which case only contiguous
+ *                            space is reserved.
+ * @param[out] pSpan2Length   a place to put the length of the second span;
+ *                            may be NULL, in which case only contiguous
+ *                            space is reserved.
+ * @return                    the total number of bytes reserved, which
+ *                            may be less than length (including zero, for
+ *                            instance if there is already a reservation
+ *                            outstanding or the ring buffer is full).
+ */
+size_t uRingBufferWriteReserve(uRingBuffer_t *pRingBuffer, size_t length,
+                               char **ppSpan1, size_t *pSpan1Length,
+                               char **ppSpan2, size_t *pSpan2Length);
+
+/** Reserve space in a ring buffer so that data can be written
+ * directly into it, e.g. by a UART or I2C driver, rather than
+ * being assembled elsewhere and copied in with uRingBufferForceAdd().
+ * Room is made in the same way as uRingBufferForceAdd(): any
+ * [non-locked: see uRingBufferLockReadHandle()] read pointers are
+ * moved on, but only when uRingBufferWriteCommit() is called and
+ * only by enough to accommodate the amount committed.  Until then,
+ * a read pointer whose data the reserved space overlaps reads
+ * nothing, since its oldest data may be being written over; for
+ * the same reason nothing should be written into the reserved
+ * space beyond what is to be committed.  The reserved space is
+ * returned as up to two spans, the second being needed when the
+ * space wraps around the end of the buffer.  Once the data has been
+ * written, call uRingBufferWriteCommit() to make it available to
+ * readers.  Only one reservation can be outstanding at a time and,
+ * while it is outstanding, uRingBufferAdd()/uRingBufferForceAdd()
+ * will fail.
+ *
+ * @param[in] pRingBuffer     a pointer to the ring buffer, cannot be NULL.
+ * @param length              the amount of space wanted.
+ * @param[out] ppSpan1        a place to put a pointer to the first span
+ *                            of reserved space, set to NULL if nothing
+ *                            could be reserved; cannot be NULL.
+ * @param[out] pSpan1Length   a place to put the length of the first span;
+ *                            cannot be NULL.
+ * @param[out] ppSpan2        a place to put a pointer to the second span
+ *                            of reserved space, NULL if there isn't one;
+ *                            may be NULL, in which case only contiguous
+ *                            space is reserved.
+ * @param[out] pSpan2Length   a place to put the length of the second span;
+ *                            may be NULL, in which case only contiguous
+ *                            space is reserved.
+ * @return                    the total number of bytes reserved, which
+ *                            may be less than length (including zero, for
+ *                            instance if there is already a reservation
+ *                            outstanding or locked read handles prevent
+ *                            room being made).
+ */
+size_t uRingBufferForceWriteReserve(uRingBuffer_t *pRingBuffer, size_t length,
+                                    char **ppSpan1, size_t *pSpan1Length,
+                                    char **ppSpan2, size_t *pSpan2Length);
+
+/** Commit data written into space reserved with
+ * uRingBufferWriteReserve() or uRingBufferForceWriteReserve(),
+ * ending the reservation; the
+ * data is the first length bytes of the first span followed, if
+ * length is greater than the first span, by the start of the
+ * second span.  Committing zero bytes simply ends the reservation.
+ *
+ * @param[in] pRingBuffer   a pointer to the ring buffer, cannot be NULL.
+ * @param length            the number of bytes written.
+ * @return                  true if the data was committed, false if
+ *                          length is greater than the amount reserved
+ *                          or there is no reservation outstanding (e.g.
+ *                          because uRingBufferReset() was called in the
+ *                          meantime), in which case nothing is added.
+ */
+bool uRingBufferWriteCommit(uRingBuffer_t *pRingBuffer, size_t length);
+
 /** Read data from a ring buffer; see also uRingBufferReadHandle()
  * if you want to have multiple consumers of data from the ring buffer.
  *
@@ -207,6 +369,48 @@ size_t uRingBufferRead(uRingBuffer_t *pRingBuffer, char *pData, size_t length);
 size_t uRingBufferPeek(uRingBuffer_t *pRingBuffer, char *pData, size_t length,
                        size_t offset);
 
+/** Like uRingBufferPeek() but, rather than copying the data, return
+ * where it is in the ring buffer as up to two spans, the second being
+ * needed when the data wraps around the end of the buffer, so that it
+ * can be worked on in place; call uRingBufferConsume() to move the
+ * read pointer on when done.  The data in the spans remains valid
+ * until it is consumed provided nothing forces it out: for a ring
+ * buffer created with uRingBufferCreate() that means not using
+ * uRingBufferForceAdd()/uRingBufferForceWriteReserve(), for a ring
+ * buffer created with uRingBufferCreateLockFree() it is always the
+ * case; uRingBufferResize() also invalidates the spans.  See also
+ * uRingBufferReadSpansHandle() if you have multiple consumers of
+ * data from the ring buffer.
+ *
+ * @param[in] pRingBuffer     a pointer to the ring buffer, cannot be NULL.
+ * @param[out] ppSpan1        a place to put a pointer to the first span
+ *                            of data, set to NULL if there is none;
+ *                            cannot be NULL.
+ * @param[out] pSpan1Length   a place to put the length of the first span;
+ *                            cannot be NULL.
+ * @param[out] ppSpan2        a place to put a pointer to the second span
+ *                            of data, NULL if there isn't one; may be
+ *                            NULL, in which case only the first,
+ *                            contiguous, span is returned.
+ * @param[out] pSpan2Length   a place to put the length of the second span;
+ *                            may be NULL, in which case only the first,
+ *                            contiguous, span is returned.
+ * @return                    the total number of bytes in the spans.
+ */
+size_t uRingBufferReadSpans(uRingBuffer_t *pRingBuffer,
+                            const char **ppSpan1, size_t *pSpan1Length,
+                            const char **ppSpan2, size_t *pSpan2Length);
+
+/** Move the read pointer of a ring buffer on, e.g. after working on
+ * data in place with uRingBufferReadSpans(); the same as calling
+ * uRingBufferRead() with pData NULL.
+ *
+ * @param[in] pRingBuffer   a pointer to the ring buffer, cannot be NULL.
+ * @param length            the maximum amount of data to consume.
+ * @return                  the number of bytes consumed.
+ */
+size_t uRingBufferConsume(uRingBuffer_t *pRingBuffer, size_t length);
+
 /** Get the amount of data available in a ring buffer; see also
  * uRingBufferDataSizeHandle(). If uRingBufferSetReadRequiresHandle()
  * is true then this will return zero.
@@ -257,6 +461,48 @@ size_t uRingBufferStatReadLoss(uRingBuffer_t *pRingBuffer);
  */
 size_t uRingBufferStatAddLoss(uRingBuffer_t *pRingBuffer);
 
+/** Get the high-water mark of the data waiting for uRingBufferRead():
+ * the largest amount of data that has been held in the ring buffer
+ * since it was created or since the high-water mark was last reset.
+ * Compared with the size of the ring buffer this shows how close
+ * uRingBufferForceAdd() came to pushing data out from under
+ * uRingBufferRead(), or uRingBufferAdd() came to failing.
+ *
+ * @param[in] pRingBuffer a pointer to the ring buffer, cannot be NULL.
+ * @param reset           if true, once it has been read, the
+ *                        high-water mark is reset to the amount of
+ *                        data currently held.
+ * @return                the high-water mark in bytes.
+ */
+size_t uRingBufferStatFillMax(uRingBuffer_t *pRingBuffer, bool reset);
+
+/** Move a ring buffer into a different linear buffer, which may be
+ * larger or smaller than the current one, retaining the unread data
+ * and the position of every read pointer (and hence read handle)
+ * relative to the newest data, i.e. change the size of the ring
+ * buffer without the readers noticing.  The unread data is moved to
+ * the start of the new linear buffer.  This will fail if there is a
+ * reservation outstanding from uRingBufferForceWriteReserve() or if
+ * the unread data of any locked read handle will not fit into the
+ * new linear buffer; the oldest of the data waiting for any other
+ * read pointer is discarded if it will not fit, just as it would be
+ * by uRingBufferForceAdd(), and is counted as lost.  On success the
+ * old linear buffer is no longer used by the ring buffer and it is up
+ * to the caller to free it, if required.  Since the data moves, any
+ * spans returned by uRingBufferReadSpans() or
+ * uRingBufferReadSpansHandle() that have not yet been consumed are
+ * no longer valid after a successful resize: the caller must make
+ * sure that no reader is working on spans while this is called.
+ *
+ * @param[in] pRingBuffer   a pointer to the ring buffer, cannot be NULL.
+ * @param[in] pLinearBuffer the new linear buffer, cannot be NULL.
+ * @param size              the size of the new linear buffer in bytes.
+ * @return                  zero on success else negative error code;
+ *                          on failure the ring buffer is unchanged.
+ */
+int32_t uRingBufferResize(uRingBuffer_t *pRingBuffer, char *pLinearBuffer,
+                          size_t size);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: MULTIPLE READERS
  * -------------------------------------------------------------- */
@@ -395,6 +641,49 @@ size_t uRingBufferReadHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
 size_t uRingBufferPeekHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
                              char *pData, size_t length, size_t offset);
 
+/** Like uRingBufferReadSpans() but for a read handle: the data in
+ * the spans remains valid until it is consumed with
+ * uRingBufferConsumeHandle() provided that the read handle is
+ * locked (see uRingBufferLockReadHandle()) or nothing adds data
+ * with uRingBufferForceAdd()/uRingBufferForceWriteReserve(), and
+ * nothing calls uRingBufferResize().  To use this function the ring
+ * buffer must have been created by calling
+ * uRingBufferCreateWithReadHandle() rather than uRingBufferCreate().
+ *
+ * @param[in] pRingBuffer     a pointer to the ring buffer, cannot be NULL.
+ * @param handle              a read handle, as originally returned by
+ *                            uRingBufferTakeReadHandle().
+ * @param[out] ppSpan1        a place to put a pointer to the first span
+ *                            of data, set to NULL if there is none;
+ *                            cannot be NULL.
+ * @param[out] pSpan1Length   a place to put the length of the first span;
+ *                            cannot be NULL.
+ * @param[out] ppSpan2        a place to put a pointer to the second span
+ *                            of data, NULL if there isn't one; may be
+ *                            NULL, in which case only the first,
+ *                            contiguous, span is returned.
+ * @param[out] pSpan2Length   a place to put the length of the second span;
+ *                            may be NULL, in which case only the first,
+ *                            contiguous, span is returned.
+ * @return                    the total number of bytes in the spans.
+ */
+size_t uRingBufferReadSpansHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
+                                  const char **ppSpan1, size_t *pSpan1Length,
+                                  const char **ppSpan2, size_t *pSpan2Length);
+
+/** Move a read handle on, e.g. after working on data in place with
+ * uRingBufferReadSpansHandle(); the same as calling
+ * uRingBufferReadHandle() with pData NULL.
+ *
+ * @param[in] pRingBuffer   a pointer to the ring buffer, cannot be NULL.
+ * @param handle            a read handle, as originally returned by
+ *                          uRingBufferTakeReadHandle().
+ * @param length            the maximum amount of data to consume.
+ * @return                  the number of bytes consumed.
+ */
+size_t uRingBufferConsumeHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
+                                size_t length);
+
 /** Like uRingBufferDataSize() except for use by an entity that has
  * previously obtained a read handle by calling uRingBufferTakeReadHandle();
  * this mechanism should be employed if there is to be more than one consumer
@@ -441,6 +730,21 @@ void uRingBufferFlushHandle(uRingBuffer_t *pRingBuffer, int32_t handle);
 size_t uRingBufferStatReadLossHandle(uRingBuffer_t *pRingBuffer,
                                      int32_t handle);
 
+/** As uRingBufferStatFillMax() but for the data waiting for the
+ * given uRingBufferReadHandle(); for a locked read handle this shows
+ * how close the ring buffer came to being unable to accept more data.
+ *
+ * @param[in] pRingBuffer a pointer to the ring buffer, cannot be NULL.
+ * @param handle          a read handle, as originally returned by
+ *                        uRingBufferTakeReadHandle().
+ * @param reset           if true, once it has been read, the
+ *                        high-water mark is reset to the amount of
+ *                        data currently waiting for the read handle.
+ * @return                the high-water mark in bytes.
+ */
+size_t uRingBufferStatFillMaxHandle(uRingBuffer_t *pRingBuffer,
+                                    int32_t handle, bool reset);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: PARSER
  * -------------------------------------------------------------- */
@@ -484,6 +788,27 @@ bool uRingBufferGetByteUnprotected(uParseHandle_t parseHandle, void *p);
  */
 size_t uRingBufferBytesAvailableUnprotected(uParseHandle_t parseHandle);
 
+/** Get a contiguous span of bytes from the ring buffer while in a
+ * parser function, rather than a byte at a time; the span ends
+ * where the data ends, where the ring buffer wraps or after size
+ * bytes, whichever comes first, so call this in a loop to get the
+ * rest.  The data is not copied: pointer returned in ppData points
+ * into the ring buffer and is only valid while in the parser function.
+ *
+ * IMPORTANT: unlike all of the other ring-buffer functions, this function
+ * is NOT thread-safe, it is ONLY intended to be used from within a
+ * U_RING_BUFFER_PARSER_f function that will be called by uRingBufferParseHandle()
+ * (which adds thread-safety).
+ *
+ * @param parseHandle     the parser handle used to access the ring buffer.
+ * @param[out] ppData     a place to put a pointer to the span.
+ * @param size            the maximum number of bytes wanted.
+ * @return                the number of bytes in the span, zero if
+ *                        there is no more data.
+ */
+size_t uRingBufferGetSpanUnprotected(uParseHandle_t parseHandle,
+                                     const char **ppData, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_SLAB_H_
+#define _U_SLAB_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup __utils
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines a slab allocator, used internally
+ * by ubxlib in place of malloc()/free() for the short-lived blocks
+ * that are allocated and freed on every operation of a data path
+ * (e.g. an event queue send or an EDM packet).  It is a small number
+ * of fixed size classes, each a uMemPool in static storage, so that
+ * allocation takes a fixed time and does not fragment the heap of a
+ * long-running device; a request that is too big for any size class,
+ * or for which all of the suitable size classes are full, is passed
+ * on to malloc().  The API functions are thread-safe, do not take a
+ * mutex and may be called before uPortInit().
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* The storage for the size classes is static RAM, taken whether or
+ * not anything is ever allocated from it: a size class costs
+ * U_MEMPOOL_BUFFER_SIZE_BYTES(blockSize, numBlocks), i.e. each block
+ * is rounded up to a multiple of 8 bytes after adding 2 bytes of
+ * fence (if #U_MEMPOOL_USE_BUF_FENCE is 1, the default).  With the
+ * defaults below that is 320 + 576 + 544 + 1056 = 2496 bytes (2304
+ * bytes without the fence).  On a RAM-constrained device, reduce the
+ * U_SLAB_SIZE_CLASS_x_NUM_BLOCKS values (e.g. to 1 each, 512 bytes
+ * with the fence) in your u_cfg_override.h or compiler defines: any
+ * allocation that does not fit falls back to malloc(), which
+ * uSlabGetStats() counts in heapAllocCount, so those figures show
+ * whether a smaller configuration is good enough.
+ */
+
+#ifndef U_SLAB_SIZE_CLASS_0_BYTES
+/** The block size of the smallest size class.
+ */
+# define U_SLAB_SIZE_CLASS_0_BYTES 32
+#endif
+
+#ifndef U_SLAB_SIZE_CLASS_0_NUM_BLOCKS
+/** The number of blocks in the smallest size class, must be
+ * at least 1.
+ */
+# define U_SLAB_SIZE_CLASS_0_NUM_BLOCKS 8
+#endif
+
+#ifndef U_SLAB_SIZE_CLASS_1_BYTES
+/** The block size of the second size class, must be larger
+ * than #U_SLAB_SIZE_CLASS_0_BYTES.
+ */
+# define U_SLAB_SIZE_CLASS_1_BYTES 64
+#endif
+
+#ifndef U_SLAB_SIZE_CLASS_1_NUM_BLOCKS
+/** The number of blocks in the second size class, must be
+ * at least 1.
+ */
+# define U_SLAB_SIZE_CLASS_1_NUM_BLOCKS 8
+#endif
+
+#ifndef U_SLAB_SIZE_CLASS_2_BYTES
+/** The block size of the third size class, must be larger
+ * than #U_SLAB_SIZE_CLASS_1_BYTES.
+ */
+# define U_SLAB_SIZE_CLASS_2_BYTES 128
+#endif
+
+#ifndef U_SLAB_SIZE_CLASS_2_NUM_BLOCKS
+/** The number of blocks in the third size class, must be
+ * at least 1.
+ */
+# define U_SLAB_SIZE_CLASS_2_NUM_BLOCKS 4
+#endif
+
+#ifndef U_SLAB_SIZE_CLASS_3_BYTES
+/** The block size of the largest size class, must be larger
+ * than #U_SLAB_SIZE_CLASS_2_BYTES; the default is big enough for
+ * an EDM AT command packet.
+ */
+# define U_SLAB_SIZE_CLASS_3_BYTES 256
+#endif
+
+#ifndef U_SLAB_SIZE_CLASS_3_NUM_BLOCKS
+/** The number of blocks in the largest size class, must be
+ * at least 1.
+ */
+# define U_SLAB_SIZE_CLASS_3_NUM_BLOCKS 4
+#endif
+
+/** The number of size classes.
+ */
+#define U_SLAB_NUM_SIZE_CLASSES 4
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Statistics for a size class of the slab allocator, see
+ * uSlabGetStats().
+ */
+typedef struct {
+    size_t blockSize; /**< the block size of the size class. */
+    int32_t numBlocks; /**< the number of blocks in the size class. */
+    int32_t usedBlockCount; /**< the number of blocks currently in use. */
+    int32_t maxUsedBlockCount; /**< the largest number of blocks that
+                                    have been in use at any one time. */
+    int32_t heapAllocCount; /**< the number of allocations which would
+                                 have fitted into this size class but
+                                 which had to come from the heap because
+                                 this and all larger size classes were
+                                 full. */
+} uSlabStats_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Allocate memory: this is taken from the smallest size class
+ * that it fits into and has a free block, else from the heap.
+ * The memory is aligned as malloc() would align it, up to
+ * #U_MEMPOOL_ALIGNMENT_BYTES.
+ *
+ * @param size  the number of bytes required.
+ * @return      a pointer to the memory, NULL on failure; must be
+ *              freed with uSlabFree(), NOT with free().
+ */
+void *pUSlabAlloc(size_t size);
+
+/** Free memory allocated with pUSlabAlloc().
+ *
+ * @param pMem  a pointer to the memory, may be NULL.
+ */
+void uSlabFree(void *pMem);
+
+/** Get the statistics for a size class of the slab allocator.
+ *
+ * @param sizeClass  the size class, 0 to #U_SLAB_NUM_SIZE_CLASSES - 1,
+ *                   0 being the smallest.
+ * @param pStats     a place to put the statistics, cannot be NULL.
+ * @return           zero on success else negative error code.
+ */
+int32_t uSlabGetStats(int32_t sizeClass, uSlabStats_t *pStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_SLAB_H_
+
+// End of file
@@ -28,7 +28,10 @@
 
 /** @file
  * @brief This header file defines functions to help with time
- * manipulation.
+ * manipulation.  Conversion between a calendar date and seconds
+ * since 1970 uses the days-from-civil algorithm, in the proleptic
+ * Gregorian calendar, which takes the same time for any date and
+ * works for dates before 1970 as well as after.
  */
 
 #ifdef __cplusplus
@@ -39,10 +42,81 @@ extern "C" {
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+/** The number of seconds in a day.
+ */
+#define U_TIME_SECONDS_PER_DAY 86400
+
+/** Helper for U_TIME_DAYS_FROM_CIVIL(): the year counted from
+ * March, so that any leap day is at the end of it.
+ */
+#define U_TIME_CIVIL_YEAR(year, month) ((year) - (((month) <= 2) ? 1 : 0))
+
+/** Helper for U_TIME_DAYS_FROM_CIVIL(): the 400 year era that
+ * U_TIME_CIVIL_YEAR() falls into, rounded towards minus infinity.
+ */
+#define U_TIME_CIVIL_ERA(year, month) ((U_TIME_CIVIL_YEAR(year, month) >= 0 ?          \
+                                        U_TIME_CIVIL_YEAR(year, month) :               \
+                                        U_TIME_CIVIL_YEAR(year, month) - 399) / 400)
+
+/** Helper for U_TIME_DAYS_FROM_CIVIL(): the year of the era,
+ * 0 to 399.
+ */
+#define U_TIME_CIVIL_YEAR_OF_ERA(year, month) (U_TIME_CIVIL_YEAR(year, month) - \
+                                               (U_TIME_CIVIL_ERA(year, month) * 400))
+
+/** Helper for U_TIME_DAYS_FROM_CIVIL(): the day of the year
+ * counted from the 1st of March, 0 to 365.
+ */
+#define U_TIME_CIVIL_DAY_OF_YEAR(month, day) (((153 * ((month) + (((month) > 2) ? -3 : 9))) + 2) / 5 + \
+                                              (day) - 1)
+
+/** The number of days from the 1st of January 1970 to the given
+ * date, negative for dates before that.  This is a constant
+ * expression if the parameters are, e.g. it may be used to
+ * initialise a static variable, but note that the parameters are
+ * evaluated more than once; at run-time uTimeDateToEpoch() is
+ * better.
+ *
+ * @param year  the year, e.g. 2023.
+ * @param month the month, 1 to 12.
+ * @param day   the day of the month, 1 to 31; values outside the
+ *              days of the month simply run on into the next or
+ *              previous months.
+ */
+#define U_TIME_DAYS_FROM_CIVIL(year, month, day) (((int64_t) U_TIME_CIVIL_ERA(year, month) * 146097) +     \
+                                                  (U_TIME_CIVIL_YEAR_OF_ERA(year, month) * 365) +           \
+                                                  (U_TIME_CIVIL_YEAR_OF_ERA(year, month) / 4) -             \
+                                                  (U_TIME_CIVIL_YEAR_OF_ERA(year, month) / 100) +           \
+                                                  U_TIME_CIVIL_DAY_OF_YEAR(month, day) - 719468)
+
+/** The number of seconds since midnight at the start of the 1st
+ * of January 1970 for the given UTC date and time, as an int64_t;
+ * like U_TIME_DAYS_FROM_CIVIL(), a constant expression if the
+ * parameters are.
+ */
+#define U_TIME_DATE_TO_EPOCH(year, month, day, hours, minutes, seconds)   \
+    ((U_TIME_DAYS_FROM_CIVIL(year, month, day) * U_TIME_SECONDS_PER_DAY) + \
+     ((int64_t) (hours) * 3600) + ((int64_t) (minutes) * 60) + (seconds))
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** A calendar date and time.
+ */
+typedef struct {
+    int32_t year;    /**< the year, e.g. 2023. */
+    int32_t month;   /**< the month, 1 to 12. */
+    int32_t day;     /**< the day of the month, 1 to 31. */
+    int32_t hours;   /**< hours since midnight, 0 to 23. */
+    int32_t minutes; /**< minutes after the hour, 0 to 59. */
+    int32_t seconds; /**< seconds after the minute, 0 to 59;
+                          60 is allowed for a leap second when
+                          converting to seconds since 1970, the
+                          answer being the same as the first
+                          second of the next minute. */
+} uTimeDate_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -62,16 +136,41 @@ bool uTimeIsLeapYear(int32_t year);
 /** Return the number of UTC seconds that have elapsed in
  * the given number of UTC months, months since the
  * start of 1970 (counting from zero), taking into account
- * leap years.  Useful when converting a day/month/year count
- * into a UTC time.
+ * leap years.  To convert a date into a UTC time use
+ * uTimeDateToEpoch() instead.
  *
  * @param monthsUtc the number of months since the start of
  *                  1970, counting from zero.
  * @return          the number of seconds in the given number
- *                  of months, taking into account leap years.
+ *                  of months, taking into account leap years;
+ *                  zero if monthsUtc is negative.
  */
 int64_t uTimeMonthsToSecondsUtc(int32_t monthsUtc);
 
+/** Convert a calendar date and time into the number of seconds
+ * since midnight at the start of the 1st of January 1970, e.g.
+ * a UTC date into a UTC time.  Days, hours, minutes and seconds
+ * outside their usual range simply run on into the next or
+ * previous unit, and so do months, e.g. month 13 is January of
+ * the following year, as for mktime().
+ *
+ * @param[in] pDate a pointer to the date, cannot be NULL.
+ * @return          the number of seconds since the start of 1970,
+ *                  negative for dates before then.
+ */
+int64_t uTimeDateToEpoch(const uTimeDate_t *pDate);
+
+/** Convert a number of seconds since midnight at the start of the
+ * 1st of January 1970, e.g. a UTC time, into a calendar date and
+ * time, the inverse of uTimeDateToEpoch().
+ *
+ * @param epoch      the number of seconds since the start of 1970,
+ *                   may be negative.
+ * @param[out] pDate a pointer to a place to put the date, cannot
+ *                   be NULL.
+ */
+void uTimeEpochToDate(int64_t epoch, uTimeDate_t *pDate);
+
 #ifdef __cplusplus
 }
 #endif
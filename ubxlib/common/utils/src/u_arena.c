@@ -0,0 +1,164 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the arena allocator.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdlib.h"    // malloc() and free()
+#include "stdint.h"    // int32_t, uintptr_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+
+#include "u_error_common.h"
+#include "u_arena.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Create an arena.
+int32_t uArenaCreate(uArena_t *pArena, char *pLinearBuffer, size_t size)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    size_t padding;
+
+    if (pArena != NULL) {
+        memset(pArena, 0, sizeof(*pArena));
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (pLinearBuffer == NULL) {
+            // malloc() returns memory aligned for any type
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pArena->pMalloced = malloc(size);
+            pLinearBuffer = (char *) pArena->pMalloced;
+            if (pLinearBuffer != NULL) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+        if (errorCode == 0) {
+            // Skip any misaligned bytes at the start
+            padding = (U_ARENA_ALIGNMENT_BYTES - ((uintptr_t) pLinearBuffer %
+                                                  U_ARENA_ALIGNMENT_BYTES)) %
+                      U_ARENA_ALIGNMENT_BYTES;
+            if (padding < size) {
+                pArena->pBuffer = pLinearBuffer + padding;
+                pArena->size = size - padding;
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Delete an arena.
+void uArenaDelete(uArena_t *pArena)
+{
+    if (pArena != NULL) {
+        free(pArena->pMalloced);
+        pArena->pMalloced = NULL;
+        pArena->pBuffer = NULL;
+        pArena->size = 0;
+        pArena->used = 0;
+    }
+}
+
+// Allocate memory from an arena.
+void *pUArenaAlloc(uArena_t *pArena, size_t size)
+{
+    void *pMem = NULL;
+    size_t allocSize = U_ARENA_ALLOC_SIZE_BYTES(size);
+
+    // The second condition catches size being so large
+    // that the rounding-up above has wrapped
+    if ((allocSize <= pArena->size - pArena->used) && (allocSize >= size)) {
+        pMem = pArena->pBuffer + pArena->used;
+        pArena->used += allocSize;
+        if (pArena->used > pArena->highWaterMark) {
+            pArena->highWaterMark = pArena->used;
+        }
+    } else {
+        pArena->allocFailCount++;
+    }
+
+    return pMem;
+}
+
+// Get a mark for the current fill level of an arena.
+size_t uArenaGetMark(const uArena_t *pArena)
+{
+    return pArena->used;
+}
+
+// Rewind an arena to a mark.
+void uArenaRewind(uArena_t *pArena, size_t mark)
+{
+    if (mark < pArena->used) {
+        pArena->used = mark;
+    }
+}
+
+// Reset an arena.
+void uArenaReset(uArena_t *pArena)
+{
+    pArena->used = 0;
+}
+
+// Get the number of bytes in use.
+size_t uArenaGetUsed(const uArena_t *pArena)
+{
+    return pArena->used;
+}
+
+// Get the high water mark.
+size_t uArenaGetHighWaterMark(const uArena_t *pArena)
+{
+    return pArena->highWaterMark;
+}
+
+// Get the number of failed allocations.
+int32_t uArenaGetAllocFailCount(const uArena_t *pArena)
+{
+    return pArena->allocFailCount;
+}
+
+// End of file
@@ -21,28 +21,36 @@
  */
 
 /** @file
- * @brief functions to assist with time manipulation.
+ * @brief Implementation of base 64 encode and decode.
  */
 
 #ifdef U_CFG_OVERRIDE
 # include "u_cfg_override.h" // For a customer's configuration override
 #endif
 
-#include "stddef.h"    // size_t
+#include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
 
-#include "u_base64.h"
+#include "u_error_common.h"
 
-// The base64.h implementation we use calls puts() so
-// we define it here to remove it
-//lint -e(683) Suppress warning about puts() being redefined.
-#define puts(x)
-#include "base64.h"
+#include "u_base64.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+/** The bit that is set in a decoded group of four characters if
+ * any of them was not base 64: the -1 in gBase64ToValue[] for such
+ * a character fills every bit from its position upwards, whereas
+ * a valid group only fills the bottom 24 bits.
+ */
+#define U_BASE64_INVALID 0x80000000UL
+
+/** The padding character.
+ */
+#define U_BASE64_PAD '='
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -51,10 +59,174 @@
  * STATIC VARIABLES
  * -------------------------------------------------------------- */
 
+/** The base 64 alphabet.
+ */
+static const char gBase64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/** The six-bit value of each character, -1 if the character
+ * is not base 64 (padding included).
+ */
+static const int8_t gBase64ToValue[256] = {
+      -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,
+      -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,
+      -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1, 0x3e,   -1,   -1,   -1, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d,   -1,   -1,   -1,   -1,   -1,   -1,
+      -1, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,   -1,   -1,   -1,   -1,   -1,
+      -1, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33,   -1,   -1,   -1,   -1,   -1,
+      -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,
+      -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,
+      -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,
+      -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,
+      -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,
+      -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,
+      -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,
+      -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1,   -1
+};
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Encode whole groups of three bytes, returning the number of
+// characters written.
+static size_t encodeGroups(const char *pBinary, size_t numGroups, char *pBase64)
+{
+    const uint8_t *pIn = (const uint8_t *) pBinary;
+    uint32_t x;
+
+    for (size_t y = 0; y < numGroups; y++) {
+        x = (((uint32_t) *pIn) << 16) | (((uint32_t) * (pIn + 1)) << 8) | *(pIn + 2);
+        *pBase64 = gBase64Alphabet[x >> 18];
+        *(pBase64 + 1) = gBase64Alphabet[(x >> 12) & 0x3f];
+        *(pBase64 + 2) = gBase64Alphabet[(x >> 6) & 0x3f];
+        *(pBase64 + 3) = gBase64Alphabet[x & 0x3f];
+        pIn += 3;
+        pBase64 += 4;
+    }
+
+    return numGroups * 4;
+}
+
+// Encode the last one or two bytes, with padding, returning the
+// number of characters written, which will be zero if length is
+// zero.
+static size_t encodeLast(const char *pBinary, size_t length, char *pBase64)
+{
+    const uint8_t *pIn = (const uint8_t *) pBinary;
+    uint32_t x;
+
+    if (length == 0) {
+        return 0;
+    }
+
+    x = ((uint32_t) *pIn) << 16;
+    if (length > 1) {
+        x |= ((uint32_t) * (pIn + 1)) << 8;
+    }
+    *pBase64 = gBase64Alphabet[x >> 18];
+    *(pBase64 + 1) = gBase64Alphabet[(x >> 12) & 0x3f];
+    *(pBase64 + 2) = (length > 1) ? gBase64Alphabet[(x >> 6) & 0x3f] : U_BASE64_PAD;
+    *(pBase64 + 3) = U_BASE64_PAD;
+
+    return 4;
+}
+
+// Decode whole groups of four characters, returning the number of
+// groups decoded; stops at the first group that contains anything
+// other than base 64 characters (e.g. padding).  Each group is read
+// before it is written so pBinary may be the same as pBase64.
+static size_t decodeGroups(const char *pBase64, size_t numGroups, char *pBinary)
+{
+    const uint8_t *pIn = (const uint8_t *) pBase64;
+    size_t y = 0;
+    bool valid = true;
+    uint32_t x;
+
+    while (valid && (y < numGroups)) {
+        x = (((uint32_t) gBase64ToValue[*pIn]) << 18) |
+            (((uint32_t) gBase64ToValue[*(pIn + 1)]) << 12) |
+            (((uint32_t) gBase64ToValue[*(pIn + 2)]) << 6) |
+            ((uint32_t) gBase64ToValue[*(pIn + 3)]);
+        // One test for the whole group
+        valid = ((x & U_BASE64_INVALID) == 0);
+        if (valid) {
+            *pBinary = (char) (x >> 16);
+            *(pBinary + 1) = (char) (x >> 8);
+            *(pBinary + 2) = (char) x;
+            pIn += 4;
+            pBinary += 3;
+            y++;
+        }
+    }
+
+    return y;
+}
+
+// Decode the last group: four characters, which may end in one
+// or two padding characters, or two or three characters without
+// padding.  Returns the number of bytes written or negative error
+// code.  The group is read before it is written so pBinary may be
+// the same as pBase64.
+static int32_t decodeLast(const char *pBase64, size_t length, char *pBinary)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uint32_t x = 0;
+
+    if (length == 4) {
+        // Remove any padding
+        if (*(pBase64 + 3) == U_BASE64_PAD) {
+            length--;
+            if (*(pBase64 + 2) == U_BASE64_PAD) {
+                length--;
+            }
+        }
+    }
+    if ((length >= 2) && (length <= 4)) {
+        for (size_t y = 0; y < length; y++) {
+            x |= ((uint32_t) gBase64ToValue[(uint8_t) * (pBase64 + y)]) << (18 - (y * 6));
+        }
+        if ((x & U_BASE64_INVALID) == 0) {
+            // Two characters make one byte, three make two, four make three
+            errorCodeOrLength = (int32_t) length - 1;
+            for (int32_t y = 0; y < errorCodeOrLength; y++) {
+                *(pBinary + y) = (char) (x >> (16 - (y * 8)));
+            }
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
+// Return the length a buffer of base 64 would decode to,
+// based only on its length and any padding at the end, or
+// negative error code if no amount of binary could have
+// been encoded as that many characters.
+static int32_t decodedLength(const char *pBase64, size_t base64LengthBytes)
+{
+    size_t length = base64LengthBytes;
+
+    if (length == 0) {
+        return 0;
+    }
+
+    if ((length > 1) && (*(pBase64 + length - 1) == U_BASE64_PAD)) {
+        length--;
+        if (*(pBase64 + length - 1) == U_BASE64_PAD) {
+            length--;
+        }
+    }
+    if ((length % 4) == 1) {
+        // A single character left over is only six bits
+        return (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    }
+
+    // Each whole group of four makes three bytes, two left over
+    // make one byte and three left over make two bytes
+    return (int32_t) (((length / 4) * 3) + (((length % 4) * 3) / 4));
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -63,42 +235,200 @@
 int32_t uBase64Encode(const char *pBinary, size_t binaryLengthBytes,
                       char *pBase64, size_t base64LengthBytes)
 {
-    int32_t bytesEncoded = 0;
-
-    // Determine the required length of decode buffer by calling
-    // base64() with NULL
-    //lint -e(712) Suppress loss of precision
-    base64(pBinary, binaryLengthBytes,
-           (int *) &(bytesEncoded), NULL); // *NOPAD* stop AStyle offsetting &
-    if ((pBase64 != NULL) && ((int32_t) base64LengthBytes >= bytesEncoded)) {
-        // Now do the encode
-        //lint -e(712) Suppress loss of precision
-        base64((const void *) pBinary, binaryLengthBytes,
-               (int *) &(bytesEncoded), pBase64);  // *NOPAD* stop AStyle offsetting &
+    size_t bytesEncoded = U_BASE64_ENCODED_LENGTH_BYTES(binaryLengthBytes);
+    size_t numGroups;
+
+    if ((pBase64 != NULL) && (base64LengthBytes >= bytesEncoded)) {
+        numGroups = binaryLengthBytes / 3;
+        encodeGroups(pBinary, numGroups, pBase64);
+        encodeLast(pBinary + (numGroups * 3), binaryLengthBytes - (numGroups * 3),
+                   pBase64 + (numGroups * 4));
     }
 
-    return bytesEncoded;
+    return (int32_t) bytesEncoded;
 }
 
 // Perform a base 64 decode.
 int32_t uBase64Decode(const char *pBase64, size_t base64LengthBytes,
                       char *pBinary, size_t binaryLengthBytes)
 {
-    int32_t bytesDecoded = 0;
-
-    // Determine the required length of decode buffer by calling
-    // unbase64() with NULL
-    //lint -e(712) Suppress loss of precision
-    unbase64(pBase64, base64LengthBytes, (int *) & (bytesDecoded),
-             NULL);  // *NOPAD* stop AStyle offsetting &
-    if ((pBinary != NULL) && ((int32_t) binaryLengthBytes >= bytesDecoded)) {
-        // Now do the decode
-        //lint -e(712) Suppress loss of precision
-        unbase64(pBase64, base64LengthBytes,
-                 (int *) &(bytesDecoded), pBinary);  // *NOPAD* stop AStyle offsetting &
+    int32_t bytesDecoded = decodedLength(pBase64, base64LengthBytes);
+    size_t lastLength;
+    size_t numGroups;
+
+    if ((pBinary != NULL) && (bytesDecoded > 0) &&
+        ((int32_t) binaryLengthBytes >= bytesDecoded)) {
+        // Everything up to the last group, which may be
+        // short or padded, must be whole groups
+        lastLength = base64LengthBytes % 4;
+        if (lastLength == 0) {
+            lastLength = 4;
+        }
+        numGroups = (base64LengthBytes - lastLength) / 4;
+        if (decodeGroups(pBase64, numGroups, pBinary) == numGroups) {
+            if (decodeLast(pBase64 + (numGroups * 4), lastLength,
+                           pBinary + (numGroups * 3)) < 0) {
+                bytesDecoded = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            }
+        } else {
+            bytesDecoded = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        }
     }
 
     return bytesDecoded;
 }
 
+// Start a chunked base 64 encode.
+void uBase64EncodeStart(uBase64Context_t *pContext)
+{
+    pContext->bufferLength = 0;
+    pContext->padded = false;
+}
+
+// Encode a chunk.
+int32_t uBase64EncodeUpdate(uBase64Context_t *pContext,
+                            const char *pBinary, size_t binaryLengthBytes,
+                            char *pBase64, size_t base64LengthBytes)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    size_t length = 0;
+    size_t numGroups;
+
+    if (base64LengthBytes >= ((pContext->bufferLength + binaryLengthBytes) / 3) * 4) {
+        // Complete any group held over from last time
+        while ((pContext->bufferLength > 0) && (binaryLengthBytes > 0)) {
+            pContext->buffer[pContext->bufferLength] = *pBinary;
+            pContext->bufferLength++;
+            pBinary++;
+            binaryLengthBytes--;
+            if (pContext->bufferLength == 3) {
+                length = encodeGroups(pContext->buffer, 1, pBase64);
+                pContext->bufferLength = 0;
+            }
+        }
+        // Encode whole groups straight from the input
+        numGroups = binaryLengthBytes / 3;
+        length += encodeGroups(pBinary, numGroups, pBase64 + length);
+        // Keep what is left for next time
+        for (size_t x = numGroups * 3; x < binaryLengthBytes; x++) {
+            pContext->buffer[pContext->bufferLength] = *(pBinary + x);
+            pContext->bufferLength++;
+        }
+        errorCodeOrLength = (int32_t) length;
+    }
+
+    return errorCodeOrLength;
+}
+
+// Finish a chunked base 64 encode.
+int32_t uBase64EncodeFinish(uBase64Context_t *pContext,
+                            char *pBase64, size_t base64LengthBytes)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+
+    if (base64LengthBytes >= U_BASE64_ENCODE_FINISH_LENGTH_BYTES) {
+        errorCodeOrLength = (int32_t) encodeLast(pContext->buffer,
+                                                 pContext->bufferLength,
+                                                 pBase64);
+        pContext->bufferLength = 0;
+    }
+
+    return errorCodeOrLength;
+}
+
+// Start a chunked base 64 decode.
+void uBase64DecodeStart(uBase64Context_t *pContext)
+{
+    pContext->bufferLength = 0;
+    pContext->padded = false;
+}
+
+// Decode a chunk.
+int32_t uBase64DecodeUpdate(uBase64Context_t *pContext,
+                            const char *pBase64, size_t base64LengthBytes,
+                            char *pBinary, size_t binaryLengthBytes)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    size_t length = 0;
+    size_t numGroups;
+    int32_t x;
+
+    if (binaryLengthBytes >= ((pContext->bufferLength + base64LengthBytes) / 4) * 3) {
+        errorCodeOrLength = (int32_t) U_ERROR_COMMON_SUCCESS;
+        // Complete any group held over from last time
+        while ((errorCodeOrLength == 0) && (pContext->bufferLength > 0) &&
+               (base64LengthBytes > 0)) {
+            pContext->buffer[pContext->bufferLength] = *pBase64;
+            pContext->bufferLength++;
+            pBase64++;
+            base64LengthBytes--;
+            if (pContext->bufferLength == 4) {
+                pContext->bufferLength = 0;
+                x = decodeLast(pContext->buffer, 4, pBinary);
+                if (x >= 0) {
+                    length = (size_t) x;
+                    pContext->padded = (x < 3);
+                } else {
+                    errorCodeOrLength = x;
+                }
+            }
+        }
+        if ((errorCodeOrLength == 0) && (base64LengthBytes > 0) && pContext->padded) {
+            // Nothing is allowed after padding
+            errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        }
+        if ((errorCodeOrLength == 0) && (base64LengthBytes > 0)) {
+            // Decode whole groups straight from the input
+            numGroups = decodeGroups(pBase64, base64LengthBytes / 4, pBinary + length);
+            pBase64 += numGroups * 4;
+            base64LengthBytes -= numGroups * 4;
+            length += numGroups * 3;
+            if (base64LengthBytes >= 4) {
+                // decodeGroups() stopped early so this must be the
+                // padded last group, otherwise it is an error
+                x = decodeLast(pBase64, 4, pBinary + length);
+                if ((x >= 0) && (x < 3) && (base64LengthBytes == 4)) {
+                    length += (size_t) x;
+                    pContext->padded = true;
+                    base64LengthBytes = 0;
+                } else {
+                    errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+                }
+            }
+            // Keep what is left for next time
+            while ((errorCodeOrLength == 0) && (base64LengthBytes > 0)) {
+                pContext->buffer[pContext->bufferLength] = *pBase64;
+                pContext->bufferLength++;
+                pBase64++;
+                base64LengthBytes--;
+            }
+        }
+        if (errorCodeOrLength == 0) {
+            errorCodeOrLength = (int32_t) length;
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
+// Finish a chunked base 64 decode.
+int32_t uBase64DecodeFinish(uBase64Context_t *pContext,
+                            char *pBinary, size_t binaryLengthBytes)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+
+    if (binaryLengthBytes >= U_BASE64_DECODE_FINISH_LENGTH_BYTES) {
+        errorCodeOrLength = 0;
+        if (pContext->bufferLength > 0) {
+            // Unpadded characters left over
+            errorCodeOrLength = decodeLast(pContext->buffer,
+                                           pContext->bufferLength,
+                                           pBinary);
+            pContext->bufferLength = 0;
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
 // End of file
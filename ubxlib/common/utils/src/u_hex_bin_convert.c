@@ -41,6 +41,30 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+/** Where the compiler says that SSE2 is available (e.g. the Linux
+ * and Windows platforms on x86) sixteen bytes at a time are
+ * converted with SSE2; define U_HEX_BIN_CONVERT_NO_SIMD to use only
+ * the look-up tables, which is what all other platforms do.
+ */
+#if !defined(U_HEX_BIN_CONVERT_NO_SIMD) && \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+# define U_HEX_BIN_CONVERT_SSE2
+# include "emmintrin.h"
+#endif
+
+/** The 32 characters of ASCII hex for all of the bytes that have
+ * the given upper nibble.
+ */
+#define U_HEX_BIN_CONVERT_ROW(x) x, '0', x, '1', x, '2', x, '3', \
+                                 x, '4', x, '5', x, '6', x, '7', \
+                                 x, '8', x, '9', x, 'A', x, 'B', \
+                                 x, 'C', x, 'D', x, 'E', x, 'F'
+
+/** The bit set in an entry of gHexToNibble[] for a valid ASCII hex
+ * character.
+ */
+#define U_HEX_BIN_CONVERT_VALID 0x10
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -49,26 +73,166 @@
  * VARIABLES
  * -------------------------------------------------------------- */
 
-static const char gHex[] = {'0', '1', '2', '3', '4', '5', '6', '7',
-                            '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
-                           };
+/** The two ASCII hex characters for each byte value.
+ */
+static const char gBinToHexPair[256 * 2] = {
+    U_HEX_BIN_CONVERT_ROW('0'),
+    U_HEX_BIN_CONVERT_ROW('1'),
+    U_HEX_BIN_CONVERT_ROW('2'),
+    U_HEX_BIN_CONVERT_ROW('3'),
+    U_HEX_BIN_CONVERT_ROW('4'),
+    U_HEX_BIN_CONVERT_ROW('5'),
+    U_HEX_BIN_CONVERT_ROW('6'),
+    U_HEX_BIN_CONVERT_ROW('7'),
+    U_HEX_BIN_CONVERT_ROW('8'),
+    U_HEX_BIN_CONVERT_ROW('9'),
+    U_HEX_BIN_CONVERT_ROW('A'),
+    U_HEX_BIN_CONVERT_ROW('B'),
+    U_HEX_BIN_CONVERT_ROW('C'),
+    U_HEX_BIN_CONVERT_ROW('D'),
+    U_HEX_BIN_CONVERT_ROW('E'),
+    U_HEX_BIN_CONVERT_ROW('F')
+};
+
+/** The nibble value for each ASCII character, OR'ed with
+ * U_HEX_BIN_CONVERT_VALID, or zero if the character is not ASCII hex.
+ */
+static const uint8_t gHexToNibble[256] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
 
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+#ifdef U_HEX_BIN_CONVERT_SSE2
+
+// Convert a vector of nibbles into upper-case ASCII hex.
+static __m128i nibbleToHexSse2(__m128i nibble)
+{
+    // '0' + nibble, plus 7 to get from ':' to 'A' if nibble > 9
+    __m128i adjust = _mm_and_si128(_mm_cmpgt_epi8(nibble, _mm_set1_epi8(9)),
+                                   _mm_set1_epi8('A' - '9' - 1));
+    return _mm_add_epi8(_mm_add_epi8(nibble, _mm_set1_epi8('0')), adjust);
+}
+
+// Convert a vector of ASCII hex into nibbles, returning the
+// nibbles and setting *pValid to all ones in the positions
+// where the character was valid ASCII hex.
+static __m128i hexToNibbleSse2(__m128i hex, __m128i *pValid)
+{
+    // The comparisons are signed, which conveniently makes
+    // characters 0x80 and above fail both tests
+    __m128i digit = _mm_sub_epi8(hex, _mm_set1_epi8('0'));
+    __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(hex, _mm_set1_epi8('0' - 1)),
+                                    _mm_cmplt_epi8(hex, _mm_set1_epi8('9' + 1)));
+    // OR'ing with 0x20 makes 'A' to 'F' into 'a' to 'f'
+    __m128i lower = _mm_or_si128(hex, _mm_set1_epi8(0x20));
+    __m128i letter = _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10));
+    __m128i isLetter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                     _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+
+    *pValid = _mm_or_si128(isDigit, isLetter);
+    return _mm_or_si128(_mm_and_si128(isDigit, digit),
+                        _mm_and_si128(isLetter, letter));
+}
+
+// Convert as many whole blocks of 16 bytes as possible into
+// ASCII hex, returning the number of bytes converted.
+static size_t binToHexSse2(const char *pBin, size_t binLength, char *pHex)
+{
+    size_t length = 0;
+    __m128i bin;
+    __m128i upper;
+    __m128i lower;
+
+    while (binLength - length >= 16) {
+        bin = _mm_loadu_si128((const __m128i *) (pBin + length));
+        upper = nibbleToHexSse2(_mm_and_si128(_mm_srli_epi16(bin, 4), _mm_set1_epi8(0x0f)));
+        lower = nibbleToHexSse2(_mm_and_si128(bin, _mm_set1_epi8(0x0f)));
+        // Interleave so that the upper nibble comes first
+        _mm_storeu_si128((__m128i *) (pHex + (length * 2)), _mm_unpacklo_epi8(upper, lower));
+        _mm_storeu_si128((__m128i *) (pHex + (length * 2) + 16), _mm_unpackhi_epi8(upper, lower));
+        length += 16;
+    }
+
+    return length;
+}
+
+// Convert as many whole blocks of 32 characters of ASCII hex as
+// possible into binary, returning the number of bytes converted;
+// stops at the start of a block containing anything that is not
+// ASCII hex.  Each block is read before it is written so pBin
+// may be the same as pHex.
+static size_t hexToBinSse2(const char *pHex, size_t hexLength, char *pBin)
+{
+    size_t length = 0;
+    bool keepGoing = true;
+    __m128i first;
+    __m128i second;
+    __m128i firstValid;
+    __m128i secondValid;
+
+    while (keepGoing && (hexLength / 2 - length >= 16)) {
+        first = hexToNibbleSse2(_mm_loadu_si128((const __m128i *) (pHex + (length * 2))),
+                                &firstValid);
+        second = hexToNibbleSse2(_mm_loadu_si128((const __m128i *) (pHex + (length * 2) + 16)),
+                                 &secondValid);
+        keepGoing = (_mm_movemask_epi8(_mm_and_si128(firstValid, secondValid)) == 0xFFFF);
+        if (keepGoing) {
+            // Each 16-bit lane holds the upper nibble in its
+            // low byte and the lower nibble in its high byte:
+            // put them together in the low byte and pack
+            first = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(first, 4), _mm_set1_epi16(0xf0)),
+                                 _mm_srli_epi16(first, 8));
+            second = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(second, 4), _mm_set1_epi16(0xf0)),
+                                  _mm_srli_epi16(second, 8));
+            _mm_storeu_si128((__m128i *) (pBin + length), _mm_packus_epi16(first, second));
+            length += 16;
+        }
+    }
+
+    return length;
+}
+
+#endif // #ifdef U_HEX_BIN_CONVERT_SSE2
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
 //lint -esym(429, pHex) Suppress Lint getting a bee in its
 // bonnet about pHex not being free()'d when it IS being free()'d.
 size_t uBinToHex(const char *pBin, size_t binLength, char *pHex)
 {
+    const char *pPair;
+    size_t x = 0;
+
     U_ASSERT(pHex != NULL);
 
-    for (size_t x = 0; x < binLength; x++) {
-        *pHex = gHex[((unsigned char) * pBin) >> 4];
-        pHex++;
-        *pHex = gHex[*pBin & 0x0f];
-        pHex++;
-        pBin++;
+#ifdef U_HEX_BIN_CONVERT_SSE2
+    x = binToHexSse2(pBin, binLength, pHex);
+#endif
+
+    for (; x < binLength; x++) {
+        pPair = gBinToHexPair + (((unsigned char) *(pBin + x)) * 2);
+        *(pHex + (x * 2)) = *pPair;
+        *(pHex + (x * 2) + 1) = *(pPair + 1);
     }
 
     return binLength * 2;
@@ -78,35 +242,25 @@ size_t uBinToHex(const char *pBin, size_t binLength, char *pHex)
 // bonnet about pBin not being free()'d when it IS being free()'d.
 size_t uHexToBin(const char *pHex, size_t hexLength, char *pBin)
 {
-    bool success = true;
-    size_t length;
-    char z[2];
+    size_t length = 0;
+    bool valid = true;
+    uint8_t upper;
+    uint8_t lower;
 
     U_ASSERT(pBin != NULL);
 
-    for (length = 0; (length < hexLength / 2) && success; length++) {
-        z[0] = *pHex - '0';
-        pHex++;
-        z[1] = *pHex - '0';
-        pHex++;
-        for (size_t y = 0; (y < sizeof(z)) && success; y++) {
-            if (z[y] > 9) {
-                // Must be A to F or a to f
-                z[y] -= 'A' - '0';
-                z[y] += 10;
-            }
-            if (z[y] > 15) {
-                // Must be a to f
-                z[y] -= 'a' - 'A';
-            }
-            // Cast here to shut-up a warning under ESP-IDF
-            // which appears to have chars as unsigned and
-            // hence thinks the first condition is always true
-            success = ((signed char) z[y] >= 0) && (z[y] <= 15);
-        }
-        if (success) {
-            *pBin = (char) (((z[0] & 0x0f) << 4) | z[1]);
-            pBin++;
+#ifdef U_HEX_BIN_CONVERT_SSE2
+    length = hexToBinSse2(pHex, hexLength, pBin);
+#endif
+
+    while (valid && (length < hexLength / 2)) {
+        upper = gHexToNibble[(unsigned char) *(pHex + (length * 2))];
+        lower = gHexToNibble[(unsigned char) *(pHex + (length * 2) + 1)];
+        valid = ((upper & lower & U_HEX_BIN_CONVERT_VALID) != 0);
+        if (valid) {
+            // The shift pushes U_HEX_BIN_CONVERT_VALID out of the byte
+            *(pBin + length) = (char) ((upper << 4) | (lower & 0x0f));
+            length++;
         }
     }
 
@@ -33,6 +33,7 @@
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
 
+#include "u_compiler.h" // U_ATOMIC_xxx
 #include "u_assert.h"
 #include "u_port.h"
 #include "u_port_debug.h"
@@ -44,31 +45,25 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
-// Configuration value if a "fence" should be added between
-// the mempool buffer chunks for detecting buffer overflows.
-// Since this only adds 2 bytes per chunk it is enabled by default.
-#ifndef U_MEMPOOL_USE_BUF_FENCE
-# define U_MEMPOOL_USE_BUF_FENCE 1
-#endif
-
-#if U_MEMPOOL_USE_BUF_FENCE
-# define U_REAL_BLOCK_SIZE(userBlockSize) \
-    (userBlockSize + sizeof(uint16_t))
-#else
-# define U_REAL_BLOCK_SIZE(userBlockSize) (userBlockSize)
-#endif
+#define U_REAL_BLOCK_SIZE(userBlockSize) U_MEMPOOL_BLOCK_SIZE_BYTES(userBlockSize)
 
 #define U_BUFFER_SIZE(pMemPool) \
-    (U_REAL_BLOCK_SIZE(pMemPool->blockSize) * pMemPool->totalBlockCount)
+    U_MEMPOOL_BUFFER_SIZE_BYTES(pMemPool->blockSize, pMemPool->totalBlockCount)
 
 #define U_FENCE_MAGIC 0xBEEF
 
+// The part of freeListHead that is the index plus one of a block.
+#define U_FREE_LIST_INDEX_MASK U_MEMPOOL_MAX_NUM_BLOCKS
+
+// The amount to add to freeListHead to increment its tag.
+#define U_FREE_LIST_TAG_INCREMENT (U_FREE_LIST_INDEX_MASK + 1)
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
 typedef struct uMemPoolFree {
-    struct uMemPoolFree *pNext;
+    uint32_t nextIndexPlusOne; // Zero if this is the last free block
 } uMemPoolFreeList_t;
 
 /* ----------------------------------------------------------------
@@ -83,23 +78,67 @@ typedef struct uMemPoolFree {
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
-static void initFreeList(uMemPoolDesc_t *pMemPool)
+// Get the block with the given index plus one, which may be the
+// whole of a freeListHead.
+static U_INLINE uMemPoolFreeList_t *pBlock(const uMemPoolDesc_t *pMemPool,
+                                           uint8_t *pBuffer,
+                                           uint32_t indexPlusOne)
+{
+    size_t realBlockSize = U_REAL_BLOCK_SIZE(pMemPool->blockSize);
+
+    indexPlusOne &= U_FREE_LIST_INDEX_MASK;
+    return (uMemPoolFreeList_t *) (pBuffer + ((indexPlusOne - 1) * realBlockSize));
+}
+
+// Make a new freeListHead from the current one, pointing to the
+// block with the given index plus one.
+static U_INLINE uint32_t newHead(uint32_t head, uint32_t indexPlusOne)
+{
+    return ((head + U_FREE_LIST_TAG_INCREMENT) & ~U_FREE_LIST_INDEX_MASK) |
+           indexPlusOne;
+}
+
+static void initFreeList(uMemPoolDesc_t *pMemPool, uint8_t *pBuffer)
 {
     // Initialize the freed linked list
-    U_ASSERT(pMemPool->pBuffer != NULL);
-    uMemPoolFreeList_t *pLastFree = (uMemPoolFreeList_t *)pMemPool->pBuffer;
-    pMemPool->pFreeList = pLastFree;
-    for (int i = 1; i < pMemPool->totalBlockCount; i++) {
-        uMemPoolFreeList_t *pFree;
-        size_t realBlockSize = U_REAL_BLOCK_SIZE(pMemPool->blockSize);
-        pFree = (uMemPoolFreeList_t *)&pMemPool->pBuffer[i * realBlockSize];
-        pLastFree->pNext = pFree;
-        pLastFree = pFree;
+    U_ASSERT(pBuffer != NULL);
+    for (int32_t i = 1; i <= pMemPool->totalBlockCount; i++) {
+        uMemPoolFreeList_t *pFree = pBlock(pMemPool, pBuffer, i);
+        if (i < pMemPool->totalBlockCount) {
+            pFree->nextIndexPlusOne = i + 1;
+        } else {
+            pFree->nextIndexPlusOne = 0;
+        }
     }
-    pLastFree->pNext = NULL;
+    pMemPool->freeListHead = newHead(pMemPool->freeListHead, 1);
     pMemPool->usedBlockCount = 0;
 }
 
+// Allocate the buffer of a pool, done on the first call to
+// uMemPoolAllocMem().  Returns the buffer.
+static uint8_t *allocBuffer(uMemPoolDesc_t *pMemPool)
+{
+    uint8_t *pBuffer;
+
+    U_PORT_MUTEX_LOCK(pMemPool->mutex);
+
+    // Check again in case another task got here first
+    pBuffer = pMemPool->pBuffer;
+    if (pBuffer == NULL) {
+        pBuffer = (uint8_t *)malloc(U_BUFFER_SIZE(pMemPool));
+        uPortLog("U_MEM_POOL: Allocated buffer %p\n", pBuffer);
+        if (pBuffer != NULL) {
+            initFreeList(pMemPool, pBuffer);
+            // Only now may other tasks use it
+            U_ATOMIC_STORE_RELEASE_PTR(&pMemPool->pBuffer, pBuffer);
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(pMemPool->mutex);
+
+    return pBuffer;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -108,7 +147,8 @@ int32_t uMemPoolInit(uMemPoolDesc_t *pMemPool, uint32_t blockSize, int32_t blkCo
 {
     int32_t err = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
 
-    if ((pMemPool != NULL) && (blockSize >= sizeof(uMemPoolFreeList_t))) {
+    if ((pMemPool != NULL) && (blockSize >= sizeof(uMemPoolFreeList_t)) &&
+        (blkCount > 0) && (blkCount <= U_MEMPOOL_MAX_NUM_BLOCKS)) {
         memset(pMemPool, 0, sizeof(uMemPoolDesc_t));
         pMemPool->blockSize = blockSize;
         pMemPool->usedBlockCount = 0;
@@ -120,6 +160,27 @@ int32_t uMemPoolInit(uMemPoolDesc_t *pMemPool, uint32_t blockSize, int32_t blkCo
     return err;
 }
 
+int32_t uMemPoolInitWithBuffer(uMemPoolDesc_t *pMemPool, uint32_t blockSize,
+                               int32_t blkCount, uint8_t *pBuffer)
+{
+    int32_t err = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pMemPool != NULL) && (blockSize >= sizeof(uMemPoolFreeList_t)) &&
+        (blkCount > 0) && (blkCount <= U_MEMPOOL_MAX_NUM_BLOCKS) &&
+        (pBuffer != NULL)) {
+        memset(pMemPool, 0, sizeof(uMemPoolDesc_t));
+        pMemPool->blockSize = blockSize;
+        pMemPool->totalBlockCount = blkCount;
+        // No mutex is needed since the buffer never has to be allocated
+        initFreeList(pMemPool, pBuffer);
+        pMemPool->pBuffer = pBuffer;
+        pMemPool->bufferIsExternal = true;
+        err = (int32_t)U_ERROR_COMMON_SUCCESS;
+    }
+
+    return err;
+}
+
 void uMemPoolDeinit(uMemPoolDesc_t *pMemPool)
 {
     if ((pMemPool != NULL) && (pMemPool->mutex != NULL)) {
@@ -134,44 +195,64 @@ void uMemPoolDeinit(uMemPoolDesc_t *pMemPool)
 
         uPortMutexDelete(pMemPool->mutex);
         memset(pMemPool, 0, sizeof(uMemPoolDesc_t));
+    } else if ((pMemPool != NULL) && pMemPool->bufferIsExternal) {
+        // The buffer belongs to the caller
+        memset(pMemPool, 0, sizeof(uMemPoolDesc_t));
     }
 }
 
 void *uMemPoolAllocMem(uMemPoolDesc_t *pMemPool)
 {
     void *pAllocMem = NULL;
-
-    if ((pMemPool != NULL) && (pMemPool->mutex != NULL)) {
-
-        U_PORT_MUTEX_LOCK(pMemPool->mutex);
-
-        // If this is the first call to uMemPoolAllocMem we need to
-        // allocate the buffer
-        if (pMemPool->pBuffer == NULL) {
-            pMemPool->pBuffer = (uint8_t *)malloc(U_BUFFER_SIZE(pMemPool));
-            uPortLog("U_MEM_POOL: Allocated buffer %p\n", pMemPool->pBuffer);
-            if (pMemPool->pBuffer != NULL) {
-                initFreeList(pMemPool);
-            }
+    uint8_t *pBuffer;
+    uMemPoolFreeList_t *pFree;
+    uint32_t head;
+    int32_t usedBlockCount;
+    int32_t maxUsedBlockCount;
+
+    if ((pMemPool != NULL) && ((pMemPool->mutex != NULL) || pMemPool->bufferIsExternal)) {
+        pBuffer = (uint8_t *) U_ATOMIC_LOAD_ACQUIRE_PTR(&pMemPool->pBuffer);
+        if (pBuffer == NULL) {
+            // If this is the first call to uMemPoolAllocMem we need to
+            // allocate the buffer
+            pBuffer = allocBuffer(pMemPool);
         }
 
-        // Grab the free memory available in the free list
-        if (pMemPool->pFreeList) {
-            pAllocMem = pMemPool->pFreeList;
-            pMemPool->pFreeList = pMemPool->pFreeList->pNext;
-            pMemPool->usedBlockCount++;
+        if (pBuffer != NULL) {
+            // Grab the memory at the head of the free list; the tag
+            // in the head makes the swap fail if anyone else has
+            // changed the list in the meantime, in which case the
+            // next pointer we read may be junk, so try again
+            head = U_ATOMIC_LOAD_ACQUIRE(&pMemPool->freeListHead);
+            while (((head & U_FREE_LIST_INDEX_MASK) != 0) && (pAllocMem == NULL)) {
+                pFree = pBlock(pMemPool, pBuffer, head);
+                if (U_ATOMIC_COMPARE_AND_SWAP(&pMemPool->freeListHead, head,
+                                              newHead(head,
+                                                      U_ATOMIC_LOAD_ACQUIRE(&pFree->nextIndexPlusOne)))) {
+                    pAllocMem = pFree;
+                } else {
+                    head = U_ATOMIC_LOAD_ACQUIRE(&pMemPool->freeListHead);
+                }
+            }
         }
 
-#if U_MEMPOOL_USE_BUF_FENCE
-        // Add the memory fence right after the user allocation
         if (pAllocMem != NULL) {
+            usedBlockCount = U_ATOMIC_ADD_FETCH(&pMemPool->usedBlockCount, 1);
+            maxUsedBlockCount = U_ATOMIC_LOAD_ACQUIRE(&pMemPool->maxUsedBlockCount);
+            while ((usedBlockCount > maxUsedBlockCount) &&
+                   !U_ATOMIC_COMPARE_AND_SWAP(&pMemPool->maxUsedBlockCount,
+                                              maxUsedBlockCount, usedBlockCount)) {
+                maxUsedBlockCount = U_ATOMIC_LOAD_ACQUIRE(&pMemPool->maxUsedBlockCount);
+            }
+#if U_MEMPOOL_USE_BUF_FENCE
+            // Add the memory fence right after the user allocation
             uint8_t *pDataPtr = (uint8_t *)pAllocMem;
             uint16_t *pMagic = (uint16_t *)&pDataPtr[pMemPool->blockSize];
             *pMagic = U_FENCE_MAGIC;
-        }
 #endif
-
-        U_PORT_MUTEX_UNLOCK(pMemPool->mutex);
+        } else {
+            U_ATOMIC_ADD_FETCH(&pMemPool->allocFailCount, 1);
+        }
     }
 
     return pAllocMem;
@@ -179,14 +260,17 @@ void *uMemPoolAllocMem(uMemPoolDesc_t *pMemPool)
 
 void uMemPoolFreeMem(uMemPoolDesc_t *pMemPool, void *pMem)
 {
-    void *pMemNext;
-
-    if ((pMemPool != NULL) && (pMem != NULL) && (pMemPool->mutex != NULL)) {
-        U_PORT_MUTEX_LOCK(pMemPool->mutex);
+    uint8_t *pBuffer;
+    uMemPoolFreeList_t *pFree = (uMemPoolFreeList_t *)pMem;
+    uint32_t indexPlusOne;
+    uint32_t head;
+
+    if ((pMemPool != NULL) && (pMem != NULL) &&
+        ((pMemPool->mutex != NULL) || pMemPool->bufferIsExternal)) {
+        pBuffer = (uint8_t *) U_ATOMIC_LOAD_ACQUIRE_PTR(&pMemPool->pBuffer);
         // Make sure the memory segment is within our buffer
-        uPortLog("pMem: %08x\n", pMem);
-        U_ASSERT((uint8_t *)pMem >= pMemPool->pBuffer);
-        U_ASSERT((uint8_t *)pMem < (pMemPool->pBuffer + U_BUFFER_SIZE(pMemPool)));
+        U_ASSERT((uint8_t *)pMem >= pBuffer);
+        U_ASSERT((uint8_t *)pMem < (pBuffer + U_BUFFER_SIZE(pMemPool)));
 
 #if U_MEMPOOL_USE_BUF_FENCE
         // Validate the magic number
@@ -198,11 +282,15 @@ void uMemPoolFreeMem(uMemPoolDesc_t *pMemPool, void *pMem)
 #endif
 
         // Add the freed memory reference before the head
-        pMemNext = pMemPool->pFreeList;
-        pMemPool->pFreeList = (uMemPoolFreeList_t *)pMem;
-        pMemPool->pFreeList->pNext = (uMemPoolFreeList_t *)pMemNext;
-        pMemPool->usedBlockCount--;
-        U_PORT_MUTEX_UNLOCK(pMemPool->mutex);
+        indexPlusOne = (uint32_t) (((uint8_t *)pMem - pBuffer) /
+                                   U_REAL_BLOCK_SIZE(pMemPool->blockSize)) + 1;
+        do {
+            head = U_ATOMIC_LOAD_ACQUIRE(&pMemPool->freeListHead);
+            // Another task may be reading this in uMemPoolAllocMem()
+            U_ATOMIC_STORE_RELEASE(&pFree->nextIndexPlusOne, head & U_FREE_LIST_INDEX_MASK);
+        } while (!U_ATOMIC_COMPARE_AND_SWAP(&pMemPool->freeListHead, head,
+                                            newHead(head, indexPlusOne)));
+        U_ATOMIC_ADD_FETCH(&pMemPool->usedBlockCount, -1);
     }
 }
 
@@ -210,9 +298,27 @@ void uMemPoolFreeAllMem(uMemPoolDesc_t *pMemPool)
 {
     if ((pMemPool != NULL) && (pMemPool->mutex != NULL)) {
         U_PORT_MUTEX_LOCK(pMemPool->mutex);
-        initFreeList(pMemPool);
+        if (pMemPool->pBuffer != NULL) {
+            initFreeList(pMemPool, pMemPool->pBuffer);
+        }
         U_PORT_MUTEX_UNLOCK(pMemPool->mutex);
+    } else if ((pMemPool != NULL) && pMemPool->bufferIsExternal) {
+        initFreeList(pMemPool, pMemPool->pBuffer);
     }
 }
 
+int32_t uMemPoolGetStats(const uMemPoolDesc_t *pMemPool, uMemPoolStats_t *pStats)
+{
+    int32_t err = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pMemPool != NULL) && (pStats != NULL)) {
+        pStats->usedBlockCount = U_ATOMIC_LOAD_ACQUIRE(&pMemPool->usedBlockCount);
+        pStats->maxUsedBlockCount = U_ATOMIC_LOAD_ACQUIRE(&pMemPool->maxUsedBlockCount);
+        pStats->allocFailCount = U_ATOMIC_LOAD_ACQUIRE(&pMemPool->allocFailCount);
+        err = (int32_t)U_ERROR_COMMON_SUCCESS;
+    }
+
+    return err;
+}
+
 // End of file
@@ -117,6 +117,55 @@ static U_INLINE const char *pPtrOffset(const char *pData, size_t offset,
     return pData;
 }
 
+// Find the read pointers with the most data waiting, of those that
+// count towards the free space (see freeSize()).  Adding data doesn't
+// change which these are, since all of the read pointers are the same
+// amount further behind afterwards (or, if pushed on by a forced add,
+// are left the maximum amount behind), so this need only be called
+// when one of them moves.
+// The ring buffer's mutex should be locked before this is called.
+static void updateSlowest(uRingBuffer_t *pRingBuffer)
+{
+    size_t used;
+    size_t usedMax = 0;
+    size_t usedLockedMax = 0;
+
+    pRingBuffer->slowestReadIndex = -1;
+    pRingBuffer->slowestLockedReadIndex = -1;
+    for (size_t x = 0; x < pRingBuffer->maxNumReadPointers; x++) {
+        // If a read handle is required we ignore the data behind
+        // the "normal" read pointer as it's not possible to get
+        // at it
+        if ((pRingBuffer->pDataRead[x] != NULL) &&
+            ((x > 0) || !pRingBuffer->readHandleRequired)) {
+            used = ptrDiff(pRingBuffer->pDataRead[x], pRingBuffer->pDataWrite,
+                           pRingBuffer->size);
+            if ((pRingBuffer->slowestReadIndex < 0) || (used > usedMax)) {
+                pRingBuffer->slowestReadIndex = (int32_t) x;
+                usedMax = used;
+            }
+            // 0 is not lockable
+            if ((x > 0) && (pRingBuffer->dataReadLockBitmap & (1ULL << (x - 1))) &&
+                ((pRingBuffer->slowestLockedReadIndex < 0) || (used > usedLockedMax))) {
+                pRingBuffer->slowestLockedReadIndex = (int32_t) x;
+                usedLockedMax = used;
+            }
+        }
+    }
+}
+
+// Call this when a read pointer has been moved towards the write
+// pointer (or given up): only if it was one of the slowest can the
+// slowest have changed.
+// The ring buffer's mutex should be locked before this is called.
+static void readPointerMoved(uRingBuffer_t *pRingBuffer, int32_t index)
+{
+    if ((index == pRingBuffer->slowestReadIndex) ||
+        (index == pRingBuffer->slowestLockedReadIndex)) {
+        updateSlowest(pRingBuffer);
+    }
+}
+
 // The ring buffer's mutex should be locked before this is called
 static void bufferReset(uRingBuffer_t *pRingBuffer)
 {
@@ -132,6 +181,10 @@ static void bufferReset(uRingBuffer_t *pRingBuffer)
     pRingBuffer->pDataWrite = pRingBuffer->pBuffer;
     // The default handle-less read pointer can always be set
     pRingBuffer->pDataRead[0] = pRingBuffer->pDataWrite;
+    // Anything reserved is no longer valid
+    pRingBuffer->writeReservedLength = 0;
+    pRingBuffer->writeReservedForced = false;
+    updateSlowest(pRingBuffer);
 }
 
 static int32_t createCommon(uRingBuffer_t *pRingBuffer, char *pLinearBuffer, size_t size)
@@ -142,55 +195,101 @@ static int32_t createCommon(uRingBuffer_t *pRingBuffer, char *pLinearBuffer, siz
     return uPortMutexCreate((uPortMutexHandle_t *) &pRingBuffer->mutex);
 }
 
+// Return the amount of data that may be read for a read pointer.
+// While a forced write reservation is outstanding the oldest data of
+// a read pointer that the reservation overlaps may be being written
+// over, so it gets nothing until uRingBufferWriteCommit() moves it
+// on by however much was actually written.
+// The ring buffer's mutex should be locked before this is called.
+static size_t readableSize(const uRingBuffer_t *pRingBuffer, int32_t handle)
+{
+    size_t size = ptrDiff(pRingBuffer->pDataRead[handle], pRingBuffer->pDataWrite,
+                          pRingBuffer->size);
+
+    if (pRingBuffer->writeReservedForced &&
+        (size + 1 + pRingBuffer->writeReservedLength > pRingBuffer->size)) {
+        size = 0;
+    }
+
+    return size;
+}
+
 // The ring buffer's mutex should be locked before this is called
 static size_t read(uRingBuffer_t *pRingBuffer, int32_t handle, char *pData,
                    size_t length, size_t offset, bool destructive)
 {
     size_t bytesRead = 0;
     size_t available;
+    size_t x;
     const char *pSource;
 
     if ((handle >= 0) && (handle < (int32_t) pRingBuffer->maxNumReadPointers) &&
         (pRingBuffer->pDataRead[handle] != NULL)) {
 
-        pSource = pPtrOffset(pRingBuffer->pDataRead[handle], offset,
-                             pRingBuffer->pBuffer, pRingBuffer->size);
-        available = ptrDiff(pSource, pRingBuffer->pDataWrite, pRingBuffer->size);
-        if (length > available) {
-            length = available;
-        }
-
-        while (bytesRead < length) {
+        available = readableSize(pRingBuffer, handle);
+        if (offset < available) {
+            available -= offset;
+            pSource = pPtrOffset(pRingBuffer->pDataRead[handle], offset,
+                                 pRingBuffer->pBuffer, pRingBuffer->size);
+            if (length > available) {
+                length = available;
+            }
             if (pData != NULL) {
-                *pData = *pSource;
-                pData++;
+                // Copy in up to two goes, the second if we wrap
+                x = (pRingBuffer->pBuffer + pRingBuffer->size) - pSource;
+                if (x > length) {
+                    x = length;
+                }
+                memcpy(pData, pSource, x);
+                memcpy(pData + x, pRingBuffer->pBuffer, length - x);
+            }
+            bytesRead = length;
+            if (destructive) {
+                pRingBuffer->pDataRead[handle] = pPtrOffset(pSource, length,
+                                                            pRingBuffer->pBuffer,
+                                                            pRingBuffer->size);
             }
-            pSource = pPtrInc(pSource, pRingBuffer->pBuffer, pRingBuffer->size);
-            bytesRead++;
-        }
-        if (destructive) {
-            pRingBuffer->pDataRead[handle] = pSource;
         }
     }
 
     return bytesRead;
 }
 
-// The ring buffer's mutex should be locked before this is called
+// The ring buffer's mutex should be locked before this is called.
+// If pData is NULL room is made for length bytes but nothing is
+// written, which is what uRingBufferWriteCommit() needs to complete
+// a forced reservation.
 static bool add(uRingBuffer_t *pRingBuffer, const char *pData,
                 size_t length, bool destructive)
 {
     bool dataFitsInBuffer = true;
+    bool pushed = false;
     size_t lost;
     size_t used;
+    size_t fillMax;
 
-    if (length >= pRingBuffer->size) {
+    if ((length >= pRingBuffer->size) ||
+        ((pData != NULL) && (pRingBuffer->writeReservedLength > 0))) {
+        // Too big or someone is writing directly into the buffer
         dataFitsInBuffer = false;
     } else {
         for (size_t x = 0; (x < pRingBuffer->maxNumReadPointers) &&
              (dataFitsInBuffer || destructive); x++) {
             if (pRingBuffer->pDataRead[x] != NULL) {
                 used = ptrDiff(pRingBuffer->pDataRead[x], pRingBuffer->pDataWrite, pRingBuffer->size);
+                // Keep track of the high-water mark
+                fillMax = used + length;
+                if (fillMax >= pRingBuffer->size) {
+                    // Can't hold more than this
+                    fillMax = pRingBuffer->size - 1;
+                }
+                if (x == 0) {
+                    if (fillMax > pRingBuffer->statFillMaxNormalBytes) {
+                        pRingBuffer->statFillMaxNormalBytes = fillMax;
+                    }
+                } else if (fillMax > pRingBuffer->statFillMaxBytes[x]) {
+                    pRingBuffer->statFillMaxBytes[x] = fillMax;
+                }
                 used++; // Account for the fact that we can't have the pointers overlap
                 if (used + length > pRingBuffer->size) {
                     // If we're on the "normal" read pointer (0) and it can't be used (because
@@ -200,6 +299,7 @@ static bool add(uRingBuffer_t *pRingBuffer, const char *pData,
                     if (((x == 0) && pRingBuffer->readHandleRequired) ||
                         (destructive && ((x == 0) || (pRingBuffer->dataReadLockBitmap & (1ULL << (x - 1))) == 0))) {
                         lost = read(pRingBuffer, x, NULL, used + length - pRingBuffer->size, 0, true);
+                        pushed = true;
                         if (x == 0) {
                             pRingBuffer->statReadLossNormalBytes += lost;
                         } else {
@@ -214,7 +314,7 @@ static bool add(uRingBuffer_t *pRingBuffer, const char *pData,
     }
 
     if (dataFitsInBuffer) {
-        while (length > 0) {
+        while ((pData != NULL) && (length > 0)) {
             *(pRingBuffer->pDataWrite) = *pData;
             pRingBuffer->pDataWrite = (char *) pPtrInc(pRingBuffer->pDataWrite, pRingBuffer->pBuffer,
                                                        pRingBuffer->size);
@@ -224,10 +324,87 @@ static bool add(uRingBuffer_t *pRingBuffer, const char *pData,
     } else {
         pRingBuffer->statAddLossBytes += length;
     }
+    if (pushed && !dataFitsInBuffer) {
+        // Read pointers were pushed on but the write pointer
+        // didn't follow, so the order of things may be different
+        updateSlowest(pRingBuffer);
+    }
+
+    return dataFitsInBuffer;
+}
+
+// Add data to a ring buffer created with uRingBufferCreateLockFree():
+// must only be called by the adding task, which owns pDataWrite.
+static bool addLockFree(uRingBuffer_t *pRingBuffer, const char *pData,
+                        size_t length)
+{
+    bool dataFitsInBuffer = false;
+    char *pWrite = pRingBuffer->pDataWrite;
+    const char *pRead = U_ATOMIC_LOAD_ACQUIRE_PTR(&(pRingBuffer->pDataRead[0]));
+    size_t used = ptrDiff(pRead, pWrite, pRingBuffer->size);
+    size_t x;
+
+    // Must keep one to prevent pointer wrap, and can't add
+    // while someone is writing directly into the buffer
+    if ((used + length < pRingBuffer->size) && (pRingBuffer->writeReservedLength == 0)) {
+        if (used + length > pRingBuffer->statFillMaxNormalBytes) {
+            pRingBuffer->statFillMaxNormalBytes = used + length;
+        }
+        x = (pRingBuffer->pBuffer + pRingBuffer->size) - pWrite;
+        if (x > length) {
+            x = length;
+        }
+        memcpy(pWrite, pData, x);
+        memcpy(pRingBuffer->pBuffer, pData + x, length - x);
+        // Only now can the reading task see the data
+        U_ATOMIC_STORE_RELEASE_PTR(&(pRingBuffer->pDataWrite),
+                                   (char *) pPtrOffset(pWrite, length, pRingBuffer->pBuffer,
+                                                       pRingBuffer->size));
+        dataFitsInBuffer = true;
+    } else {
+        pRingBuffer->statAddLossBytes += length;
+    }
 
     return dataFitsInBuffer;
 }
 
+// Read data from a ring buffer created with uRingBufferCreateLockFree():
+// must only be called by the reading task, which owns pDataRead[0].
+static size_t readLockFree(uRingBuffer_t *pRingBuffer, char *pData,
+                           size_t length, size_t offset, bool destructive)
+{
+    size_t bytesRead = 0;
+    const char *pSource = pRingBuffer->pDataRead[0];
+    char *pWrite = U_ATOMIC_LOAD_ACQUIRE_PTR(&(pRingBuffer->pDataWrite));
+    size_t available = ptrDiff(pSource, pWrite, pRingBuffer->size);
+    size_t x;
+
+    if (offset < available) {
+        available -= offset;
+        pSource = pPtrOffset(pSource, offset, pRingBuffer->pBuffer, pRingBuffer->size);
+        if (length > available) {
+            length = available;
+        }
+        if (pData != NULL) {
+            x = (pRingBuffer->pBuffer + pRingBuffer->size) - pSource;
+            if (x > length) {
+                x = length;
+            }
+            memcpy(pData, pSource, x);
+            memcpy(pData + x, pRingBuffer->pBuffer, length - x);
+        }
+        bytesRead = length;
+        if (destructive) {
+            // Hand the space back to the adding task
+            U_ATOMIC_STORE_RELEASE_PTR(&(pRingBuffer->pDataRead[0]),
+                                       pPtrOffset(pSource, length, pRingBuffer->pBuffer,
+                                                  pRingBuffer->size));
+        }
+    }
+
+    return bytesRead;
+}
+
 // This function does the ring buffer mutex locking itself.
 static size_t lock(uRingBuffer_t *pRingBuffer, int32_t handle, bool lockNotUnlock)
 {
@@ -244,6 +421,7 @@ static size_t lock(uRingBuffer_t *pRingBuffer, int32_t handle, bool lockNotUnloc
             } else {
                 pRingBuffer->dataReadLockBitmap &= ~(1ULL << (handle - 1));
             }
+            updateSlowest(pRingBuffer);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
@@ -252,54 +430,193 @@ static size_t lock(uRingBuffer_t *pRingBuffer, int32_t handle, bool lockNotUnloc
     return dataSize;
 }
 
+// The ring buffer's mutex should be locked before this is called
+static size_t freeSize(const uRingBuffer_t *pRingBuffer, bool max)
+{
+    size_t size = pRingBuffer->size;
+    // If we're doing max then we only take into account
+    // locked data buffer pointers
+    int32_t x = max ? pRingBuffer->slowestLockedReadIndex : pRingBuffer->slowestReadIndex;
+
+    if (x >= 0) {
+        size = pRingBuffer->size - ptrDiff(pRingBuffer->pDataRead[x], pRingBuffer->pDataWrite,
+                                           pRingBuffer->size);
+    } else if (!max) {
+        // If we didn't find a single data read pointer,
+        // and we're not doing max, report what is in the
+        // buffer anyway
+        size = pRingBuffer->size - ptrDiff(pRingBuffer->pBuffer, pRingBuffer->pDataWrite,
+                                           pRingBuffer->size);
+    }
+    if (size > 0) {
+        //  Must keep one to prevent pointer wrap
+        size--;
+    }
+
+    return size;
+}
+
 // This function does the ring buffer mutex locking itself.
 static size_t availableSize(const uRingBuffer_t *pRingBuffer, bool max)
 {
     size_t size = 0;
-    size_t y = 0;
-    bool foundADataReadPointer = false;
 
     if (pRingBuffer->pBuffer != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
-        size = pRingBuffer->size;
-        for (size_t x = 0; x < pRingBuffer->maxNumReadPointers; x++) {
-            // If a read handle is required we ignore the data behind
-            // the "normal" read pointer as it's not possible to get
-            // at it
-            if ((pRingBuffer->pDataRead[x] != NULL) &&
-                ((x > 0) || !pRingBuffer->readHandleRequired)) {
-                // If we're doing max then we only take into account
-                // locked data buffer pointers and we ignore 0 since
-                // it is not lockable
-                if (!max || ((x > 0) && (pRingBuffer->dataReadLockBitmap & (1ULL << (x - 1))))) {
-                    y = pRingBuffer->size - ptrDiff(pRingBuffer->pDataRead[x], pRingBuffer->pDataWrite,
-                                                    pRingBuffer->size);
-                    if (y < size) {
-                        size = y;
-                    }
-                    foundADataReadPointer = true;
+        size = freeSize(pRingBuffer, max);
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+    }
+
+    return size;
+}
+
+// Describe length bytes of the ring buffer, beginning at pStart,
+// as up to two spans, the second being needed if they wrap; if
+// the caller has nowhere to put a second span the length is
+// limited to that of the first.  Returns the total length.
+static size_t spans(const uRingBuffer_t *pRingBuffer, const char *pStart,
+                    size_t length, const char **ppSpan1, size_t *pSpan1Length,
+                    const char **ppSpan2, size_t *pSpan2Length)
+{
+    size_t x = (pRingBuffer->pBuffer + pRingBuffer->size) - pStart;
+
+    if ((length > x) && ((ppSpan2 == NULL) || (pSpan2Length == NULL))) {
+        // Caller only wants contiguous space
+        length = x;
+    }
+    if (length > 0) {
+        *ppSpan1 = pStart;
+        *pSpan1Length = length;
+        if (length > x) {
+            *pSpan1Length = x;
+            *ppSpan2 = pRingBuffer->pBuffer;
+            *pSpan2Length = length - x;
+        }
+    }
+
+    return length;
+}
+
+// Reserve space in a ring buffer for writing, see
+// uRingBufferWriteReserve() and uRingBufferForceWriteReserve().
+// This function does the ring buffer mutex locking itself.
+static size_t writeReserve(uRingBuffer_t *pRingBuffer, size_t length,
+                           bool destructive,
+                           char **ppSpan1, size_t *pSpan1Length,
+                           char **ppSpan2, size_t *pSpan2Length)
+{
+    size_t reservedLength = 0;
+    size_t x;
+
+    *ppSpan1 = NULL;
+    *pSpan1Length = 0;
+    if ((ppSpan2 != NULL) && (pSpan2Length != NULL)) {
+        *ppSpan2 = NULL;
+        *pSpan2Length = 0;
+    }
+
+    if (pRingBuffer->pBuffer != NULL) {
+        if (pRingBuffer->lockFree) {
+            // Only the adding task may do this, and it can't
+            // move the read pointer on
+            if (!destructive && (pRingBuffer->writeReservedLength == 0)) {
+                // Must keep one to prevent pointer wrap
+                x = pRingBuffer->size - 1 -
+                    ptrDiff(U_ATOMIC_LOAD_ACQUIRE_PTR(&(pRingBuffer->pDataRead[0])),
+                            pRingBuffer->pDataWrite, pRingBuffer->size);
+                if (length > x) {
+                    length = x;
+                }
+                reservedLength = spans(pRingBuffer, pRingBuffer->pDataWrite, length,
+                                       (const char **) ppSpan1, pSpan1Length,
+                                       (const char **) ppSpan2, pSpan2Length);
+                pRingBuffer->writeReservedLength = reservedLength;
+            }
+        } else {
+
+            U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+
+            // Only one reservation may be outstanding at a time
+            if (pRingBuffer->writeReservedLength == 0) {
+                // A forced reservation can't go beyond what the
+                // locked read pointers allow, an unforced one
+                // can't go beyond what any of them allow
+                x = freeSize(pRingBuffer, destructive);
+                if (length > x) {
+                    length = x;
+                }
+                x = pRingBuffer->pBuffer + pRingBuffer->size - pRingBuffer->pDataWrite;
+                if ((length > x) && ((ppSpan2 == NULL) || (pSpan2Length == NULL))) {
+                    // Caller only wants contiguous space
+                    length = x;
+                }
+                // For a forced reservation, the read pointers that
+                // may be moved on are left where they are until the
+                // commit, when they are moved on by only as much as
+                // was written (see readableSize() for what they get
+                // in the meantime); an unforced reservation can't
+                // need them to move at all
+                if (length > 0) {
+                    reservedLength = spans(pRingBuffer, pRingBuffer->pDataWrite, length,
+                                           (const char **) ppSpan1, pSpan1Length,
+                                           (const char **) ppSpan2, pSpan2Length);
+                    pRingBuffer->writeReservedLength = reservedLength;
+                    pRingBuffer->writeReservedForced = destructive;
                 }
             }
-        }
 
-        if (!max && !foundADataReadPointer) {
-            // If we didn't find a single data read pointer,
-            // and we're not doing max, report what is in the
-            // buffer anyway
-            size = pRingBuffer->size - ptrDiff(pRingBuffer->pBuffer, pRingBuffer->pDataWrite,
-                                               pRingBuffer->size);
-        }
-        if (size > 0) {
-            //  Must keep one to prevent pointer wrap
-            size--;
+            U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
         }
+    }
 
-        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+    return reservedLength;
+}
+
+// Get the data waiting for a read pointer as spans, see
+// uRingBufferReadSpans() and uRingBufferReadSpansHandle().
+// This function does the ring buffer mutex locking itself.
+static size_t readSpans(uRingBuffer_t *pRingBuffer, int32_t handle,
+                        const char **ppSpan1, size_t *pSpan1Length,
+                        const char **ppSpan2, size_t *pSpan2Length)
+{
+    size_t length = 0;
+
+    *ppSpan1 = NULL;
+    *pSpan1Length = 0;
+    if ((ppSpan2 != NULL) && (pSpan2Length != NULL)) {
+        *ppSpan2 = NULL;
+        *pSpan2Length = 0;
     }
 
-    return size;
+    if (pRingBuffer->pBuffer != NULL) {
+        if (pRingBuffer->lockFree) {
+            // Only the reading task may do this
+            if (handle == 0) {
+                length = ptrDiff(pRingBuffer->pDataRead[0],
+                                 U_ATOMIC_LOAD_ACQUIRE_PTR(&(pRingBuffer->pDataWrite)),
+                                 pRingBuffer->size);
+                length = spans(pRingBuffer, pRingBuffer->pDataRead[0], length,
+                               ppSpan1, pSpan1Length, ppSpan2, pSpan2Length);
+            }
+        } else {
+
+            U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+
+            if ((handle >= 0) && (handle < (int32_t) pRingBuffer->maxNumReadPointers) &&
+                (pRingBuffer->pDataRead[handle] != NULL)) {
+                length = readableSize(pRingBuffer, handle);
+                length = spans(pRingBuffer, pRingBuffer->pDataRead[handle], length,
+                               ppSpan1, pSpan1Length, ppSpan2, pSpan2Length);
+            }
+
+            U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        }
+    }
+
+    return length;
 }
 
 // Hex print for debug purposes.
@@ -399,6 +716,20 @@ int32_t uRingBufferCreate(uRingBuffer_t *pRingBuffer, char *pLinearBuffer, size_
     return createCommon(pRingBuffer, pLinearBuffer, size);
 }
 
+int32_t uRingBufferCreateLockFree(uRingBuffer_t *pRingBuffer, char *pLinearBuffer,
+                                  size_t size)
+{
+    int32_t errorCode = uRingBufferCreate(pRingBuffer, pLinearBuffer, size);
+
+    if (errorCode == 0) {
+        // The mutex is still created, the functions which aren't
+        // on the lock-free path use it
+        pRingBuffer->lockFree = true;
+    }
+
+    return errorCode;
+}
+
 void uRingBufferDelete(uRingBuffer_t *pRingBuffer)
 {
     if ((pRingBuffer != NULL) && (pRingBuffer->mutex != NULL)) {
@@ -407,6 +738,8 @@ void uRingBufferDelete(uRingBuffer_t *pRingBuffer)
             pRingBuffer->pDataRead = NULL;
             free(pRingBuffer->statReadLossBytes);
             pRingBuffer->statReadLossBytes = NULL;
+            free(pRingBuffer->statFillMaxBytes);
+            pRingBuffer->statFillMaxBytes = NULL;
         }
         pRingBuffer->maxNumReadPointers = 0;
         uPortMutexDelete((uPortMutexHandle_t) pRingBuffer->mutex);
@@ -420,12 +753,16 @@ bool uRingBufferAdd(uRingBuffer_t *pRingBuffer, const char *pData, size_t length
     bool dataFitsInBuffer = false;
 
     if (pRingBuffer->pBuffer != NULL) {
+        if (pRingBuffer->lockFree) {
+            dataFitsInBuffer = addLockFree(pRingBuffer, pData, length);
+        } else {
 
-        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+            U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
-        dataFitsInBuffer = add(pRingBuffer, pData, length, false);
+            dataFitsInBuffer = add(pRingBuffer, pData, length, false);
 
-        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+            U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        }
     }
 
     return dataFitsInBuffer;
@@ -436,28 +773,108 @@ bool uRingBufferForceAdd(uRingBuffer_t *pRingBuffer, const char *pData, size_t l
     bool dataFitsInBuffer = false;
 
     if (pRingBuffer->pBuffer != NULL) {
+        if (pRingBuffer->lockFree) {
+            // Can't move the read pointer on from here
+            dataFitsInBuffer = addLockFree(pRingBuffer, pData, length);
+        } else {
 
-        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+            U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
-        dataFitsInBuffer = add(pRingBuffer, pData, length, true);
+            dataFitsInBuffer = add(pRingBuffer, pData, length, true);
 
-        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+            U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        }
     }
 
     return dataFitsInBuffer;
 }
 
+size_t uRingBufferWriteReserve(uRingBuffer_t *pRingBuffer, size_t length,
+                               char **ppSpan1, size_t *pSpan1Length,
+                               char **ppSpan2, size_t *pSpan2Length)
+{
+    return writeReserve(pRingBuffer, length, false,
+                        ppSpan1, pSpan1Length, ppSpan2, pSpan2Length);
+}
+
+size_t uRingBufferForceWriteReserve(uRingBuffer_t *pRingBuffer, size_t length,
+                                    char **ppSpan1, size_t *pSpan1Length,
+                                    char **ppSpan2, size_t *pSpan2Length)
+{
+    return writeReserve(pRingBuffer, length, true,
+                        ppSpan1, pSpan1Length, ppSpan2, pSpan2Length);
+}
+
+bool uRingBufferWriteCommit(uRingBuffer_t *pRingBuffer, size_t length)
+{
+    bool committed = false;
+    uint64_t lockBitmap;
+
+    if (pRingBuffer->pBuffer != NULL) {
+        if (pRingBuffer->lockFree) {
+            // Only the adding task may do this
+            if (length <= pRingBuffer->writeReservedLength) {
+                if (length > 0) {
+                    U_ATOMIC_STORE_RELEASE_PTR(&(pRingBuffer->pDataWrite),
+                                               (char *) pPtrOffset(pRingBuffer->pDataWrite, length,
+                                                                   pRingBuffer->pBuffer,
+                                                                   pRingBuffer->size));
+                }
+                committed = true;
+            }
+            pRingBuffer->writeReservedLength = 0;
+        } else {
+
+            U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+
+            if (length <= pRingBuffer->writeReservedLength) {
+                if (pRingBuffer->writeReservedForced && (length > 0)) {
+                    // Move on the read pointers that the written data
+                    // has caught up with; the reservation was limited
+                    // by the locked ones so only a read pointer locked
+                    // since could be among them and, since its data
+                    // has been written over, it has to move too.
+                    // The flag must be clear for readableSize() to let
+                    // add() move them.
+                    pRingBuffer->writeReservedForced = false;
+                    lockBitmap = pRingBuffer->dataReadLockBitmap;
+                    pRingBuffer->dataReadLockBitmap = 0;
+                    add(pRingBuffer, NULL, length, true);
+                    pRingBuffer->dataReadLockBitmap = lockBitmap;
+                }
+                pRingBuffer->pDataWrite = (char *) pPtrOffset(pRingBuffer->pDataWrite, length,
+                                                              pRingBuffer->pBuffer,
+                                                              pRingBuffer->size);
+                committed = true;
+            }
+            pRingBuffer->writeReservedLength = 0;
+            pRingBuffer->writeReservedForced = false;
+
+            U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        }
+    }
+
+    return committed;
+}
+
 size_t uRingBufferRead(uRingBuffer_t *pRingBuffer, char *pData, size_t length)
 {
     size_t bytesRead = 0;
 
     if ((pRingBuffer->pBuffer != NULL) && !pRingBuffer->readHandleRequired) {
+        if (pRingBuffer->lockFree) {
+            bytesRead = readLockFree(pRingBuffer, pData, length, 0, true);
+        } else {
 
-        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+            U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
-        bytesRead = read(pRingBuffer, 0, pData, length, 0, true);
+            bytesRead = read(pRingBuffer, 0, pData, length, 0, true);
+            if (bytesRead > 0) {
+                readPointerMoved(pRingBuffer, 0);
+            }
 
-        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+            U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        }
     }
 
     return bytesRead;
@@ -469,31 +886,69 @@ size_t uRingBufferPeek(uRingBuffer_t *pRingBuffer, char *pData, size_t length,
     size_t bytesRead = 0;
 
     if ((pRingBuffer->pBuffer != NULL) && !pRingBuffer->readHandleRequired) {
+        if (pRingBuffer->lockFree) {
+            bytesRead = readLockFree(pRingBuffer, pData, length, offset, false);
+        } else {
 
-        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+            U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
-        bytesRead = read(pRingBuffer, 0, pData, length, offset, false);
+            bytesRead = read(pRingBuffer, 0, pData, length, offset, false);
 
-        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+            U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        }
     }
 
     return bytesRead;
 }
 
+size_t uRingBufferReadSpans(uRingBuffer_t *pRingBuffer,
+                            const char **ppSpan1, size_t *pSpan1Length,
+                            const char **ppSpan2, size_t *pSpan2Length)
+{
+    size_t length = 0;
+
+    if (!pRingBuffer->readHandleRequired) {
+        length = readSpans(pRingBuffer, 0, ppSpan1, pSpan1Length,
+                           ppSpan2, pSpan2Length);
+    } else {
+        *ppSpan1 = NULL;
+        *pSpan1Length = 0;
+        if ((ppSpan2 != NULL) && (pSpan2Length != NULL)) {
+            *ppSpan2 = NULL;
+            *pSpan2Length = 0;
+        }
+    }
+
+    return length;
+}
+
+size_t uRingBufferConsume(uRingBuffer_t *pRingBuffer, size_t length)
+{
+    // A read that throws the data away does exactly this
+    return uRingBufferRead(pRingBuffer, NULL, length);
+}
+
 size_t uRingBufferDataSize(const uRingBuffer_t *pRingBuffer)
 {
     size_t dataSize = 0;
 
     if (pRingBuffer->pBuffer != NULL) {
+        if (pRingBuffer->lockFree) {
+            // Either task may ask this, hence both are atomic
+            dataSize = ptrDiff(U_ATOMIC_LOAD_ACQUIRE_PTR(&(pRingBuffer->pDataRead[0])),
+                               U_ATOMIC_LOAD_ACQUIRE_PTR(&(pRingBuffer->pDataWrite)),
+                               pRingBuffer->size);
+        } else {
+
+            U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+
+            if (!pRingBuffer->readHandleRequired) {
+                // Only report if the non-handled read can be used
+                dataSize = ptrDiff(pRingBuffer->pDataRead[0], pRingBuffer->pDataWrite, pRingBuffer->size);
+            }
 
-        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
-
-        if (!pRingBuffer->readHandleRequired) {
-            // Only report if the non-handled read can be used
-            dataSize = ptrDiff(pRingBuffer->pDataRead[0], pRingBuffer->pDataWrite, pRingBuffer->size);
+            U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
         }
-
-        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
     }
 
     return dataSize;
@@ -501,18 +956,33 @@ size_t uRingBufferDataSize(const uRingBuffer_t *pRingBuffer)
 
 size_t uRingBufferAvailableSize(const uRingBuffer_t *pRingBuffer)
 {
-    return availableSize(pRingBuffer, false);
+    size_t size = 0;
+
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->lockFree) {
+        // Must keep one to prevent pointer wrap
+        size = pRingBuffer->size - 1 - uRingBufferDataSize(pRingBuffer);
+    } else {
+        size = availableSize(pRingBuffer, false);
+    }
+
+    return size;
 }
 
 void uRingBufferFlush(uRingBuffer_t *pRingBuffer)
 {
     if (pRingBuffer->pBuffer != NULL) {
+        if (pRingBuffer->lockFree) {
+            U_ATOMIC_STORE_RELEASE_PTR(&(pRingBuffer->pDataRead[0]),
+                                       U_ATOMIC_LOAD_ACQUIRE_PTR(&(pRingBuffer->pDataWrite)));
+        } else {
 
-        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+            U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
-        pRingBuffer->pDataRead[0] = pRingBuffer->pDataWrite;
+            pRingBuffer->pDataRead[0] = pRingBuffer->pDataWrite;
+            readPointerMoved(pRingBuffer, 0);
 
-        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+            U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+        }
     }
 }
 
@@ -560,6 +1030,121 @@ size_t uRingBufferStatAddLoss(uRingBuffer_t *pRingBuffer)
     return bytesLost;
 }
 
+size_t uRingBufferStatFillMax(uRingBuffer_t *pRingBuffer, bool reset)
+{
+    size_t fillMax = 0;
+
+    if (pRingBuffer->pBuffer != NULL) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+
+        fillMax = pRingBuffer->statFillMaxNormalBytes;
+        if (reset) {
+            pRingBuffer->statFillMaxNormalBytes = ptrDiff(pRingBuffer->pDataRead[0],
+                                                          pRingBuffer->pDataWrite,
+                                                          pRingBuffer->size);
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+    }
+
+    return fillMax;
+}
+
+int32_t uRingBufferResize(uRingBuffer_t *pRingBuffer, char *pLinearBuffer,
+                          size_t size)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    const char *pOldest;
+    size_t usedLocked = 0;
+    size_t used = 0;
+    size_t x;
+
+    if (pRingBuffer->pBuffer != NULL) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pLinearBuffer != NULL) && (size > 0) && !pRingBuffer->lockFree &&
+            (pRingBuffer->writeReservedLength == 0)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            // Find the most data waiting for any read pointer and
+            // for any locked read pointer; data for the "normal"
+            // read pointer is of no interest if it cannot be read
+            for (size_t y = 0; y < pRingBuffer->maxNumReadPointers; y++) {
+                if ((pRingBuffer->pDataRead[y] != NULL) &&
+                    ((y > 0) || !pRingBuffer->readHandleRequired)) {
+                    x = ptrDiff(pRingBuffer->pDataRead[y], pRingBuffer->pDataWrite,
+                                pRingBuffer->size);
+                    if (x > used) {
+                        used = x;
+                    }
+                    if ((y > 0) && (pRingBuffer->dataReadLockBitmap & (1ULL << (y - 1))) &&
+                        (x > usedLocked)) {
+                        usedLocked = x;
+                    }
+                }
+            }
+            // Must keep one to prevent pointer wrap
+            if (usedLocked < size) {
+                // Unlocked read pointers lose the oldest of their data
+                // if it won't fit, just as they would for a forced add
+                if (used >= size) {
+                    used = size - 1;
+                }
+                pOldest = pPtrOffset(pRingBuffer->pDataWrite, pRingBuffer->size - used,
+                                     pRingBuffer->pBuffer, pRingBuffer->size);
+                // Copy the data across, unwrapping it as we go
+                x = (pRingBuffer->pBuffer + pRingBuffer->size) - pOldest;
+                if (x > used) {
+                    x = used;
+                }
+                memcpy(pLinearBuffer, pOldest, x);
+                memcpy(pLinearBuffer + x, pRingBuffer->pBuffer, used - x);
+                if (pRingBuffer->readHandleRequired) {
+                    // Nothing for the "normal" read pointer to keep
+                    pRingBuffer->pDataRead[0] = pRingBuffer->pDataWrite;
+                }
+                // Move the read pointers so that each has the same
+                // amount of data behind the new write pointer
+                for (size_t y = 0; y < pRingBuffer->maxNumReadPointers; y++) {
+                    if (pRingBuffer->pDataRead[y] != NULL) {
+                        x = ptrDiff(pRingBuffer->pDataRead[y], pRingBuffer->pDataWrite,
+                                    pRingBuffer->size);
+                        if (x > used) {
+                            if (y == 0) {
+                                pRingBuffer->statReadLossNormalBytes += x - used;
+                            } else {
+                                pRingBuffer->statReadLossBytes[y] += x - used;
+                            }
+                            x = used;
+                        }
+                        pRingBuffer->pDataRead[y] = pLinearBuffer + used - x;
+                    }
+                }
+                pRingBuffer->pDataWrite = pLinearBuffer + used;
+                pRingBuffer->pBuffer = pLinearBuffer;
+                pRingBuffer->size = size;
+                updateSlowest(pRingBuffer);
+                // A smaller ring buffer can't have held as much
+                if (pRingBuffer->statFillMaxNormalBytes >= size) {
+                    pRingBuffer->statFillMaxNormalBytes = size - 1;
+                }
+                for (size_t y = 1; y < pRingBuffer->maxNumReadPointers; y++) {
+                    if (pRingBuffer->statFillMaxBytes[y] >= size) {
+                        pRingBuffer->statFillMaxBytes[y] = size - 1;
+                    }
+                }
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: MULTIPLE READERS
  * -------------------------------------------------------------- */
@@ -573,13 +1158,16 @@ int32_t uRingBufferCreateWithReadHandle(uRingBuffer_t *pRingBuffer, char *pLinea
     maxNumReadHandles++; // Add one more for the non-handled read
     pRingBuffer->pDataRead = (const char **) malloc((maxNumReadHandles) * sizeof(const char *));
     pRingBuffer->statReadLossBytes = (size_t *) malloc((maxNumReadHandles) * sizeof(size_t));
+    pRingBuffer->statFillMaxBytes = (size_t *) malloc((maxNumReadHandles) * sizeof(size_t));
     if ((pRingBuffer->pDataRead != NULL) && (pRingBuffer->statReadLossBytes != NULL) &&
+        (pRingBuffer->statFillMaxBytes != NULL) &&
         (maxNumReadHandles < (sizeof(pRingBuffer->dataReadLockBitmap) * 8))) {
         pRingBuffer->isMalloced = true;
         pRingBuffer->maxNumReadPointers = maxNumReadHandles;
         for (size_t x = 0; x < pRingBuffer->maxNumReadPointers; x++) {
             pRingBuffer->pDataRead[x] = NULL;
             pRingBuffer->statReadLossBytes[x] = 0;
+            pRingBuffer->statFillMaxBytes[x] = 0;
         }
         errorCode = createCommon(pRingBuffer, pLinearBuffer, size);
     }
@@ -588,6 +1176,8 @@ int32_t uRingBufferCreateWithReadHandle(uRingBuffer_t *pRingBuffer, char *pLinea
         pRingBuffer->pDataRead = NULL;
         free(pRingBuffer->statReadLossBytes);
         pRingBuffer->statReadLossBytes = NULL;
+        free(pRingBuffer->statFillMaxBytes);
+        pRingBuffer->statFillMaxBytes = NULL;
         pRingBuffer->maxNumReadPointers = 0;
     }
 
@@ -607,6 +1197,7 @@ void uRingBufferSetReadRequiresHandle(uRingBuffer_t *pRingBuffer, bool onNotOff)
             pRingBuffer->pDataRead[0] = pRingBuffer->pDataWrite;
         }
         pRingBuffer->readHandleRequired = onNotOff;
+        updateSlowest(pRingBuffer);
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
     }
@@ -633,9 +1224,14 @@ int32_t uRingBufferTakeReadHandle(uRingBuffer_t *pRingBuffer)
             if (pRingBuffer->pDataRead[x] == NULL) {
                 pRingBuffer->pDataRead[x] = pRingBuffer->pDataWrite;
                 pRingBuffer->statReadLossBytes[x] = 0;
+                pRingBuffer->statFillMaxBytes[x] = 0;
                 readHandle = x;
             }
         }
+        if ((readHandle > 0) && (pRingBuffer->slowestReadIndex < 0)) {
+            // Nothing was waiting, now this is
+            updateSlowest(pRingBuffer);
+        }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
     }
@@ -652,6 +1248,7 @@ void uRingBufferGiveReadHandle(uRingBuffer_t *pRingBuffer, int32_t handle)
         if ((handle >= 1) && (handle < (int32_t) pRingBuffer->maxNumReadPointers)) {
             pRingBuffer->pDataRead[handle] = NULL;
             pRingBuffer->dataReadLockBitmap &= ~(1ULL << (handle - 1));
+            readPointerMoved(pRingBuffer, handle);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
@@ -700,6 +1297,9 @@ size_t uRingBufferReadHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
         bytesRead = read(pRingBuffer, handle, pData, length, 0, true);
+        if (bytesRead > 0) {
+            readPointerMoved(pRingBuffer, handle);
+        }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
     }
@@ -724,6 +1324,21 @@ size_t uRingBufferPeekHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
     return bytesRead;
 }
 
+size_t uRingBufferReadSpansHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
+                                  const char **ppSpan1, size_t *pSpan1Length,
+                                  const char **ppSpan2, size_t *pSpan2Length)
+{
+    return readSpans(pRingBuffer, handle, ppSpan1, pSpan1Length,
+                     ppSpan2, pSpan2Length);
+}
+
+size_t uRingBufferConsumeHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
+                                size_t length)
+{
+    // A read that throws the data away does exactly this
+    return uRingBufferReadHandle(pRingBuffer, handle, NULL, length);
+}
+
 size_t uRingBufferDataSizeHandle(const uRingBuffer_t *pRingBuffer, int32_t handle)
 {
     size_t dataSize = 0;
@@ -757,6 +1372,7 @@ void uRingBufferFlushHandle(uRingBuffer_t *pRingBuffer, int32_t handle)
         if ((handle >= 1) && (handle < (int32_t) pRingBuffer->maxNumReadPointers) &&
             (pRingBuffer->pDataRead[handle] != NULL)) {
             pRingBuffer->pDataRead[handle] = pRingBuffer->pDataWrite;
+            readPointerMoved(pRingBuffer, handle);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
@@ -783,6 +1399,31 @@ size_t uRingBufferStatReadLossHandle(uRingBuffer_t *pRingBuffer,
     return bytesLost;
 }
 
+size_t uRingBufferStatFillMaxHandle(uRingBuffer_t *pRingBuffer,
+                                    int32_t handle, bool reset)
+{
+    size_t fillMax = 0;
+
+    if (pRingBuffer->pBuffer != NULL) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+
+        if ((handle >= 1) && (handle < (int32_t) pRingBuffer->maxNumReadPointers) &&
+            (pRingBuffer->pDataRead[handle] != NULL)) {
+            fillMax = pRingBuffer->statFillMaxBytes[handle];
+            if (reset) {
+                pRingBuffer->statFillMaxBytes[handle] = ptrDiff(pRingBuffer->pDataRead[handle],
+                                                                pRingBuffer->pDataWrite,
+                                                                pRingBuffer->size);
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+    }
+
+    return fillMax;
+}
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: PARSER
  * -------------------------------------------------------------- */
@@ -858,4 +1499,23 @@ size_t uRingBufferBytesAvailableUnprotected(uParseHandle_t parseHandle)
     return pCtx->bytesAvailable;
 }
 
+size_t uRingBufferGetSpanUnprotected(uParseHandle_t parseHandle,
+                                     const char **ppData, size_t size)
+{
+    uRingBufferParseContext_t *pCtx = (uRingBufferParseContext_t *)parseHandle;
+    size_t toEnd = (pCtx->pRingBuffer->pBuffer + pCtx->pRingBuffer->size) - pCtx->pSource;
+    if (size > pCtx->bytesAvailable) {
+        size = pCtx->bytesAvailable;
+    }
+    if (size > toEnd) {
+        size = toEnd;
+    }
+    *ppData = pCtx->pSource;
+    pCtx->pSource = pPtrOffset(pCtx->pSource, size, pCtx->pRingBuffer->pBuffer,
+                               pCtx->pRingBuffer->size);
+    pCtx->bytesParsed += size;
+    pCtx->bytesAvailable -= size;
+    return size;
+}
+
 // End of file
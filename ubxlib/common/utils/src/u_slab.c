@@ -0,0 +1,211 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the slab allocator.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdlib.h"    // malloc() and free()
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+
+#include "u_compiler.h" // U_ATOMIC_xxx
+#include "u_error_common.h"
+#include "u_port_os.h"  // Required by u_mempool.h
+#include "u_mempool.h"
+#include "u_slab.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The number of uint64_t's needed for the buffer of a size class,
+ * uint64_t being used to get the alignment right.
+ */
+#define U_SLAB_BUFFER_LENGTH_UINT64(blockSize, numBlocks) \
+    ((U_MEMPOOL_BUFFER_SIZE_BYTES(blockSize, numBlocks) + sizeof(uint64_t) - 1) / \
+     sizeof(uint64_t))
+
+/** Values for gInitState.
+ */
+#define U_SLAB_INIT_STATE_NONE        0
+#define U_SLAB_INIT_STATE_IN_PROGRESS 1
+#define U_SLAB_INIT_STATE_DONE        2
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Definition of a size class.
+ */
+typedef struct {
+    size_t blockSize;
+    int32_t numBlocks;
+    uint64_t *pBuffer;
+} uSlabSizeClass_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Storage for the size classes.
+ */
+static uint64_t gBufferSizeClass0[U_SLAB_BUFFER_LENGTH_UINT64(U_SLAB_SIZE_CLASS_0_BYTES,
+                                                              U_SLAB_SIZE_CLASS_0_NUM_BLOCKS)];
+static uint64_t gBufferSizeClass1[U_SLAB_BUFFER_LENGTH_UINT64(U_SLAB_SIZE_CLASS_1_BYTES,
+                                                              U_SLAB_SIZE_CLASS_1_NUM_BLOCKS)];
+static uint64_t gBufferSizeClass2[U_SLAB_BUFFER_LENGTH_UINT64(U_SLAB_SIZE_CLASS_2_BYTES,
+                                                              U_SLAB_SIZE_CLASS_2_NUM_BLOCKS)];
+static uint64_t gBufferSizeClass3[U_SLAB_BUFFER_LENGTH_UINT64(U_SLAB_SIZE_CLASS_3_BYTES,
+                                                              U_SLAB_SIZE_CLASS_3_NUM_BLOCKS)];
+
+/** The size classes, smallest first.
+ */
+static const uSlabSizeClass_t gSizeClass[U_SLAB_NUM_SIZE_CLASSES] = {
+    {U_SLAB_SIZE_CLASS_0_BYTES, U_SLAB_SIZE_CLASS_0_NUM_BLOCKS, gBufferSizeClass0},
+    {U_SLAB_SIZE_CLASS_1_BYTES, U_SLAB_SIZE_CLASS_1_NUM_BLOCKS, gBufferSizeClass1},
+    {U_SLAB_SIZE_CLASS_2_BYTES, U_SLAB_SIZE_CLASS_2_NUM_BLOCKS, gBufferSizeClass2},
+    {U_SLAB_SIZE_CLASS_3_BYTES, U_SLAB_SIZE_CLASS_3_NUM_BLOCKS, gBufferSizeClass3}
+};
+
+/** A memory pool for each size class.
+ */
+static uMemPoolDesc_t gPool[U_SLAB_NUM_SIZE_CLASSES];
+
+/** The number of allocations that had to come from the heap,
+ * indexed by the size class they would have fitted into.
+ */
+static int32_t gHeapAllocCount[U_SLAB_NUM_SIZE_CLASSES] = {0};
+
+/** Where we are with initialisation.
+ */
+static int32_t gInitState = U_SLAB_INIT_STATE_NONE;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Initialise the memory pools, if not already done, returning
+// true if they are ready for use.  No mutex is available to
+// protect this so, should a second task arrive while the first
+// is still initialising, false is returned and that allocation
+// will come from the heap.
+static bool init(void)
+{
+    bool initialised = (U_ATOMIC_LOAD_ACQUIRE(&gInitState) == U_SLAB_INIT_STATE_DONE);
+
+    if (!initialised &&
+        U_ATOMIC_COMPARE_AND_SWAP(&gInitState, U_SLAB_INIT_STATE_NONE,
+                                  U_SLAB_INIT_STATE_IN_PROGRESS)) {
+        for (size_t x = 0; x < U_SLAB_NUM_SIZE_CLASSES; x++) {
+            uMemPoolInitWithBuffer(&gPool[x], (uint32_t) gSizeClass[x].blockSize,
+                                   gSizeClass[x].numBlocks,
+                                   (uint8_t *) gSizeClass[x].pBuffer);
+        }
+        U_ATOMIC_ADD_FETCH(&gInitState, 1);
+        initialised = true;
+    }
+
+    return initialised;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Allocate memory.
+void *pUSlabAlloc(size_t size)
+{
+    void *pMem = NULL;
+    int32_t firstSizeClass = -1;
+
+    if (init()) {
+        for (size_t x = 0; (x < U_SLAB_NUM_SIZE_CLASSES) && (pMem == NULL); x++) {
+            if (size <= gSizeClass[x].blockSize) {
+                if (firstSizeClass < 0) {
+                    firstSizeClass = (int32_t) x;
+                }
+                pMem = uMemPoolAllocMem(&gPool[x]);
+            }
+        }
+    }
+
+    if (pMem == NULL) {
+        if (firstSizeClass >= 0) {
+            U_ATOMIC_ADD_FETCH(&gHeapAllocCount[firstSizeClass], 1);
+        }
+        pMem = malloc(size);
+    }
+
+    return pMem;
+}
+
+// Free memory.
+void uSlabFree(void *pMem)
+{
+    uint8_t *pBuffer;
+    bool freed = false;
+
+    if (pMem != NULL) {
+        for (size_t x = 0; (x < U_SLAB_NUM_SIZE_CLASSES) && !freed; x++) {
+            pBuffer = (uint8_t *) gSizeClass[x].pBuffer;
+            if (((uint8_t *) pMem >= pBuffer) &&
+                ((uint8_t *) pMem < pBuffer + U_MEMPOOL_BUFFER_SIZE_BYTES(gSizeClass[x].blockSize,
+                                                                          gSizeClass[x].numBlocks))) {
+                uMemPoolFreeMem(&gPool[x], pMem);
+                freed = true;
+            }
+        }
+        if (!freed) {
+            free(pMem);
+        }
+    }
+}
+
+// Get the statistics for a size class.
+int32_t uSlabGetStats(int32_t sizeClass, uSlabStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uMemPoolStats_t poolStats = {0};
+
+    if ((sizeClass >= 0) && (sizeClass < U_SLAB_NUM_SIZE_CLASSES) &&
+        (pStats != NULL)) {
+        if (U_ATOMIC_LOAD_ACQUIRE(&gInitState) == U_SLAB_INIT_STATE_DONE) {
+            uMemPoolGetStats(&gPool[sizeClass], &poolStats);
+        }
+        pStats->blockSize = gSizeClass[sizeClass].blockSize;
+        pStats->numBlocks = gSizeClass[sizeClass].numBlocks;
+        pStats->usedBlockCount = poolStats.usedBlockCount;
+        pStats->maxUsedBlockCount = poolStats.maxUsedBlockCount;
+        pStats->heapAllocCount = U_ATOMIC_LOAD_ACQUIRE(&gHeapAllocCount[sizeClass]);
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// End of file
@@ -45,47 +45,105 @@
  * STATIC VARIABLES
  * -------------------------------------------------------------- */
 
-static const char gDaysInMonth[] = {31, 28, 31, 30, 31, 30, 31,
-                                    31, 30, 31, 30, 31
-                                   };
-static const char gDaysInMonthLeapYear[] = {31, 29, 31, 30, 31, 30,
-                                            31, 31, 30, 31, 30, 31
-                                           };
-
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Integer division rounding towards minus infinity, divisor positive.
+static int64_t floorDiv(int64_t dividend, int64_t divisor)
+{
+    int64_t quotient = dividend / divisor;
+
+    if ((dividend % divisor) < 0) {
+        quotient--;
+    }
+
+    return quotient;
+}
+
+// Days since the start of 1970 for a date with the month 1 to 12;
+// the same as U_TIME_DAYS_FROM_CIVIL() without evaluating anything
+// twice.
+static int64_t daysFromCivil(int64_t year, int32_t month, int32_t day)
+{
+    int64_t era;
+    int32_t yearOfEra;
+    int32_t dayOfYear;
+
+    // Count years from March so that the leap day is at the end
+    if (month <= 2) {
+        year--;
+    }
+    era = floorDiv(year, 400);
+    yearOfEra = (int32_t) (year - (era * 400));
+    dayOfYear = (((153 * (month + ((month > 2) ? -3 : 9))) + 2) / 5) + day - 1;
+
+    return (era * 146097) + (yearOfEra * 365) + (yearOfEra / 4) -
+           (yearOfEra / 100) + dayOfYear - 719468;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
 
 bool uTimeIsLeapYear(int32_t year)
 {
-    bool isLeapYear = false;
-
-    if (year % 400 == 0) {
-        isLeapYear = true;
-    } else if (year % 4 == 0) {
-        isLeapYear = true;
-    }
-
-    return isLeapYear;
+    return ((year % 4 == 0) && (year % 100 != 0)) || (year % 400 == 0);
 }
 
 int64_t uTimeMonthsToSecondsUtc(int32_t monthsUtc)
 {
     int64_t secondsUtc = 0;
 
-    for (int32_t x = 0; x < monthsUtc; x++) {
-        if (uTimeIsLeapYear((x / 12) + 1970)) {
-            secondsUtc += gDaysInMonthLeapYear[x % 12] * 3600 * 24;
-        } else {
-            secondsUtc += gDaysInMonth[x % 12] * 3600 * 24;
-        }
+    if (monthsUtc > 0) {
+        secondsUtc = daysFromCivil(1970 + (monthsUtc / 12), (monthsUtc % 12) + 1, 1) *
+                     U_TIME_SECONDS_PER_DAY;
     }
 
     return secondsUtc;
 }
 
+int64_t uTimeDateToEpoch(const uTimeDate_t *pDate)
+{
+    int64_t year = pDate->year;
+    int32_t month = pDate->month - 1;
+
+    // Bring the month into range, adjusting the year to match
+    if ((month < 0) || (month > 11)) {
+        year += floorDiv(month, 12);
+        month -= (int32_t) (floorDiv(month, 12) * 12);
+    }
+
+    return (daysFromCivil(year, month + 1, pDate->day) * U_TIME_SECONDS_PER_DAY) +
+           ((int64_t) pDate->hours * 3600) + ((int64_t) pDate->minutes * 60) +
+           pDate->seconds;
+}
+
+void uTimeEpochToDate(int64_t epoch, uTimeDate_t *pDate)
+{
+    int64_t days = floorDiv(epoch, U_TIME_SECONDS_PER_DAY);
+    int32_t seconds = (int32_t) (epoch - (days * U_TIME_SECONDS_PER_DAY));
+    int64_t era;
+    int32_t dayOfEra;
+    int32_t yearOfEra;
+    int32_t dayOfYear;
+    int32_t monthFromMarch;
+
+    // The inverse of daysFromCivil(): count from the 1st of March
+    // of the year 0, split into 400 year eras of 146097 days
+    days += 719468;
+    era = floorDiv(days, 146097);
+    dayOfEra = (int32_t) (days - (era * 146097));
+    yearOfEra = (dayOfEra - (dayOfEra / 1460) + (dayOfEra / 36524) -
+                 (dayOfEra / 146096)) / 365;
+    dayOfYear = dayOfEra - ((365 * yearOfEra) + (yearOfEra / 4) - (yearOfEra / 100));
+    monthFromMarch = ((5 * dayOfYear) + 2) / 153;
+    pDate->day = dayOfYear - (((153 * monthFromMarch) + 2) / 5) + 1;
+    pDate->month = (monthFromMarch < 10) ? monthFromMarch + 3 : monthFromMarch - 9;
+    pDate->year = (int32_t) ((era * 400) + yearOfEra + ((pDate->month <= 2) ? 1 : 0));
+    pDate->hours = seconds / 3600;
+    pDate->minutes = (seconds % 3600) / 60;
+    pDate->seconds = seconds % 60;
+}
+
 // End of file
@@ -0,0 +1,313 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Test for the arena allocator API
+ */
+
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stdlib.h"    // malloc(), free()
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t, uintptr_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+#include "u_arena.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_ARENA_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/** The size of linear buffer to use in testing, deliberately
+ * not a multiple of #U_ARENA_ALIGNMENT_BYTES.
+ */
+#define U_TEST_ARENA_BUFFER_SIZE_BYTES 101
+
+#ifndef U_TEST_ARENA_NUM_REQUESTS
+/** The number of back-to-back requests to simulate in the
+ * arenaRequests test.
+ */
+# define U_TEST_ARENA_NUM_REQUESTS 1000
+#endif
+
+/** The sizes of the buffers of a simulated request, the same as
+ * those of a Cloud Locate request: a topic, then the RRLP buffer,
+ * released after sending, then a read topic and message buffer.
+ */
+#define U_TEST_ARENA_REQUEST_TOPIC_BYTES 128
+#define U_TEST_ARENA_REQUEST_RRLP_BYTES 1024
+#define U_TEST_ARENA_REQUEST_MESSAGE_BYTES (512 + 1)
+
+/** The arena size needed for a simulated request.
+ */
+#define U_TEST_ARENA_REQUEST_SIZE_BYTES (U_ARENA_ALLOC_SIZE_BYTES(U_TEST_ARENA_REQUEST_TOPIC_BYTES) + \
+                                         U_ARENA_ALLOC_SIZE_BYTES(U_TEST_ARENA_REQUEST_RRLP_BYTES))
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** A linear buffer for testing, with a little extra
+ * to check for overruns.
+ */
+static char gLinearBuffer[U_TEST_ARENA_BUFFER_SIZE_BYTES + U_ARENA_ALIGNMENT_BYTES];
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Run a simulated request using the given arena, returning true
+// on success.
+static bool request(uArena_t *pArena)
+{
+    bool success = false;
+    char *pTopic;
+    char *pRrlp;
+    char *pTopicRead;
+    char *pMessage;
+    size_t mark;
+
+    pTopic = (char *) pUArenaAlloc(pArena, U_TEST_ARENA_REQUEST_TOPIC_BYTES);
+    mark = uArenaGetMark(pArena);
+    pRrlp = (char *) pUArenaAlloc(pArena, U_TEST_ARENA_REQUEST_RRLP_BYTES);
+    if ((pTopic != NULL) && (pRrlp != NULL)) {
+        memset(pTopic, 't', U_TEST_ARENA_REQUEST_TOPIC_BYTES);
+        memset(pRrlp, 'r', U_TEST_ARENA_REQUEST_RRLP_BYTES);
+        uArenaRewind(pArena, mark);
+        pTopicRead = (char *) pUArenaAlloc(pArena, U_TEST_ARENA_REQUEST_TOPIC_BYTES);
+        pMessage = (char *) pUArenaAlloc(pArena, U_TEST_ARENA_REQUEST_MESSAGE_BYTES);
+        if ((pTopicRead != NULL) && (pMessage != NULL)) {
+            memset(pTopicRead, 'T', U_TEST_ARENA_REQUEST_TOPIC_BYTES);
+            memset(pMessage, 'm', U_TEST_ARENA_REQUEST_MESSAGE_BYTES);
+            // The topic must have survived the rewind
+            success = (*pTopic == 't') &&
+                      (*(pTopic + U_TEST_ARENA_REQUEST_TOPIC_BYTES - 1) == 't');
+        }
+    }
+
+    return success;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TESTS
+ * -------------------------------------------------------------- */
+
+/** Basic test of the arena allocator.
+ */
+U_PORT_TEST_FUNCTION("[arena]", "arenaBasic")
+{
+    uArena_t arena;
+    char *pLinearBuffer;
+    char *pMem[(U_TEST_ARENA_BUFFER_SIZE_BYTES / U_ARENA_ALIGNMENT_BYTES) + 1];
+    size_t used;
+    size_t mark;
+    size_t x;
+    int32_t heapUsed;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+
+    U_PORT_TEST_ASSERT(uArenaCreate(NULL, gLinearBuffer, sizeof(gLinearBuffer)) < 0);
+    uArenaDelete(NULL);
+
+    // Use a deliberately misaligned linear buffer
+    pLinearBuffer = gLinearBuffer;
+    if (((uintptr_t) pLinearBuffer % U_ARENA_ALIGNMENT_BYTES) == 0) {
+        pLinearBuffer++;
+    }
+    memset(gLinearBuffer, 0xFF, sizeof(gLinearBuffer));
+    U_PORT_TEST_ASSERT(uArenaCreate(&arena, pLinearBuffer, U_TEST_ARENA_BUFFER_SIZE_BYTES) == 0);
+    U_PORT_TEST_ASSERT(uArenaGetUsed(&arena) == 0);
+    U_PORT_TEST_ASSERT(uArenaGetHighWaterMark(&arena) == 0);
+    U_PORT_TEST_ASSERT(uArenaGetAllocFailCount(&arena) == 0);
+
+    // Too big
+    U_PORT_TEST_ASSERT(pUArenaAlloc(&arena, U_TEST_ARENA_BUFFER_SIZE_BYTES) == NULL);
+    U_PORT_TEST_ASSERT(pUArenaAlloc(&arena, (size_t) -1) == NULL);
+    U_PORT_TEST_ASSERT(uArenaGetAllocFailCount(&arena) == 2);
+    U_PORT_TEST_ASSERT(uArenaGetUsed(&arena) == 0);
+
+    // Fill the arena with single bytes: each should be
+    // aligned, within the linear buffer and take one
+    // alignment unit
+    for (x = 0; x < sizeof(pMem) / sizeof(pMem[0]); x++) {
+        pMem[x] = (char *) pUArenaAlloc(&arena, 1);
+        if (pMem[x] == NULL) {
+            break;
+        }
+        U_PORT_TEST_ASSERT(((uintptr_t) pMem[x] % U_ARENA_ALIGNMENT_BYTES) == 0);
+        U_PORT_TEST_ASSERT(pMem[x] >= pLinearBuffer);
+        U_PORT_TEST_ASSERT(pMem[x] < pLinearBuffer + U_TEST_ARENA_BUFFER_SIZE_BYTES);
+        if (x > 0) {
+            U_PORT_TEST_ASSERT(pMem[x] == pMem[x - 1] + U_ARENA_ALIGNMENT_BYTES);
+        }
+        *pMem[x] = (char) x;
+    }
+    U_PORT_TEST_ASSERT(x >= (U_TEST_ARENA_BUFFER_SIZE_BYTES / U_ARENA_ALIGNMENT_BYTES) - 1);
+    U_PORT_TEST_ASSERT(x <= U_TEST_ARENA_BUFFER_SIZE_BYTES / U_ARENA_ALIGNMENT_BYTES);
+    U_PORT_TEST_ASSERT(uArenaGetAllocFailCount(&arena) == 3);
+    used = uArenaGetUsed(&arena);
+    U_PORT_TEST_ASSERT(used == x * U_ARENA_ALIGNMENT_BYTES);
+    U_PORT_TEST_ASSERT(uArenaGetHighWaterMark(&arena) == used);
+    for (size_t y = 0; y < x; y++) {
+        U_PORT_TEST_ASSERT(*pMem[y] == (char) y);
+    }
+    // Nothing outside the linear buffer should have been touched
+    for (char *pTmp = gLinearBuffer; pTmp < pLinearBuffer; pTmp++) {
+        U_PORT_TEST_ASSERT(*pTmp == (char) 0xFF);
+    }
+    for (char *pTmp = pLinearBuffer + U_TEST_ARENA_BUFFER_SIZE_BYTES;
+         pTmp < gLinearBuffer + sizeof(gLinearBuffer); pTmp++) {
+        U_PORT_TEST_ASSERT(*pTmp == (char) 0xFF);
+    }
+
+    // Rewind to a mark half-way and allocate again: should get
+    // the same memory back, a mark beyond the fill level should
+    // be ignored
+    uArenaRewind(&arena, (x / 2) * U_ARENA_ALIGNMENT_BYTES);
+    mark = uArenaGetMark(&arena);
+    U_PORT_TEST_ASSERT(mark == (x / 2) * U_ARENA_ALIGNMENT_BYTES);
+    uArenaRewind(&arena, mark + U_ARENA_ALIGNMENT_BYTES);
+    U_PORT_TEST_ASSERT(uArenaGetUsed(&arena) == mark);
+    U_PORT_TEST_ASSERT(pUArenaAlloc(&arena, 1) == pMem[x / 2]);
+    U_PORT_TEST_ASSERT(uArenaGetHighWaterMark(&arena) == used);
+
+    // Reset and allocate everything in one go
+    uArenaReset(&arena);
+    U_PORT_TEST_ASSERT(uArenaGetUsed(&arena) == 0);
+    U_PORT_TEST_ASSERT(pUArenaAlloc(&arena, used) == pMem[0]);
+    U_PORT_TEST_ASSERT(pUArenaAlloc(&arena, 1) == NULL);
+    U_PORT_TEST_ASSERT(uArenaGetHighWaterMark(&arena) == used);
+    U_PORT_TEST_ASSERT(uArenaGetAllocFailCount(&arena) == 4);
+    uArenaDelete(&arena);
+
+    // Now with a malloc()ed linear buffer
+    U_PORT_TEST_ASSERT(uArenaCreate(&arena, NULL, U_TEST_ARENA_BUFFER_SIZE_BYTES) == 0);
+    pMem[0] = (char *) pUArenaAlloc(&arena, U_TEST_ARENA_BUFFER_SIZE_BYTES -
+                                    U_ARENA_ALIGNMENT_BYTES);
+    U_PORT_TEST_ASSERT(pMem[0] != NULL);
+    memset(pMem[0], 0xAA, U_TEST_ARENA_BUFFER_SIZE_BYTES - U_ARENA_ALIGNMENT_BYTES);
+    uArenaDelete(&arena);
+    // Deleting twice should do no harm
+    uArenaDelete(&arena);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
+/** Run many back-to-back requests, shaped like a Cloud Locate
+ * request, each taking its memory from one arena, and report the
+ * peak memory used.
+ */
+U_PORT_TEST_FUNCTION("[arena]", "arenaRequests")
+{
+    uArena_t arena;
+    int32_t heapUsed;
+    int32_t heapMinFreeStart;
+    int32_t heapMinFreeEnd;
+    int32_t startTimeMs;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    heapMinFreeStart = uPortGetHeapMinFree();
+
+    // First with an arena created per request, as
+    // uLocationPrivateCloudLocate() does, then with one
+    // arena created once and reset between requests
+    startTimeMs = uPortGetTickTimeMs();
+    for (size_t x = 0; x < U_TEST_ARENA_NUM_REQUESTS; x++) {
+        U_PORT_TEST_ASSERT(uArenaCreate(&arena, NULL, U_TEST_ARENA_REQUEST_SIZE_BYTES) == 0);
+        U_PORT_TEST_ASSERT(request(&arena));
+        U_PORT_TEST_ASSERT(uArenaGetHighWaterMark(&arena) == U_TEST_ARENA_REQUEST_SIZE_BYTES);
+        uArenaDelete(&arena);
+    }
+    U_TEST_PRINT_LINE("%d request(s) with an arena each took %d ms,"
+                      " one heap allocation of %d byte(s) per request.",
+                      U_TEST_ARENA_NUM_REQUESTS, uPortGetTickTimeMs() - startTimeMs,
+                      U_TEST_ARENA_REQUEST_SIZE_BYTES);
+
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uArenaCreate(&arena, NULL, U_TEST_ARENA_REQUEST_SIZE_BYTES) == 0);
+    for (size_t x = 0; x < U_TEST_ARENA_NUM_REQUESTS; x++) {
+        U_PORT_TEST_ASSERT(request(&arena));
+        uArenaReset(&arena);
+        U_PORT_TEST_ASSERT(uArenaGetUsed(&arena) == 0);
+    }
+    U_PORT_TEST_ASSERT(uArenaGetHighWaterMark(&arena) == U_TEST_ARENA_REQUEST_SIZE_BYTES);
+    U_PORT_TEST_ASSERT(uArenaGetAllocFailCount(&arena) == 0);
+    U_TEST_PRINT_LINE("%d request(s) with a single arena took %d ms, peak arena"
+                      " use %d byte(s).", U_TEST_ARENA_NUM_REQUESTS,
+                      uPortGetTickTimeMs() - startTimeMs,
+                      (int) uArenaGetHighWaterMark(&arena));
+    uArenaDelete(&arena);
+
+    heapMinFreeEnd = uPortGetHeapMinFree();
+    if ((heapMinFreeStart >= 0) && (heapMinFreeEnd >= 0)) {
+        U_TEST_PRINT_LINE("minimum free heap went from %d to %d byte(s).",
+                          heapMinFreeStart, heapMinFreeEnd);
+    }
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
+// End of file
@@ -0,0 +1,349 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Test for the base 64 API
+ */
+
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stdlib.h"    // malloc(), free()
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // strlen(), memcmp(), memcpy(), memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+#include "u_base64.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_BASE64_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/** The size of binary buffer to use in testing.
+ */
+#define U_TEST_BASE64_BIN_LENGTH_BYTES 1024
+
+#ifndef U_TEST_BASE64_SPEED_MS
+/** How long to run each conversion for when measuring speed.
+ */
+# define U_TEST_BASE64_SPEED_MS 1000
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A pair of binary and base 64 encoded strings.
+ */
+typedef struct {
+    const char *pBinary;
+    const char *pBase64;
+} uTestBase64Vector_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The test vectors from RFC 4648.
+ */
+static const uTestBase64Vector_t gVector[] = {{"", ""},
+    {"f", "Zg=="},
+    {"fo", "Zm8="},
+    {"foo", "Zm9v"},
+    {"foob", "Zm9vYg=="},
+    {"fooba", "Zm9vYmE="},
+    {"foobar", "Zm9vYmFy"}
+};
+
+/** Binary data.
+ */
+static char gBin[U_TEST_BASE64_BIN_LENGTH_BYTES];
+
+/** Somewhere to put binary data that has been converted back.
+ */
+static char gBinOut[U_TEST_BASE64_BIN_LENGTH_BYTES];
+
+/** Base 64 data.
+ */
+static char gBase64[U_BASE64_ENCODED_LENGTH_BYTES(U_TEST_BASE64_BIN_LENGTH_BYTES)];
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Encode gBin in chunks of the given size, returning the
+// number of bytes written to gBase64.
+static size_t encodeChunks(size_t length, size_t chunkSize)
+{
+    uBase64Context_t context;
+    size_t base64Length = 0;
+    size_t thisChunk;
+    int32_t x;
+
+    uBase64EncodeStart(&context);
+    for (size_t y = 0; y < length; y += thisChunk) {
+        thisChunk = chunkSize;
+        if (thisChunk > length - y) {
+            thisChunk = length - y;
+        }
+        x = uBase64EncodeUpdate(&context, gBin + y, thisChunk, gBase64 + base64Length,
+                                U_BASE64_ENCODED_LENGTH_BYTES(thisChunk));
+        U_PORT_TEST_ASSERT(x >= 0);
+        base64Length += x;
+    }
+    x = uBase64EncodeFinish(&context, gBase64 + base64Length,
+                            U_BASE64_ENCODE_FINISH_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(x >= 0);
+
+    return base64Length + x;
+}
+
+// Decode the given base 64 in chunks of the given size into
+// gBinOut, returning the number of bytes decoded or negative
+// error code.
+static int32_t decodeChunks(const char *pBase64, size_t length, size_t chunkSize)
+{
+    uBase64Context_t context;
+    size_t binLength = 0;
+    size_t thisChunk;
+    int32_t x = 0;
+
+    uBase64DecodeStart(&context);
+    for (size_t y = 0; (y < length) && (x >= 0); y += thisChunk) {
+        thisChunk = chunkSize;
+        if (thisChunk > length - y) {
+            thisChunk = length - y;
+        }
+        x = uBase64DecodeUpdate(&context, pBase64 + y, thisChunk, gBinOut + binLength,
+                                U_BASE64_DECODED_LENGTH_MAX_BYTES(thisChunk));
+        if (x >= 0) {
+            binLength += x;
+        }
+    }
+    if (x >= 0) {
+        x = uBase64DecodeFinish(&context, gBinOut + binLength,
+                                U_BASE64_DECODE_FINISH_LENGTH_BYTES);
+        if (x >= 0) {
+            x += (int32_t) binLength;
+        }
+    }
+
+    return x;
+}
+
+// Run a whole-buffer encode or decode repeatedly and return the
+// speed in kbytes (of input) per second.
+static int32_t speedKBytesPerSecond(bool encode)
+{
+    int32_t startTimeMs;
+    int32_t durationMs;
+    int32_t kBytes = 0;
+
+    startTimeMs = uPortGetTickTimeMs();
+    do {
+        if (encode) {
+            uBase64Encode(gBin, sizeof(gBin), gBase64, sizeof(gBase64));
+            kBytes += sizeof(gBin) / 1024;
+        } else {
+            uBase64Decode(gBase64, sizeof(gBase64), gBinOut, sizeof(gBinOut));
+            kBytes += sizeof(gBase64) / 1024;
+        }
+        durationMs = uPortGetTickTimeMs() - startTimeMs;
+    } while (durationMs < U_TEST_BASE64_SPEED_MS);
+
+    return (int32_t) (((int64_t) kBytes * 1000) / durationMs);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TESTS
+ * -------------------------------------------------------------- */
+
+/** Test whole-buffer encode and decode.
+ */
+U_PORT_TEST_FUNCTION("[base64]", "base64Basic")
+{
+    const char *pBinary;
+    const char *pBase64;
+    size_t length;
+    int32_t x;
+
+    for (size_t y = 0; y < sizeof(gVector) / sizeof(gVector[0]); y++) {
+        pBinary = gVector[y].pBinary;
+        pBase64 = gVector[y].pBase64;
+        U_PORT_TEST_ASSERT(uBase64Encode(pBinary, strlen(pBinary), NULL, 0) ==
+                           (int32_t) strlen(pBase64));
+        U_PORT_TEST_ASSERT(U_BASE64_ENCODED_LENGTH_BYTES(strlen(pBinary)) == strlen(pBase64));
+        memset(gBase64, 0, sizeof(gBase64));
+        // Too small a buffer gives the length without encoding
+        if (strlen(pBase64) > 0) {
+            U_PORT_TEST_ASSERT(uBase64Encode(pBinary, strlen(pBinary), gBase64,
+                                             strlen(pBase64) - 1) == (int32_t) strlen(pBase64));
+            U_PORT_TEST_ASSERT(gBase64[0] == 0);
+        }
+        U_PORT_TEST_ASSERT(uBase64Encode(pBinary, strlen(pBinary), gBase64,
+                                         sizeof(gBase64)) == (int32_t) strlen(pBase64));
+        U_PORT_TEST_ASSERT(memcmp(gBase64, pBase64, strlen(pBase64)) == 0);
+        U_PORT_TEST_ASSERT(gBase64[strlen(pBase64)] == 0);
+        U_PORT_TEST_ASSERT(uBase64Decode(pBase64, strlen(pBase64), NULL, 0) ==
+                           (int32_t) strlen(pBinary));
+        U_PORT_TEST_ASSERT(uBase64Decode(pBase64, strlen(pBase64), gBinOut,
+                                         sizeof(gBinOut)) == (int32_t) strlen(pBinary));
+        U_PORT_TEST_ASSERT(memcmp(gBinOut, pBinary, strlen(pBinary)) == 0);
+        // Unpadded should decode to the same thing
+        length = strlen(pBase64);
+        while ((length > 0) && (pBase64[length - 1] == '=')) {
+            length--;
+        }
+        U_PORT_TEST_ASSERT(uBase64Decode(pBase64, length, gBinOut,
+                                         sizeof(gBinOut)) == (int32_t) strlen(pBinary));
+        U_PORT_TEST_ASSERT(memcmp(gBinOut, pBinary, strlen(pBinary)) == 0);
+    }
+
+    // All lengths, decoding back in place
+    for (size_t y = 0; y < sizeof(gBin); y++) {
+        gBin[y] = (char) ((y * 13) + (y >> 8));
+    }
+    for (length = 0; length < 100; length++) {
+        x = uBase64Encode(gBin, length, gBase64, sizeof(gBase64));
+        U_PORT_TEST_ASSERT(x == (int32_t) U_BASE64_ENCODED_LENGTH_BYTES(length));
+        U_PORT_TEST_ASSERT(uBase64Decode(gBase64, x, gBase64, x) == (int32_t) length);
+        U_PORT_TEST_ASSERT(memcmp(gBase64, gBin, length) == 0);
+    }
+
+    // Invalid characters, padding in the middle and a single
+    // character left over are all errors
+    x = uBase64Encode(gBin, 30, gBase64, sizeof(gBase64));
+    for (size_t y = 0; y < (size_t) x; y += 5) {
+        gBase64[y] = '*';
+        U_PORT_TEST_ASSERT(uBase64Decode(gBase64, x, gBinOut, sizeof(gBinOut)) < 0);
+        uBase64Encode(gBin, 30, gBase64, sizeof(gBase64));
+    }
+    U_PORT_TEST_ASSERT(uBase64Decode("Zg==Zg==", 8, gBinOut, sizeof(gBinOut)) < 0);
+    U_PORT_TEST_ASSERT(uBase64Decode("Zm9vY", 5, gBinOut, sizeof(gBinOut)) < 0);
+    U_PORT_TEST_ASSERT(uBase64Decode("Z", 1, gBinOut, sizeof(gBinOut)) < 0);
+    U_PORT_TEST_ASSERT(uBase64Decode("Z", 1, NULL, 0) < 0);
+}
+
+/** Test chunked encode and decode.
+ */
+U_PORT_TEST_FUNCTION("[base64]", "base64Chunked")
+{
+    uBase64Context_t context;
+    size_t base64Length;
+    size_t length;
+    char buffer[U_BASE64_DECODED_LENGTH_MAX_BYTES(8)];
+
+    for (size_t y = 0; y < sizeof(gBin); y++) {
+        gBin[y] = (char) ((y * 13) + (y >> 8));
+    }
+
+    // Every chunk size, including sizes that don't divide
+    // evenly into three or four, against the whole-buffer
+    // functions
+    for (length = 0; length < 50; length += 7) {
+        for (size_t chunkSize = 1; chunkSize < 12; chunkSize++) {
+            base64Length = encodeChunks(length, chunkSize);
+            U_PORT_TEST_ASSERT(base64Length == U_BASE64_ENCODED_LENGTH_BYTES(length));
+            U_PORT_TEST_ASSERT(uBase64Decode(gBase64, base64Length, gBinOut,
+                                             sizeof(gBinOut)) == (int32_t) length);
+            U_PORT_TEST_ASSERT(memcmp(gBinOut, gBin, length) == 0);
+            for (size_t decodeChunkSize = 1; decodeChunkSize < 12; decodeChunkSize++) {
+                memset(gBinOut, 0, sizeof(gBinOut));
+                U_PORT_TEST_ASSERT(decodeChunks(gBase64, base64Length,
+                                                decodeChunkSize) == (int32_t) length);
+                U_PORT_TEST_ASSERT(memcmp(gBinOut, gBin, length) == 0);
+            }
+        }
+    }
+
+    // A big one in one go
+    base64Length = encodeChunks(sizeof(gBin), sizeof(gBin));
+    U_PORT_TEST_ASSERT(decodeChunks(gBase64, base64Length, 100) == sizeof(gBin));
+    U_PORT_TEST_ASSERT(memcmp(gBinOut, gBin, sizeof(gBin)) == 0);
+
+    // Unpadded, and padding split across chunks
+    U_PORT_TEST_ASSERT(decodeChunks("Zm9vYg", 6, 4) == 4);
+    U_PORT_TEST_ASSERT(memcmp(gBinOut, "foob", 4) == 0);
+    U_PORT_TEST_ASSERT(decodeChunks("Zm9vYg==", 8, 7) == 4);
+    U_PORT_TEST_ASSERT(memcmp(gBinOut, "foob", 4) == 0);
+
+    // Errors: data after padding, in the same chunk or the next,
+    // an invalid character and a single character left over
+    U_PORT_TEST_ASSERT(decodeChunks("Zg==Zg==", 8, 8) < 0);
+    U_PORT_TEST_ASSERT(decodeChunks("Zg==Zg==", 8, 4) < 0);
+    U_PORT_TEST_ASSERT(decodeChunks("Zg==Zg==", 8, 3) < 0);
+    U_PORT_TEST_ASSERT(decodeChunks("Zm9v*mFy", 8, 3) < 0);
+    U_PORT_TEST_ASSERT(decodeChunks("Zm9vY", 5, 2) < 0);
+
+    // Too little room
+    uBase64EncodeStart(&context);
+    U_PORT_TEST_ASSERT(uBase64EncodeUpdate(&context, "foobar", 6, buffer, 7) < 0);
+    U_PORT_TEST_ASSERT(uBase64EncodeFinish(&context, buffer, 3) < 0);
+    uBase64DecodeStart(&context);
+    U_PORT_TEST_ASSERT(uBase64DecodeUpdate(&context, "Zm9vYmFy", 8, buffer, 5) < 0);
+    U_PORT_TEST_ASSERT(uBase64DecodeUpdate(&context, "Zm9vYmFy", 8, buffer,
+                                           sizeof(buffer)) == 6);
+    U_PORT_TEST_ASSERT(memcmp(buffer, "foobar", 6) == 0);
+    U_PORT_TEST_ASSERT(uBase64DecodeFinish(&context, buffer, 1) < 0);
+    U_PORT_TEST_ASSERT(uBase64DecodeFinish(&context, buffer, sizeof(buffer)) == 0);
+}
+
+/** Measure the speed of whole-buffer encode and decode.
+ */
+U_PORT_TEST_FUNCTION("[base64]", "base64Speed")
+{
+    int32_t encodeSpeed;
+    int32_t decodeSpeed;
+
+    for (size_t y = 0; y < sizeof(gBin); y++) {
+        gBin[y] = (char) y;
+    }
+    encodeSpeed = speedKBytesPerSecond(true);
+    decodeSpeed = speedKBytesPerSecond(false);
+    U_PORT_TEST_ASSERT(memcmp(gBinOut, gBin, sizeof(gBin)) == 0);
+    U_TEST_PRINT_LINE("encode %d kbytes/s, decode %d kbytes/s.", encodeSpeed, decodeSpeed);
+    U_PORT_TEST_ASSERT(encodeSpeed > 0);
+    U_PORT_TEST_ASSERT(decodeSpeed > 0);
+}
+
+// End of file
@@ -0,0 +1,259 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Test for the hex/binary conversion API
+ */
+
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stdlib.h"    // malloc(), free()
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcmp(), memcpy(), memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+#include "u_hex_bin_convert.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_HEX_BIN_CONVERT_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/** The size of binary buffer to use in testing; a multiple of
+ * 256 so that every byte value appears equally.
+ */
+#define U_TEST_HEX_BIN_CONVERT_BIN_LENGTH_BYTES 1024
+
+#ifndef U_TEST_HEX_BIN_CONVERT_SPEED_MS
+/** How long to run each conversion for when measuring speed.
+ */
+# define U_TEST_HEX_BIN_CONVERT_SPEED_MS 1000
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A conversion function, as measured by hexBinConvertSpeed.
+ */
+typedef size_t (*uTestHexBinConvertFunction_t)(const char *pIn, size_t inLength,
+                                                char *pOut);
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Binary data.
+ */
+static char gBin[U_TEST_HEX_BIN_CONVERT_BIN_LENGTH_BYTES];
+
+/** Somewhere to put binary data that has been converted back.
+ */
+static char gBinOut[U_TEST_HEX_BIN_CONVERT_BIN_LENGTH_BYTES];
+
+/** ASCII hex data.
+ */
+static char gHex[U_TEST_HEX_BIN_CONVERT_BIN_LENGTH_BYTES * 2];
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// A conversion to ASCII hex one nibble at a time, the way it used
+// to be done, for comparison.
+static size_t binToHexNibble(const char *pBin, size_t binLength, char *pHex)
+{
+    static const char hex[] = "0123456789ABCDEF";
+
+    for (size_t x = 0; x < binLength; x++) {
+        *pHex = hex[((unsigned char) * pBin) >> 4];
+        pHex++;
+        *pHex = hex[*pBin & 0x0f];
+        pHex++;
+        pBin++;
+    }
+
+    return binLength * 2;
+}
+
+// A conversion from ASCII hex one character at a time, the way it
+// used to be done, for comparison; only valid ASCII hex is handled.
+static size_t hexToBinNibble(const char *pHex, size_t hexLength, char *pBin)
+{
+    char z[2];
+
+    for (size_t x = 0; x < hexLength / 2; x++) {
+        for (size_t y = 0; y < sizeof(z); y++) {
+            z[y] = *pHex - '0';
+            pHex++;
+            if (z[y] > 9) {
+                z[y] -= 'A' - '0';
+                z[y] += 10;
+            }
+            if (z[y] > 15) {
+                z[y] -= 'a' - 'A';
+            }
+        }
+        *pBin = (char) (((z[0] & 0x0f) << 4) | z[1]);
+        pBin++;
+    }
+
+    return hexLength / 2;
+}
+
+// Run a conversion function repeatedly and return the speed
+// in kbytes (of input) per second.
+static int32_t speedKBytesPerSecond(uTestHexBinConvertFunction_t pFunction,
+                                    const char *pIn, size_t inLength,
+                                    char *pOut)
+{
+    int32_t startTimeMs;
+    int32_t durationMs;
+    int32_t kBytes = 0;
+    size_t bytes = 0;
+
+    startTimeMs = uPortGetTickTimeMs();
+    do {
+        pFunction(pIn, inLength, pOut);
+        bytes += inLength;
+        if (bytes >= 1024) {
+            kBytes += (int32_t) (bytes / 1024);
+            bytes %= 1024;
+        }
+        durationMs = uPortGetTickTimeMs() - startTimeMs;
+    } while (durationMs < U_TEST_HEX_BIN_CONVERT_SPEED_MS);
+
+    return (int32_t) (((int64_t) kBytes * 1000) / durationMs);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TESTS
+ * -------------------------------------------------------------- */
+
+/** Test that conversion works for all byte values, lengths and
+ * alignments, and that invalid ASCII hex is rejected.
+ */
+U_PORT_TEST_FUNCTION("[hexBinConvert]", "hexBinConvertBasic")
+{
+    size_t length;
+    size_t x;
+    char c;
+
+    for (x = 0; x < sizeof(gBin); x++) {
+        gBin[x] = (char) ((x * 7) + (x >> 8));
+    }
+
+    // Every length and offset up to a few blocks, checked against
+    // the nibble-at-a-time version, and back again
+    for (size_t offset = 0; offset < 4; offset++) {
+        for (length = 0; length < 70; length++) {
+            memset(gHex, 0x5A, sizeof(gHex));
+            U_PORT_TEST_ASSERT(uBinToHex(gBin + offset, length, gHex + offset) == length * 2);
+            U_PORT_TEST_ASSERT(*(gHex + offset + (length * 2)) == 0x5A);
+            binToHexNibble(gBin + offset, length, gBinOut);
+            U_PORT_TEST_ASSERT(memcmp(gHex + offset, gBinOut, length * 2) == 0);
+            memset(gBinOut, 0x5A, sizeof(gBinOut));
+            U_PORT_TEST_ASSERT(uHexToBin(gHex + offset, length * 2, gBinOut + offset) == length);
+            U_PORT_TEST_ASSERT(memcmp(gBin + offset, gBinOut + offset, length) == 0);
+            U_PORT_TEST_ASSERT(*(gBinOut + offset + length) == 0x5A);
+            // An odd length ignores the last character
+            U_PORT_TEST_ASSERT(uHexToBin(gHex + offset, (length * 2) + 1, gBinOut + offset) == length);
+        }
+    }
+
+    // All of it, then back again in place
+    U_PORT_TEST_ASSERT(uBinToHex(gBin, sizeof(gBin), gHex) == sizeof(gHex));
+    U_PORT_TEST_ASSERT(uHexToBin(gHex, sizeof(gHex), gHex) == sizeof(gBin));
+    U_PORT_TEST_ASSERT(memcmp(gBin, gHex, sizeof(gBin)) == 0);
+
+    // Lower case works too
+    memcpy(gHex, "0123456789abcdefABCDEF", 22);
+    U_PORT_TEST_ASSERT(uHexToBin(gHex, 22, gBinOut) == 11);
+    U_PORT_TEST_ASSERT(memcmp(gBinOut, "\x01\x23\x45\x67\x89\xab\xcd\xef\xab\xcd\xef", 11) == 0);
+
+    // Any character that is not ASCII hex, in either position of
+    // a pair, anywhere in the first few blocks, stops conversion
+    uBinToHex(gBin, sizeof(gBin), gHex);
+    for (x = 0; x < 256; x++) {
+        c = (char) x;
+        if (((c < '0') || (c > '9')) && ((c < 'A') || (c > 'F')) && ((c < 'a') || (c > 'f'))) {
+            for (size_t y = 0; y < 100; y += 3) {
+                uBinToHex(gBin, 64, gHex);
+                *(gHex + y) = c;
+                U_PORT_TEST_ASSERT(uHexToBin(gHex, 128, gBinOut) == y / 2);
+                U_PORT_TEST_ASSERT(memcmp(gBin, gBinOut, y / 2) == 0);
+            }
+        }
+    }
+}
+
+/** Measure the speed of conversion, of the functions in the API
+ * and of the nibble-at-a-time versions for comparison.
+ */
+U_PORT_TEST_FUNCTION("[hexBinConvert]", "hexBinConvertSpeed")
+{
+    int32_t encodeSpeed;
+    int32_t encodeSpeedNibble;
+    int32_t decodeSpeed;
+    int32_t decodeSpeedNibble;
+
+    for (size_t x = 0; x < sizeof(gBin); x++) {
+        gBin[x] = (char) x;
+    }
+    uBinToHex(gBin, sizeof(gBin), gHex);
+
+    encodeSpeedNibble = speedKBytesPerSecond(binToHexNibble, gBin, sizeof(gBin), gHex);
+    encodeSpeed = speedKBytesPerSecond(uBinToHex, gBin, sizeof(gBin), gHex);
+    decodeSpeedNibble = speedKBytesPerSecond(hexToBinNibble, gHex, sizeof(gHex), gBinOut);
+    decodeSpeed = speedKBytesPerSecond(uHexToBin, gHex, sizeof(gHex), gBinOut);
+    U_PORT_TEST_ASSERT(memcmp(gBin, gBinOut, sizeof(gBin)) == 0);
+
+    U_TEST_PRINT_LINE("binary to hex: %d kbytes/s, nibble at a time %d kbytes/s.",
+                      encodeSpeed, encodeSpeedNibble);
+    U_TEST_PRINT_LINE("hex to binary: %d kbytes/s, nibble at a time %d kbytes/s.",
+                      decodeSpeed, decodeSpeedNibble);
+    U_PORT_TEST_ASSERT(encodeSpeed > 0);
+    U_PORT_TEST_ASSERT(decodeSpeed > 0);
+}
+
+// End of file
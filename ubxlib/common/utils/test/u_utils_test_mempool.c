@@ -36,6 +36,8 @@
 #include "stdbool.h"
 #include "string.h"        // strncpy(), strcmp(), memcpy(), memset()
 
+#include "u_compiler.h" // U_ATOMIC_xxx
+
 #include "u_cfg_sw.h"
 #include "u_cfg_app_platform_specific.h"
 #include "u_cfg_test_platform_specific.h"
@@ -65,6 +67,16 @@
 #define TEST_BLOCK_COUNT 8
 #define TEST_BLOCK_SIZE  64
 
+/** The number of times each task in the contention test
+ * allocates, checks and frees blocks.
+ */
+#define TEST_NUM_ITERATIONS 10000
+
+/** How long to wait for the other task in the contention test
+ * to finish.
+ */
+#define TEST_TIMEOUT_MS 10000
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -73,6 +85,15 @@
  * VARIABLES
  * -------------------------------------------------------------- */
 
+/** The number of errors found by the task in the contention test,
+ * valid once gTaskFinished is set.
+ */
+static int32_t gTaskErrorCount = 0;
+
+/** Set to 1 when the task in the contention test has finished.
+ */
+static int32_t gTaskFinished = 0;
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -87,6 +108,45 @@ static bool isAllBytes(uint8_t *pBuf, size_t size, uint8_t cmpByte)
     return true;
 }
 
+// Allocate up to half of the blocks in the pool, fill each with a
+// pattern unique to this caller, check that the pattern is intact
+// and free them again, TEST_NUM_ITERATIONS times; returns the
+// number of blocks found to have been handed out twice.
+static int32_t allocCheckFree(uMemPoolDesc_t *pMempoolDesc, uint8_t pattern)
+{
+    int32_t errorCount = 0;
+    uint8_t *pBuf[TEST_BLOCK_COUNT / 2];
+    size_t numBufs;
+
+    for (size_t x = 0; x < TEST_NUM_ITERATIONS; x++) {
+        numBufs = (x % (sizeof(pBuf) / sizeof(pBuf[0]))) + 1;
+        for (size_t y = 0; y < numBufs; y++) {
+            pBuf[y] = (uint8_t *)uMemPoolAllocMem(pMempoolDesc);
+            if (pBuf[y] != NULL) {
+                memset(pBuf[y], pattern, TEST_BLOCK_SIZE);
+            }
+        }
+        for (size_t y = 0; y < numBufs; y++) {
+            if (pBuf[y] != NULL) {
+                if (!isAllBytes(pBuf[y], TEST_BLOCK_SIZE, pattern)) {
+                    errorCount++;
+                }
+                uMemPoolFreeMem(pMempoolDesc, (void *)pBuf[y]);
+            }
+        }
+    }
+
+    return errorCount;
+}
+
+// Task for the contention test.
+static void allocCheckFreeTask(void *pParameter)
+{
+    gTaskErrorCount = allocCheckFree((uMemPoolDesc_t *) pParameter, 0xAA);
+    U_ATOMIC_STORE_RELEASE(&gTaskFinished, 1);
+    uPortTaskDelete(NULL);
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: TESTS
  * -------------------------------------------------------------- */
@@ -228,4 +288,103 @@ U_PORT_TEST_FUNCTION("[mempool]", "mempoolFreeAllMem")
 
 }
 
+U_PORT_TEST_FUNCTION("[mempool]", "mempoolStatsAndContention")
+{
+    int32_t errCode;
+    uMemPoolDesc_t mempoolDesc;
+    uMemPoolStats_t stats;
+    uint8_t *pBuf[TEST_BLOCK_COUNT];
+    uPortTaskHandle_t taskHandle;
+    int32_t errorCount;
+    int32_t startTimeMs;
+    int32_t heapUsed;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+
+    // Too many blocks is not allowed
+    U_PORT_TEST_ASSERT(uMemPoolInit(&mempoolDesc, TEST_BLOCK_SIZE,
+                                    U_MEMPOOL_MAX_NUM_BLOCKS + 1) < 0);
+    errCode = uMemPoolInit(&mempoolDesc, TEST_BLOCK_SIZE, TEST_BLOCK_COUNT);
+    U_PORT_TEST_ASSERT(errCode == U_ERROR_COMMON_SUCCESS);
+    U_PORT_TEST_ASSERT(uMemPoolGetStats(&mempoolDesc, &stats) == 0);
+    U_PORT_TEST_ASSERT(stats.usedBlockCount == 0);
+    U_PORT_TEST_ASSERT(stats.maxUsedBlockCount == 0);
+    U_PORT_TEST_ASSERT(stats.allocFailCount == 0);
+
+    // Allocate all buffers available in the pool, and one more
+    for (int32_t i = 0; i < TEST_BLOCK_COUNT; i++) {
+        pBuf[i] = (uint8_t *)uMemPoolAllocMem(&mempoolDesc);
+        U_PORT_TEST_ASSERT(pBuf[i] != NULL);
+    }
+    U_PORT_TEST_ASSERT(uMemPoolAllocMem(&mempoolDesc) == NULL);
+    U_PORT_TEST_ASSERT(uMemPoolGetStats(&mempoolDesc, &stats) == 0);
+    U_PORT_TEST_ASSERT(stats.usedBlockCount == TEST_BLOCK_COUNT);
+    U_PORT_TEST_ASSERT(stats.maxUsedBlockCount == TEST_BLOCK_COUNT);
+    U_PORT_TEST_ASSERT(stats.allocFailCount == 1);
+
+    // Free two, the high-water mark should stay where it is
+    uMemPoolFreeMem(&mempoolDesc, (void *)pBuf[1]);
+    uMemPoolFreeMem(&mempoolDesc, (void *)pBuf[0]);
+    U_PORT_TEST_ASSERT(uMemPoolGetStats(&mempoolDesc, &stats) == 0);
+    U_PORT_TEST_ASSERT(stats.usedBlockCount == TEST_BLOCK_COUNT - 2);
+    U_PORT_TEST_ASSERT(stats.maxUsedBlockCount == TEST_BLOCK_COUNT);
+    U_PORT_TEST_ASSERT(stats.allocFailCount == 1);
+
+    // The last one freed comes back first
+    U_PORT_TEST_ASSERT(uMemPoolAllocMem(&mempoolDesc) == pBuf[0]);
+    U_PORT_TEST_ASSERT(uMemPoolAllocMem(&mempoolDesc) == pBuf[1]);
+    uMemPoolFreeAllMem(&mempoolDesc);
+    U_PORT_TEST_ASSERT(uMemPoolGetStats(&mempoolDesc, &stats) == 0);
+    U_PORT_TEST_ASSERT(stats.usedBlockCount == 0);
+    U_PORT_TEST_ASSERT(stats.maxUsedBlockCount == TEST_BLOCK_COUNT);
+
+    // Time allocations and frees in one task
+    startTimeMs = uPortGetTickTimeMs();
+    errorCount = allocCheckFree(&mempoolDesc, 0x55);
+    U_TEST_PRINT_LINE("%d iteration(s) of alloc/check/free in one task took %d ms.",
+                      TEST_NUM_ITERATIONS, uPortGetTickTimeMs() - startTimeMs);
+    U_PORT_TEST_ASSERT(errorCount == 0);
+
+    // Now do the same from two tasks at once: no block
+    // should ever be handed to both
+    gTaskErrorCount = 0;
+    gTaskFinished = 0;
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uPortTaskCreate(allocCheckFreeTask, "mempoolTask",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       (void *) &mempoolDesc,
+                                       U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+    errorCount = allocCheckFree(&mempoolDesc, 0x55);
+    while (!U_ATOMIC_LOAD_ACQUIRE(&gTaskFinished) &&
+           (uPortGetTickTimeMs() - startTimeMs < TEST_TIMEOUT_MS)) {
+        uPortTaskBlock(10);
+    }
+    U_TEST_PRINT_LINE("%d iteration(s) of alloc/check/free in each of two"
+                      " tasks took %d ms.", TEST_NUM_ITERATIONS,
+                      uPortGetTickTimeMs() - startTimeMs);
+    U_PORT_TEST_ASSERT(U_ATOMIC_LOAD_ACQUIRE(&gTaskFinished));
+    U_PORT_TEST_ASSERT(errorCount == 0);
+    U_PORT_TEST_ASSERT(gTaskErrorCount == 0);
+    U_PORT_TEST_ASSERT(uMemPoolGetStats(&mempoolDesc, &stats) == 0);
+    U_TEST_PRINT_LINE("%d block(s) in use at most, %d allocation failure(s).",
+                      stats.maxUsedBlockCount, stats.allocFailCount);
+    U_PORT_TEST_ASSERT(stats.usedBlockCount == 0);
+    // Give the task time to be deleted
+    uPortTaskBlock(U_CFG_OS_YIELD_MS);
+
+    uMemPoolDeinit(&mempoolDesc);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
 // End of file
\ No newline at end of file
@@ -32,9 +32,11 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
+#include "stdlib.h"    // malloc(), free()
 #include "string.h"    // strncpy(), strcmp(), memcpy(), memset()
 
 #include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"  // For U_CFG_OS_YIELD_MS
 #include "u_cfg_app_platform_specific.h"
 #include "u_cfg_test_platform_specific.h"
 
@@ -75,14 +77,80 @@
 # define U_TEST_UTILS_RINGBUFFER_FILL_CHAR 0x5a
 #endif
 
+#ifndef U_TEST_UTILS_RINGBUFFER_BENCHMARK_SIZE
+/** The size of ring buffer to use when comparing the mutex-protected
+ * and lock-free forms of ring buffer.
+ */
+# define U_TEST_UTILS_RINGBUFFER_BENCHMARK_SIZE 256
+#endif
+
+#ifndef U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_ITEMS
+/** The number of items to pass between two tasks when comparing
+ * the mutex-protected and lock-free forms of ring buffer.
+ */
+# define U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_ITEMS 20000
+#endif
+
+#ifndef U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_ROUND_TRIPS
+/** The number of items to send to another task and have echoed back
+ * when comparing the mutex-protected and lock-free forms of ring
+ * buffer; fewer than #U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_ITEMS
+ * since, on a single core, each one will involve a task switch.
+ */
+# define U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_ROUND_TRIPS 1000
+#endif
+
+#ifndef U_TEST_UTILS_RINGBUFFER_BENCHMARK_SPIN_COUNT
+/** How many times to try a full or empty ring buffer when comparing
+ * the mutex-protected and lock-free forms of ring buffer before
+ * blocking to let the task at the other end run.
+ */
+# define U_TEST_UTILS_RINGBUFFER_BENCHMARK_SPIN_COUNT 1000
+#endif
+
+#ifndef U_TEST_UTILS_RINGBUFFER_BENCHMARK_TIMEOUT_MS
+/** How long to wait for the task at the other end to finish when
+ * comparing the mutex-protected and lock-free forms of ring buffer.
+ */
+# define U_TEST_UTILS_RINGBUFFER_BENCHMARK_TIMEOUT_MS 10000
+#endif
+
+/** The largest number of read handles that
+ * uRingBufferCreateWithReadHandle() will accept, one per bit of
+ * the lock bitmap, less one for the "normal" read pointer and
+ * one more since that's how the check is done.
+ */
+#define U_TEST_UTILS_RINGBUFFER_READ_HANDLES_MAX_POSSIBLE_NUM ((sizeof(uint64_t) * 8) - 2)
+
+#ifndef U_TEST_UTILS_RINGBUFFER_FREE_SIZE_NUM_ITERATIONS
+/** The number of times to move the read handles around when checking
+ * the free space of a ring buffer with the most read handles.
+ */
+# define U_TEST_UTILS_RINGBUFFER_FREE_SIZE_NUM_ITERATIONS 1000
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** What the task at the other end of the benchmark needs to know.
+ */
+typedef struct {
+    uRingBuffer_t *pRingBufferIn; /**< where to read items from, NULL to
+                                       make up its own, a count. */
+    uRingBuffer_t *pRingBufferOut; /**< where to write items to. */
+    uint32_t numItems; /**< the number of items to write. */
+    volatile bool finished; /**< set when the task has finished. */
+} uTestUtilsRingBufferBenchmark_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
 
+/** The parameters for the task at the other end of the benchmark.
+ */
+static uTestUtilsRingBufferBenchmark_t gBenchmark;
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -107,6 +175,204 @@ static void printBuffer(const char *pTitle, const char *pStr, size_t length)
     uPortTaskBlock(10);
 }
 
+// Parser that takes everything available a span at a time,
+// copying it to the buffer passed in as the user parameter,
+// the first byte of which must be the number of spans expected.
+static int32_t spanParser(uParseHandle_t parseHandle, void *pUserParam)
+{
+    char *pBuffer = (char *) pUserParam;
+    size_t numSpans = 0;
+    const char *pSpan;
+    size_t spanSize;
+
+    while ((spanSize = uRingBufferGetSpanUnprotected(parseHandle, &pSpan,
+                                                     U_TEST_UTILS_RINGBUFFER_SIZE)) > 0) {
+        memcpy(pBuffer + 1, pSpan, spanSize);
+        pBuffer += spanSize;
+        numSpans++;
+    }
+
+    return (numSpans == (size_t) *((char *) pUserParam)) ? U_ERROR_COMMON_SUCCESS :
+           U_ERROR_COMMON_NOT_FOUND;
+}
+
+// Work out the free space in a ring buffer the long way round, from
+// the amount of data waiting for each read pointer, for comparison
+// with uRingBufferAvailableSize()/uRingBufferAvailableSizeMax().
+static size_t freeSizeBruteForce(uRingBuffer_t *pRingBuffer,
+                                 const int32_t *pHandles, size_t numHandles,
+                                 bool max)
+{
+    size_t usedMax = 0;
+    size_t used;
+
+    if (!max) {
+        usedMax = uRingBufferDataSize(pRingBuffer);
+    }
+    for (size_t x = 0; x < numHandles; x++) {
+        if ((*(pHandles + x) >= 0) &&
+            (!max || uRingBufferReadHandleIsLocked(pRingBuffer, *(pHandles + x)))) {
+            used = uRingBufferDataSizeHandle(pRingBuffer, *(pHandles + x));
+            if (used > usedMax) {
+                usedMax = used;
+            }
+        }
+    }
+
+    return pRingBuffer->size - 1 - usedMax;
+}
+
+// Add an item to a ring buffer, waiting for there to be room.
+static void benchmarkAdd(uRingBuffer_t *pRingBuffer, uint32_t item)
+{
+    for (size_t x = 0; !uRingBufferAdd(pRingBuffer, (const char *) &item, sizeof(item)); x++) {
+        if (x >= U_TEST_UTILS_RINGBUFFER_BENCHMARK_SPIN_COUNT) {
+            uPortTaskBlock(U_CFG_OS_YIELD_MS);
+            x = 0;
+        }
+    }
+}
+
+// Read an item from a ring buffer, waiting for there to be one.
+static uint32_t benchmarkRead(uRingBuffer_t *pRingBuffer)
+{
+    uint32_t item = 0;
+
+    for (size_t x = 0; uRingBufferRead(pRingBuffer, (char *) &item, sizeof(item)) == 0; x++) {
+        if (x >= U_TEST_UTILS_RINGBUFFER_BENCHMARK_SPIN_COUNT) {
+            uPortTaskBlock(U_CFG_OS_YIELD_MS);
+            x = 0;
+        }
+    }
+
+    return item;
+}
+
+// The task at the other end of the benchmark: either writes a count
+// or echoes what it reads.
+static void benchmarkTask(void *pParameter)
+{
+    uTestUtilsRingBufferBenchmark_t *pBenchmark = (uTestUtilsRingBufferBenchmark_t *) pParameter;
+    uint32_t numItems = pBenchmark->numItems;
+    uint32_t item;
+
+    for (uint32_t x = 0; x < numItems; x++) {
+        item = x;
+        if (pBenchmark->pRingBufferIn != NULL) {
+            item = benchmarkRead(pBenchmark->pRingBufferIn);
+        }
+        benchmarkAdd(pBenchmark->pRingBufferOut, item);
+    }
+
+    pBenchmark->finished = true;
+    uPortTaskDelete(NULL);
+}
+
+// Start the task at the other end of the benchmark.
+static void benchmarkStart(uRingBuffer_t *pRingBufferIn,
+                           uRingBuffer_t *pRingBufferOut, uint32_t numItems)
+{
+    uPortTaskHandle_t taskHandle;
+
+    gBenchmark.pRingBufferIn = pRingBufferIn;
+    gBenchmark.pRingBufferOut = pRingBufferOut;
+    gBenchmark.numItems = numItems;
+    gBenchmark.finished = false;
+    U_PORT_TEST_ASSERT(uPortTaskCreate(benchmarkTask, "benchmarkTask",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       (void *) &gBenchmark,
+                                       U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+}
+
+// Wait for the task at the other end of the benchmark to finish.
+static void benchmarkStop(void)
+{
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    while (!gBenchmark.finished &&
+           (uPortGetTickTimeMs() - startTimeMs < U_TEST_UTILS_RINGBUFFER_BENCHMARK_TIMEOUT_MS)) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(gBenchmark.finished);
+    // Let the task be deleted
+    uPortTaskBlock(100);
+}
+
+// Measure the cost of an add and a read with no contention, then
+// pass items between two tasks, first in one direction, as fast
+// as possible, then there and back again, one at a time, printing
+// the results.
+static void benchmark(bool lockFree)
+{
+    uRingBuffer_t ringBuffer[2];
+    char *pLinearBuffer[2];
+    int32_t timeMs;
+    uint32_t item;
+    const char *pName = lockFree ? "lock-free" : "mutex";
+
+    for (size_t x = 0; x < sizeof(ringBuffer) / sizeof(ringBuffer[0]); x++) {
+        pLinearBuffer[x] = (char *) malloc(U_TEST_UTILS_RINGBUFFER_BENCHMARK_SIZE);
+        U_PORT_TEST_ASSERT(pLinearBuffer[x] != NULL);
+        if (lockFree) {
+            U_PORT_TEST_ASSERT(uRingBufferCreateLockFree(&(ringBuffer[x]), pLinearBuffer[x],
+                                                         U_TEST_UTILS_RINGBUFFER_BENCHMARK_SIZE) == 0);
+        } else {
+            U_PORT_TEST_ASSERT(uRingBufferCreate(&(ringBuffer[x]), pLinearBuffer[x],
+                                                 U_TEST_UTILS_RINGBUFFER_BENCHMARK_SIZE) == 0);
+        }
+    }
+
+    // Cost: add and read back in this task alone
+    timeMs = uPortGetTickTimeMs();
+    for (uint32_t x = 0; x < U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_ITEMS; x++) {
+        uRingBufferAdd(&(ringBuffer[0]), (const char *) &x, sizeof(x));
+        U_PORT_TEST_ASSERT(uRingBufferRead(&(ringBuffer[0]), (char *) &item,
+                                           sizeof(item)) == sizeof(item));
+        U_PORT_TEST_ASSERT(item == x);
+    }
+    timeMs = uPortGetTickTimeMs() - timeMs;
+    U_TEST_PRINT_LINE("%s: %d add/read pair(s) in one task in %d ms.", pName,
+                      U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_ITEMS, timeMs);
+
+    // Throughput: the other task writes a count, we read it
+    timeMs = uPortGetTickTimeMs();
+    benchmarkStart(NULL, &(ringBuffer[0]), U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_ITEMS);
+    for (uint32_t x = 0; x < U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_ITEMS; x++) {
+        U_PORT_TEST_ASSERT(benchmarkRead(&(ringBuffer[0])) == x);
+    }
+    timeMs = uPortGetTickTimeMs() - timeMs;
+    benchmarkStop();
+    if (timeMs <= 0) {
+        timeMs = 1;
+    }
+    U_TEST_PRINT_LINE("%s: %d item(s) one way in %d ms, %d item(s)/s.", pName,
+                      U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_ITEMS, timeMs,
+                      (int32_t) ((U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_ITEMS * 1000LL) / timeMs));
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&(ringBuffer[0])) == 0);
+
+    // Latency: we write an item, the other task echoes it back
+    timeMs = uPortGetTickTimeMs();
+    benchmarkStart(&(ringBuffer[0]), &(ringBuffer[1]),
+                   U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_ROUND_TRIPS);
+    for (uint32_t x = 0; x < U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_ROUND_TRIPS; x++) {
+        benchmarkAdd(&(ringBuffer[0]), x);
+        U_PORT_TEST_ASSERT(benchmarkRead(&(ringBuffer[1])) == x);
+    }
+    timeMs = uPortGetTickTimeMs() - timeMs;
+    benchmarkStop();
+    U_TEST_PRINT_LINE("%s: %d item(s) there and back in %d ms, %d us per round trip.",
+                      pName, U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_ROUND_TRIPS, timeMs,
+                      (int32_t) ((timeMs * 1000LL) / U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_ROUND_TRIPS));
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&(ringBuffer[0])) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&(ringBuffer[1])) == 0);
+
+    for (size_t x = 0; x < sizeof(ringBuffer) / sizeof(ringBuffer[0]); x++) {
+        uRingBufferDelete(&(ringBuffer[x]));
+        free(pLinearBuffer[x]);
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: TESTS
  * -------------------------------------------------------------- */
@@ -882,4 +1148,749 @@ U_PORT_TEST_FUNCTION("[ringbuffer]", "ringbufferBasic")
     U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
 }
 
-// End of file
\ No newline at end of file
+U_PORT_TEST_FUNCTION("[ringbuffer]", "ringbufferWriteReserve")
+{
+    int32_t heapUsed;
+    uRingBuffer_t ringBuffer = {0};
+    char linearBuffer[U_TEST_UTILS_RINGBUFFER_SIZE + 1];
+    char bufferOut[U_TEST_UTILS_RINGBUFFER_SIZE + 1];
+    char bufferIn[U_TEST_UTILS_RINGBUFFER_SIZE + 1];
+    int32_t handle[U_TEST_UTILS_RINGBUFFER_READ_HANDLES_MAX_NUM];
+    char *pSpan1;
+    size_t span1Length;
+    char *pSpan2;
+    size_t span2Length;
+    size_t y;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+
+    U_TEST_PRINT_LINE("testing ring buffer write reservation.");
+    for (size_t x = 0; x < sizeof(bufferIn); x++) {
+        bufferIn[x] = (char) (x + 1);
+    }
+    memset(linearBuffer, 0, sizeof(linearBuffer));
+    U_PORT_TEST_ASSERT(uRingBufferCreateWithReadHandle(&ringBuffer, linearBuffer,
+                                                       sizeof(linearBuffer),
+                                                       U_TEST_UTILS_RINGBUFFER_READ_HANDLES_MAX_NUM) == 0);
+    handle[0] = uRingBufferTakeReadHandle(&ringBuffer);
+    U_PORT_TEST_ASSERT(handle[0] >= 0);
+    handle[1] = uRingBufferTakeReadHandle(&ringBuffer);
+    U_PORT_TEST_ASSERT(handle[1] >= 0);
+    uRingBufferLockReadHandle(&ringBuffer, handle[0]);
+
+    // Reserve, write and commit some contiguous space
+    y = uRingBufferForceWriteReserve(&ringBuffer, 5, &pSpan1, &span1Length,
+                                     &pSpan2, &span2Length);
+    U_TEST_PRINT_LINE(" reserved %d byte(s), spans %d and %d byte(s).",
+                      y, span1Length, span2Length);
+    U_PORT_TEST_ASSERT(y == 5);
+    U_PORT_TEST_ASSERT(pSpan1 == linearBuffer);
+    U_PORT_TEST_ASSERT(span1Length == 5);
+    U_PORT_TEST_ASSERT(pSpan2 == NULL);
+    U_PORT_TEST_ASSERT(span2Length == 0);
+    // Only one reservation at a time and no adds in the meantime
+    U_PORT_TEST_ASSERT(uRingBufferForceWriteReserve(&ringBuffer, 1, &pSpan1, &span1Length,
+                                                    &pSpan2, &span2Length) == 0);
+    U_PORT_TEST_ASSERT(pSpan1 == NULL);
+    U_PORT_TEST_ASSERT(!uRingBufferForceAdd(&ringBuffer, bufferIn, 1));
+    pSpan1 = linearBuffer;
+    memcpy(pSpan1, bufferIn, 5);
+    // Nothing should be visible until commit
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle[0]) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferWriteCommit(&ringBuffer, 5));
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle[0]) == 5);
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle[1]) == 5);
+    memset(bufferOut, U_TEST_UTILS_RINGBUFFER_FILL_CHAR, sizeof(bufferOut));
+    U_PORT_TEST_ASSERT(uRingBufferReadHandle(&ringBuffer, handle[0], bufferOut, sizeof(bufferOut)) == 5);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn, 5) == 0);
+    U_PORT_TEST_ASSERT(bufferOut[5] == U_TEST_UTILS_RINGBUFFER_FILL_CHAR);
+
+    // Now reserve everything: this must wrap, giving two spans; the
+    // unlocked handle is only pushed on to make the room at commit
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSizeMax(&ringBuffer) == sizeof(linearBuffer) - 1);
+    y = uRingBufferForceWriteReserve(&ringBuffer, sizeof(linearBuffer), &pSpan1, &span1Length,
+                                     &pSpan2, &span2Length);
+    U_TEST_PRINT_LINE(" reserved %d byte(s), spans %d and %d byte(s).",
+                      y, span1Length, span2Length);
+    U_PORT_TEST_ASSERT(y == sizeof(linearBuffer) - 1);
+    U_PORT_TEST_ASSERT(pSpan1 == linearBuffer + 5);
+    U_PORT_TEST_ASSERT(span1Length == sizeof(linearBuffer) - 5);
+    U_PORT_TEST_ASSERT(pSpan2 == linearBuffer);
+    U_PORT_TEST_ASSERT(span1Length + span2Length == y);
+    U_PORT_TEST_ASSERT(uRingBufferStatReadLossHandle(&ringBuffer, handle[1]) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferStatReadLossHandle(&ringBuffer, handle[0]) == 0);
+    // Its data is overlapped by the reservation so it can't be read
+    U_PORT_TEST_ASSERT(uRingBufferReadHandle(&ringBuffer, handle[1], bufferOut, sizeof(bufferOut)) == 0);
+    // Committing more than was reserved should fail and end the
+    // reservation, nothing being lost
+    U_PORT_TEST_ASSERT(!uRingBufferWriteCommit(&ringBuffer, y + 1));
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle[0]) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle[1]) == 5);
+    U_PORT_TEST_ASSERT(uRingBufferStatReadLossHandle(&ringBuffer, handle[1]) == 0);
+    // Do it again, properly this time
+    U_PORT_TEST_ASSERT(uRingBufferForceWriteReserve(&ringBuffer, y, &pSpan1, &span1Length,
+                                                    &pSpan2, &span2Length) == y);
+    memcpy(pSpan1, bufferIn, span1Length);
+    memcpy(pSpan2, bufferIn + span1Length, span2Length);
+    U_PORT_TEST_ASSERT(uRingBufferWriteCommit(&ringBuffer, y));
+    U_PORT_TEST_ASSERT(uRingBufferStatReadLossHandle(&ringBuffer, handle[1]) == 5);
+    U_PORT_TEST_ASSERT(uRingBufferStatReadLossHandle(&ringBuffer, handle[0]) == 0);
+    printBuffer("  ring buffer now contains", linearBuffer, sizeof(linearBuffer));
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle[0]) == y);
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSizeMax(&ringBuffer) == 0);
+    // The locked handle is full so no more can be reserved
+    U_PORT_TEST_ASSERT(uRingBufferForceWriteReserve(&ringBuffer, 1, &pSpan1, &span1Length,
+                                                    &pSpan2, &span2Length) == 0);
+    memset(bufferOut, U_TEST_UTILS_RINGBUFFER_FILL_CHAR, sizeof(bufferOut));
+    U_PORT_TEST_ASSERT(uRingBufferReadHandle(&ringBuffer, handle[0], bufferOut, sizeof(bufferOut)) == y);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn, y) == 0);
+
+    // Asking for contiguous space only should stop at the end of the buffer
+    y = uRingBufferForceWriteReserve(&ringBuffer, sizeof(linearBuffer), &pSpan1, &span1Length,
+                                     NULL, NULL);
+    U_TEST_PRINT_LINE(" reserved %d contiguous byte(s).", y);
+    U_PORT_TEST_ASSERT(y == span1Length);
+    U_PORT_TEST_ASSERT(pSpan1 + span1Length == linearBuffer + sizeof(linearBuffer));
+    U_PORT_TEST_ASSERT(uRingBufferWriteCommit(&ringBuffer, 0));
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle[0]) == 0);
+
+    // A reset throws away any reservation
+    U_PORT_TEST_ASSERT(uRingBufferForceWriteReserve(&ringBuffer, 3, &pSpan1, &span1Length,
+                                                    &pSpan2, &span2Length) == 3);
+    uRingBufferReset(&ringBuffer);
+    U_PORT_TEST_ASSERT(!uRingBufferWriteCommit(&ringBuffer, 3));
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle[0]) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferForceAdd(&ringBuffer, bufferIn, 1));
+
+    // A forced reservation that is only partly used should cost the
+    // unlocked handle only what was needed for the part committed
+    U_PORT_TEST_ASSERT(uRingBufferForceAdd(&ringBuffer, bufferIn + 1, sizeof(linearBuffer) - 4));
+    U_PORT_TEST_ASSERT(uRingBufferConsumeHandle(&ringBuffer, handle[0],
+                                                sizeof(linearBuffer)) == sizeof(linearBuffer) - 3);
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle[1]) == sizeof(linearBuffer) - 3);
+    y = uRingBufferStatReadLossHandle(&ringBuffer, handle[1]);
+    U_PORT_TEST_ASSERT(uRingBufferForceWriteReserve(&ringBuffer, sizeof(linearBuffer), &pSpan1,
+                                                    &span1Length, &pSpan2,
+                                                    &span2Length) == sizeof(linearBuffer) - 1);
+    U_PORT_TEST_ASSERT(uRingBufferReadHandle(&ringBuffer, handle[1], bufferOut, sizeof(bufferOut)) == 0);
+    // The write pointer is at 8, so the four bytes wrap
+    U_PORT_TEST_ASSERT(span1Length == sizeof(linearBuffer) - 8);
+    memcpy(pSpan1, bufferIn + 5, span1Length);
+    memcpy(pSpan2, bufferIn + 5 + span1Length, 4 - span1Length);
+    U_PORT_TEST_ASSERT(uRingBufferWriteCommit(&ringBuffer, 4));
+    U_PORT_TEST_ASSERT(uRingBufferStatReadLossHandle(&ringBuffer, handle[1]) == y + 2);
+    memset(bufferOut, U_TEST_UTILS_RINGBUFFER_FILL_CHAR, sizeof(bufferOut));
+    U_PORT_TEST_ASSERT(uRingBufferReadHandle(&ringBuffer, handle[1], bufferOut,
+                                             sizeof(bufferOut)) == sizeof(linearBuffer) - 1);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn + 2, sizeof(linearBuffer) - 5) == 0);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut + sizeof(linearBuffer) - 5, bufferIn + 5, 4) == 0);
+
+    // Done
+    U_TEST_PRINT_LINE("deleting ring buffer...");
+    uRingBufferGiveReadHandle(&ringBuffer, handle[0]);
+    uRingBufferGiveReadHandle(&ringBuffer, handle[1]);
+    uRingBufferDelete(&ringBuffer);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
+U_PORT_TEST_FUNCTION("[ringbuffer]", "ringbufferParseSpan")
+{
+    int32_t heapUsed;
+    uRingBuffer_t ringBuffer = {0};
+    char linearBuffer[U_TEST_UTILS_RINGBUFFER_SIZE + 1];
+    char bufferOut[U_TEST_UTILS_RINGBUFFER_SIZE + 2];
+    char bufferIn[U_TEST_UTILS_RINGBUFFER_SIZE + 1];
+    int32_t handle;
+    U_RING_BUFFER_PARSER_f parserList[] = {spanParser, NULL};
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+
+    U_TEST_PRINT_LINE("testing ring buffer parsing with spans.");
+    for (size_t x = 0; x < sizeof(bufferIn); x++) {
+        bufferIn[x] = (char) (x + 1);
+    }
+    U_PORT_TEST_ASSERT(uRingBufferCreateWithReadHandle(&ringBuffer, linearBuffer,
+                                                       sizeof(linearBuffer), 1) == 0);
+    handle = uRingBufferTakeReadHandle(&ringBuffer);
+    U_PORT_TEST_ASSERT(handle >= 0);
+
+    // Contiguous data should come out as a single span
+    U_PORT_TEST_ASSERT(uRingBufferForceAdd(&ringBuffer, bufferIn, 6));
+    memset(bufferOut, U_TEST_UTILS_RINGBUFFER_FILL_CHAR, sizeof(bufferOut));
+    bufferOut[0] = 1;
+    U_PORT_TEST_ASSERT(uRingBufferParseHandle(&ringBuffer, handle, parserList, bufferOut) == 6);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut + 1, bufferIn, 6) == 0);
+    U_PORT_TEST_ASSERT(bufferOut[7] == U_TEST_UTILS_RINGBUFFER_FILL_CHAR);
+    // Parsing doesn't move the read pointer on, reading does
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle) == 6);
+    U_PORT_TEST_ASSERT(uRingBufferReadHandle(&ringBuffer, handle, bufferOut, 6) == 6);
+
+    // Data that wraps should come out as two spans
+    U_PORT_TEST_ASSERT(uRingBufferForceAdd(&ringBuffer, bufferIn, 8));
+    memset(bufferOut, U_TEST_UTILS_RINGBUFFER_FILL_CHAR, sizeof(bufferOut));
+    bufferOut[0] = 2;
+    U_PORT_TEST_ASSERT(uRingBufferParseHandle(&ringBuffer, handle, parserList, bufferOut) == 8);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut + 1, bufferIn, 8) == 0);
+    U_PORT_TEST_ASSERT(bufferOut[9] == U_TEST_UTILS_RINGBUFFER_FILL_CHAR);
+
+    // Done
+    U_TEST_PRINT_LINE("deleting ring buffer...");
+    uRingBufferGiveReadHandle(&ringBuffer, handle);
+    uRingBufferDelete(&ringBuffer);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
+/** Test resizing a ring buffer with data in it and the high-water mark.
+ */
+U_PORT_TEST_FUNCTION("[ringbuffer]", "ringbufferResize")
+{
+    int32_t heapUsed;
+    uRingBuffer_t ringBuffer = {0};
+    char linearBuffer1[U_TEST_UTILS_RINGBUFFER_SIZE];
+    char linearBuffer2[U_TEST_UTILS_RINGBUFFER_SIZE * 2];
+    char linearBuffer3[U_TEST_UTILS_RINGBUFFER_SIZE / 2];
+    char bufferIn[U_TEST_UTILS_RINGBUFFER_SIZE * 2];
+    char bufferOut[U_TEST_UTILS_RINGBUFFER_SIZE * 2];
+    int32_t handle1;
+    int32_t handle2;
+    char *pSpan;
+    size_t spanLength;
+    const char *pDataReadNormal;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+
+    U_TEST_PRINT_LINE("testing ring buffer resize.");
+    for (size_t x = 0; x < sizeof(bufferIn); x++) {
+        bufferIn[x] = (char) (x + 1);
+    }
+    U_PORT_TEST_ASSERT(uRingBufferCreateWithReadHandle(&ringBuffer, linearBuffer1,
+                                                       sizeof(linearBuffer1), 2) == 0);
+    uRingBufferSetReadRequiresHandle(&ringBuffer, true);
+    handle1 = uRingBufferTakeReadHandle(&ringBuffer);
+    U_PORT_TEST_ASSERT(handle1 >= 0);
+    handle2 = uRingBufferTakeReadHandle(&ringBuffer);
+    U_PORT_TEST_ASSERT(handle2 >= 0);
+    U_PORT_TEST_ASSERT(uRingBufferStatFillMaxHandle(&ringBuffer, handle1, false) == 0);
+
+    // Add six bytes and read four of them from handle 1
+    U_PORT_TEST_ASSERT(uRingBufferForceAdd(&ringBuffer, bufferIn, 6));
+    U_PORT_TEST_ASSERT(uRingBufferStatFillMaxHandle(&ringBuffer, handle1, false) == 6);
+    U_PORT_TEST_ASSERT(uRingBufferReadHandle(&ringBuffer, handle1, bufferOut, 4) == 4);
+    // Add five more, so that the data wraps and handle 2
+    // loses the first two bytes: handle 1 now has bytes
+    // 5 to 11 waiting, handle 2 has bytes 3 to 11
+    U_PORT_TEST_ASSERT(uRingBufferForceAdd(&ringBuffer, bufferIn + 6, 5));
+    U_PORT_TEST_ASSERT(uRingBufferStatReadLossHandle(&ringBuffer, handle2) == 2);
+    U_PORT_TEST_ASSERT(uRingBufferStatFillMaxHandle(&ringBuffer, handle1, false) == 7);
+    U_PORT_TEST_ASSERT(uRingBufferStatFillMaxHandle(&ringBuffer, handle2, false) == sizeof(linearBuffer1) - 1);
+
+    // Can't move into a buffer that is too small for a locked handle,
+    // and failing leaves everything alone, the "normal" read pointer
+    // included
+    uRingBufferLockReadHandle(&ringBuffer, handle2);
+    pDataReadNormal = ringBuffer.pDataRead[0];
+    U_PORT_TEST_ASSERT(uRingBufferResize(&ringBuffer, linearBuffer3,
+                                         sizeof(linearBuffer3)) < 0);
+    U_PORT_TEST_ASSERT(ringBuffer.pDataRead[0] == pDataReadNormal);
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle2) == 9);
+    uRingBufferUnlockReadHandle(&ringBuffer, handle2);
+
+    // Grow it: nothing should be lost
+    U_PORT_TEST_ASSERT(uRingBufferResize(&ringBuffer, linearBuffer2,
+                                         sizeof(linearBuffer2)) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle1) == 7);
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle2) == 9);
+    U_PORT_TEST_ASSERT(uRingBufferStatReadLossHandle(&ringBuffer, handle2) == 2);
+    memset(bufferOut, U_TEST_UTILS_RINGBUFFER_FILL_CHAR, sizeof(bufferOut));
+    U_PORT_TEST_ASSERT(uRingBufferReadHandle(&ringBuffer, handle2, bufferOut, sizeof(bufferOut)) == 9);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn + 2, 9) == 0);
+    U_PORT_TEST_ASSERT(bufferOut[9] == U_TEST_UTILS_RINGBUFFER_FILL_CHAR);
+    // The larger buffer can now hold more
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSize(&ringBuffer) == sizeof(linearBuffer2) - 1 - 7);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn + 11, 9));
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle1) == 16);
+    memset(bufferOut, U_TEST_UTILS_RINGBUFFER_FILL_CHAR, sizeof(bufferOut));
+    U_PORT_TEST_ASSERT(uRingBufferReadHandle(&ringBuffer, handle1, bufferOut, 14) == 14);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn + 4, 14) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferReadHandle(&ringBuffer, handle2, bufferOut, 7) == 7);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn + 11, 7) == 0);
+
+    // Resetting the high-water mark takes it down to what is held
+    U_PORT_TEST_ASSERT(uRingBufferStatFillMaxHandle(&ringBuffer, handle1, true) == 16);
+    U_PORT_TEST_ASSERT(uRingBufferStatFillMaxHandle(&ringBuffer, handle1, false) == 2);
+    U_PORT_TEST_ASSERT(uRingBufferStatFillMaxHandle(&ringBuffer, handle2, false) == sizeof(linearBuffer1) - 1);
+
+    // Can't resize while a reservation is outstanding
+    U_PORT_TEST_ASSERT(uRingBufferForceWriteReserve(&ringBuffer, 1, &pSpan, &spanLength,
+                                                    NULL, NULL) == 1);
+    U_PORT_TEST_ASSERT(uRingBufferResize(&ringBuffer, linearBuffer3,
+                                         sizeof(linearBuffer3)) < 0);
+    U_PORT_TEST_ASSERT(uRingBufferWriteCommit(&ringBuffer, 0));
+
+    // Add four more bytes, so that both handles have six bytes
+    // waiting; with one of them locked it can't shrink to five
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 4));
+    uRingBufferLockReadHandle(&ringBuffer, handle1);
+    U_PORT_TEST_ASSERT(uRingBufferResize(&ringBuffer, linearBuffer3,
+                                         sizeof(linearBuffer3)) < 0);
+    uRingBufferUnlockReadHandle(&ringBuffer, handle1);
+
+    // Unlocked, it can, keeping the last four bytes
+    U_PORT_TEST_ASSERT(uRingBufferResize(&ringBuffer, linearBuffer3,
+                                         sizeof(linearBuffer3)) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle1) == 4);
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle2) == 4);
+    U_PORT_TEST_ASSERT(uRingBufferStatReadLossHandle(&ringBuffer, handle1) == 2);
+    U_PORT_TEST_ASSERT(uRingBufferStatReadLossHandle(&ringBuffer, handle2) == 4);
+    U_PORT_TEST_ASSERT(uRingBufferStatFillMaxHandle(&ringBuffer, handle2, false) == sizeof(linearBuffer3) - 1);
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSize(&ringBuffer) == 0);
+    U_PORT_TEST_ASSERT(!uRingBufferAdd(&ringBuffer, bufferIn, 1));
+    memset(bufferOut, U_TEST_UTILS_RINGBUFFER_FILL_CHAR, sizeof(bufferOut));
+    U_PORT_TEST_ASSERT(uRingBufferReadHandle(&ringBuffer, handle1, bufferOut, sizeof(bufferOut)) == 4);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn, 4) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferReadHandle(&ringBuffer, handle2, bufferOut, sizeof(bufferOut)) == 4);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn, 4) == 0);
+
+    // Done
+    U_TEST_PRINT_LINE("deleting ring buffer...");
+    uRingBufferGiveReadHandle(&ringBuffer, handle2);
+    uRingBufferGiveReadHandle(&ringBuffer, handle1);
+    uRingBufferDelete(&ringBuffer);
+
+    // Check the high-water mark of the handle-less form
+    U_PORT_TEST_ASSERT(uRingBufferCreate(&ringBuffer, linearBuffer1,
+                                         sizeof(linearBuffer1)) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 3));
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, bufferOut, 2) == 2);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 1));
+    U_PORT_TEST_ASSERT(uRingBufferStatFillMax(&ringBuffer, true) == 3);
+    U_PORT_TEST_ASSERT(uRingBufferStatFillMax(&ringBuffer, false) == 2);
+    U_PORT_TEST_ASSERT(uRingBufferResize(&ringBuffer, linearBuffer3,
+                                         sizeof(linearBuffer3)) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, bufferOut, sizeof(bufferOut)) == 2);
+    U_PORT_TEST_ASSERT((bufferOut[0] == bufferIn[2]) && (bufferOut[1] == bufferIn[0]));
+    uRingBufferDelete(&ringBuffer);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
+U_PORT_TEST_FUNCTION("[ringbuffer]", "ringbufferLockFree")
+{
+    int32_t heapUsed;
+    uRingBuffer_t ringBuffer = {0};
+    char linearBuffer[U_TEST_UTILS_RINGBUFFER_SIZE];
+    char bufferIn[U_TEST_UTILS_RINGBUFFER_SIZE];
+    char bufferOut[U_TEST_UTILS_RINGBUFFER_SIZE];
+    char *pSpan;
+    size_t spanLength;
+
+    // The benchmark needs tasks
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    heapUsed = uPortGetHeapFree();
+
+    U_TEST_PRINT_LINE("testing lock-free ring buffer.");
+    for (size_t x = 0; x < sizeof(bufferIn); x++) {
+        bufferIn[x] = (char) (x + 1);
+    }
+
+    U_PORT_TEST_ASSERT(uRingBufferCreateLockFree(&ringBuffer, linearBuffer,
+                                                 sizeof(linearBuffer)) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSize(&ringBuffer) == sizeof(linearBuffer) - 1);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, bufferOut, sizeof(bufferOut)) == 0);
+
+    // Fill it, which should leave no room
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 6));
+    U_PORT_TEST_ASSERT(!uRingBufferAdd(&ringBuffer, bufferIn, sizeof(linearBuffer) - 6));
+    U_PORT_TEST_ASSERT(uRingBufferStatAddLoss(&ringBuffer) == sizeof(linearBuffer) - 6);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn + 6, sizeof(linearBuffer) - 7));
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == sizeof(linearBuffer) - 1);
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSize(&ringBuffer) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferStatFillMax(&ringBuffer, false) == sizeof(linearBuffer) - 1);
+    // Forced add can't make room, only the reader can do that
+    U_PORT_TEST_ASSERT(!uRingBufferForceAdd(&ringBuffer, bufferIn, 1));
+    U_PORT_TEST_ASSERT(uRingBufferStatReadLoss(&ringBuffer) == 0);
+
+    // Peek and read some of it
+    memset(bufferOut, U_TEST_UTILS_RINGBUFFER_FILL_CHAR, sizeof(bufferOut));
+    U_PORT_TEST_ASSERT(uRingBufferPeek(&ringBuffer, bufferOut, 2, 3) == 2);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn + 3, 2) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferPeek(&ringBuffer, bufferOut, 2, sizeof(linearBuffer) - 1) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, bufferOut, 4) == 4);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn, 4) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSize(&ringBuffer) == 4);
+
+    // Add across the wrap and read it all back
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 4));
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == sizeof(linearBuffer) - 1);
+    memset(bufferOut, U_TEST_UTILS_RINGBUFFER_FILL_CHAR, sizeof(bufferOut));
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, bufferOut,
+                                       sizeof(bufferOut)) == sizeof(linearBuffer) - 1);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn + 4, sizeof(linearBuffer) - 5) == 0);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut + sizeof(linearBuffer) - 5, bufferIn, 4) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 0);
+
+    // Discard and flush
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 5));
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, NULL, 2) == 2);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 3);
+    uRingBufferFlush(&ringBuffer);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 0);
+
+    // Not supported
+    U_PORT_TEST_ASSERT(uRingBufferForceWriteReserve(&ringBuffer, 1, &pSpan, &spanLength,
+                                                    NULL, NULL) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferResize(&ringBuffer, bufferOut, sizeof(bufferOut)) < 0);
+    uRingBufferDelete(&ringBuffer);
+
+    // Now compare the two forms with two tasks
+    benchmark(false);
+    benchmark(true);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+
+    uPortDeinit();
+}
+
+U_PORT_TEST_FUNCTION("[ringbuffer]", "ringbufferFreeSize")
+{
+    int32_t heapUsed;
+    uRingBuffer_t ringBuffer = {0};
+    char *pLinearBuffer;
+    int32_t handles[U_TEST_UTILS_RINGBUFFER_READ_HANDLES_MAX_POSSIBLE_NUM];
+    size_t numHandles = sizeof(handles) / sizeof(handles[0]);
+    char bufferIn[U_TEST_UTILS_RINGBUFFER_SIZE];
+    size_t total = 0;
+    int32_t timeMs;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+
+    U_TEST_PRINT_LINE("testing free space with %d read handles.", numHandles);
+    for (size_t x = 0; x < sizeof(bufferIn); x++) {
+        bufferIn[x] = (char) (x + 1);
+    }
+    pLinearBuffer = (char *) malloc(U_TEST_UTILS_RINGBUFFER_BENCHMARK_SIZE);
+    U_PORT_TEST_ASSERT(pLinearBuffer != NULL);
+    // One too many is not allowed
+    U_PORT_TEST_ASSERT(uRingBufferCreateWithReadHandle(&ringBuffer, pLinearBuffer,
+                                                       U_TEST_UTILS_RINGBUFFER_BENCHMARK_SIZE,
+                                                       numHandles + 1) < 0);
+    U_PORT_TEST_ASSERT(uRingBufferCreateWithReadHandle(&ringBuffer, pLinearBuffer,
+                                                       U_TEST_UTILS_RINGBUFFER_BENCHMARK_SIZE,
+                                                       numHandles) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSizeMax(&ringBuffer) ==
+                       U_TEST_UTILS_RINGBUFFER_BENCHMARK_SIZE - 1);
+    for (size_t x = 0; x < numHandles; x++) {
+        handles[x] = uRingBufferTakeReadHandle(&ringBuffer);
+        U_PORT_TEST_ASSERT(handles[x] >= 0);
+        uRingBufferLockReadHandle(&ringBuffer, handles[x]);
+    }
+    U_PORT_TEST_ASSERT(uRingBufferTakeReadHandle(&ringBuffer) < 0);
+
+    // Move the read handles around at different rates, locking,
+    // unlocking, giving and taking them as we go, checking that the
+    // free space is always what it should be
+    for (size_t x = 0; x < U_TEST_UTILS_RINGBUFFER_FREE_SIZE_NUM_ITERATIONS; x++) {
+        uRingBufferForceAdd(&ringBuffer, bufferIn, (x % sizeof(bufferIn)) + 1);
+        for (size_t y = 0; y < numHandles; y++) {
+            if (handles[y] >= 0) {
+                uRingBufferReadHandle(&ringBuffer, handles[y], NULL, (x + y) % 7);
+            }
+        }
+        if ((x % 5) == 0) {
+            uRingBufferRead(&ringBuffer, NULL, x % 13);
+        }
+        if ((x % 4) == 0) {
+            if (uRingBufferReadHandleIsLocked(&ringBuffer, handles[x % numHandles])) {
+                uRingBufferUnlockReadHandle(&ringBuffer, handles[x % numHandles]);
+            } else {
+                uRingBufferLockReadHandle(&ringBuffer, handles[x % numHandles]);
+            }
+        }
+        if ((x % 11) == 0) {
+            uRingBufferFlushHandle(&ringBuffer, handles[(x * 3) % numHandles]);
+        }
+        if ((x % 17) == 0) {
+            uRingBufferGiveReadHandle(&ringBuffer, handles[(x * 7) % numHandles]);
+            handles[(x * 7) % numHandles] = uRingBufferTakeReadHandle(&ringBuffer);
+            U_PORT_TEST_ASSERT(handles[(x * 7) % numHandles] >= 0);
+        }
+        U_PORT_TEST_ASSERT(uRingBufferAvailableSize(&ringBuffer) ==
+                           freeSizeBruteForce(&ringBuffer, handles, numHandles, false));
+        U_PORT_TEST_ASSERT(uRingBufferAvailableSizeMax(&ringBuffer) ==
+                           freeSizeBruteForce(&ringBuffer, handles, numHandles, true));
+    }
+
+    // Time the free space queries with all of the handles in use
+    for (size_t x = 0; x < numHandles; x++) {
+        uRingBufferLockReadHandle(&ringBuffer, handles[x]);
+    }
+    timeMs = uPortGetTickTimeMs();
+    for (size_t x = 0; x < U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_ITEMS; x++) {
+        total += uRingBufferAvailableSizeMax(&ringBuffer);
+        total += uRingBufferAvailableSize(&ringBuffer);
+    }
+    timeMs = uPortGetTickTimeMs() - timeMs;
+    U_TEST_PRINT_LINE("%d calls each to uRingBufferAvailableSizeMax() and"
+                      " uRingBufferAvailableSize() with %d read handles locked"
+                      " took %d ms.", U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_ITEMS,
+                      numHandles, timeMs);
+    U_PORT_TEST_ASSERT(total > 0);
+
+    // Done
+    for (size_t x = 0; x < numHandles; x++) {
+        uRingBufferGiveReadHandle(&ringBuffer, handles[x]);
+    }
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSizeMax(&ringBuffer) ==
+                       U_TEST_UTILS_RINGBUFFER_BENCHMARK_SIZE - 1);
+    uRingBufferDelete(&ringBuffer);
+    free(pLinearBuffer);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
+U_PORT_TEST_FUNCTION("[ringbuffer]", "ringbufferSpans")
+{
+    int32_t heapUsed;
+    uRingBuffer_t ringBuffer = {0};
+    char linearBuffer[16];
+    char bufferIn[sizeof(linearBuffer)];
+    char bufferOut[sizeof(linearBuffer)];
+    const char *pSpan1;
+    const char *pSpan2;
+    size_t span1Length;
+    size_t span2Length;
+    char *pWrite1;
+    char *pWrite2;
+    size_t write1Length;
+    size_t write2Length;
+    int32_t handle;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+
+    for (size_t x = 0; x < sizeof(bufferIn); x++) {
+        bufferIn[x] = (char) (x + 1);
+    }
+
+    U_TEST_PRINT_LINE("testing spans with a normal ring buffer.");
+    U_PORT_TEST_ASSERT(uRingBufferCreate(&ringBuffer, linearBuffer,
+                                         sizeof(linearBuffer)) == 0);
+    // Nothing there
+    U_PORT_TEST_ASSERT(uRingBufferReadSpans(&ringBuffer, &pSpan1, &span1Length,
+                                            &pSpan2, &span2Length) == 0);
+    U_PORT_TEST_ASSERT(pSpan1 == NULL);
+    U_PORT_TEST_ASSERT(span1Length == 0);
+    U_PORT_TEST_ASSERT(pSpan2 == NULL);
+    U_PORT_TEST_ASSERT(span2Length == 0);
+    // Move the pointers to near the end so that data wraps
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 12));
+    U_PORT_TEST_ASSERT(uRingBufferConsume(&ringBuffer, 12) == 12);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 10));
+    U_PORT_TEST_ASSERT(uRingBufferReadSpans(&ringBuffer, &pSpan1, &span1Length,
+                                            &pSpan2, &span2Length) == 10);
+    U_PORT_TEST_ASSERT(pSpan1 == linearBuffer + 12);
+    U_PORT_TEST_ASSERT(span1Length == 4);
+    U_PORT_TEST_ASSERT(pSpan2 == linearBuffer);
+    U_PORT_TEST_ASSERT(span2Length == 6);
+    U_PORT_TEST_ASSERT(memcmp(pSpan1, bufferIn, span1Length) == 0);
+    U_PORT_TEST_ASSERT(memcmp(pSpan2, bufferIn + span1Length, span2Length) == 0);
+    // Contiguous only
+    U_PORT_TEST_ASSERT(uRingBufferReadSpans(&ringBuffer, &pSpan1, &span1Length,
+                                            NULL, NULL) == 4);
+    U_PORT_TEST_ASSERT(pSpan1 == linearBuffer + 12);
+    U_PORT_TEST_ASSERT(span1Length == 4);
+    // Consume some, the spans should follow
+    U_PORT_TEST_ASSERT(uRingBufferConsume(&ringBuffer, 5) == 5);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 5);
+    U_PORT_TEST_ASSERT(uRingBufferReadSpans(&ringBuffer, &pSpan1, &span1Length,
+                                            &pSpan2, &span2Length) == 5);
+    U_PORT_TEST_ASSERT(pSpan1 == linearBuffer + 1);
+    U_PORT_TEST_ASSERT(span1Length == 5);
+    U_PORT_TEST_ASSERT(pSpan2 == NULL);
+    U_PORT_TEST_ASSERT(memcmp(pSpan1, bufferIn + 5, span1Length) == 0);
+    // Consuming more than there is just empties it
+    U_PORT_TEST_ASSERT(uRingBufferConsume(&ringBuffer, 100) == 5);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 0);
+
+    // Reserve space that wraps, write into it and commit it
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 10));
+    U_PORT_TEST_ASSERT(uRingBufferConsume(&ringBuffer, 10) == 10);
+    // Write pointer is now at 0 + 6 + 10 = 16 => 0, so move it on a little
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 13));
+    U_PORT_TEST_ASSERT(uRingBufferConsume(&ringBuffer, 13) == 13);
+    // Write pointer at 13, only 15 bytes can ever be free
+    U_PORT_TEST_ASSERT(uRingBufferWriteReserve(&ringBuffer, 100, &pWrite1, &write1Length,
+                                               &pWrite2, &write2Length) == 15);
+    U_PORT_TEST_ASSERT(pWrite1 == linearBuffer + 13);
+    U_PORT_TEST_ASSERT(write1Length == 3);
+    U_PORT_TEST_ASSERT(pWrite2 == linearBuffer);
+    U_PORT_TEST_ASSERT(write2Length == 12);
+    // A second reservation, or an add, is not allowed while one is outstanding
+    U_PORT_TEST_ASSERT(uRingBufferWriteReserve(&ringBuffer, 1, &pWrite1, &write1Length,
+                                               NULL, NULL) == 0);
+    U_PORT_TEST_ASSERT(pWrite1 == NULL);
+    U_PORT_TEST_ASSERT(!uRingBufferAdd(&ringBuffer, bufferIn, 1));
+    // The reservation was cancelled by the failed attempt, reserve again
+    // and commit less than was reserved
+    U_PORT_TEST_ASSERT(uRingBufferWriteCommit(&ringBuffer, 0));
+    U_PORT_TEST_ASSERT(uRingBufferWriteReserve(&ringBuffer, 5, &pWrite1, &write1Length,
+                                               &pWrite2, &write2Length) == 5);
+    memcpy(pWrite1, bufferIn, write1Length);
+    memcpy(pWrite2, bufferIn + write1Length, write2Length);
+    // Can't commit more than was reserved
+    U_PORT_TEST_ASSERT(!uRingBufferWriteCommit(&ringBuffer, 6));
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferWriteReserve(&ringBuffer, 5, &pWrite1, &write1Length,
+                                               &pWrite2, &write2Length) == 5);
+    memcpy(pWrite1, bufferIn, write1Length);
+    memcpy(pWrite2, bufferIn + write1Length, write2Length);
+    U_PORT_TEST_ASSERT(uRingBufferWriteCommit(&ringBuffer, 4));
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 4);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, bufferOut, sizeof(bufferOut)) == 4);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn, 4) == 0);
+    uRingBufferDelete(&ringBuffer);
+
+    U_TEST_PRINT_LINE("testing spans with read handles.");
+    U_PORT_TEST_ASSERT(uRingBufferCreateWithReadHandle(&ringBuffer, linearBuffer,
+                                                       sizeof(linearBuffer), 1) == 0);
+    handle = uRingBufferTakeReadHandle(&ringBuffer);
+    U_PORT_TEST_ASSERT(handle >= 0);
+    // Normal read not allowed when a handle is required
+    uRingBufferSetReadRequiresHandle(&ringBuffer, true);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 6));
+    U_PORT_TEST_ASSERT(uRingBufferReadSpans(&ringBuffer, &pSpan1, &span1Length,
+                                            &pSpan2, &span2Length) == 0);
+    U_PORT_TEST_ASSERT(pSpan1 == NULL);
+    U_PORT_TEST_ASSERT(uRingBufferReadSpansHandle(&ringBuffer, handle,
+                                                  &pSpan1, &span1Length,
+                                                  &pSpan2, &span2Length) == 6);
+    U_PORT_TEST_ASSERT(span1Length == 6);
+    U_PORT_TEST_ASSERT(pSpan2 == NULL);
+    U_PORT_TEST_ASSERT(memcmp(pSpan1, bufferIn, span1Length) == 0);
+    // A non-forced reservation is limited by the unread data of the handle,
+    // whether it is locked or not
+    U_PORT_TEST_ASSERT(uRingBufferWriteReserve(&ringBuffer, 100, &pWrite1, &write1Length,
+                                               &pWrite2, &write2Length) ==
+                       sizeof(linearBuffer) - 1 - 6);
+    U_PORT_TEST_ASSERT(uRingBufferWriteCommit(&ringBuffer, 0));
+    // A forced one is limited only if the handle is locked
+    uRingBufferLockReadHandle(&ringBuffer, handle);
+    U_PORT_TEST_ASSERT(uRingBufferForceWriteReserve(&ringBuffer, 100, &pWrite1, &write1Length,
+                                                    &pWrite2, &write2Length) ==
+                       sizeof(linearBuffer) - 1 - 6);
+    U_PORT_TEST_ASSERT(uRingBufferWriteCommit(&ringBuffer, 0));
+    // The data in the spans is untouched
+    U_PORT_TEST_ASSERT(uRingBufferReadSpansHandle(&ringBuffer, handle,
+                                                  &pSpan1, &span1Length,
+                                                  &pSpan2, &span2Length) == 6);
+    U_PORT_TEST_ASSERT(memcmp(pSpan1, bufferIn, span1Length) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferConsumeHandle(&ringBuffer, handle, 2) == 2);
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle) == 4);
+    U_PORT_TEST_ASSERT(uRingBufferReadSpansHandle(&ringBuffer, handle,
+                                                  &pSpan1, &span1Length,
+                                                  &pSpan2, &span2Length) == 4);
+    U_PORT_TEST_ASSERT(memcmp(pSpan1, bufferIn + 2, span1Length) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferConsumeHandle(&ringBuffer, handle, 4) == 4);
+    // A handle that has been given back gets nothing
+    uRingBufferGiveReadHandle(&ringBuffer, handle);
+    U_PORT_TEST_ASSERT(uRingBufferReadSpansHandle(&ringBuffer, handle,
+                                                  &pSpan1, &span1Length,
+                                                  &pSpan2, &span2Length) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferConsumeHandle(&ringBuffer, handle, 1) == 0);
+    uRingBufferDelete(&ringBuffer);
+
+    U_TEST_PRINT_LINE("testing spans with a lock-free ring buffer.");
+    U_PORT_TEST_ASSERT(uRingBufferCreateLockFree(&ringBuffer, linearBuffer,
+                                                 sizeof(linearBuffer)) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 14));
+    U_PORT_TEST_ASSERT(uRingBufferConsume(&ringBuffer, 14) == 14);
+    U_PORT_TEST_ASSERT(uRingBufferWriteReserve(&ringBuffer, 8, &pWrite1, &write1Length,
+                                               &pWrite2, &write2Length) == 8);
+    U_PORT_TEST_ASSERT(pWrite1 == linearBuffer + 14);
+    U_PORT_TEST_ASSERT(write1Length == 2);
+    U_PORT_TEST_ASSERT(pWrite2 == linearBuffer);
+    U_PORT_TEST_ASSERT(write2Length == 6);
+    // Adding is not allowed while a reservation is outstanding
+    U_PORT_TEST_ASSERT(!uRingBufferAdd(&ringBuffer, bufferIn, 1));
+    memcpy(pWrite1, bufferIn, write1Length);
+    memcpy(pWrite2, bufferIn + write1Length, write2Length);
+    // Nothing is visible until committed
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferWriteCommit(&ringBuffer, 8));
+    U_PORT_TEST_ASSERT(uRingBufferReadSpans(&ringBuffer, &pSpan1, &span1Length,
+                                            &pSpan2, &span2Length) == 8);
+    U_PORT_TEST_ASSERT(pSpan1 == linearBuffer + 14);
+    U_PORT_TEST_ASSERT(span1Length == 2);
+    U_PORT_TEST_ASSERT(pSpan2 == linearBuffer);
+    U_PORT_TEST_ASSERT(span2Length == 6);
+    U_PORT_TEST_ASSERT(memcmp(pSpan1, bufferIn, span1Length) == 0);
+    U_PORT_TEST_ASSERT(memcmp(pSpan2, bufferIn + span1Length, span2Length) == 0);
+    // Forced reservation is not supported
+    U_PORT_TEST_ASSERT(uRingBufferForceWriteReserve(&ringBuffer, 1, &pWrite1, &write1Length,
+                                                    NULL, NULL) == 0);
+    // Reservation is limited by the free space
+    U_PORT_TEST_ASSERT(uRingBufferWriteReserve(&ringBuffer, 100, &pWrite1, &write1Length,
+                                               &pWrite2, &write2Length) ==
+                       sizeof(linearBuffer) - 1 - 8);
+    U_PORT_TEST_ASSERT(uRingBufferWriteCommit(&ringBuffer, 0));
+    U_PORT_TEST_ASSERT(uRingBufferConsume(&ringBuffer, 3) == 3);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, bufferOut, sizeof(bufferOut)) == 5);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn + 3, 5) == 0);
+    uRingBufferDelete(&ringBuffer);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
+// End of file
@@ -0,0 +1,193 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Test for the slab allocator API
+ */
+
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "errno.h"
+#include "stdlib.h"    // malloc(), free()
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"        // strncpy(), strcmp(), memcpy(), memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+#include "u_cfg_os_platform_specific.h"  // For #define U_CFG_OS_CLIB_LEAKS
+
+#include "u_error_common.h"
+
+#include "u_port_clib_platform_specific.h" /* struct timeval in some cases. */
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+#include "u_port_event_queue.h"
+#include "u_mempool.h"
+#include "u_slab.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_SLAB_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/** The total number of blocks in all of the size classes.
+ */
+#define U_TEST_SLAB_TOTAL_NUM_BLOCKS (U_SLAB_SIZE_CLASS_0_NUM_BLOCKS + \
+                                      U_SLAB_SIZE_CLASS_1_NUM_BLOCKS + \
+                                      U_SLAB_SIZE_CLASS_2_NUM_BLOCKS + \
+                                      U_SLAB_SIZE_CLASS_3_NUM_BLOCKS)
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Somewhere to keep the blocks allocated during testing.
+ */
+static uint8_t *gpBlock[U_TEST_SLAB_TOTAL_NUM_BLOCKS + 1];
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Get the number of blocks in use in all size classes.
+static int32_t usedBlockCount(void)
+{
+    uSlabStats_t stats;
+    int32_t count = 0;
+
+    for (int32_t x = 0; x < U_SLAB_NUM_SIZE_CLASSES; x++) {
+        U_PORT_TEST_ASSERT(uSlabGetStats(x, &stats) == 0);
+        count += stats.usedBlockCount;
+    }
+
+    return count;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TESTS
+ * -------------------------------------------------------------- */
+
+U_PORT_TEST_FUNCTION("[slab]", "slabBasic")
+{
+    uSlabStats_t stats;
+    uSlabStats_t statsStart[U_SLAB_NUM_SIZE_CLASSES];
+    int32_t usedAtStart;
+    size_t size;
+    int32_t heapUsed;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+
+    U_PORT_TEST_ASSERT(uSlabGetStats(-1, &stats) < 0);
+    U_PORT_TEST_ASSERT(uSlabGetStats(U_SLAB_NUM_SIZE_CLASSES, &stats) < 0);
+    for (int32_t x = 0; x < U_SLAB_NUM_SIZE_CLASSES; x++) {
+        U_PORT_TEST_ASSERT(uSlabGetStats(x, &(statsStart[x])) == 0);
+        if (x > 0) {
+            U_PORT_TEST_ASSERT(statsStart[x].blockSize > statsStart[x - 1].blockSize);
+        }
+        U_PORT_TEST_ASSERT(statsStart[x].numBlocks > 0);
+        U_TEST_PRINT_LINE("size class %d: %d block(s) of %d byte(s), %d in use"
+                          " (maximum %d), %d allocation(s) from the heap.", x,
+                          statsStart[x].numBlocks, (int) statsStart[x].blockSize,
+                          statsStart[x].usedBlockCount, statsStart[x].maxUsedBlockCount,
+                          statsStart[x].heapAllocCount);
+    }
+    // Something else may be holding blocks (e.g. an event queue
+    // in a background task) so work relative to that
+    usedAtStart = usedBlockCount();
+
+    // An allocation that is too big for any size class comes
+    // from the heap and is not counted
+    size = statsStart[U_SLAB_NUM_SIZE_CLASSES - 1].blockSize + 1;
+    gpBlock[0] = (uint8_t *) pUSlabAlloc(size);
+    U_PORT_TEST_ASSERT(gpBlock[0] != NULL);
+    memset(gpBlock[0], 0xAA, size);
+    U_PORT_TEST_ASSERT(usedBlockCount() == usedAtStart);
+    uSlabFree(gpBlock[0]);
+    uSlabFree(NULL);
+
+    // Each size fits into the right size class
+    for (int32_t x = 0; x < U_SLAB_NUM_SIZE_CLASSES; x++) {
+        gpBlock[x] = (uint8_t *) pUSlabAlloc(statsStart[x].blockSize);
+        U_PORT_TEST_ASSERT(gpBlock[x] != NULL);
+        // Should be aligned
+        U_PORT_TEST_ASSERT(((uintptr_t) gpBlock[x] % sizeof(uint32_t)) == 0);
+        memset(gpBlock[x], x, statsStart[x].blockSize);
+        U_PORT_TEST_ASSERT(uSlabGetStats(x, &stats) == 0);
+        U_PORT_TEST_ASSERT(stats.usedBlockCount == statsStart[x].usedBlockCount + 1);
+    }
+    for (int32_t x = 0; x < U_SLAB_NUM_SIZE_CLASSES; x++) {
+        for (size_t y = 0; y < statsStart[x].blockSize; y++) {
+            U_PORT_TEST_ASSERT(*(gpBlock[x] + y) == x);
+        }
+        uSlabFree(gpBlock[x]);
+    }
+    U_PORT_TEST_ASSERT(usedBlockCount() == usedAtStart);
+
+    // Fill all of the size classes with the smallest allocations:
+    // they should overflow into the larger size classes and then
+    // into the heap
+    for (size_t x = 0; x < sizeof(gpBlock) / sizeof(gpBlock[0]); x++) {
+        gpBlock[x] = (uint8_t *) pUSlabAlloc(1);
+        U_PORT_TEST_ASSERT(gpBlock[x] != NULL);
+        *gpBlock[x] = (uint8_t) x;
+    }
+    U_PORT_TEST_ASSERT(usedBlockCount() == U_TEST_SLAB_TOTAL_NUM_BLOCKS);
+    U_PORT_TEST_ASSERT(uSlabGetStats(0, &stats) == 0);
+    U_PORT_TEST_ASSERT(stats.heapAllocCount > statsStart[0].heapAllocCount);
+    U_PORT_TEST_ASSERT(stats.maxUsedBlockCount == stats.numBlocks);
+    for (size_t x = 0; x < sizeof(gpBlock) / sizeof(gpBlock[0]); x++) {
+        U_PORT_TEST_ASSERT(*gpBlock[x] == (uint8_t) x);
+        uSlabFree(gpBlock[x]);
+    }
+    U_PORT_TEST_ASSERT(usedBlockCount() == usedAtStart);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
+// End of file
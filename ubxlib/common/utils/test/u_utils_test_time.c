@@ -0,0 +1,313 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Test for the time manipulation API
+ */
+
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stdlib.h"    // malloc(), free()
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+#include "u_time.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_TIME_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_TEST_TIME_START_YEAR
+/** The first year of the exhaustive test; the range should
+ * include a year divisible by 100 but not 400 and one divisible
+ * by 400.
+ */
+# define U_TEST_TIME_START_YEAR 1900
+#endif
+
+#ifndef U_TEST_TIME_END_YEAR
+/** The last year of the exhaustive test.
+ */
+# define U_TEST_TIME_END_YEAR 2199
+#endif
+
+#ifndef U_TEST_TIME_SPEED_MS
+/** How long to run each conversion for when measuring speed.
+ */
+# define U_TEST_TIME_SPEED_MS 1000
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A date and the seconds since 1970 it should convert to.
+ */
+typedef struct {
+    uTimeDate_t date;
+    int64_t epoch;
+} uTestTimeDate_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Dates with known answers.
+ */
+static const uTestTimeDate_t gTestDate[] = {
+    {{1970,  1,  1,  0,  0,  0}, 0},
+    {{1969, 12, 31, 23, 59, 59}, -1},
+    {{2000,  2, 29, 12,  0,  0}, 951825600LL},
+    {{2038,  1, 19,  3, 14,  8}, 2147483648LL},
+    {{2100,  3,  1,  0,  0,  0}, 4107542400LL},
+    {{1600,  1,  1,  0,  0,  0}, -11676096000LL},
+    {{   1,  1,  1,  0,  0,  0}, -62135596800LL},
+    {{9999, 12, 31, 23, 59, 59}, 253402300799LL}
+};
+
+/** Proof that the macro form is a constant expression.
+ */
+static const int64_t gEpoch2038 = U_TIME_DATE_TO_EPOCH(2038, 1, 19, 3, 14, 8);
+
+/** Days in each month of a year that is not a leap year.
+ */
+static const int32_t gDaysInMonth[] = {31, 28, 31, 30, 31, 30,
+                                       31, 31, 30, 31, 30, 31
+                                      };
+
+/** Somewhere to put results so that the compiler can't optimise
+ * the conversions away when measuring speed.
+ */
+static volatile int64_t gSink;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Check that two dates are the same.
+static bool dateIsEqual(const uTimeDate_t *pA, const uTimeDate_t *pB)
+{
+    return (pA->year == pB->year) && (pA->month == pB->month) &&
+           (pA->day == pB->day) && (pA->hours == pB->hours) &&
+           (pA->minutes == pB->minutes) && (pA->seconds == pB->seconds);
+}
+
+// Conversion of a date to seconds since 1970 the way it used to be
+// done, a month at a time from 1970, for comparison.
+static int64_t dateToEpochByMonth(const uTimeDate_t *pDate)
+{
+    int64_t epoch = 0;
+    int32_t months = ((pDate->year - 1970) * 12) + pDate->month - 1;
+    int32_t days;
+
+    for (int32_t x = 0; x < months; x++) {
+        days = gDaysInMonth[x % 12];
+        if (((x % 12) == 1) && uTimeIsLeapYear((x / 12) + 1970)) {
+            days++;
+        }
+        epoch += (int64_t) days * 3600 * 24;
+    }
+
+    return epoch + ((int64_t) (pDate->day - 1) * 3600 * 24) +
+           ((int64_t) pDate->hours * 3600) + ((int64_t) pDate->minutes * 60) +
+           pDate->seconds;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TESTS
+ * -------------------------------------------------------------- */
+
+/** Test conversion of known dates, the leap year rules and the
+ * handling of out of range months.
+ */
+U_PORT_TEST_FUNCTION("[time]", "timeBasic")
+{
+    uTimeDate_t date;
+    const uTimeDate_t *pDate;
+
+    U_PORT_TEST_ASSERT(gEpoch2038 == 2147483648LL);
+    U_PORT_TEST_ASSERT(U_TIME_DAYS_FROM_CIVIL(1970, 1, 1) == 0);
+    U_PORT_TEST_ASSERT(U_TIME_DAYS_FROM_CIVIL(1969, 12, 31) == -1);
+
+    for (size_t x = 0; x < sizeof(gTestDate) / sizeof(gTestDate[0]); x++) {
+        pDate = &(gTestDate[x].date);
+        U_PORT_TEST_ASSERT(uTimeDateToEpoch(pDate) == gTestDate[x].epoch);
+        U_PORT_TEST_ASSERT(U_TIME_DATE_TO_EPOCH(pDate->year, pDate->month, pDate->day,
+                                                pDate->hours, pDate->minutes,
+                                                pDate->seconds) == gTestDate[x].epoch);
+        memset(&date, 0xFF, sizeof(date));
+        uTimeEpochToDate(gTestDate[x].epoch, &date);
+        U_PORT_TEST_ASSERT(dateIsEqual(&date, pDate));
+    }
+
+    U_PORT_TEST_ASSERT(uTimeIsLeapYear(2000));
+    U_PORT_TEST_ASSERT(uTimeIsLeapYear(2024));
+    U_PORT_TEST_ASSERT(!uTimeIsLeapYear(2023));
+    U_PORT_TEST_ASSERT(!uTimeIsLeapYear(2100));
+    U_PORT_TEST_ASSERT(!uTimeIsLeapYear(1900));
+
+    // Months out of range run on into the adjacent years, as mktime()
+    date = gTestDate[0].date;
+    date.month = 13;
+    U_PORT_TEST_ASSERT(uTimeDateToEpoch(&date) == 31536000LL);
+    date.month = 0;
+    U_PORT_TEST_ASSERT(uTimeDateToEpoch(&date) == -31 * 3600 * 24);
+    date.month = -11;
+    U_PORT_TEST_ASSERT(uTimeDateToEpoch(&date) == -365 * 3600 * 24);
+    // ...as do seconds
+    date = gTestDate[0].date;
+    date.seconds = 61;
+    U_PORT_TEST_ASSERT(uTimeDateToEpoch(&date) == 61);
+
+    U_PORT_TEST_ASSERT(uTimeMonthsToSecondsUtc(-1) == 0);
+    U_PORT_TEST_ASSERT(uTimeMonthsToSecondsUtc(0) == 0);
+    U_PORT_TEST_ASSERT(uTimeMonthsToSecondsUtc(12) == 31536000LL);
+}
+
+/** Test every day over a range of years against a day-by-day count,
+ * in both directions.
+ */
+U_PORT_TEST_FUNCTION("[time]", "timeExhaustive")
+{
+    uTimeDate_t date = {U_TEST_TIME_START_YEAR, 1, 1, 0, 0, 0};
+    uTimeDate_t dateOut;
+    int64_t epoch;
+    int64_t days;
+    int32_t daysInMonth;
+    int32_t count = 0;
+
+    epoch = uTimeDateToEpoch(&date);
+    days = epoch / (3600 * 24);
+    U_PORT_TEST_ASSERT(epoch == days * 3600 * 24);
+    U_PORT_TEST_ASSERT(days == U_TIME_DAYS_FROM_CIVIL(U_TEST_TIME_START_YEAR, 1, 1));
+
+    U_TEST_PRINT_LINE("checking every day from %d to %d...",
+                      U_TEST_TIME_START_YEAR, U_TEST_TIME_END_YEAR);
+    for (date.year = U_TEST_TIME_START_YEAR; date.year <= U_TEST_TIME_END_YEAR; date.year++) {
+        for (date.month = 1; date.month <= 12; date.month++) {
+            if (date.year >= 1970) {
+                U_PORT_TEST_ASSERT(uTimeMonthsToSecondsUtc(((date.year - 1970) * 12) +
+                                                           date.month - 1) == days * 3600 * 24);
+            }
+            daysInMonth = gDaysInMonth[date.month - 1];
+            if ((date.month == 2) && uTimeIsLeapYear(date.year)) {
+                daysInMonth++;
+            }
+            for (date.day = 1; date.day <= daysInMonth; date.day++) {
+                U_PORT_TEST_ASSERT(U_TIME_DAYS_FROM_CIVIL(date.year, date.month, date.day) == days);
+                date.hours = 0;
+                date.minutes = 0;
+                date.seconds = 0;
+                U_PORT_TEST_ASSERT(uTimeDateToEpoch(&date) == days * 3600 * 24);
+                uTimeEpochToDate(days * 3600 * 24, &dateOut);
+                U_PORT_TEST_ASSERT(dateIsEqual(&dateOut, &date));
+                // The last second of the day too
+                date.hours = 23;
+                date.minutes = 59;
+                date.seconds = 59;
+                epoch = (days * 3600 * 24) + (3600 * 24) - 1;
+                U_PORT_TEST_ASSERT(uTimeDateToEpoch(&date) == epoch);
+                uTimeEpochToDate(epoch, &dateOut);
+                U_PORT_TEST_ASSERT(dateIsEqual(&dateOut, &date));
+                days++;
+                count++;
+            }
+        }
+    }
+    U_TEST_PRINT_LINE("%d days checked.", count);
+}
+
+/** Measure the speed of conversion, of the functions in the API
+ * and of the month-at-a-time version for comparison.
+ */
+U_PORT_TEST_FUNCTION("[time]", "timeSpeed")
+{
+    uTimeDate_t date = {2022, 6, 15, 12, 30, 45};
+    int64_t epoch = uTimeDateToEpoch(&date);
+    int32_t startTimeMs;
+    int32_t durationMs;
+    int32_t count;
+    int32_t toEpochPerSecond;
+    int32_t toDatePerSecond;
+    int32_t byMonthPerSecond;
+
+    U_PORT_TEST_ASSERT(dateToEpochByMonth(&date) == epoch);
+
+    count = 0;
+    startTimeMs = uPortGetTickTimeMs();
+    do {
+        gSink = uTimeDateToEpoch(&date);
+        count++;
+        durationMs = uPortGetTickTimeMs() - startTimeMs;
+    } while (durationMs < U_TEST_TIME_SPEED_MS);
+    toEpochPerSecond = (int32_t) (((int64_t) count * 1000) / durationMs);
+
+    count = 0;
+    startTimeMs = uPortGetTickTimeMs();
+    do {
+        uTimeEpochToDate(epoch, &date);
+        gSink = date.day;
+        count++;
+        durationMs = uPortGetTickTimeMs() - startTimeMs;
+    } while (durationMs < U_TEST_TIME_SPEED_MS);
+    toDatePerSecond = (int32_t) (((int64_t) count * 1000) / durationMs);
+
+    count = 0;
+    startTimeMs = uPortGetTickTimeMs();
+    do {
+        gSink = dateToEpochByMonth(&date);
+        count++;
+        durationMs = uPortGetTickTimeMs() - startTimeMs;
+    } while (durationMs < U_TEST_TIME_SPEED_MS);
+    byMonthPerSecond = (int32_t) (((int64_t) count * 1000) / durationMs);
+
+    U_TEST_PRINT_LINE("date to epoch: %d conversions/s, month at a time %d conversions/s.",
+                      toEpochPerSecond, byMonthPerSecond);
+    U_TEST_PRINT_LINE("epoch to date: %d conversions/s.", toDatePerSecond);
+    U_PORT_TEST_ASSERT(toEpochPerSecond > 0);
+    U_PORT_TEST_ASSERT(toDatePerSecond > 0);
+}
+
+// End of file
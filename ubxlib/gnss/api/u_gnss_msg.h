@@ -58,20 +58,30 @@ extern "C" {
  * streamed (e.g. over I2C or UART) from the GNSS chip.  Should
  * be big enough to hold a few long messages from the device
  * while these are read asynchronously in task-space by the
- * application.
+ * application.  This is only the starting size: see
+ * uGnssMsgReceiveSetRingBufferAutoSize() for a way to have
+ * it adapt to the data flow.
  */
 # define U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES 2048
 #endif
 
-#ifndef U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES
-/** A temporary buffer, used as a staging post to
- * get stuff from a streaming source (e.g. I2C or UART)
- * into the ring buffer; must be less than
- * U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES - 1 but, since this
- * is just a "chunking" temporary buffer, a rather smaller
- * value is usually a good idea anyway.
+#ifndef U_GNSS_MSG_RING_BUFFER_AUTO_SIZE_WINDOW_MS
+/** The period over which the use of the ring buffer is assessed
+ * when automatic ring buffer sizing is on, see
+ * uGnssMsgReceiveSetRingBufferAutoSize().
  */
-# define U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES (U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES / 8)
+# define U_GNSS_MSG_RING_BUFFER_AUTO_SIZE_WINDOW_MS 5000
+#endif
+
+#ifndef U_GNSS_MSG_RING_BUFFER_AUTO_SIZE_SHRINK_WINDOWS
+/** The number of consecutive windows of
+ * #U_GNSS_MSG_RING_BUFFER_AUTO_SIZE_WINDOW_MS in which the ring
+ * buffer must never be more than a quarter full before automatic
+ * ring buffer sizing halves it; growing, on the other hand, happens
+ * at the end of the first window in which data is lost or the ring
+ * buffer is more than three quarters full.
+ */
+# define U_GNSS_MSG_RING_BUFFER_AUTO_SIZE_SHRINK_WINDOWS 6
 #endif
 
 #ifndef U_GNSS_MSG_RECEIVER_MAX_NUM
@@ -93,6 +103,22 @@ extern "C" {
 # define U_GNSS_MSG_RECEIVE_TASK_STACK_SIZE_BYTES (1024 * 3)
 #endif
 
+#ifndef U_GNSS_MSG_RECEIVE_TASK_SHARED
+/** Set this to 1 to have a single task service the asynchronous
+ * message receive of ALL GNSS instances, rather than each GNSS
+ * instance starting a task of its own in uGnssMsgReceiveStart().
+ * This is useful where several GNSS chips are attached to one MCU:
+ * N receivers then cost one stack of
+ * #U_GNSS_MSG_RECEIVE_TASK_STACK_SIZE_BYTES rather than N of them,
+ * plus no per-instance task, queue or task-running mutex.  Each
+ * instance is still polled at its own rate, adapted to the data
+ * arriving from it.  Note that the callbacks of all instances are
+ * then called from the same task, so a slow callback for one GNSS
+ * instance will delay the servicing of all the others.
+ */
+# define U_GNSS_MSG_RECEIVE_TASK_SHARED 0
+#endif
+
 #ifndef U_GNSS_MSG_RECEIVE_TASK_QUEUE_LENGTH
 /** The length of the queue controlling the message receive
  * task: just need the one.
@@ -107,6 +133,14 @@ extern "C" {
 # define U_GNSS_MSG_RECEIVE_TASK_QUEUE_ITEM_SIZE_BYTES 1
 #endif
 
+/** The length of the header that precedes each record of a
+ * capture made with uGnssMsgCaptureStart(): a 32-bit little-endian
+ * time in milliseconds, relative to the start of the capture, at
+ * which the data was read from the GNSS chip, followed by the 16-bit
+ * little-endian length of the data that follows the header.
+ */
+#define U_GNSS_MSG_CAPTURE_HEADER_LENGTH_BYTES 6
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -162,6 +196,31 @@ typedef void (*uGnssMsgReceiveCallback_t)(uDeviceHandle_t gnssHandle,
                                           int32_t errorCodeOrLength,
                                           void *pCallbackParam);
 
+/** Callback that is called by the message receive task when data
+ * has been read from the GNSS chip while a capture, started with
+ * uGnssMsgCaptureStart(), is in progress; use this, for instance, to
+ * write the capture to a file.  pHeader followed by pData, written
+ * one after the other, form a record in the same format as that
+ * written to the capture buffer, hence a sequence of such records
+ * may be passed to uGnssMsgReplayStart().  This callback should be
+ * executed as quickly as possible to avoid data loss and it must
+ * NOT call any GNSS API functions.
+ *
+ * @param gnssHandle             the handle of the GNSS instance.
+ * @param[in] pHeader            the record header,
+ *                               #U_GNSS_MSG_CAPTURE_HEADER_LENGTH_BYTES
+ *                               long.
+ * @param[in] pData              the data read from the GNSS chip.
+ * @param size                   the amount of data at pData.
+ * @param[in,out] pCallbackParam the callback parameter that was originally
+ *                               given to uGnssMsgCaptureStart().
+ */
+typedef void (*uGnssMsgCaptureCallback_t)(uDeviceHandle_t gnssHandle,
+                                          const char *pHeader,
+                                          const char *pData,
+                                          size_t size,
+                                          void *pCallbackParam);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: MISC
  * -------------------------------------------------------------- */
@@ -357,7 +416,9 @@ int32_t uGnssMsgReceive(uDeviceHandle_t gnssHandle,
  *                               uGnssMsgIsGood(), no others or you risk
  *                               getting mutex-locked. pCallback is run in
  *                               the context of a task with a stack of size
- *                               #U_GNSS_MSG_RECEIVE_TASK_STACK_SIZE_BYTES;
+ *                               #U_GNSS_MSG_RECEIVE_TASK_STACK_SIZE_BYTES,
+ *                               shared between all GNSS instances if
+ *                               #U_GNSS_MSG_RECEIVE_TASK_SHARED is 1;
  *                               you may you may call uGnssMsgReceiveStackMinFree()
  *                               just before calling uGnssMsgReceiveStop()
  *                               to check if the remaining stack margin was
@@ -438,6 +499,46 @@ int32_t uGnssMsgReceiveStop(uDeviceHandle_t gnssHandle,
  */
 int32_t uGnssMsgReceiveStopAll(uDeviceHandle_t gnssHandle);
 
+/** Switch automatic output-rate tuning on or off; it is off by
+ * default.  When it is on, the GNSS chip is asked to emit a
+ * message only while something wants it: a reader started with
+ * uGnssMsgReceiveStart() or a uGnssMsgReceive() that is waiting.
+ * Output rates are set to 1 (every navigation epoch) or 0 in the
+ * RAM layer of the GNSS chip, with changes batched into as few
+ * UBX-CFG-VALSET messages as possible, for the port that this MCU
+ * is connected to.  This saves bandwidth on the port and the effort
+ * of parsing messages that no-one will read (see
+ * uGnssMsgReceiveStatStreamLoss()).
+ *
+ * So that calling uGnssMsgReceive() in a loop doesn't cost two
+ * UBX-CFG-VALSET messages per call, a message that uGnssMsgReceive()
+ * was waiting for is left on for U_GNSS_MSG_OUT_HOLD_OFF_TIME_MS
+ * afterwards; it is switched off by the first of uGnssMsgReceive(),
+ * uGnssMsgReceiveStart() or uGnssMsgReceiveStop() to be called
+ * once that time is up.  If the GNSS chip rejects a message with
+ * a NAK its output rate is left alone from then on; if setting an
+ * output rate fails for any other reason (e.g. a timeout) it is
+ * tried again next time.
+ *
+ * Only readers that ask for a specific message are counted: a
+ * reader with a wildcard message ID (e.g. all NMEA messages) gets
+ * whatever the others cause to be emitted.  Only commonly used NMEA,
+ * UBX and RTCM messages are covered; the output rate of a message
+ * that is not covered, or that the GNSS chip does not support, is
+ * left alone.  Switching this on turns off the periodic output of
+ * every covered message that no reader wants, so it is only useful
+ * where everything that reads the GNSS stream does so through this
+ * API.  Switching it off leaves the output rates as they are.  Only
+ * supported by M9 modules and later.
+ *
+ * @param gnssHandle   the handle of the GNSS instance.
+ * @param onNotOff     true to switch automatic output-rate tuning
+ *                     on, false to switch it off.
+ * @return             zero on success else negative error code.
+ */
+int32_t uGnssMsgReceiveSetAutoOutput(uDeviceHandle_t gnssHandle,
+                                     bool onNotOff);
+
 /** Return the minimum number of bytes of stack free in the task
  * that is running the message receive.  Will return a valid
  * number only if at least one uGnssMsgReceiveStart() is running.
@@ -474,6 +575,134 @@ size_t uGnssMsgReceiveStatReadLoss(uDeviceHandle_t gnssHandle);
  */
 size_t uGnssMsgReceiveStatStreamLoss(uDeviceHandle_t gnssHandle);
 
+/** Switch automatic sizing of the ring buffer on or off; off by
+ * default, in which case the ring buffer stays at
+ * #U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES.  When on, while a
+ * non-blocking message receive is running (see
+ * uGnssMsgReceiveStart()), the highest fill level of the ring buffer
+ * and the loss counts (see uGnssMsgReceiveStatReadLoss() and
+ * uGnssMsgReceiveStatStreamLoss()) are assessed every
+ * #U_GNSS_MSG_RING_BUFFER_AUTO_SIZE_WINDOW_MS and the ring buffer
+ * is doubled in size if data has been lost or it came close to
+ * being full, or halved if it has been little used for
+ * #U_GNSS_MSG_RING_BUFFER_AUTO_SIZE_SHRINK_WINDOWS in a row, within
+ * the limits given here.  A change of size is made by the message
+ * receive task in between messages, no data is lost in the process,
+ * and it requires a heap allocation of the new size while the old
+ * one still exists.  The size is not put back when automatic sizing
+ * is switched off.  Only relevant for streaming transports (e.g.
+ * UART or I2C).
+ *
+ * @param gnssHandle   the handle of the GNSS instance.
+ * @param minSizeBytes the smallest the ring buffer may become.
+ * @param maxSizeBytes the largest the ring buffer may become; use
+ *                     zero (with minSizeBytes zero) to switch
+ *                     automatic sizing off.
+ * @return             zero on success else negative error code.
+ */
+int32_t uGnssMsgReceiveSetRingBufferAutoSize(uDeviceHandle_t gnssHandle,
+                                             size_t minSizeBytes,
+                                             size_t maxSizeBytes);
+
+/** Get the current size of the ring buffer, which will only differ
+ * from #U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES if
+ * uGnssMsgReceiveSetRingBufferAutoSize() has been used.
+ *
+ * @param gnssHandle   the handle of the GNSS instance.
+ * @return             the size of the ring buffer in bytes, else
+ *                     negative error code.
+ */
+int32_t uGnssMsgReceiveGetRingBufferSize(uDeviceHandle_t gnssHandle);
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS: CAPTURE/REPLAY
+ * -------------------------------------------------------------- */
+
+/** Start capturing the raw byte stream from the GNSS chip, each
+ * chunk read preceded by a #U_GNSS_MSG_CAPTURE_HEADER_LENGTH_BYTES
+ * header that records when it was read, so that the capture may
+ * later be passed to uGnssMsgReplayStart() to reproduce a session
+ * exactly.  The capture is written to pBuffer, a RAM log, and/or is
+ * passed to pCallback, which might write it to a file.  The data is
+ * captured as it is read by the message receive task, hence a
+ * capture only includes data while uGnssMsgReceiveStart() is active.
+ * Only available where the transport is a streaming one (UART or I2C).
+ * Any capture already in progress is stopped and its data discarded.
+ *
+ * @param gnssHandle         the handle of the GNSS instance.
+ * @param[in] pBuffer        a buffer to write the capture to; may be
+ *                           NULL if pCallback is not NULL.  Records
+ *                           that do not fit are dropped and counted,
+ *                           see uGnssMsgCaptureStop().
+ * @param size               the amount of storage at pBuffer.
+ * @param[in] pCallback      a callback to be called with each record
+ *                           as it is captured; may be NULL if pBuffer
+ *                           is not NULL.
+ * @param[in] pCallbackParam will be passed to pCallback as its last
+ *                           parameter.
+ * @return                   zero on success else negative error code.
+ */
+int32_t uGnssMsgCaptureStart(uDeviceHandle_t gnssHandle,
+                             char *pBuffer, size_t size,
+                             uGnssMsgCaptureCallback_t pCallback,
+                             void *pCallbackParam);
+
+/** Stop a capture begun with uGnssMsgCaptureStart().
+ *
+ * @param gnssHandle       the handle of the GNSS instance.
+ * @param[out] pLostBytes  a place to put the number of bytes of data
+ *                         that could not be written to the capture
+ *                         buffer because it was full; may be NULL.
+ * @return                 on success the number of bytes written to
+ *                         the capture buffer, else negative error code.
+ */
+int32_t uGnssMsgCaptureStop(uDeviceHandle_t gnssHandle,
+                            size_t *pLostBytes);
+
+/** Replay a capture made with uGnssMsgCaptureStart() in place of
+ * the stream from the GNSS chip: while a replay is active the
+ * message receive task, and hence anything using uGnssMsgReceive()
+ * or uGnssMsgReceiveStart(), is fed from the capture rather than
+ * from the GNSS chip; data sent with uGnssMsgSend() still goes to
+ * the GNSS chip.  This allows a session to be reproduced
+ * deterministically, e.g. on a Linux host, where the GNSS instance
+ * may be added on a UART with nothing connected to it.  Once the
+ * capture has been replayed nothing further is received until
+ * uGnssMsgReplayStop() is called.  Any replay already in progress
+ * is replaced.
+ *
+ * @param gnssHandle    the handle of the GNSS instance.
+ * @param[in] pCapture  the capture, which will be copied by this
+ *                      function; cannot be NULL.
+ * @param size          the amount of data at pCapture.
+ * @param maxSpeed      if true the capture is replayed as fast as
+ *                      the receiver can keep up, else each record is
+ *                      replayed at the time, relative to the call to
+ *                      this function, at which it was captured.
+ * @return              zero on success else negative error code.
+ */
+int32_t uGnssMsgReplayStart(uDeviceHandle_t gnssHandle,
+                            const char *pCapture, size_t size,
+                            bool maxSpeed);
+
+/** Get the number of bytes of a replay started with
+ * uGnssMsgReplayStart() that have not yet been replayed.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @return            on success the number of bytes of the
+ *                    capture (including headers) still to be
+ *                    replayed, else negative error code.
+ */
+int32_t uGnssMsgReplayGetRemaining(uDeviceHandle_t gnssHandle);
+
+/** Stop a replay begun with uGnssMsgReplayStart(); reception
+ * will revert to being from the GNSS chip.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @return            zero on success else negative error code.
+ */
+int32_t uGnssMsgReplayStop(uDeviceHandle_t gnssHandle);
+
 #ifdef __cplusplus
 }
 #endif
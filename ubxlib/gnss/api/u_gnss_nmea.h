@@ -0,0 +1,323 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_NMEA_H_
+#define _U_GNSS_NMEA_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the NMEA field parsing functions
+ * of the GNSS API.  These functions take an NMEA sentence, as
+ * obtained with uGnssMsgReceive() or in the callback of
+ * uGnssMsgReceiveStart(), and parse it in place: fields are returned
+ * as views into the sentence, nothing is copied, and all values are
+ * decoded as fixed-point integers, no floating point or sscanf() is
+ * involved.  These functions do not talk to the GNSS chip and may
+ * be called from anywhere, including a message receive callback.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The value used in the structures populated by the decoders
+ * of this API for a field that is empty in the NMEA sentence.
+ */
+#define U_GNSS_NMEA_FIELD_NOT_PRESENT INT32_MIN
+
+/** The maximum number of satellites in an NMEA GSA sentence.
+ */
+#define U_GNSS_NMEA_GSA_MAX_NUM_SVS 12
+
+/** The maximum number of satellites in an NMEA GSV sentence.
+ */
+#define U_GNSS_NMEA_GSV_MAX_NUM_SATELLITES 4
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A field of an NMEA sentence: a view into the sentence, NOT
+ * null-terminated.
+ */
+typedef struct {
+    const char *pData; /**< the start of the field. */
+    size_t size;       /**< the number of characters in the field,
+                            zero if the field is empty. */
+} uGnssNmeaField_t;
+
+/** Context for uGnssNmeaTokenizerNext(), set up by
+ * uGnssNmeaTokenizerInit(); the contents should not be touched
+ * by the application.
+ */
+typedef struct {
+    const char *pNext;
+    const char *pEnd;
+    bool done;
+} uGnssNmeaTokenizer_t;
+
+/** The decoded contents of an NMEA GGA sentence; any value
+ * not present in the sentence is set to #U_GNSS_NMEA_FIELD_NOT_PRESENT.
+ */
+typedef struct {
+    char talker[2];                     /**< the talker ID, e.g. "GN", NOT null-terminated. */
+    int32_t timeOfDayMs;                /**< UTC time of day in milliseconds. */
+    int32_t latitudeX1e7;               /**< latitude in ten millionths of a degree. */
+    int32_t longitudeX1e7;              /**< longitude in ten millionths of a degree. */
+    int32_t quality;                    /**< the fix quality, 0 for no fix. */
+    int32_t numSvs;                     /**< the number of satellites used. */
+    int32_t hdopX100;                   /**< horizontal dilution of precision times 100. */
+    int32_t altitudeMillimetres;        /**< altitude above mean sea level. */
+    int32_t geoidSeparationMillimetres; /**< height of the geoid above the ellipsoid. */
+} uGnssNmeaGga_t;
+
+/** The decoded contents of an NMEA RMC sentence; any value
+ * not present in the sentence is set to #U_GNSS_NMEA_FIELD_NOT_PRESENT.
+ */
+typedef struct {
+    char talker[2];                    /**< the talker ID, e.g. "GN", NOT null-terminated. */
+    int32_t timeOfDayMs;               /**< UTC time of day in milliseconds. */
+    bool valid;                        /**< true if the status field is 'A'. */
+    int32_t latitudeX1e7;              /**< latitude in ten millionths of a degree. */
+    int32_t longitudeX1e7;             /**< longitude in ten millionths of a degree. */
+    int32_t speedMillimetresPerSecond; /**< speed over ground. */
+    int32_t courseDegreesX100;         /**< course over ground in hundredths of a degree. */
+    int32_t day;                       /**< UTC day of the month, 1 to 31. */
+    int32_t month;                     /**< UTC month, 1 to 12. */
+    int32_t year;                      /**< UTC year, e.g. 2022. */
+    char mode;                         /**< the mode indicator (NMEA 2.3 and later),
+                                            e.g. 'A' for autonomous, 0 if not present. */
+} uGnssNmeaRmc_t;
+
+/** The decoded contents of an NMEA GSA sentence; any value
+ * not present in the sentence is set to #U_GNSS_NMEA_FIELD_NOT_PRESENT.
+ */
+typedef struct {
+    char talker[2];                         /**< the talker ID, e.g. "GN", NOT null-terminated. */
+    char opMode;                            /**< 'M' for manual or 'A' for automatic, 0 if not
+                                                 present. */
+    int32_t fixType;                        /**< 1 for no fix, 2 for 2D, 3 for 3D. */
+    int32_t svId[U_GNSS_NMEA_GSA_MAX_NUM_SVS]; /**< the IDs of the satellites used. */
+    size_t numSvs;                          /**< the number of entries populated in svId[]. */
+    int32_t pdopX100;                       /**< position dilution of precision times 100. */
+    int32_t hdopX100;                       /**< horizontal dilution of precision times 100. */
+    int32_t vdopX100;                       /**< vertical dilution of precision times 100. */
+    int32_t systemId;                       /**< the GNSS system ID (NMEA 4.10 and later). */
+} uGnssNmeaGsa_t;
+
+/** A satellite in an NMEA GSV sentence; any value not present
+ * in the sentence is set to #U_GNSS_NMEA_FIELD_NOT_PRESENT.
+ */
+typedef struct {
+    int32_t svId;
+    int32_t elevationDegrees;
+    int32_t azimuthDegrees;
+    int32_t cnoDbHz;
+} uGnssNmeaGsvSatellite_t;
+
+/** The decoded contents of an NMEA GSV sentence; any value
+ * not present in the sentence is set to #U_GNSS_NMEA_FIELD_NOT_PRESENT.
+ */
+typedef struct {
+    char talker[2];         /**< the talker ID, e.g. "GP", NOT null-terminated. */
+    int32_t numMessages;    /**< the number of GSV sentences in this set. */
+    int32_t messageNumber;  /**< the number of this sentence in the set, from 1. */
+    int32_t numSvsInView;   /**< the total number of satellites in view. */
+    uGnssNmeaGsvSatellite_t satellite[U_GNSS_NMEA_GSV_MAX_NUM_SATELLITES];
+    size_t numSatellites;   /**< the number of entries populated in satellite[]. */
+    int32_t signalId;       /**< the signal ID (NMEA 4.10 and later). */
+} uGnssNmeaGsv_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS: TOKENIZER
+ * -------------------------------------------------------------- */
+
+/** Set up to tokenize an NMEA sentence.  The sentence must begin
+ * with '$' (or '!'); if it includes a "*hh" checksum then the
+ * checksum is verified.  Any trailing CR/LF is ignored.  The
+ * sentence is not copied, hence it must remain in place while
+ * the tokenizer and the fields it returns are in use.
+ *
+ * @param[out] pTokenizer a place to put the tokenizer context;
+ *                        cannot be NULL.
+ * @param[in] pSentence   the NMEA sentence; need not be
+ *                        null-terminated, cannot be NULL.
+ * @param size            the number of characters at pSentence.
+ * @return                zero on success, #U_GNSS_ERROR_CRC if
+ *                        the checksum is incorrect, else negative
+ *                        error code.
+ */
+int32_t uGnssNmeaTokenizerInit(uGnssNmeaTokenizer_t *pTokenizer,
+                               const char *pSentence, size_t size);
+
+/** Get the next field of a sentence; the first field returned is
+ * the address field (e.g. "GNGGA").
+ *
+ * @param[in] pTokenizer the tokenizer context, as populated by
+ *                       uGnssNmeaTokenizerInit(); cannot be NULL.
+ * @param[out] pField    a place to put the field; cannot be NULL.
+ * @return               true if a field was returned, false if
+ *                       there are no more fields.
+ */
+bool uGnssNmeaTokenizerNext(uGnssNmeaTokenizer_t *pTokenizer,
+                            uGnssNmeaField_t *pField);
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS: FIELD DECODERS
+ * -------------------------------------------------------------- */
+
+/** Decode a field that contains a signed decimal integer.
+ *
+ * @param[in] pField  the field; cannot be NULL.
+ * @param[out] pValue a place to put the value; cannot be NULL.
+ * @return            zero on success, #U_ERROR_COMMON_NOT_FOUND
+ *                    if the field is empty, else negative error
+ *                    code.
+ */
+int32_t uGnssNmeaFieldToInt32(const uGnssNmeaField_t *pField,
+                              int32_t *pValue);
+
+/** Decode a field that contains a signed decimal number with
+ * an optional fractional part, e.g. "-12.345", as a fixed-point
+ * integer with the given number of decimal places, e.g. -12345
+ * for three decimal places.  Digits beyond the number of decimal
+ * places asked for are discarded.
+ *
+ * @param[in] pField       the field; cannot be NULL.
+ * @param decimalPlaces    the number of decimal places, 0 to 9.
+ * @param[out] pValue      a place to put the value; cannot be NULL.
+ * @return                 zero on success, #U_ERROR_COMMON_NOT_FOUND
+ *                         if the field is empty, else negative error
+ *                         code (including if the value will not fit
+ *                         into an int32_t).
+ */
+int32_t uGnssNmeaFieldToFixed(const uGnssNmeaField_t *pField,
+                              int32_t decimalPlaces, int32_t *pValue);
+
+/** Decode an NMEA latitude ("ddmm.mmmm") or longitude ("dddmm.mmmm")
+ * field and its hemisphere field ('N', 'S', 'E' or 'W').
+ *
+ * @param[in] pField       the latitude or longitude field; cannot
+ *                         be NULL.
+ * @param[in] pHemisphere  the hemisphere field; cannot be NULL.
+ * @param[out] pX1e7       a place to put the value in ten millionths
+ *                         of a degree, negative for south or west;
+ *                         cannot be NULL.
+ * @return                 zero on success, #U_ERROR_COMMON_NOT_FOUND
+ *                         if either field is empty, else negative
+ *                         error code.
+ */
+int32_t uGnssNmeaFieldToLatLong(const uGnssNmeaField_t *pField,
+                                const uGnssNmeaField_t *pHemisphere,
+                                int32_t *pX1e7);
+
+/** Decode an NMEA time field ("hhmmss.ss").
+ *
+ * @param[in] pField          the field; cannot be NULL.
+ * @param[out] pTimeOfDayMs   a place to put the time of day in
+ *                            milliseconds; cannot be NULL.
+ * @return                    zero on success, #U_ERROR_COMMON_NOT_FOUND
+ *                            if the field is empty, else negative
+ *                            error code.
+ */
+int32_t uGnssNmeaFieldToTime(const uGnssNmeaField_t *pField,
+                             int32_t *pTimeOfDayMs);
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS: SENTENCE DECODERS
+ * -------------------------------------------------------------- */
+
+/** Decode an NMEA GGA sentence, from any talker.
+ *
+ * @param[in] pSentence the NMEA sentence; need not be
+ *                      null-terminated, cannot be NULL.
+ * @param size          the number of characters at pSentence.
+ * @param[out] pGga     a place to put the decoded sentence; cannot
+ *                      be NULL.
+ * @return              zero on success, #U_GNSS_ERROR_CRC if the
+ *                      checksum is incorrect, else negative error
+ *                      code (including if the sentence is not a
+ *                      GGA sentence).
+ */
+int32_t uGnssNmeaDecodeGga(const char *pSentence, size_t size,
+                           uGnssNmeaGga_t *pGga);
+
+/** Decode an NMEA RMC sentence, from any talker.
+ *
+ * @param[in] pSentence the NMEA sentence; need not be
+ *                      null-terminated, cannot be NULL.
+ * @param size          the number of characters at pSentence.
+ * @param[out] pRmc     a place to put the decoded sentence; cannot
+ *                      be NULL.
+ * @return              zero on success, #U_GNSS_ERROR_CRC if the
+ *                      checksum is incorrect, else negative error
+ *                      code (including if the sentence is not an
+ *                      RMC sentence).
+ */
+int32_t uGnssNmeaDecodeRmc(const char *pSentence, size_t size,
+                           uGnssNmeaRmc_t *pRmc);
+
+/** Decode an NMEA GSA sentence, from any talker.
+ *
+ * @param[in] pSentence the NMEA sentence; need not be
+ *                      null-terminated, cannot be NULL.
+ * @param size          the number of characters at pSentence.
+ * @param[out] pGsa     a place to put the decoded sentence; cannot
+ *                      be NULL.
+ * @return              zero on success, #U_GNSS_ERROR_CRC if the
+ *                      checksum is incorrect, else negative error
+ *                      code (including if the sentence is not a
+ *                      GSA sentence).
+ */
+int32_t uGnssNmeaDecodeGsa(const char *pSentence, size_t size,
+                           uGnssNmeaGsa_t *pGsa);
+
+/** Decode an NMEA GSV sentence, from any talker.
+ *
+ * @param[in] pSentence the NMEA sentence; need not be
+ *                      null-terminated, cannot be NULL.
+ * @param size          the number of characters at pSentence.
+ * @param[out] pGsv     a place to put the decoded sentence; cannot
+ *                      be NULL.
+ * @return              zero on success, #U_GNSS_ERROR_CRC if the
+ *                      checksum is incorrect, else negative error
+ *                      code (including if the sentence is not a
+ *                      GSV sentence).
+ */
+int32_t uGnssNmeaDecodeGsv(const char *pSentence, size_t size,
+                           uGnssNmeaGsv_t *pGsv);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_NMEA_H_
+
+// End of file
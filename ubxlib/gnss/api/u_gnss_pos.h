@@ -253,6 +253,53 @@ int32_t uGnssPosGetRrlp(uDeviceHandle_t gnssHandle, char *pBuffer, size_t sizeBy
                         int32_t pseudorangeRmsErrorIndexLimit,
                         bool (*pKeepGoingCallback) (uDeviceHandle_t));
 
+/** As uGnssPosGetRrlp() but, rather than returning the first set of
+ * RRLP information that meets the criteria, all of the epochs that
+ * arrive within timeBudgetMs are scored and the best of them is
+ * returned: the one with the most satellites meeting the criteria
+ * and, of those, the highest summed carrier to noise ratio.  For
+ * the same acquisition time this gives the Cloud Locate service
+ * better data to work with.
+ *
+ * Where the GNSS chip is connected via UART or I2C the periodic
+ * UBX-RXM-MEASX message is switched on for the duration and each
+ * epoch is taken from the stream as it arrives; the message is
+ * switched off again afterwards.  Where the GNSS chip is connected
+ * via an intermediate AT module UBX-RXM-MEASX is polled, as for
+ * uGnssPosGetRrlp().
+ *
+ * If no epoch meets the criteria within timeBudgetMs then this
+ * function carries on, returning the first one that does, until
+ * pKeepGoingCallback returns false or, if pKeepGoingCallback is
+ * NULL, #U_GNSS_POS_TIMEOUT_SECONDS have elapsed.
+ *
+ * Unlike uGnssPosGetRrlp(), a block of sizeBytes of heap is
+ * required while this function is running.
+ *
+ * @param gnssHandle                    the handle of the GNSS instance to use.
+ * @param pBuffer                       a place to store the binary RRLP
+ *                                      information, formatted as for
+ *                                      uGnssPosGetRrlp(); cannot be NULL.
+ * @param sizeBytes                     the number of bytes of storage at pBuffer.
+ * @param svsThreshold                  as for uGnssPosGetRrlp().
+ * @param cNoThreshold                  as for uGnssPosGetRrlp().
+ * @param multipathIndexLimit           as for uGnssPosGetRrlp().
+ * @param pseudorangeRmsErrorIndexLimit as for uGnssPosGetRrlp().
+ * @param timeBudgetMs                  the time to spend collecting epochs in
+ *                                      milliseconds; with the usual one second
+ *                                      measurement rate, 5000 would mean picking
+ *                                      the best of around five epochs.
+ * @param[in] pKeepGoingCallback        as for uGnssPosGetRrlp(), may be NULL.
+ * @return                              on success the number of bytes returned, else
+ *                                      negative error code.
+ */
+int32_t uGnssPosGetRrlpBest(uDeviceHandle_t gnssHandle, char *pBuffer, size_t sizeBytes,
+                            int32_t svsThreshold, int32_t cNoThreshold,
+                            int32_t multipathIndexLimit,
+                            int32_t pseudorangeRmsErrorIndexLimit,
+                            int32_t timeBudgetMs,
+                            bool (*pKeepGoingCallback) (uDeviceHandle_t));
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,249 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_SPARTN_H_
+#define _U_GNSS_SPARTN_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_device.h"
+#include "u_mqtt_client.h"
+#include "u_spartn.h"
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the GNSS SPARTN forwarder API: SPARTN
+ * correction data, e.g. read from an MQTT subscription to the Point
+ * Perfect service, is framed and validated with uSpartnFramerAddData()
+ * and the valid messages are written to a u-blox high-precision GNSS
+ * chip, such as the ZED-F9P.  Rather than performing a write for each
+ * message, messages are gathered into a buffer and written in one go
+ * when the buffer is full or when the oldest message in it has been
+ * waiting for longer than a latency budget chosen by the application;
+ * on a UART-connected GNSS chip this reduces the number of write
+ * calls considerably at little cost in latency.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_GNSS_SPARTN_FORWARD_BUFFER_LENGTH_BYTES
+/** The size of the buffer in which SPARTN messages are gathered
+ * before being written to the GNSS chip and hence the largest
+ * write that will be performed; must be at least
+ * #U_SPARTN_MESSAGE_LENGTH_MAX_BYTES.
+ */
+# define U_GNSS_SPARTN_FORWARD_BUFFER_LENGTH_BYTES (U_SPARTN_MESSAGE_LENGTH_MAX_BYTES * 2)
+#endif
+
+#ifndef U_GNSS_SPARTN_FORWARD_MQTT_MESSAGE_LENGTH_BYTES
+/** The size of the temporary buffer that uGnssSpartnForwardMqttRead()
+ * allocates to read an MQTT message into; an MQTT message that is
+ * longer than this will be truncated, the framer will throw away
+ * the incomplete SPARTN message at the end.
+ */
+# define U_GNSS_SPARTN_FORWARD_MQTT_MESSAGE_LENGTH_BYTES 4096
+#endif
+
+#ifndef U_GNSS_SPARTN_FORWARD_MQTT_TOPIC_LENGTH_BYTES
+/** The size of the temporary buffer that uGnssSpartnForwardMqttRead()
+ * allocates to read an MQTT topic name into, including room
+ * for a null terminator.
+ */
+# define U_GNSS_SPARTN_FORWARD_MQTT_TOPIC_LENGTH_BYTES 64
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The function used by a SPARTN forwarder to write to the GNSS
+ * chip; this has the same form as uGnssMsgSend(), which is what
+ * is used by default.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @param[in] pBuffer the data to write.
+ * @param size        the number of bytes at pBuffer.
+ * @return            on success the number of bytes written, else
+ *                    negative error code.
+ */
+typedef int32_t (*uGnssSpartnForwardWrite_t)(uDeviceHandle_t gnssHandle,
+                                             const char *pBuffer, size_t size);
+
+/** Statistics kept by a SPARTN forwarder, see uGnssSpartnForward_t.
+ * The latency of a message is measured from the call that passed
+ * the last of its data to the forwarder to the end of the write
+ * that sent it to the GNSS chip.
+ */
+typedef struct {
+    int32_t messageCount;     /**< the number of SPARTN messages
+                                   written to the GNSS chip. */
+    int32_t bytesWritten;     /**< the number of bytes written to the
+                                   GNSS chip. */
+    int32_t writeCount;       /**< the number of write calls made. */
+    int32_t writeErrorCount;  /**< the number of write calls that
+                                   failed or were short. */
+    int32_t latencyMaxMs;     /**< the largest latency of any message
+                                   written. */
+    int64_t latencyTotalMs;   /**< the sum of the latencies of the
+                                   messages written; divide by
+                                   messageCount for the average. */
+} uGnssSpartnForwardStatistics_t;
+
+/** A SPARTN forwarder.  This includes a framer and a buffer
+ * of #U_GNSS_SPARTN_FORWARD_BUFFER_LENGTH_BYTES so you may want to
+ * allocate it statically or with malloc() rather than put it on the
+ * stack.  Other than the counts in framer and statistics, which may
+ * be read, the contents should not be accessed directly.
+ */
+typedef struct {
+    uSpartnFramer_t framer;               /**< the framer. */
+    uDeviceHandle_t gnssHandle;           /**< the GNSS chip to write to. */
+    uGnssSpartnForwardWrite_t pWrite;     /**< the write function. */
+    int32_t latencyBudgetMs;              /**< how long a message may wait
+                                               in buffer. */
+    char buffer[U_GNSS_SPARTN_FORWARD_BUFFER_LENGTH_BYTES]; /**< the messages
+                                                                 waiting to be
+                                                                 written. */
+    size_t bufferLength;                  /**< the number of bytes in buffer. */
+    int32_t bufferMessageCount;           /**< the number of messages in buffer. */
+    int32_t bufferStartTimeMs;            /**< the arrival time of the oldest
+                                               message in buffer. */
+    int64_t bufferArrivalOffsetMs;        /**< the sum of the arrival times of
+                                               the messages in buffer, relative
+                                               to bufferStartTimeMs. */
+    int32_t arrivalTimeMs;                /**< the time at which the data
+                                               currently being framed arrived. */
+    int32_t lastErrorCode;                /**< the result of a failed write
+                                               made from the framer callback. */
+    uGnssSpartnForwardStatistics_t statistics; /**< the statistics. */
+} uGnssSpartnForward_t;
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Initialise a SPARTN forwarder, or reset one, throwing away any
+ * data it is holding and zeroing the counts.
+ *
+ * @param[out] pForward     a pointer to the forwarder, cannot be NULL.
+ * @param gnssHandle        the handle of the GNSS instance to write to.
+ * @param latencyBudgetMs   the longest time, in milliseconds, that a
+ *                          SPARTN message may be held by the forwarder
+ *                          in order to gather it with others into a
+ *                          single write.  Zero means that messages are
+ *                          only gathered from within each call to
+ *                          uGnssSpartnForwardAddData(), which are written
+ *                          before it returns.  The budget can only be
+ *                          met if uGnssSpartnForwardPoll() (or
+ *                          uGnssSpartnForwardMqttRead(), which calls it) is
+ *                          called at least this often.
+ * @param[in] pWrite        the function to write with; use NULL for
+ *                          uGnssMsgSend(), which is the normal case.
+ * @return                  zero on success else negative error code.
+ */
+int32_t uGnssSpartnForwardInit(uGnssSpartnForward_t *pForward,
+                               uDeviceHandle_t gnssHandle,
+                               int32_t latencyBudgetMs,
+                               uGnssSpartnForwardWrite_t pWrite);
+
+/** Add a chunk of SPARTN data to a forwarder.  The data is passed
+ * through the framer of the forwarder and each valid SPARTN message
+ * found is added to the forwarder's buffer; if the buffer fills up it
+ * is written to the GNSS chip, and it is also written if the oldest
+ * message in it has used up the latency budget.  Anything that is
+ * not a valid SPARTN message is thrown away.
+ *
+ * @param[in] pForward a pointer to the forwarder, which must have
+ *                     been initialised with uGnssSpartnForwardInit().
+ * @param[in] pData    a pointer to the data; may be NULL only if
+ *                     size is zero.
+ * @param size         the number of bytes at pData.
+ * @return             the number of valid SPARTN messages found
+ *                     else negative error code; if a write to the
+ *                     GNSS chip fails, the data of that write is
+ *                     thrown away and the error code is returned.
+ */
+int32_t uGnssSpartnForwardAddData(uGnssSpartnForward_t *pForward,
+                                  const char *pData, size_t size);
+
+/** Write the buffer of a forwarder to the GNSS chip if the oldest
+ * message in it has used up the latency budget; call this
+ * periodically, at least once every latency budget.
+ *
+ * @param[in] pForward a pointer to the forwarder.
+ * @return             the number of bytes written, zero if there
+ *                     was nothing to write or it was not yet time
+ *                     to write it, else negative error code.
+ */
+int32_t uGnssSpartnForwardPoll(uGnssSpartnForward_t *pForward);
+
+/** Write the buffer of a forwarder to the GNSS chip now, whatever
+ * the latency budget.
+ *
+ * @param[in] pForward a pointer to the forwarder.
+ * @return             the number of bytes written, zero if there
+ *                     was nothing to write, else negative error code.
+ */
+int32_t uGnssSpartnForwardFlush(uGnssSpartnForward_t *pForward);
+
+/** Read all of the unread messages from an MQTT client, pass
+ * the ones carrying SPARTN corrections to uGnssSpartnForwardAddData()
+ * and then call uGnssSpartnForwardPoll(): call this when the message
+ * callback set with uMqttClientSetMessageCallback() indicates that
+ * there are unread messages and periodically, at least once every
+ * latency budget, in between.  Since reading an MQTT message
+ * consumes it, messages on topics that do not match pTopicPrefixStr
+ * are thrown away: if you are also subscribed to other topics, e.g.
+ * the Point Perfect key topic, you should read those yourself.
+ * A temporary buffer of #U_GNSS_SPARTN_FORWARD_MQTT_MESSAGE_LENGTH_BYTES
+ * is allocated while this function is reading.
+ *
+ * @param[in] pForward           a pointer to the forwarder.
+ * @param[in] pMqttClientContext a pointer to the MQTT client context,
+ *                               as returned by pUMqttClientOpen(),
+ *                               subscribed to the correction topics.
+ * @param[in] pTopicPrefixStr    the null-terminated start of the topic
+ *                               names of the correction topics, e.g.
+ *                               "/pp/ip/"; use NULL to forward the
+ *                               messages of all topics.
+ * @return                       the number of valid SPARTN messages
+ *                               found else negative error code.
+ */
+int32_t uGnssSpartnForwardMqttRead(uGnssSpartnForward_t *pForward,
+                                   uMqttClientContext_t *pMqttClientContext,
+                                   const char *pTopicPrefixStr);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_SPARTN_H_
+
+// End of file
@@ -44,6 +44,25 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** A transaction for uGnssUtilUbxTransparentSendReceiveList().
+ */
+typedef struct {
+    const char *pCommand; /**< the command to send; may be NULL. */
+    size_t commandLengthBytes; /**< the amount of data at pCommand; must
+                                    be non-zero if pCommand is non-NULL. */
+    char *pResponse; /**< a pointer to somewhere to store the response,
+                          if one is expected; may be NULL. */
+    size_t maxResponseLengthBytes; /**< the amount of storage at pResponse;
+                                        must be non-zero if pResponse is
+                                        non-NULL. */
+    int32_t errorCodeOrResponseLength; /**< populated by
+                                            uGnssUtilUbxTransparentSendReceiveList()
+                                            with what
+                                            uGnssUtilUbxTransparentSendReceive()
+                                            would have returned for this
+                                            transaction. */
+} uGnssUtilUbxTransparentTransaction_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -108,6 +127,32 @@ int32_t uGnssUtilUbxTransparentSendReceive(uDeviceHandle_t gnssHandle,
                                            char *pResponse,
                                            size_t maxResponseLengthBytes);
 
+/** As uGnssUtilUbxTransparentSendReceive() but performs a list of
+ * transactions, one after the other, in one go.  This is of most
+ * benefit when the GNSS chip is connected via an intermediate
+ * (e.g. cellular) module (i.e. you are using #U_GNSS_TRANSPORT_AT),
+ * since all of the transactions are then performed under a single
+ * lock of the AT interface, no other AT traffic getting in between
+ * them, e.g. when polling for several UBX messages.  For the streaming
+ * transports the transactions are simply performed in turn.  The same
+ * caveats apply as for uGnssUtilUbxTransparentSendReceive().
+ *
+ * The transactions are performed even if an earlier one fails; the
+ * outcome of each is written to its errorCodeOrResponseLength field.
+ *
+ * @param gnssHandle      the handle of the GNSS instance.
+ * @param[in,out] pList   a pointer to an array of numTransactions
+ *                        transactions; may be NULL only if
+ *                        numTransactions is zero.
+ * @param numTransactions the number of transactions at pList.
+ * @return                on success the number of transactions
+ *                        that succeeded, else negative error code,
+ *                        in which case no transactions were performed.
+ */
+int32_t uGnssUtilUbxTransparentSendReceiveList(uDeviceHandle_t gnssHandle,
+                                               uGnssUtilUbxTransparentTransaction_t *pList,
+                                               size_t numTransactions);
+
 #ifdef __cplusplus
 }
 #endif
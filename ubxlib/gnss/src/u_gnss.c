@@ -145,8 +145,22 @@ static void deleteGnssInstance(uGnssPrivateInstance_t *pInstance)
                 uRingBufferDelete(&(pInstance->ringBuffer));
                 free(pInstance->pLinearBuffer);
             }
-            // This can go now too (it is legal C to free a NULL pointer)
-            free(pInstance->pTemporaryBuffer);
+            // Anything to do with capture or replay can go,
+            // nothing can be filling the ring buffer now
+            free(pInstance->pCapture);
+            free(pInstance->pReplay);
+            if (pInstance->captureMutex != NULL) {
+                uPortMutexDelete(pInstance->captureMutex);
+            }
+            // Lose any automatic output-rate tuning state
+            free(pInstance->pMsgOut);
+            // ...and any automatic ring buffer sizing state
+            free(pInstance->pRingBufferSize);
+            if (pInstance->ringBufferSizeMutex != NULL) {
+                uPortMutexDelete(pInstance->ringBufferSizeMutex);
+            }
+            // Free the AT transport buffer
+            free(pInstance->pAtBuffer);
             // Delete the transport mutex
             uPortMutexDelete(pInstance->transportMutex);
             // Deallocate the uDevice instance
@@ -272,7 +286,6 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
                     if (errorCode == 0) {
                         pInstance->transportType = transportType;
                         pInstance->pLinearBuffer = NULL;
-                        pInstance->pTemporaryBuffer = NULL;
                         pInstance->ringBufferReadHandlePrivate = -1;
                         pInstance->ringBufferReadHandleMsgReceive = -1;
                         pInstance->pModule = &(gUGnssPrivateModuleList[moduleType]);
@@ -300,6 +313,14 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
                         pInstance->posMutex = NULL;
                         pInstance->posTaskFlags = 0;
                         pInstance->pMsgReceive = NULL;
+                        pInstance->captureMutex = NULL;
+                        pInstance->pCapture = NULL;
+                        pInstance->pReplay = NULL;
+                        pInstance->pMsgOut = NULL;
+                        pInstance->ringBufferSizeMutex = NULL;
+                        pInstance->pRingBufferSize = NULL;
+                        pInstance->pAtBuffer = NULL;
+                        pInstance->atBufferLength = 0;
                         pInstance->pNext = NULL;
 
                         // Now set up the pins
@@ -350,34 +371,29 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
                             // which we stream messages received from the module
                             pInstance->pLinearBuffer = (char *) malloc(U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES);
                             if (pInstance->pLinearBuffer != NULL) {
-                                // Also need a temporary buffer to get stuff out
-                                // of the UART/I2C in the first place
-                                pInstance->pTemporaryBuffer = (char *) malloc(U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES);
-                                if (pInstance->pTemporaryBuffer != NULL) {
-                                    // +2 below to keep one for ourselves and one for the
-                                    // blocking transparent receive function
-                                    errorCode = uRingBufferCreateWithReadHandle(&(pInstance->ringBuffer),
-                                                                                pInstance->pLinearBuffer,
-                                                                                U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES,
-                                                                                U_GNSS_MSG_RECEIVER_MAX_NUM + 2);
-                                    if (errorCode == 0) {
-                                        // No sneaky uRingBufferRead()'s allowed
-                                        uRingBufferSetReadRequiresHandle(&(pInstance->ringBuffer), true);
-                                        // Reserve a handle for us
+                                // +2 below to keep one for ourselves and one for the
+                                // blocking transparent receive function
+                                errorCode = uRingBufferCreateWithReadHandle(&(pInstance->ringBuffer),
+                                                                            pInstance->pLinearBuffer,
+                                                                            U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES,
+                                                                            U_GNSS_MSG_RECEIVER_MAX_NUM + 2);
+                                if (errorCode == 0) {
+                                    // No sneaky uRingBufferRead()'s allowed
+                                    uRingBufferSetReadRequiresHandle(&(pInstance->ringBuffer), true);
+                                    // Reserve a handle for us
+                                    errorCode = uRingBufferTakeReadHandle(&(pInstance->ringBuffer));
+                                    if (errorCode >= 0) {
+                                        pInstance->ringBufferReadHandlePrivate = errorCode;
+                                        // ...and one for uGnssMsgReceive()
                                         errorCode = uRingBufferTakeReadHandle(&(pInstance->ringBuffer));
                                         if (errorCode >= 0) {
-                                            pInstance->ringBufferReadHandlePrivate = errorCode;
-                                            // ...and one for uGnssMsgReceive()
-                                            errorCode = uRingBufferTakeReadHandle(&(pInstance->ringBuffer));
-                                            if (errorCode >= 0) {
-                                                pInstance->ringBufferReadHandleMsgReceive = errorCode;
-                                                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-                                            } else {
-                                                uRingBufferDelete(&(pInstance->ringBuffer));
-                                            }
+                                            pInstance->ringBufferReadHandleMsgReceive = errorCode;
+                                            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                                         } else {
                                             uRingBufferDelete(&(pInstance->ringBuffer));
                                         }
+                                    } else {
+                                        uRingBufferDelete(&(pInstance->ringBuffer));
                                     }
                                 }
                             }
@@ -395,9 +411,6 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
                             uRingBufferDelete(&(pInstance->ringBuffer));
                             free(pInstance->pLinearBuffer);
                         }
-                        if (pInstance->pTemporaryBuffer != NULL) {
-                            free(pInstance->pTemporaryBuffer);
-                        }
                         if (pInstance->transportMutex != NULL) {
                             uPortMutexDelete(pInstance->transportMutex);
                         }
@@ -224,8 +224,7 @@ int64_t uGnssInfoGetTimeUtc(uDeviceHandle_t gnssHandle)
     uGnssPrivateInstance_t *pInstance;
     // Enough room for the body of the UBX-NAV-TIMEUTC message
     char message[20];
-    int32_t months;
-    int32_t year;
+    uTimeDate_t date;
 
     if (gUGnssPrivateMutex != NULL) {
 
@@ -243,22 +242,19 @@ int64_t uGnssInfoGetTimeUtc(uDeviceHandle_t gnssHandle)
                 // Check the validity flag
                 errorCodeOrTime = (int64_t) U_ERROR_COMMON_UNKNOWN;
                 if (message[19] & 0x04) {
-                    errorCodeOrTime = 0;
-                    // Year is 1999-2099, so need to adjust to get year since 1970
-                    year = (uUbxProtocolUint16Decode(message + 12) - 1999) + 29;
-                    // Month (1 to 12), so take away 1 to make it zero-based
-                    months = message[14] - 1;
-                    months += year * 12;
-                    // Work out the number of seconds due to the year/month count
-                    errorCodeOrTime += uTimeMonthsToSecondsUtc(months);
+                    // Year is 1999-2099
+                    date.year = (int32_t) uUbxProtocolUint16Decode(message + 12);
+                    // Month (1 to 12)
+                    date.month = message[14];
                     // Day (1 to 31)
-                    errorCodeOrTime += ((int32_t) message[15] - 1) * 3600 * 24;
+                    date.day = message[15];
                     // Hour (0 to 23)
-                    errorCodeOrTime += ((int32_t) message[16]) * 3600;
+                    date.hours = message[16];
                     // Minute (0 to 59)
-                    errorCodeOrTime += ((int32_t) message[17]) * 60;
+                    date.minutes = message[17];
                     // Second (0 to 60)
-                    errorCodeOrTime += message[18];
+                    date.seconds = message[18];
+                    errorCodeOrTime = uTimeDateToEpoch(&date);
 
                     uPortLog("U_GNSS_POS: UTC time is %d.\n", (int32_t) errorCodeOrTime);
                 }
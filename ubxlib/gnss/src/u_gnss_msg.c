@@ -85,6 +85,7 @@
 #include "u_gnss_module_type.h"
 #include "u_gnss_type.h"
 #include "u_gnss.h"
+#include "u_gnss_cfg_val_key.h"
 #include "u_gnss_private.h"
 #include "u_gnss_msg.h"
 
@@ -123,110 +124,662 @@
 # error U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS must be at least as big as U_CFG_OS_YIELD_MS
 #endif
 
+#ifndef U_GNSS_MSG_TASK_POLL_MAX_TIME_MS
+/** The longest the asynchronous message receive task will wait between
+ * polls of an I2C input stream when little or nothing is arriving; the
+ * interval adapts between U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS and this
+ * according to the observed data rate.  This only applies to I2C, where
+ * the GNSS chip buffers the data: a UART has no flow control, so the
+ * UART input stream is always polled every
+ * U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS in case a burst of data arrives
+ * after a quiet spell and overflows the UART buffer.
+ */
+# define U_GNSS_MSG_TASK_POLL_MAX_TIME_MS (U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS * 4)
+#endif
+
+#ifndef U_GNSS_MSG_TASK_POLL_TARGET_LENGTH_BYTES
+/** The amount of data the asynchronous message receive task aims to
+ * find waiting on each poll of the input stream: polling more often
+ * than this wastes bus transactions (a real cost on I2C, where every
+ * poll is a bus access), polling less often risks overflowing the
+ * buffer at the far end.
+ */
+# define U_GNSS_MSG_TASK_POLL_TARGET_LENGTH_BYTES (U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES / 8)
+#endif
+
+#ifndef U_GNSS_MSG_OUT_VALSET_MAX_NUM_KEYS
+/** The maximum number of message output rates that automatic
+ * output-rate tuning will set in a single UBX-CFG-VALSET message.
+ */
+# define U_GNSS_MSG_OUT_VALSET_MAX_NUM_KEYS 16
+#endif
+
+#ifndef U_GNSS_MSG_OUT_HOLD_OFF_TIME_MS
+/** When automatic output-rate tuning is on, how long a message
+ * that uGnssMsgReceive() was waiting for is left switched on after
+ * it stops waiting, so that calling uGnssMsgReceive() in a loop
+ * costs no UBX-CFG-VALSET messages and doesn't have to wait for
+ * the message to be switched back on each time.
+ */
+# define U_GNSS_MSG_OUT_HOLD_OFF_TIME_MS 5000
+#endif
+
+/** Value for the rate field of #uGnssPrivateMsgOut_t meaning that
+ * the output rate of the message is not known.
+ */
+#define U_GNSS_MSG_OUT_RATE_UNKNOWN 0xFF
+
+/** Value for the rate field of #uGnssPrivateMsgOut_t meaning that
+ * the GNSS chip does not support the message.
+ */
+#define U_GNSS_MSG_OUT_RATE_UNSUPPORTED 0xFE
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** A message whose output rate automatic output-rate tuning,
+ * see uGnssMsgReceiveSetAutoOutput(), knows how to set.
+ */
+typedef struct {
+    uGnssProtocol_t protocol;
+    uint16_t id; /**< (class << 8) | ID for UBX, message type for RTCM. */
+    char nmea[4]; /**< the NMEA sentence type, e.g. "GGA", null-terminated. */
+    uint16_t keyItemI2c; /**< the MSGOUT item ID for the I2C port: those for
+                              UART1, UART2, USB and SPI follow it, which is
+                              the order of uGnssPort_t. */
+} uGnssMsgOutKey_t;
+
 /* ----------------------------------------------------------------
  * STATIC VARIABLES
  * -------------------------------------------------------------- */
 
+/** The messages that automatic output-rate tuning knows of, most
+ * commonly supported first since a CFG-VALSET carrying a key that
+ * a GNSS chip does not support will be rejected whole.
+ */
+static const uGnssMsgOutKey_t gMsgOutKey[] = {
+    {U_GNSS_PROTOCOL_NMEA, 0, "DTM", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_NMEA_ID_DTM_I2C_U1},
+    {U_GNSS_PROTOCOL_NMEA, 0, "GBS", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_NMEA_ID_GBS_I2C_U1},
+    {U_GNSS_PROTOCOL_NMEA, 0, "GGA", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_NMEA_ID_GGA_I2C_U1},
+    {U_GNSS_PROTOCOL_NMEA, 0, "GLL", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_NMEA_ID_GLL_I2C_U1},
+    {U_GNSS_PROTOCOL_NMEA, 0, "GNS", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_NMEA_ID_GNS_I2C_U1},
+    {U_GNSS_PROTOCOL_NMEA, 0, "GRS", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_NMEA_ID_GRS_I2C_U1},
+    {U_GNSS_PROTOCOL_NMEA, 0, "GSA", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_NMEA_ID_GSA_I2C_U1},
+    {U_GNSS_PROTOCOL_NMEA, 0, "GST", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_NMEA_ID_GST_I2C_U1},
+    {U_GNSS_PROTOCOL_NMEA, 0, "GSV", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_NMEA_ID_GSV_I2C_U1},
+    {U_GNSS_PROTOCOL_NMEA, 0, "RMC", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_NMEA_ID_RMC_I2C_U1},
+    {U_GNSS_PROTOCOL_NMEA, 0, "VLW", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_NMEA_ID_VLW_I2C_U1},
+    {U_GNSS_PROTOCOL_NMEA, 0, "VTG", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_NMEA_ID_VTG_I2C_U1},
+    {U_GNSS_PROTOCOL_NMEA, 0, "ZDA", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_NMEA_ID_ZDA_I2C_U1},
+    {U_GNSS_PROTOCOL_UBX, 0x0107, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_NAV_PVT_I2C_U1}, // NAV-PVT
+    {U_GNSS_PROTOCOL_UBX, 0x0102, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_NAV_POSLLH_I2C_U1}, // NAV-POSLLH
+    {U_GNSS_PROTOCOL_UBX, 0x0114, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_NAV_HPPOSLLH_I2C_U1}, // NAV-HPPOSLLH
+    {U_GNSS_PROTOCOL_UBX, 0x0101, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_NAV_POSECEF_I2C_U1}, // NAV-POSECEF
+    {U_GNSS_PROTOCOL_UBX, 0x0103, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_NAV_STATUS_I2C_U1}, // NAV-STATUS
+    {U_GNSS_PROTOCOL_UBX, 0x0104, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_NAV_DOP_I2C_U1}, // NAV-DOP
+    {U_GNSS_PROTOCOL_UBX, 0x0112, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_NAV_VELNED_I2C_U1}, // NAV-VELNED
+    {U_GNSS_PROTOCOL_UBX, 0x0121, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_NAV_TIMEUTC_I2C_U1}, // NAV-TIMEUTC
+    {U_GNSS_PROTOCOL_UBX, 0x0120, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_NAV_TIMEGPS_I2C_U1}, // NAV-TIMEGPS
+    {U_GNSS_PROTOCOL_UBX, 0x0122, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_NAV_CLOCK_I2C_U1}, // NAV-CLOCK
+    {U_GNSS_PROTOCOL_UBX, 0x0135, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_NAV_SAT_I2C_U1}, // NAV-SAT
+    {U_GNSS_PROTOCOL_UBX, 0x0143, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_NAV_SIG_I2C_U1}, // NAV-SIG
+    {U_GNSS_PROTOCOL_UBX, 0x0161, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_NAV_EOE_I2C_U1}, // NAV-EOE
+    {U_GNSS_PROTOCOL_UBX, 0x0136, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_NAV_COV_I2C_U1}, // NAV-COV
+    {U_GNSS_PROTOCOL_UBX, 0x0109, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_NAV_ODO_I2C_U1}, // NAV-ODO
+    {U_GNSS_PROTOCOL_UBX, 0x013c, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_NAV_RELPOSNED_I2C_U1}, // NAV-RELPOSNED
+    {U_GNSS_PROTOCOL_UBX, 0x0214, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_RXM_MEASX_I2C_U1}, // RXM-MEASX
+    {U_GNSS_PROTOCOL_UBX, 0x0215, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_RXM_RAWX_I2C_U1}, // RXM-RAWX
+    {U_GNSS_PROTOCOL_UBX, 0x0213, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_RXM_SFRBX_I2C_U1}, // RXM-SFRBX
+    {U_GNSS_PROTOCOL_UBX, 0x0234, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_RXM_COR_I2C_U1}, // RXM-COR
+    {U_GNSS_PROTOCOL_UBX, 0x0232, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_RXM_RTCM_I2C_U1}, // RXM-RTCM
+    {U_GNSS_PROTOCOL_UBX, 0x0233, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_RXM_SPARTN_I2C_U1}, // RXM-SPARTN
+    {U_GNSS_PROTOCOL_UBX, 0x0272, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_RXM_PMP_I2C_U1}, // RXM-PMP
+    {U_GNSS_PROTOCOL_UBX, 0x0a36, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_MON_COMMS_I2C_U1}, // MON-COMMS
+    {U_GNSS_PROTOCOL_UBX, 0x0a09, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_MON_HW_I2C_U1}, // MON-HW
+    {U_GNSS_PROTOCOL_UBX, 0x0a02, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_MON_IO_I2C_U1}, // MON-IO
+    {U_GNSS_PROTOCOL_UBX, 0x0a38, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_MON_RF_I2C_U1}, // MON-RF
+    {U_GNSS_PROTOCOL_UBX, 0x0a21, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_MON_RXR_I2C_U1}, // MON-RXR
+    {U_GNSS_PROTOCOL_UBX, 0x0a39, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_MON_SYS_I2C_U1}, // MON-SYS
+    {U_GNSS_PROTOCOL_UBX, 0x0a07, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_MON_RXBUF_I2C_U1}, // MON-RXBUF
+    {U_GNSS_PROTOCOL_UBX, 0x0a08, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_MON_TXBUF_I2C_U1}, // MON-TXBUF
+    {U_GNSS_PROTOCOL_UBX, 0x0d01, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_TIM_TP_I2C_U1}, // TIM-TP
+    {U_GNSS_PROTOCOL_UBX, 0x0d03, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_TIM_TM2_I2C_U1}, // TIM-TM2
+    {U_GNSS_PROTOCOL_UBX, 0x1010, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_ESF_STATUS_I2C_U1}, // ESF-STATUS
+    {U_GNSS_PROTOCOL_UBX, 0x1002, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_ESF_MEAS_I2C_U1}, // ESF-MEAS
+    {U_GNSS_PROTOCOL_UBX, 0x1003, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_ESF_RAW_I2C_U1}, // ESF-RAW
+    {U_GNSS_PROTOCOL_UBX, 0x1014, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_ESF_ALG_I2C_U1}, // ESF-ALG
+    {U_GNSS_PROTOCOL_UBX, 0x1015, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_UBX_ESF_INS_I2C_U1}, // ESF-INS
+    {U_GNSS_PROTOCOL_RTCM, 1005, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_RTCM_3X_TYPE1005_I2C_U1},
+    {U_GNSS_PROTOCOL_RTCM, 1074, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_RTCM_3X_TYPE1074_I2C_U1},
+    {U_GNSS_PROTOCOL_RTCM, 1077, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_RTCM_3X_TYPE1077_I2C_U1},
+    {U_GNSS_PROTOCOL_RTCM, 1084, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_RTCM_3X_TYPE1084_I2C_U1},
+    {U_GNSS_PROTOCOL_RTCM, 1087, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_RTCM_3X_TYPE1087_I2C_U1},
+    {U_GNSS_PROTOCOL_RTCM, 1094, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_RTCM_3X_TYPE1094_I2C_U1},
+    {U_GNSS_PROTOCOL_RTCM, 1097, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_RTCM_3X_TYPE1097_I2C_U1},
+    {U_GNSS_PROTOCOL_RTCM, 1124, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_RTCM_3X_TYPE1124_I2C_U1},
+    {U_GNSS_PROTOCOL_RTCM, 1127, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_RTCM_3X_TYPE1127_I2C_U1},
+    {U_GNSS_PROTOCOL_RTCM, 1230, "", U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_RTCM_3X_TYPE1230_I2C_U1},
+};
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
-// Task that runs the non-blocking message receive.
-static void msgReceiveTask(void *pParam)
+// Grow or shrink the ring buffer according to how hard it was
+// worked over the last window, if automatic ring buffer sizing
+// is on; called by the message receive task between messages.
+// The ring buffer keeps all of its unread data, and where each
+// read handle is in it, across a change of size.
+static void ringBufferAutoSize(uGnssPrivateInstance_t *pInstance)
+{
+    uGnssPrivateRingBufferSize_t *pRingBufferSize;
+    uRingBuffer_t *pRingBuffer = &(pInstance->ringBuffer);
+    int32_t readHandle = pInstance->pMsgReceive->ringBufferReadHandle;
+    size_t size;
+    size_t newSize;
+    size_t fillMax;
+    size_t lossBytes;
+    char *pLinearBuffer;
+
+    if (pInstance->ringBufferSizeMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(pInstance->ringBufferSizeMutex);
+
+        pRingBufferSize = pInstance->pRingBufferSize;
+        if ((pRingBufferSize != NULL) &&
+            ((pRingBufferSize->readHandle != readHandle) ||
+             (uPortGetTickTimeMs() - pRingBufferSize->windowStartTimeMs >=
+              U_GNSS_MSG_RING_BUFFER_AUTO_SIZE_WINDOW_MS))) {
+            // Only the read handle of this task is of interest: the
+            // others are flushed before use and so always look full
+            fillMax = uRingBufferStatFillMaxHandle(pRingBuffer, readHandle, true);
+            lossBytes = uRingBufferStatAddLoss(pRingBuffer) +
+                        uRingBufferStatReadLossHandle(pRingBuffer, readHandle);
+            size = pRingBuffer->size;
+            newSize = size;
+            if (pRingBufferSize->readHandle != readHandle) {
+                // First window for this read handle, just start counting
+                pRingBufferSize->readHandle = readHandle;
+                pRingBufferSize->quietWindowCount = 0;
+            } else if ((lossBytes != pRingBufferSize->lossBytes) ||
+                       (fillMax > size - (size / 4))) {
+                // Lost data, or came close to it: double up
+                newSize = size * 2;
+                pRingBufferSize->quietWindowCount = 0;
+            } else if (fillMax < size / 4) {
+                // Not much used: halve it if this goes on
+                pRingBufferSize->quietWindowCount++;
+                if (pRingBufferSize->quietWindowCount >= U_GNSS_MSG_RING_BUFFER_AUTO_SIZE_SHRINK_WINDOWS) {
+                    newSize = size / 2;
+                    pRingBufferSize->quietWindowCount = 0;
+                }
+            } else {
+                pRingBufferSize->quietWindowCount = 0;
+            }
+            if (newSize > pRingBufferSize->maxSizeBytes) {
+                newSize = pRingBufferSize->maxSizeBytes;
+            }
+            if (newSize < pRingBufferSize->minSizeBytes) {
+                newSize = pRingBufferSize->minSizeBytes;
+            }
+            if (newSize != size) {
+                pLinearBuffer = (char *) malloc(newSize);
+                if (pLinearBuffer != NULL) {
+                    // This will fail, harmlessly, if what this task
+                    // has yet to read won't fit or the ring buffer
+                    // is part way through being written-to
+                    if (uRingBufferResize(pRingBuffer, pLinearBuffer, newSize) == 0) {
+                        free(pInstance->pLinearBuffer);
+                        pInstance->pLinearBuffer = pLinearBuffer;
+                    } else {
+                        free(pLinearBuffer);
+                    }
+                }
+            }
+            pRingBufferSize->lossBytes = lossBytes;
+            pRingBufferSize->windowStartTimeMs = uPortGetTickTimeMs();
+        }
+
+        U_PORT_MUTEX_UNLOCK(pInstance->ringBufferSizeMutex);
+    }
+}
+
+// Service the non-blocking message receive of one GNSS instance:
+// pull in data, call any interested readers and work out how long
+// to wait before doing it again.  Note that this does NOT lock
+// gUGnssPrivateMutex: it doesn't need to, provided the task
+// that calls it is brought up and torn down in an organised way.
+static int32_t msgReceiveService(uGnssPrivateInstance_t *pInstance)
 {
-    uGnssPrivateInstance_t *pInstance = (uGnssPrivateInstance_t *) pParam;
-    char queueItem[U_GNSS_MSG_RECEIVE_TASK_QUEUE_ITEM_SIZE_BYTES];
     uGnssPrivateMsgReceive_t *pMsgReceive = pInstance->pMsgReceive;
     uGnssPrivateMsgReader_t *pReader;
     int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_UNKNOWN;
     int32_t receiveSize;
-    int32_t yieldTimeMs;
-    size_t discardSize = 0;
+    int32_t yieldTimeMs = pMsgReceive->pollIntervalMs;
     uGnssMessageId_t messageId;
     uGnssPrivateMessageId_t privateMessageId;
     char nmeaId[U_GNSS_NMEA_MESSAGE_MATCH_LENGTH_CHARACTERS + 1];
 
-    U_PORT_MUTEX_LOCK(pMsgReceive->taskRunningMutexHandle);
+    // Pull stuff into the ring buffer
+    receiveSize = uGnssPrivateStreamFillRingBuffer(pInstance, 0, 0);
+    // Deal with any discard from a previous run around this loop
+    pMsgReceive->discardSize -= uRingBufferReadHandle(&(pInstance->ringBuffer),
+                                                      pMsgReceive->ringBufferReadHandle,
+                                                      NULL, pMsgReceive->discardSize);
+    errorCodeOrLength = 0;
+    if (pMsgReceive->discardSize == 0) {
+        errorCodeOrLength = uRingBufferDataSizeHandle(&(pInstance->ringBuffer),
+                                                      pMsgReceive->ringBufferReadHandle);
+        // Run around a loop processing the data from the ring buffer
+        // for as long as we're still finding messages in it
+        while (errorCodeOrLength > 0) {
+            privateMessageId.type = U_GNSS_PROTOCOL_ALL;
+            // Attempt to decode a message of any type from the ring buffer
+            errorCodeOrLength = uGnssPrivateStreamDecodeRingBuffer(pInstance,
+                                                                   pMsgReceive->ringBufferReadHandle,
+                                                                   &privateMessageId);
+            if ((errorCodeOrLength > 0) || (errorCodeOrLength == (int32_t) U_GNSS_ERROR_NACK)) {
+                // Remember how long the message is
+                pMsgReceive->msgBytesLeftToRead = 0;
+                if (errorCodeOrLength > 0) {
+                    pMsgReceive->msgBytesLeftToRead = errorCodeOrLength;
+                }
 
-    // Lock our ring buffer read handle; now we just have to keep up...
-    uRingBufferLockReadHandle(&(pInstance->ringBuffer),
-                              pMsgReceive->ringBufferReadHandle);
+                if (uGnssPrivateMessageIdToPublic(&privateMessageId, &messageId, nmeaId) == 0) {
+                    // Got something, with a message ID now in public form;
+                    // go through the list of readers looking for those interested
+
+                    U_PORT_MUTEX_LOCK(pMsgReceive->readerMutexHandle);
+
+                    pReader = pMsgReceive->pReaderList;
+                    while (pReader != NULL) {
+                        if (uGnssPrivateMessageIdIsWanted(&privateMessageId,
+                                                          &(pReader->privateMessageId))) {
+                            // This reader is interested, call the callback
+                            ((uGnssMsgReceiveCallback_t) pReader->pCallback)(pInstance->gnssHandle,
+                                                                             &messageId,
+                                                                             errorCodeOrLength,
+                                                                             pReader->pCallbackParam);
+                        }
+                        // Next!
+                        pReader = pReader->pNext;
+                    }
 
-    // Continue until we receive something on the queue, which
-    // will cause us to exit
-    while (uPortQueueTryReceive(pMsgReceive->taskExitQueueHandle, 0, queueItem) < 0) {
+                    U_PORT_MUTEX_UNLOCK(pMsgReceive->readerMutexHandle);
+                }
 
-        // Note that this does NOT lock gUGnssPrivateMutex: it doesn't need to,
-        // provided this task is brought up and torn down in an organised way
-
-        // Pull stuff into the ring buffer
-        receiveSize = uGnssPrivateStreamFillRingBuffer(pInstance, 0, 0);
-        // Deal with any discard from a previous run around this loop
-        discardSize -= uRingBufferReadHandle(&(pInstance->ringBuffer),
-                                             pMsgReceive->ringBufferReadHandle,
-                                             NULL, discardSize);
-        errorCodeOrLength = 0;
-        if (discardSize == 0) {
-            errorCodeOrLength = uRingBufferDataSizeHandle(&(pInstance->ringBuffer),
-                                                          pMsgReceive->ringBufferReadHandle);
-            // Run around a loop processing the data from the ring buffer
-            // for as long as we're still finding messages in it
-            while (errorCodeOrLength > 0) {
-                privateMessageId.type = U_GNSS_PROTOCOL_ALL;
-                // Attempt to decode a message of any type from the ring buffer
-                errorCodeOrLength = uGnssPrivateStreamDecodeRingBuffer(pInstance,
-                                                                       pMsgReceive->ringBufferReadHandle,
-                                                                       &privateMessageId);
-                if ((errorCodeOrLength > 0) || (errorCodeOrLength == (int32_t) U_GNSS_ERROR_NACK)) {
-                    // Remember how long the message is
-                    pMsgReceive->msgBytesLeftToRead = 0;
-                    if (errorCodeOrLength > 0) {
-                        pMsgReceive->msgBytesLeftToRead = errorCodeOrLength;
-                    }
+                // Clear out any remaining data
+                uRingBufferReadHandle(&(pInstance->ringBuffer),
+                                      pMsgReceive->ringBufferReadHandle, NULL,
+                                      pMsgReceive->msgBytesLeftToRead);
+            }
+        }
+    }
 
-                    if (uGnssPrivateMessageIdToPublic(&privateMessageId, &messageId, nmeaId) == 0) {
-                        // Got something, with a message ID now in public form;
-                        // go through the list of readers looking for those interested
-
-                        U_PORT_MUTEX_LOCK(pMsgReceive->readerMutexHandle);
-
-                        pReader = pMsgReceive->pReaderList;
-                        while (pReader != NULL) {
-                            if (uGnssPrivateMessageIdIsWanted(&privateMessageId,
-                                                              &(pReader->privateMessageId))) {
-                                // This reader is interested, call the callback
-                                ((uGnssMsgReceiveCallback_t) pReader->pCallback)(pInstance->gnssHandle,
-                                                                                 &messageId,
-                                                                                 errorCodeOrLength,
-                                                                                 pReader->pCallbackParam);
-                            }
-                            // Next!
-                            pReader = pReader->pNext;
-                        }
+    // Between messages is a safe point to change the size of the
+    // ring buffer, should that be required
+    ringBufferAutoSize(pInstance);
+
+    // Relax to let others in; on I2C, where the GNSS chip holds on
+    // to the data until we read it, for a time adapted to the rate
+    // at which data is arriving: aim to find about
+    // U_GNSS_MSG_TASK_POLL_TARGET_LENGTH_BYTES waiting next time,
+    // backing off towards U_GNSS_MSG_TASK_POLL_MAX_TIME_MS while
+    // nothing arrives, unless we're desperately seeking the rest
+    // of a message
+    if (uGnssPrivateGetStreamType(pInstance->transportType) !=
+        (int32_t) U_GNSS_PRIVATE_STREAM_TYPE_I2C) {
+        yieldTimeMs = U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS;
+    } else if (receiveSize > 0) {
+        yieldTimeMs = (yieldTimeMs + ((yieldTimeMs * U_GNSS_MSG_TASK_POLL_TARGET_LENGTH_BYTES) /
+                                      receiveSize)) / 2;
+    } else if (errorCodeOrLength != (int32_t) U_ERROR_COMMON_TIMEOUT) {
+        yieldTimeMs *= 2;
+    }
+    if ((errorCodeOrLength == (int32_t) U_ERROR_COMMON_TIMEOUT) ||
+        (yieldTimeMs < U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS)) {
+        yieldTimeMs = U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS;
+    }
+    if (yieldTimeMs > U_GNSS_MSG_TASK_POLL_MAX_TIME_MS) {
+        yieldTimeMs = U_GNSS_MSG_TASK_POLL_MAX_TIME_MS;
+    }
+    pMsgReceive->pollIntervalMs = yieldTimeMs;
 
-                        U_PORT_MUTEX_UNLOCK(pMsgReceive->readerMutexHandle);
+    return yieldTimeMs;
+}
+
+// Find the entry in gMsgOutKey[] for a message ID, returning its
+// index or -1 if there isn't one; wildcards never match, the
+// interest of a reader that would take anything cannot be
+// used to decide what the GNSS chip should emit.
+static int32_t msgOutFind(const uGnssPrivateMessageId_t *pMessageId)
+{
+    int32_t index = -1;
+    const uGnssMsgOutKey_t *pKey;
+
+    for (size_t x = 0; (x < sizeof(gMsgOutKey) / sizeof(gMsgOutKey[0])) &&
+         (index < 0); x++) {
+        pKey = &(gMsgOutKey[x]);
+        if (pKey->protocol == pMessageId->type) {
+            switch (pMessageId->type) {
+                case U_GNSS_PROTOCOL_UBX:
+                    // A wildcard UBX ID contains 0xFF, which no real one does
+                    if (pMessageId->id.ubx == pKey->id) {
+                        index = (int32_t) x;
                     }
+                    break;
+                case U_GNSS_PROTOCOL_RTCM:
+                    if (pMessageId->id.rtcm == pKey->id) {
+                        index = (int32_t) x;
+                    }
+                    break;
+                case U_GNSS_PROTOCOL_NMEA:
+                    // The talker ID doesn't matter, the sentence
+                    // type must match exactly
+                    if ((strlen(pMessageId->id.nmea) == 5) &&
+                        (memcmp(pMessageId->id.nmea + 2, pKey->nmea, 3) == 0)) {
+                        index = (int32_t) x;
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    return index;
+}
 
-                    // Clear out any remaining data
-                    uRingBufferReadHandle(&(pInstance->ringBuffer),
-                                          pMsgReceive->ringBufferReadHandle, NULL,
-                                          pMsgReceive->msgBytesLeftToRead);
+// Note that a reader, or a blocking receive, does or no longer does
+// want a message; msgOutApply() must be called to act on it.
+// gUGnssPrivateMutex should be locked before this is called.
+static void msgOutWant(uGnssPrivateInstance_t *pInstance,
+                       const uGnssPrivateMessageId_t *pMessageId,
+                       bool wantNotRelease)
+{
+    int32_t index;
+    uGnssPrivateMsgOut_t *pMsgOut;
+
+    if (pInstance->pMsgOut != NULL) {
+        index = msgOutFind(pMessageId);
+        if (index >= 0) {
+            pMsgOut = pInstance->pMsgOut + index;
+            if (wantNotRelease) {
+                if (pMsgOut->wanted < UINT8_MAX) {
+                    pMsgOut->wanted++;
                 }
+            } else if (pMsgOut->wanted > 0) {
+                pMsgOut->wanted--;
             }
         }
+    }
+}
 
-        // Relax to let others in; relax for twice as long if we last
-        // received nothing and aren't desperately seeking more data,
-        // in order to allow some data to build up
-        yieldTimeMs = U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS;
-        if ((receiveSize == 0) && (errorCodeOrLength != (int32_t) U_ERROR_COMMON_TIMEOUT))  {
-            yieldTimeMs *= 2;
+// Note that uGnssMsgReceive() has stopped waiting for a message,
+// so that, should nothing else want it, it is left switched on for
+// U_GNSS_MSG_OUT_HOLD_OFF_TIME_MS in case uGnssMsgReceive() is
+// called for it again.
+// gUGnssPrivateMutex should be locked before this is called.
+static void msgOutHoldOff(uGnssPrivateInstance_t *pInstance,
+                          const uGnssPrivateMessageId_t *pMessageId)
+{
+    int32_t index;
+    uGnssPrivateMsgOut_t *pMsgOut;
+
+    if (pInstance->pMsgOut != NULL) {
+        index = msgOutFind(pMessageId);
+        if (index >= 0) {
+            pMsgOut = pInstance->pMsgOut + index;
+            pMsgOut->holdOff = true;
+            pMsgOut->holdOffStartMs = uPortGetTickTimeMs();
         }
-        uPortTaskBlock(yieldTimeMs);
+    }
+}
+
+// Send a UBX-CFG-VALSET setting the output rates of the given
+// entries in gMsgOutKey[] on the port we are connected to.
+// gUGnssPrivateMutex should be locked before this is called.
+static int32_t msgOutSend(uGnssPrivateInstance_t *pInstance,
+                          const size_t *pIndex, size_t numIndexes)
+{
+    // Room for the body of a UBX-CFG-VALSET message carrying
+    // U_GNSS_MSG_OUT_VALSET_MAX_NUM_KEYS one-byte values
+    char message[4 + ((4 + 1) * U_GNSS_MSG_OUT_VALSET_MAX_NUM_KEYS)] = {0};
+    char *pData = message + 4;
+    uint32_t keyId;
+    size_t index;
+
+    // Version 0, RAM layer only, no transaction
+    message[1] = 0x01;
+    for (size_t x = 0; x < numIndexes; x++) {
+        index = *(pIndex + x);
+        keyId = U_GNSS_CFG_VAL_KEY(U_GNSS_CFG_VAL_KEY_GROUP_ID_MSGOUT,
+                                   gMsgOutKey[index].keyItemI2c +
+                                   (uint32_t) pInstance->portNumber,
+                                   U_GNSS_CFG_VAL_KEY_SIZE_ONE_BYTE);
+        *((uint32_t *) pData) = uUbxProtocolUint32Encode(keyId);
+        *(pData + 4) = (char) ((pInstance->pMsgOut + index)->wanted > 0);
+        pData += 4 + 1;
+    }
+
+    return uGnssPrivateSendUbxMessage(pInstance, 0x06, 0x8a,
+                                      message, pData - message);
+}
+
+// Bring the output rates of the messages in gMsgOutKey[] into line
+// with what is wanted, in as few UBX-CFG-VALSET messages as possible;
+// a message that is being held off (see msgOutHoldOff()) is left on
+// until its time is up.  Only a message that the GNSS chip NAKs is
+// marked as unsupported: after any other failure the rates are
+// left as they were, to be tried again next time.
+// gUGnssPrivateMutex should be locked before this is called.
+static int32_t msgOutApply(uGnssPrivateInstance_t *pInstance)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t sendErrorCode;
+    size_t index[U_GNSS_MSG_OUT_VALSET_MAX_NUM_KEYS];
+    size_t numIndexes = 0;
+    uGnssPrivateMsgOut_t *pMsgOut;
+    uint8_t rate;
+    size_t x = 0;
+    int32_t nowMs = uPortGetTickTimeMs();
+
+    while ((pInstance->pMsgOut != NULL) &&
+           ((x < sizeof(gMsgOutKey) / sizeof(gMsgOutKey[0])) || (numIndexes > 0))) {
+        if (x < sizeof(gMsgOutKey) / sizeof(gMsgOutKey[0])) {
+            // Collect the messages whose rate needs to change
+            pMsgOut = pInstance->pMsgOut + x;
+            rate = (pMsgOut->wanted > 0);
+            if (pMsgOut->holdOff &&
+                ((rate > 0) ||
+                 (nowMs - pMsgOut->holdOffStartMs >= U_GNSS_MSG_OUT_HOLD_OFF_TIME_MS))) {
+                // Wanted again or time is up
+                pMsgOut->holdOff = false;
+            }
+            if ((pMsgOut->rate != U_GNSS_MSG_OUT_RATE_UNSUPPORTED) &&
+                (pMsgOut->rate != rate) && !pMsgOut->holdOff) {
+                index[numIndexes] = x;
+                numIndexes++;
+            }
+            x++;
+        }
+        if ((numIndexes > 0) &&
+            ((numIndexes == sizeof(index) / sizeof(index[0])) ||
+             (x == sizeof(gMsgOutKey) / sizeof(gMsgOutKey[0])))) {
+            // Got a full batch, or the end of the table, send it
+            sendErrorCode = msgOutSend(pInstance, index, numIndexes);
+            if (sendErrorCode == 0) {
+                for (size_t y = 0; y < numIndexes; y++) {
+                    pMsgOut = pInstance->pMsgOut + index[y];
+                    pMsgOut->rate = (pMsgOut->wanted > 0);
+                }
+            } else if (sendErrorCode == (int32_t) U_GNSS_ERROR_NACK) {
+                // The whole lot is rejected if the GNSS chip doesn't
+                // support any one of them: try them one at a time
+                // to find out which and then forget about those
+                for (size_t y = 0; y < numIndexes; y++) {
+                    pMsgOut = pInstance->pMsgOut + index[y];
+                    sendErrorCode = msgOutSend(pInstance, &(index[y]), 1);
+                    if (sendErrorCode == 0) {
+                        pMsgOut->rate = (pMsgOut->wanted > 0);
+                    } else if (sendErrorCode == (int32_t) U_GNSS_ERROR_NACK) {
+                        pMsgOut->rate = U_GNSS_MSG_OUT_RATE_UNSUPPORTED;
+                        if (pMsgOut->wanted > 0) {
+                            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+                        }
+                    } else {
+                        errorCode = sendErrorCode;
+                    }
+                }
+            } else {
+                // A timeout or a transport error says nothing
+                // about what the GNSS chip supports
+                errorCode = sendErrorCode;
+            }
+            numIndexes = 0;
+        }
+    }
+
+    return errorCode;
+}
+
+#if U_GNSS_MSG_RECEIVE_TASK_SHARED
+
+// Task that runs the non-blocking message receive for all GNSS
+// instances, each polled at its own adaptive interval.
+static void msgReceiveTask(void *pParam)
+{
+    uGnssPrivateMsgReceiveShared_t *pShared = (uGnssPrivateMsgReceiveShared_t *) pParam;
+    char queueItem[U_GNSS_MSG_RECEIVE_TASK_QUEUE_ITEM_SIZE_BYTES];
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPrivateMsgReceive_t *pMsgReceive;
+    int32_t nowMs;
+    int32_t waitMs;
+
+    U_PORT_MUTEX_LOCK(pShared->taskRunningMutexHandle);
+
+    // Continue until we receive something on the queue, which
+    // will cause us to exit
+    while (uPortQueueTryReceive(pShared->taskExitQueueHandle, 0, queueItem) < 0) {
+        waitMs = U_GNSS_MSG_TASK_POLL_MAX_TIME_MS;
+
+        U_PORT_MUTEX_LOCK(pShared->instanceListMutexHandle);
+
+        pInstance = pShared->pInstanceList;
+        while (pInstance != NULL) {
+            pMsgReceive = pInstance->pMsgReceive;
+            nowMs = uPortGetTickTimeMs();
+            if (nowMs - pMsgReceive->nextPollTimeMs >= 0) {
+                pMsgReceive->nextPollTimeMs = nowMs + msgReceiveService(pInstance);
+            }
+            // Sleep no longer than the most urgent instance allows
+            if (pMsgReceive->nextPollTimeMs - nowMs < waitMs) {
+                waitMs = pMsgReceive->nextPollTimeMs - nowMs;
+            }
+            pInstance = pMsgReceive->pNextShared;
+        }
+
+        U_PORT_MUTEX_UNLOCK(pShared->instanceListMutexHandle);
+
+        if (waitMs < U_CFG_OS_YIELD_MS) {
+            waitMs = U_CFG_OS_YIELD_MS;
+        }
+        uPortTaskBlock(waitMs);
+    }
+
+    U_PORT_MUTEX_UNLOCK(pShared->taskRunningMutexHandle);
+
+    // Delete ourself
+    uPortTaskDelete(NULL);
+}
+
+// Add a GNSS instance to those serviced by the shared message
+// receive task, starting the task if it is not already running.
+// gUGnssPrivateMutex should be locked before this is called.
+static int32_t msgReceiveSharedAdd(uGnssPrivateInstance_t *pInstance)
+{
+    int32_t errorCode = 0;
+    uGnssPrivateMsgReceiveShared_t *pShared = &gUGnssPrivateMsgReceiveShared;
+    uGnssPrivateMsgReceive_t *pMsgReceive = pInstance->pMsgReceive;
+
+    if (pShared->taskHandle == NULL) {
+        errorCode = uPortMutexCreate(&(pShared->instanceListMutexHandle));
+        if (errorCode == 0) {
+            errorCode = uPortQueueCreate(U_GNSS_MSG_RECEIVE_TASK_QUEUE_LENGTH,
+                                         U_GNSS_MSG_RECEIVE_TASK_QUEUE_ITEM_SIZE_BYTES,
+                                         &(pShared->taskExitQueueHandle));
+            if (errorCode == 0) {
+                errorCode = uPortMutexCreate(&(pShared->taskRunningMutexHandle));
+                if (errorCode == 0) {
+                    errorCode = uPortTaskCreate(msgReceiveTask, "gnssMsgRx",
+                                                U_GNSS_MSG_RECEIVE_TASK_STACK_SIZE_BYTES,
+                                                pShared, U_GNSS_MSG_RECEIVE_TASK_PRIORITY,
+                                                &(pShared->taskHandle));
+                    if (errorCode == 0) {
+                        // Wait for the task to lock the mutex,
+                        // which shows it is running
+                        while (uPortMutexTryLock(pShared->taskRunningMutexHandle, 0) == 0) {
+                            uPortMutexUnlock(pShared->taskRunningMutexHandle);
+                            uPortTaskBlock(U_CFG_OS_YIELD_MS);
+                        }
+                    }
+                }
+            }
+        }
+        if (errorCode != 0) {
+            // Tidy up if we couldn't get OS resources
+            if (pShared->taskRunningMutexHandle != NULL) {
+                uPortMutexDelete(pShared->taskRunningMutexHandle);
+            }
+            if (pShared->taskExitQueueHandle != NULL) {
+                uPortQueueDelete(pShared->taskExitQueueHandle);
+            }
+            if (pShared->instanceListMutexHandle != NULL) {
+                uPortMutexDelete(pShared->instanceListMutexHandle);
+            }
+            memset(pShared, 0, sizeof(*pShared));
+        }
+    }
+
+    if (errorCode == 0) {
+        // Lock our ring buffer read handle and hand the
+        // instance to the shared task, to be polled straight away
+        uRingBufferLockReadHandle(&(pInstance->ringBuffer),
+                                  pMsgReceive->ringBufferReadHandle);
+        pMsgReceive->taskHandle = pShared->taskHandle;
+        pMsgReceive->nextPollTimeMs = uPortGetTickTimeMs();
+
+        U_PORT_MUTEX_LOCK(pShared->instanceListMutexHandle);
+
+        pMsgReceive->pNextShared = pShared->pInstanceList;
+        pShared->pInstanceList = pInstance;
+
+        U_PORT_MUTEX_UNLOCK(pShared->instanceListMutexHandle);
+    }
+
+    return errorCode;
+}
+
+#else
+
+// Task that runs the non-blocking message receive.
+static void msgReceiveTask(void *pParam)
+{
+    uGnssPrivateInstance_t *pInstance = (uGnssPrivateInstance_t *) pParam;
+    char queueItem[U_GNSS_MSG_RECEIVE_TASK_QUEUE_ITEM_SIZE_BYTES];
+    uGnssPrivateMsgReceive_t *pMsgReceive = pInstance->pMsgReceive;
+
+    U_PORT_MUTEX_LOCK(pMsgReceive->taskRunningMutexHandle);
+
+    // Lock our ring buffer read handle; now we just have to keep up...
+    uRingBufferLockReadHandle(&(pInstance->ringBuffer),
+                              pMsgReceive->ringBufferReadHandle);
+
+    // Continue until we receive something on the queue, which
+    // will cause us to exit
+    while (uPortQueueTryReceive(pMsgReceive->taskExitQueueHandle, 0, queueItem) < 0) {
+        uPortTaskBlock(msgReceiveService(pInstance));
     }
 
     // Now we can unlock our ring buffer read handle.  Phew.
@@ -239,6 +792,8 @@ static void msgReceiveTask(void *pParam)
     uPortTaskDelete(NULL);
 }
 
+#endif // U_GNSS_MSG_RECEIVE_TASK_SHARED
+
 // Read a message from the ring buffer into a user's buffer.
 int32_t msgReceiveCallbackRead(uDeviceHandle_t gnssHandle,
                                char *pBuffer, size_t size,
@@ -277,6 +832,32 @@ int32_t msgReceiveCallbackRead(uDeviceHandle_t gnssHandle,
     return errorCodeOrLength;
 }
 
+// Get the instance for capture/replay, creating the capture mutex
+// if required.
+// gUGnssPrivateMutex should be locked before this is called.
+static int32_t getCaptureInstance(uDeviceHandle_t gnssHandle,
+                                  uGnssPrivateInstance_t **ppInstance)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssPrivateInstance_t *pInstance;
+
+    pInstance = pUGnssPrivateGetInstance(gnssHandle);
+    if (pInstance != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+        if (uGnssPrivateGetStreamType(pInstance->transportType) >= 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            if (pInstance->captureMutex == NULL) {
+                errorCode = uPortMutexCreate(&(pInstance->captureMutex));
+            }
+            if (errorCode == 0) {
+                *ppInstance = pInstance;
+            }
+        }
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: MISC
  * -------------------------------------------------------------- */
@@ -431,12 +1012,21 @@ int32_t uGnssMsgReceive(uDeviceHandle_t gnssHandle,
         pInstance = pUGnssPrivateGetInstance(gnssHandle);
         if ((pInstance != NULL) && (pMessageId != NULL) &&
             (uGnssPrivateMessageIdToPrivate(pMessageId, &privateMessageId) == 0)) {
+            // If automatic output-rate tuning is on, make sure the
+            // message is being emitted for as long as we wait for it;
+            // if we waited for it recently it will still be on
+            msgOutWant(pInstance, &privateMessageId, true);
+            msgOutApply(pInstance);
             errorCodeOrLength = uGnssPrivateReceiveStreamMessage(pInstance,
                                                                  &privateMessageId,
                                                                  pInstance->ringBufferReadHandleMsgReceive,
                                                                  ppBuffer, size,
                                                                  timeoutMs,
                                                                  pKeepGoingCallback);
+            // Leave it on for a while, in case we're called again for
+            // it; it will be switched off by a later msgOutApply()
+            msgOutWant(pInstance, &privateMessageId, false);
+            msgOutHoldOff(pInstance, &privateMessageId);
         }
 
         U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
@@ -455,7 +1045,9 @@ int32_t uGnssMsgReceiveStart(uDeviceHandle_t gnssHandle,
     uGnssPrivateInstance_t *pInstance;
     uGnssPrivateMsgReceive_t *pMsgReceive;
     uGnssPrivateMsgReader_t *pReader;
+#if !U_GNSS_MSG_RECEIVE_TASK_SHARED
     const char *pTaskName = "gnssMsgRx";
+#endif
 
     if (gUGnssPrivateMutex != NULL) {
 
@@ -475,45 +1067,48 @@ int32_t uGnssMsgReceiveStart(uDeviceHandle_t gnssHandle,
                     if (pInstance->pMsgReceive != NULL) {
                         pMsgReceive = pInstance->pMsgReceive;
                         memset(pMsgReceive, 0, sizeof(*pMsgReceive));
+                        pMsgReceive->pollIntervalMs = U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS;
                         // Take a "master" read handle
                         pMsgReceive->ringBufferReadHandle = uRingBufferTakeReadHandle(&(pInstance->ringBuffer));
                         if (pMsgReceive->ringBufferReadHandle >= 0) {
-                            // Allocate a temporary buffer that we can use to pull data
-                            // from the streaming source into the ring-buffer from our
-                            // asynchronous task
-                            pMsgReceive->pTemporaryBuffer = (char *) malloc(U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES);
-                            if (pMsgReceive->pTemporaryBuffer != NULL) {
-                                // Create the mutex that controls access to the linked-list of readers
-                                errorCodeOrHandle = uPortMutexCreate(&(pMsgReceive->readerMutexHandle));
+                            // Create the mutex that controls access to the linked-list of readers
+                            errorCodeOrHandle = uPortMutexCreate(&(pMsgReceive->readerMutexHandle));
+#if U_GNSS_MSG_RECEIVE_TASK_SHARED
+                            if (errorCodeOrHandle == 0) {
+                                // Hand the instance to the shared task
+                                errorCodeOrHandle = msgReceiveSharedAdd(pInstance);
+                            }
+#else
+                            if (errorCodeOrHandle == 0) {
+                                // Create the queue that allows us to get the task to exit
+                                errorCodeOrHandle = uPortQueueCreate(U_GNSS_MSG_RECEIVE_TASK_QUEUE_LENGTH,
+                                                                     U_GNSS_MSG_RECEIVE_TASK_QUEUE_ITEM_SIZE_BYTES,
+                                                                     &(pMsgReceive->taskExitQueueHandle));
                                 if (errorCodeOrHandle == 0) {
-                                    // Create the queue that allows us to get the task to exit
-                                    errorCodeOrHandle = uPortQueueCreate(U_GNSS_MSG_RECEIVE_TASK_QUEUE_LENGTH,
-                                                                         U_GNSS_MSG_RECEIVE_TASK_QUEUE_ITEM_SIZE_BYTES,
-                                                                         &(pMsgReceive->taskExitQueueHandle));
+                                    // Create the mutex for task running status
+                                    errorCodeOrHandle = uPortMutexCreate(&(pMsgReceive->taskRunningMutexHandle));
                                     if (errorCodeOrHandle == 0) {
-                                        // Create the mutex for task running status
-                                        errorCodeOrHandle = uPortMutexCreate(&(pMsgReceive->taskRunningMutexHandle));
+                                        //... and then the task
+                                        errorCodeOrHandle = uPortTaskCreate(msgReceiveTask,
+                                                                            pTaskName,
+                                                                            U_GNSS_MSG_RECEIVE_TASK_STACK_SIZE_BYTES,
+                                                                            pInstance, U_GNSS_MSG_RECEIVE_TASK_PRIORITY,
+                                                                            &(pMsgReceive->taskHandle));
                                         if (errorCodeOrHandle == 0) {
-                                            //... and then the task
-                                            errorCodeOrHandle = uPortTaskCreate(msgReceiveTask,
-                                                                                pTaskName,
-                                                                                U_GNSS_MSG_RECEIVE_TASK_STACK_SIZE_BYTES,
-                                                                                pInstance, U_GNSS_MSG_RECEIVE_TASK_PRIORITY,
-                                                                                &(pMsgReceive->taskHandle));
-                                            if (errorCodeOrHandle == 0) {
-                                                // Wait for the task to lock the mutex,
-                                                // which shows it is running
-                                                while (uPortMutexTryLock(pMsgReceive->taskRunningMutexHandle, 0) == 0) {
-                                                    uPortMutexUnlock(pMsgReceive->taskRunningMutexHandle);
-                                                    uPortTaskBlock(U_CFG_OS_YIELD_MS);
-                                                }
+                                            // Wait for the task to lock the mutex,
+                                            // which shows it is running
+                                            while (uPortMutexTryLock(pMsgReceive->taskRunningMutexHandle, 0) == 0) {
+                                                uPortMutexUnlock(pMsgReceive->taskRunningMutexHandle);
+                                                uPortTaskBlock(U_CFG_OS_YIELD_MS);
                                             }
                                         }
                                     }
                                 }
                             }
+#endif
                             if (errorCodeOrHandle != 0) {
                                 // Tidy up if we couldn't get OS resources
+#if !U_GNSS_MSG_RECEIVE_TASK_SHARED
                                 if (pMsgReceive->taskHandle != NULL) {
                                     uPortTaskDelete(msgReceiveTask);
                                 }
@@ -523,10 +1118,10 @@ int32_t uGnssMsgReceiveStart(uDeviceHandle_t gnssHandle,
                                 if (pMsgReceive->taskExitQueueHandle != NULL) {
                                     uPortQueueDelete(pMsgReceive->taskExitQueueHandle);
                                 }
+#endif
                                 if (pMsgReceive->readerMutexHandle != NULL) {
                                     uPortMutexDelete(pMsgReceive->readerMutexHandle);
                                 }
-                                free(pInstance->pTemporaryBuffer);
                                 uRingBufferGiveReadHandle(&(pInstance->ringBuffer),
                                                           pMsgReceive->ringBufferReadHandle);
                                 free(pInstance->pMsgReceive);
@@ -562,6 +1157,11 @@ int32_t uGnssMsgReceiveStart(uDeviceHandle_t gnssHandle,
 
                 U_PORT_MUTEX_UNLOCK(pInstance->pMsgReceive->readerMutexHandle);
 
+                // If automatic output-rate tuning is on, make sure
+                // the GNSS chip is emitting the message
+                msgOutWant(pInstance, &(pReader->privateMessageId), true);
+                msgOutApply(pInstance);
+
                 // Return the handle
                 errorCodeOrHandle = pReader->handle;
             }
@@ -627,6 +1227,7 @@ int32_t uGnssMsgReceiveStop(uDeviceHandle_t gnssHandle, int32_t asyncHandle)
                         } else {
                             pMsgReceive->pReaderList = pCurrent->pNext;
                         }
+                        msgOutWant(pInstance, &(pCurrent->privateMessageId), false);
                         free(pCurrent);
                         pCurrent = NULL;
                         errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
@@ -643,6 +1244,8 @@ int32_t uGnssMsgReceiveStop(uDeviceHandle_t gnssHandle, int32_t asyncHandle)
                     uGnssPrivateStopMsgReceive(pInstance);
                 }
 
+                // Stop the GNSS chip emitting anything no-one now wants
+                msgOutApply(pInstance);
             }
         }
 
@@ -657,6 +1260,7 @@ int32_t uGnssMsgReceiveStopAll(uDeviceHandle_t gnssHandle)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uGnssPrivateInstance_t *pInstance;
+    uGnssPrivateMsgReader_t *pReader;
 
     if (gUGnssPrivateMutex != NULL) {
 
@@ -666,8 +1270,78 @@ int32_t uGnssMsgReceiveStopAll(uDeviceHandle_t gnssHandle)
         pInstance = pUGnssPrivateGetInstance(gnssHandle);
         if (pInstance != NULL) {
             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            if (pInstance->pMsgReceive != NULL) {
+                // No need to lock the reader mutex, it is only
+                // read from the task
+                pReader = pInstance->pMsgReceive->pReaderList;
+                while (pReader != NULL) {
+                    msgOutWant(pInstance, &(pReader->privateMessageId), false);
+                    pReader = pReader->pNext;
+                }
+            }
             // We can just call the shut down function to lose the lot
             uGnssPrivateStopMsgReceive(pInstance);
+            // ...and switch off everything that was wanted in one go
+            msgOutApply(pInstance);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Switch automatic output-rate tuning on or off.
+int32_t uGnssMsgReceiveSetAutoOutput(uDeviceHandle_t gnssHandle, bool onNotOff)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPrivateMsgReader_t *pReader;
+    size_t numKeys = sizeof(gMsgOutKey) / sizeof(gMsgOutKey[0]);
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            if (!onNotOff) {
+                // Just forget it all, the output rates stay as they are
+                free(pInstance->pMsgOut);
+                pInstance->pMsgOut = NULL;
+            } else if (pInstance->pMsgOut == NULL) {
+                errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+                if (U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
+                    errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                    pInstance->pMsgOut = (uGnssPrivateMsgOut_t *) malloc(numKeys * sizeof(uGnssPrivateMsgOut_t));
+                    if (pInstance->pMsgOut != NULL) {
+                        for (size_t x = 0; x < numKeys; x++) {
+                            (pInstance->pMsgOut + x)->wanted = 0;
+                            (pInstance->pMsgOut + x)->rate = U_GNSS_MSG_OUT_RATE_UNKNOWN;
+                            (pInstance->pMsgOut + x)->holdOff = false;
+                            (pInstance->pMsgOut + x)->holdOffStartMs = 0;
+                        }
+                        // Count what any readers that are already
+                        // running want; no need to lock the reader
+                        // mutex, it is only read from the task
+                        if (pInstance->pMsgReceive != NULL) {
+                            pReader = pInstance->pMsgReceive->pReaderList;
+                            while (pReader != NULL) {
+                                msgOutWant(pInstance, &(pReader->privateMessageId), true);
+                                pReader = pReader->pNext;
+                            }
+                        }
+                        // Since no rate is known this sets all of
+                        // them, switching off anything not wanted;
+                        // anything the GNSS chip doesn't support is
+                        // simply left out from now on
+                        msgOutApply(pInstance);
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    }
+                }
+            }
         }
 
         U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
@@ -741,4 +1415,279 @@ size_t uGnssMsgReceiveStatStreamLoss(uDeviceHandle_t gnssHandle)
     return bytesLost;
 }
 
+// Switch automatic sizing of the ring buffer on or off.
+int32_t uGnssMsgReceiveSetRingBufferAutoSize(uDeviceHandle_t gnssHandle,
+                                             size_t minSizeBytes,
+                                             size_t maxSizeBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPrivateRingBufferSize_t *pRingBufferSize = NULL;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (minSizeBytes <= maxSizeBytes) &&
+            ((maxSizeBytes == 0) || (minSizeBytes > 0))) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if ((uGnssPrivateGetStreamType(pInstance->transportType) >= 0) &&
+                (pInstance->pLinearBuffer != NULL)) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                if (maxSizeBytes > 0) {
+                    errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                    pRingBufferSize = (uGnssPrivateRingBufferSize_t *) malloc(sizeof(*pRingBufferSize));
+                    if (pRingBufferSize != NULL) {
+                        pRingBufferSize->minSizeBytes = minSizeBytes;
+                        pRingBufferSize->maxSizeBytes = maxSizeBytes;
+                        pRingBufferSize->readHandle = -1;
+                        pRingBufferSize->windowStartTimeMs = uPortGetTickTimeMs();
+                        pRingBufferSize->lossBytes = 0;
+                        pRingBufferSize->quietWindowCount = 0;
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    }
+                }
+                if ((errorCode == 0) && (pInstance->ringBufferSizeMutex == NULL)) {
+                    errorCode = uPortMutexCreate(&(pInstance->ringBufferSizeMutex));
+                }
+                if (errorCode == 0) {
+
+                    U_PORT_MUTEX_LOCK(pInstance->ringBufferSizeMutex);
+
+                    free(pInstance->pRingBufferSize);
+                    pInstance->pRingBufferSize = pRingBufferSize;
+                    pRingBufferSize = NULL;
+
+                    U_PORT_MUTEX_UNLOCK(pInstance->ringBufferSizeMutex);
+                }
+                free(pRingBufferSize);
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Get the current size of the ring buffer.
+int32_t uGnssMsgReceiveGetRingBufferSize(uDeviceHandle_t gnssHandle)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (pInstance->pLinearBuffer != NULL) {
+                errorCodeOrSize = (int32_t) pInstance->ringBuffer.size;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCodeOrSize;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: CAPTURE/REPLAY
+ * -------------------------------------------------------------- */
+
+// Start capturing the stream from the GNSS chip.
+int32_t uGnssMsgCaptureStart(uDeviceHandle_t gnssHandle,
+                             char *pBuffer, size_t size,
+                             uGnssMsgCaptureCallback_t pCallback,
+                             void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance = NULL;
+    uGnssPrivateCapture_t *pCapture;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (((pBuffer != NULL) && (size > 0)) || (pCallback != NULL)) {
+            errorCode = getCaptureInstance(gnssHandle, &pInstance);
+        }
+        if (pInstance != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pCapture = (uGnssPrivateCapture_t *) malloc(sizeof(uGnssPrivateCapture_t));
+            if (pCapture != NULL) {
+                memset(pCapture, 0, sizeof(*pCapture));
+                pCapture->pBuffer = pBuffer;
+                pCapture->size = size;
+                pCapture->pCallback = (void *) pCallback;
+                pCapture->pCallbackParam = pCallbackParam;
+                pCapture->startTimeMs = uPortGetTickTimeMs();
+
+                U_PORT_MUTEX_LOCK(pInstance->captureMutex);
+
+                // Replace any capture that was already in progress
+                free(pInstance->pCapture);
+                pInstance->pCapture = pCapture;
+
+                U_PORT_MUTEX_UNLOCK(pInstance->captureMutex);
+
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Stop capturing the stream from the GNSS chip.
+int32_t uGnssMsgCaptureStop(uDeviceHandle_t gnssHandle,
+                            size_t *pLostBytes)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance = NULL;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCodeOrLength = getCaptureInstance(gnssHandle, &pInstance);
+        if (pInstance != NULL) {
+
+            U_PORT_MUTEX_LOCK(pInstance->captureMutex);
+
+            errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            if (pInstance->pCapture != NULL) {
+                errorCodeOrLength = (int32_t) pInstance->pCapture->length;
+                if (pLostBytes != NULL) {
+                    *pLostBytes = pInstance->pCapture->lossBytes;
+                }
+                free(pInstance->pCapture);
+                pInstance->pCapture = NULL;
+            }
+
+            U_PORT_MUTEX_UNLOCK(pInstance->captureMutex);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCodeOrLength;
+}
+
+// Replay a capture in place of the stream from the GNSS chip.
+int32_t uGnssMsgReplayStart(uDeviceHandle_t gnssHandle,
+                            const char *pCapture, size_t size,
+                            bool maxSpeed)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance = NULL;
+    uGnssPrivateReplay_t *pReplay;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pCapture != NULL) {
+            errorCode = getCaptureInstance(gnssHandle, &pInstance);
+        }
+        if (pInstance != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            // Allocate the replay state and a copy of the capture in one go
+            pReplay = (uGnssPrivateReplay_t *) malloc(sizeof(uGnssPrivateReplay_t) + size);
+            if (pReplay != NULL) {
+                memset(pReplay, 0, sizeof(*pReplay));
+                memcpy(((char *) pReplay) + sizeof(*pReplay), pCapture, size);
+                pReplay->pCapture = ((const char *) pReplay) + sizeof(*pReplay);
+                pReplay->size = size;
+                pReplay->maxSpeed = maxSpeed;
+                pReplay->startTimeMs = uPortGetTickTimeMs();
+
+                U_PORT_MUTEX_LOCK(pInstance->captureMutex);
+
+                free(pInstance->pReplay);
+                pInstance->pReplay = pReplay;
+
+                U_PORT_MUTEX_UNLOCK(pInstance->captureMutex);
+
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Get the amount of a capture remaining to be replayed.
+int32_t uGnssMsgReplayGetRemaining(uDeviceHandle_t gnssHandle)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance = NULL;
+    uGnssPrivateReplay_t *pReplay;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCodeOrLength = getCaptureInstance(gnssHandle, &pInstance);
+        if (pInstance != NULL) {
+
+            U_PORT_MUTEX_LOCK(pInstance->captureMutex);
+
+            errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+            pReplay = pInstance->pReplay;
+            if (pReplay != NULL) {
+                errorCodeOrLength = 0;
+                if (pReplay->offset < pReplay->size) {
+                    errorCodeOrLength = (int32_t) (pReplay->size - pReplay->offset);
+                }
+            }
+
+            U_PORT_MUTEX_UNLOCK(pInstance->captureMutex);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCodeOrLength;
+}
+
+// Stop replaying a capture.
+int32_t uGnssMsgReplayStop(uDeviceHandle_t gnssHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance = NULL;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = getCaptureInstance(gnssHandle, &pInstance);
+        if (pInstance != NULL) {
+
+            U_PORT_MUTEX_LOCK(pInstance->captureMutex);
+
+            free(pInstance->pReplay);
+            pInstance->pReplay = NULL;
+
+            U_PORT_MUTEX_UNLOCK(pInstance->captureMutex);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
 // End of file
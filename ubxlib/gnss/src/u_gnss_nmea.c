@@ -0,0 +1,643 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief This source file contains the implementation of the NMEA
+ * field parsing functions of the GNSS API.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+
+#include "u_error_common.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss.h"    // U_GNSS_ERROR_CRC
+#include "u_gnss_nmea.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The length of the talker ID at the start of the address field.
+ */
+#define U_GNSS_NMEA_TALKER_LENGTH_CHARACTERS 2
+
+/** The length of the sentence formatter that follows the talker ID.
+ */
+#define U_GNSS_NMEA_FORMATTER_LENGTH_CHARACTERS 3
+
+/** The number of fields, including the address field, in a GGA
+ * sentence.
+ */
+#define U_GNSS_NMEA_GGA_NUM_FIELDS 15
+
+/** The minimum number of fields, including the address field, in
+ * an RMC sentence (NMEA 2.1).
+ */
+#define U_GNSS_NMEA_RMC_MIN_NUM_FIELDS 12
+
+/** The minimum number of fields, including the address field, in
+ * a GSA sentence (before NMEA 4.10).
+ */
+#define U_GNSS_NMEA_GSA_MIN_NUM_FIELDS 18
+
+/** The minimum number of fields, including the address field, in
+ * a GSV sentence (no satellites).
+ */
+#define U_GNSS_NMEA_GSV_MIN_NUM_FIELDS 4
+
+/** The number of fields per satellite in a GSV sentence.
+ */
+#define U_GNSS_NMEA_GSV_FIELDS_PER_SATELLITE 4
+
+/** Knots to millimetres per second is 1852000 / 3600, reduced.
+ */
+#define U_GNSS_NMEA_KNOTS_TO_MM_PER_S_NUMERATOR 4630
+#define U_GNSS_NMEA_KNOTS_TO_MM_PER_S_DENOMINATOR 9
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Powers of ten, for fixed-point scaling.
+ */
+static const int32_t gPowersOfTen[] = {1, 10, 100, 1000, 10000, 100000,
+                                       1000000, 10000000, 100000000,
+                                       1000000000
+                                      };
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Convert a hex character into a nibble, -1 if it is not hex.
+static int32_t hexNibble(char c)
+{
+    int32_t nibble = -1;
+
+    if ((c >= '0') && (c <= '9')) {
+        nibble = c - '0';
+    } else if ((c >= 'A') && (c <= 'F')) {
+        nibble = c - 'A' + 10;
+    } else if ((c >= 'a') && (c <= 'f')) {
+        nibble = c - 'a' + 10;
+    }
+
+    return nibble;
+}
+
+// Parse a signed decimal number with an optional fractional part
+// as a fixed-point 64-bit integer with the given number of decimal
+// places; digits beyond that are discarded.
+static int32_t parseFixed(const uGnssNmeaField_t *pField,
+                          int32_t decimalPlaces, int64_t *pValue)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+    const char *pData = pField->pData;
+    const char *pEnd = pField->pData + pField->size;
+    bool negative = false;
+    bool fraction = false;
+    int32_t numDigits = 0;
+    int64_t value = 0;
+
+    if (pField->size > 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if ((*pData == '-') || (*pData == '+')) {
+            negative = (*pData == '-');
+            pData++;
+        }
+        for (; (pData < pEnd) && (errorCode == 0); pData++) {
+            if ((*pData >= '0') && (*pData <= '9')) {
+                if (!fraction) {
+                    value = (value * 10) + (*pData - '0');
+                    if (value > INT32_MAX) {
+                        // A number this big can't be right
+                        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+                    }
+                } else if (decimalPlaces > 0) {
+                    value = (value * 10) + (*pData - '0');
+                    decimalPlaces--;
+                }
+                numDigits++;
+            } else if ((*pData == '.') && !fraction) {
+                fraction = true;
+            } else {
+                errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            }
+        }
+        if (numDigits == 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        }
+        if (errorCode == 0) {
+            // Scale for any decimal places that weren't in the field
+            value *= gPowersOfTen[decimalPlaces];
+            if (negative) {
+                value = -value;
+            }
+            *pValue = value;
+        }
+    }
+
+    return errorCode;
+}
+
+// Decode a field as fixed-point, setting the value to
+// U_GNSS_NMEA_FIELD_NOT_PRESENT if the field is empty; returns
+// false only if the field is present but bad.
+static bool fieldToFixedOrNotPresent(const uGnssNmeaField_t *pField,
+                                     int32_t decimalPlaces, int32_t *pValue)
+{
+    int32_t errorCode = uGnssNmeaFieldToFixed(pField, decimalPlaces, pValue);
+
+    if (errorCode == (int32_t) U_ERROR_COMMON_NOT_FOUND) {
+        *pValue = U_GNSS_NMEA_FIELD_NOT_PRESENT;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return (errorCode == 0);
+}
+
+// Decode a latitude/longitude pair of fields, setting the value to
+// U_GNSS_NMEA_FIELD_NOT_PRESENT if either is empty; returns false
+// only if the fields are present but bad.
+static bool fieldToLatLongOrNotPresent(const uGnssNmeaField_t *pField,
+                                       const uGnssNmeaField_t *pHemisphere,
+                                       int32_t *pX1e7)
+{
+    int32_t errorCode = uGnssNmeaFieldToLatLong(pField, pHemisphere, pX1e7);
+
+    if (errorCode == (int32_t) U_ERROR_COMMON_NOT_FOUND) {
+        *pX1e7 = U_GNSS_NMEA_FIELD_NOT_PRESENT;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return (errorCode == 0);
+}
+
+// Decode a time field, setting the value to
+// U_GNSS_NMEA_FIELD_NOT_PRESENT if it is empty; returns false
+// only if the field is present but bad.
+static bool fieldToTimeOrNotPresent(const uGnssNmeaField_t *pField,
+                                    int32_t *pTimeOfDayMs)
+{
+    int32_t errorCode = uGnssNmeaFieldToTime(pField, pTimeOfDayMs);
+
+    if (errorCode == (int32_t) U_ERROR_COMMON_NOT_FOUND) {
+        *pTimeOfDayMs = U_GNSS_NMEA_FIELD_NOT_PRESENT;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return (errorCode == 0);
+}
+
+// Tokenize a sentence into pFields[], checking that it has the given
+// sentence formatter (e.g. "GGA") and copying the talker ID into
+// pTalker; returns the number of fields or negative error code.
+static int32_t splitSentence(const char *pSentence, size_t size,
+                             const char *pFormatter, char *pTalker,
+                             uGnssNmeaField_t *pFields, size_t maxNumFields)
+{
+    int32_t errorCodeOrNumFields = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssNmeaTokenizer_t tokenizer;
+    int32_t numFields = 0;
+
+    if (pSentence != NULL) {
+        errorCodeOrNumFields = uGnssNmeaTokenizerInit(&tokenizer, pSentence, size);
+        if (errorCodeOrNumFields == 0) {
+            while (((size_t) numFields < maxNumFields) &&
+                   uGnssNmeaTokenizerNext(&tokenizer, pFields + numFields)) {
+                numFields++;
+            }
+            errorCodeOrNumFields = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            // The address field must be a talker ID followed by the formatter
+            if ((numFields > 0) &&
+                (pFields->size == U_GNSS_NMEA_TALKER_LENGTH_CHARACTERS +
+                 U_GNSS_NMEA_FORMATTER_LENGTH_CHARACTERS) &&
+                (memcmp(pFields->pData + U_GNSS_NMEA_TALKER_LENGTH_CHARACTERS,
+                        pFormatter, U_GNSS_NMEA_FORMATTER_LENGTH_CHARACTERS) == 0)) {
+                memcpy(pTalker, pFields->pData, U_GNSS_NMEA_TALKER_LENGTH_CHARACTERS);
+                errorCodeOrNumFields = numFields;
+            }
+        }
+    }
+
+    return errorCodeOrNumFields;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TOKENIZER
+ * -------------------------------------------------------------- */
+
+// Set up to tokenize an NMEA sentence.
+int32_t uGnssNmeaTokenizerInit(uGnssNmeaTokenizer_t *pTokenizer,
+                               const char *pSentence, size_t size)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const char *pEnd;
+    const char *pStar;
+    uint8_t checksum = 0;
+    int32_t hi;
+    int32_t lo;
+
+    if ((pTokenizer != NULL) && (pSentence != NULL) && (size > 1) &&
+        ((*pSentence == '$') || (*pSentence == '!'))) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        pEnd = pSentence + size;
+        // Lose any line ending
+        while ((pEnd > pSentence + 1) && ((*(pEnd - 1) == '\r') || (*(pEnd - 1) == '\n'))) {
+            pEnd--;
+        }
+        // Checksum everything between the '$' and the '*', if there is one
+        pStar = pSentence + 1;
+        while ((pStar < pEnd) && (*pStar != '*')) {
+            checksum ^= (uint8_t) *pStar;
+            pStar++;
+        }
+        if (pStar < pEnd) {
+            errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            if (pEnd - pStar == 3) {
+                hi = hexNibble(*(pStar + 1));
+                lo = hexNibble(*(pStar + 2));
+                if ((hi >= 0) && (lo >= 0)) {
+                    errorCode = (int32_t) U_GNSS_ERROR_CRC;
+                    if (((hi << 4) | lo) == checksum) {
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    }
+                }
+            }
+        }
+        if (errorCode == 0) {
+            pTokenizer->pNext = pSentence + 1;
+            pTokenizer->pEnd = pStar;
+            pTokenizer->done = false;
+        }
+    }
+
+    return errorCode;
+}
+
+// Get the next field of a sentence.
+bool uGnssNmeaTokenizerNext(uGnssNmeaTokenizer_t *pTokenizer,
+                            uGnssNmeaField_t *pField)
+{
+    bool gotField = false;
+    const char *pComma;
+
+    if ((pTokenizer != NULL) && (pField != NULL) && !pTokenizer->done) {
+        pComma = pTokenizer->pNext;
+        while ((pComma < pTokenizer->pEnd) && (*pComma != ',')) {
+            pComma++;
+        }
+        pField->pData = pTokenizer->pNext;
+        pField->size = pComma - pTokenizer->pNext;
+        if (pComma < pTokenizer->pEnd) {
+            pTokenizer->pNext = pComma + 1;
+        } else {
+            // That was the last one
+            pTokenizer->done = true;
+        }
+        gotField = true;
+    }
+
+    return gotField;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: FIELD DECODERS
+ * -------------------------------------------------------------- */
+
+// Decode a field that contains a signed decimal integer.
+int32_t uGnssNmeaFieldToInt32(const uGnssNmeaField_t *pField,
+                              int32_t *pValue)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int64_t value = 0;
+    size_t x;
+
+    if ((pField != NULL) && (pValue != NULL)) {
+        // No decimal point allowed
+        for (x = 0; (x < pField->size) && (pField->pData[x] != '.'); x++) {}
+        if (x == pField->size) {
+            errorCode = parseFixed(pField, 0, &value);
+            if (errorCode == 0) {
+                *pValue = (int32_t) value;
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Decode a field that contains a fixed-point decimal number.
+int32_t uGnssNmeaFieldToFixed(const uGnssNmeaField_t *pField,
+                              int32_t decimalPlaces, int32_t *pValue)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int64_t value = 0;
+
+    if ((pField != NULL) && (pValue != NULL) && (decimalPlaces >= 0) &&
+        (decimalPlaces < (int32_t) (sizeof(gPowersOfTen) / sizeof(gPowersOfTen[0])))) {
+        errorCode = parseFixed(pField, decimalPlaces, &value);
+        if (errorCode == 0) {
+            if ((value > INT32_MAX) || (value < -INT32_MAX)) {
+                errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            } else {
+                *pValue = (int32_t) value;
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Decode an NMEA latitude or longitude field.
+int32_t uGnssNmeaFieldToLatLong(const uGnssNmeaField_t *pField,
+                                const uGnssNmeaField_t *pHemisphere,
+                                int32_t *pX1e7)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int64_t value = 0;
+    int64_t degrees;
+    char hemisphere;
+
+    if ((pField != NULL) && (pHemisphere != NULL) && (pX1e7 != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        if (pHemisphere->size > 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            hemisphere = *(pHemisphere->pData);
+            if ((pHemisphere->size == 1) &&
+                ((hemisphere == 'N') || (hemisphere == 'S') ||
+                 (hemisphere == 'E') || (hemisphere == 'W'))) {
+                // value is degrees * 100 plus minutes, times 1e7
+                errorCode = parseFixed(pField, 7, &value);
+                if (errorCode == 0) {
+                    errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+                    degrees = value / 1000000000LL;
+                    value -= degrees * 1000000000LL;
+                    if ((value >= 0) && (value < 600000000LL) && (degrees <= 180)) {
+                        // Convert minutes to degrees, rounding
+                        value = (degrees * 10000000LL) + ((value + 30) / 60);
+                        if ((hemisphere == 'S') || (hemisphere == 'W')) {
+                            value = -value;
+                        }
+                        *pX1e7 = (int32_t) value;
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    }
+                }
+            }
+        } else if (pField->size > 0) {
+            // Can't have a value without a hemisphere
+            errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        }
+    }
+
+    return errorCode;
+}
+
+// Decode an NMEA time field.
+int32_t uGnssNmeaFieldToTime(const uGnssNmeaField_t *pField,
+                             int32_t *pTimeOfDayMs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int64_t value = 0;
+    int32_t hours;
+    int32_t minutes;
+    int32_t milliseconds;
+
+    if ((pField != NULL) && (pTimeOfDayMs != NULL)) {
+        // value is hhmmss times 1000
+        errorCode = parseFixed(pField, 3, &value);
+        if (errorCode == 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            hours = (int32_t) (value / 10000000);
+            minutes = (int32_t) ((value / 100000) % 100);
+            milliseconds = (int32_t) (value % 100000);
+            // Allow 60 seconds for a leap second
+            if ((value >= 0) && (hours < 24) && (minutes < 60) && (milliseconds < 61000)) {
+                *pTimeOfDayMs = (hours * 3600000) + (minutes * 60000) + milliseconds;
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: SENTENCE DECODERS
+ * -------------------------------------------------------------- */
+
+// Decode an NMEA GGA sentence.
+int32_t uGnssNmeaDecodeGga(const char *pSentence, size_t size,
+                           uGnssNmeaGga_t *pGga)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssNmeaField_t fields[U_GNSS_NMEA_GGA_NUM_FIELDS];
+
+    if (pGga != NULL) {
+        errorCode = splitSentence(pSentence, size, "GGA", pGga->talker,
+                                  fields, sizeof(fields) / sizeof(fields[0]));
+        if (errorCode == U_GNSS_NMEA_GGA_NUM_FIELDS) {
+            errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            if (fieldToTimeOrNotPresent(&(fields[1]), &(pGga->timeOfDayMs)) &&
+                fieldToLatLongOrNotPresent(&(fields[2]), &(fields[3]), &(pGga->latitudeX1e7)) &&
+                fieldToLatLongOrNotPresent(&(fields[4]), &(fields[5]), &(pGga->longitudeX1e7)) &&
+                fieldToFixedOrNotPresent(&(fields[6]), 0, &(pGga->quality)) &&
+                fieldToFixedOrNotPresent(&(fields[7]), 0, &(pGga->numSvs)) &&
+                fieldToFixedOrNotPresent(&(fields[8]), 2, &(pGga->hdopX100)) &&
+                fieldToFixedOrNotPresent(&(fields[9]), 3, &(pGga->altitudeMillimetres)) &&
+                fieldToFixedOrNotPresent(&(fields[11]), 3, &(pGga->geoidSeparationMillimetres))) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        } else if (errorCode >= 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        }
+    }
+
+    return errorCode;
+}
+
+// Decode an NMEA RMC sentence.
+int32_t uGnssNmeaDecodeRmc(const char *pSentence, size_t size,
+                           uGnssNmeaRmc_t *pRmc)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssNmeaField_t fields[U_GNSS_NMEA_RMC_MIN_NUM_FIELDS + 2];
+    int32_t date = 0;
+
+    if (pRmc != NULL) {
+        errorCode = splitSentence(pSentence, size, "RMC", pRmc->talker,
+                                  fields, sizeof(fields) / sizeof(fields[0]));
+        if (errorCode >= U_GNSS_NMEA_RMC_MIN_NUM_FIELDS) {
+            pRmc->mode = 0;
+            if ((errorCode > U_GNSS_NMEA_RMC_MIN_NUM_FIELDS) && (fields[12].size > 0)) {
+                pRmc->mode = *(fields[12].pData);
+            }
+            errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            pRmc->valid = (fields[2].size == 1) && (*(fields[2].pData) == 'A');
+            pRmc->day = U_GNSS_NMEA_FIELD_NOT_PRESENT;
+            pRmc->month = U_GNSS_NMEA_FIELD_NOT_PRESENT;
+            pRmc->year = U_GNSS_NMEA_FIELD_NOT_PRESENT;
+            if (fieldToTimeOrNotPresent(&(fields[1]), &(pRmc->timeOfDayMs)) &&
+                fieldToLatLongOrNotPresent(&(fields[3]), &(fields[4]), &(pRmc->latitudeX1e7)) &&
+                fieldToLatLongOrNotPresent(&(fields[5]), &(fields[6]), &(pRmc->longitudeX1e7)) &&
+                fieldToFixedOrNotPresent(&(fields[7]), 3, &(pRmc->speedMillimetresPerSecond)) &&
+                fieldToFixedOrNotPresent(&(fields[8]), 2, &(pRmc->courseDegreesX100))) {
+                if (pRmc->speedMillimetresPerSecond != U_GNSS_NMEA_FIELD_NOT_PRESENT) {
+                    // Speed is in thousandths of a knot at this point
+                    pRmc->speedMillimetresPerSecond = (int32_t) ((((int64_t) pRmc->speedMillimetresPerSecond) *
+                                                                  U_GNSS_NMEA_KNOTS_TO_MM_PER_S_NUMERATOR) /
+                                                                 (U_GNSS_NMEA_KNOTS_TO_MM_PER_S_DENOMINATOR * 1000));
+                }
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                if (fields[9].size > 0) {
+                    errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+                    // ddmmyy
+                    if ((fields[9].size == 6) &&
+                        (uGnssNmeaFieldToInt32(&(fields[9]), &date) == 0) && (date >= 0)) {
+                        pRmc->day = date / 10000;
+                        pRmc->month = (date / 100) % 100;
+                        // GNSS didn't exist before 1980
+                        pRmc->year = date % 100;
+                        pRmc->year += (pRmc->year < 80) ? 2000 : 1900;
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    }
+                }
+            }
+        } else if (errorCode >= 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        }
+    }
+
+    return errorCode;
+}
+
+// Decode an NMEA GSA sentence.
+int32_t uGnssNmeaDecodeGsa(const char *pSentence, size_t size,
+                           uGnssNmeaGsa_t *pGsa)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssNmeaField_t fields[U_GNSS_NMEA_GSA_MIN_NUM_FIELDS + 1];
+    int32_t numFields;
+    bool good;
+
+    if (pGsa != NULL) {
+        numFields = splitSentence(pSentence, size, "GSA", pGsa->talker,
+                                  fields, sizeof(fields) / sizeof(fields[0]));
+        errorCode = numFields;
+        if (numFields >= U_GNSS_NMEA_GSA_MIN_NUM_FIELDS) {
+            errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            pGsa->opMode = 0;
+            if (fields[1].size > 0) {
+                pGsa->opMode = *(fields[1].pData);
+            }
+            pGsa->numSvs = 0;
+            good = fieldToFixedOrNotPresent(&(fields[2]), 0, &(pGsa->fixType));
+            for (size_t x = 0; (x < U_GNSS_NMEA_GSA_MAX_NUM_SVS) && good; x++) {
+                // Satellite IDs are packed at the start, empty fields after
+                if (fields[3 + x].size > 0) {
+                    good = (uGnssNmeaFieldToInt32(&(fields[3 + x]), &(pGsa->svId[pGsa->numSvs])) == 0);
+                    pGsa->numSvs++;
+                }
+            }
+            pGsa->systemId = U_GNSS_NMEA_FIELD_NOT_PRESENT;
+            if (good && (numFields > U_GNSS_NMEA_GSA_MIN_NUM_FIELDS)) {
+                good = fieldToFixedOrNotPresent(&(fields[18]), 0, &(pGsa->systemId));
+            }
+            if (good &&
+                fieldToFixedOrNotPresent(&(fields[15]), 2, &(pGsa->pdopX100)) &&
+                fieldToFixedOrNotPresent(&(fields[16]), 2, &(pGsa->hdopX100)) &&
+                fieldToFixedOrNotPresent(&(fields[17]), 2, &(pGsa->vdopX100))) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        } else if (numFields >= 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        }
+    }
+
+    return errorCode;
+}
+
+// Decode an NMEA GSV sentence.
+int32_t uGnssNmeaDecodeGsv(const char *pSentence, size_t size,
+                           uGnssNmeaGsv_t *pGsv)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssNmeaField_t fields[U_GNSS_NMEA_GSV_MIN_NUM_FIELDS +
+                            (U_GNSS_NMEA_GSV_MAX_NUM_SATELLITES *
+                             U_GNSS_NMEA_GSV_FIELDS_PER_SATELLITE) + 1];
+    int32_t numFields;
+    uGnssNmeaField_t *pField;
+    uGnssNmeaGsvSatellite_t *pSatellite;
+    bool good;
+
+    if (pGsv != NULL) {
+        numFields = splitSentence(pSentence, size, "GSV", pGsv->talker,
+                                  fields, sizeof(fields) / sizeof(fields[0]));
+        errorCode = numFields;
+        if (numFields >= U_GNSS_NMEA_GSV_MIN_NUM_FIELDS) {
+            errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+            good = fieldToFixedOrNotPresent(&(fields[1]), 0, &(pGsv->numMessages)) &&
+                   fieldToFixedOrNotPresent(&(fields[2]), 0, &(pGsv->messageNumber)) &&
+                   fieldToFixedOrNotPresent(&(fields[3]), 0, &(pGsv->numSvsInView));
+            // Whole satellites follow, then maybe a signal ID
+            numFields -= U_GNSS_NMEA_GSV_MIN_NUM_FIELDS;
+            pGsv->numSatellites = numFields / U_GNSS_NMEA_GSV_FIELDS_PER_SATELLITE;
+            pField = &(fields[U_GNSS_NMEA_GSV_MIN_NUM_FIELDS]);
+            for (size_t x = 0; (x < pGsv->numSatellites) && good; x++) {
+                pSatellite = &(pGsv->satellite[x]);
+                good = fieldToFixedOrNotPresent(pField, 0, &(pSatellite->svId)) &&
+                       fieldToFixedOrNotPresent(pField + 1, 0, &(pSatellite->elevationDegrees)) &&
+                       fieldToFixedOrNotPresent(pField + 2, 0, &(pSatellite->azimuthDegrees)) &&
+                       fieldToFixedOrNotPresent(pField + 3, 0, &(pSatellite->cnoDbHz));
+                pField += U_GNSS_NMEA_GSV_FIELDS_PER_SATELLITE;
+            }
+            pGsv->signalId = U_GNSS_NMEA_FIELD_NOT_PRESENT;
+            if (good && ((numFields % U_GNSS_NMEA_GSV_FIELDS_PER_SATELLITE) != 0)) {
+                // Must be just the one extra field, the signal ID
+                good = ((numFields % U_GNSS_NMEA_GSV_FIELDS_PER_SATELLITE) == 1) &&
+                       fieldToFixedOrNotPresent(pField, 0, &(pGsv->signalId));
+            }
+            if (good) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        } else if (numFields >= 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        }
+    }
+
+    return errorCode;
+}
+
+// End of file
@@ -51,6 +51,7 @@
 #include "u_gnss_module_type.h"
 #include "u_gnss_type.h"
 #include "u_gnss_private.h"
+#include "u_gnss_cfg_val_key.h"
 #include "u_gnss_pos.h"
 
 /* ----------------------------------------------------------------
@@ -85,6 +86,16 @@
 #define U_GNSS_POS_RRLP_HEADER_SIZE_BYTES (U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES - 2)
 #endif
 
+#ifndef U_GNSS_POS_RRLP_STREAM_WAIT_MS
+/** When uGnssPosGetRrlpBest() has not yet found any RRLP epoch
+ * that meets the criteria and the time budget has run out, the
+ * period to wait for each further epoch to arrive from the
+ * periodic UBX-RXM-MEASX stream before checking the
+ * "keep going" callback again.
+ */
+# define U_GNSS_POS_RRLP_STREAM_WAIT_MS 2000
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -124,8 +135,7 @@ static int32_t posGet(uGnssPrivateInstance_t *pInstance,
     int32_t errorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
     // Enough room for the body of the UBX-NAV-PVT message
     char message[92] = {0};
-    int32_t months;
-    int32_t year;
+    uTimeDate_t date;
     int32_t y;
     int64_t t = -1;
 
@@ -138,22 +148,19 @@ static int32_t posGet(uGnssPrivateInstance_t *pInstance,
             // Time and date are valid; we don't indicate
             // success based on this but we report it anyway
             // if it is valid
-            t = 0;
-            // Year is 1999-2099, so need to adjust to get year since 1970
-            year = ((int32_t) uUbxProtocolUint16Decode(message + 4) - 1999) + 29;
-            // Month (1 to 12), so take away 1 to make it zero-based
-            months = message[6] - 1;
-            months += year * 12;
-            // Work out the number of seconds due to the year/month count
-            t += uTimeMonthsToSecondsUtc(months);
+            // Year is 1999-2099
+            date.year = (int32_t) uUbxProtocolUint16Decode(message + 4);
+            // Month (1 to 12)
+            date.month = message[6];
             // Day (1 to 31)
-            t += ((int32_t) message[7] - 1) * 3600 * 24;
+            date.day = message[7];
             // Hour (0 to 23)
-            t += ((int32_t) message[8]) * 3600;
+            date.hours = message[8];
             // Minute (0 to 59)
-            t += ((int32_t) message[9]) * 60;
+            date.minutes = message[9];
             // Second (0 to 60)
-            t += message[10];
+            date.seconds = message[10];
+            t = uTimeDateToEpoch(&date);
             if (printIt) {
                 uPortLog("U_GNSS_POS: UTC time = %d.\n", (int32_t) t);
             }
@@ -279,6 +286,136 @@ static void posGetTask(void *pParameter)
     uPortTaskDelete(NULL);
 }
 
+// Evaluate the body of a UBX-RXM-MEASX message against the RRLP
+// criteria, returning a score if the message meets them, higher
+// being better, else negative; the score puts the number of
+// satellites meeting the criteria first and their summed carrier
+// to noise ratio second.  No logging is done here as this is called
+// for every epoch.
+static int32_t rrlpScore(const uint8_t *pBody, int32_t bodySize,
+                         int32_t svsThreshold, int32_t cNoThreshold,
+                         int32_t multipathIndexLimit,
+                         int32_t pseudorangeRmsErrorIndexLimit,
+                         int32_t *pSvs, int32_t *pNumMeetingCriteria)
+{
+    int32_t score = 0;
+    int32_t svs = 0;
+    int32_t numMeetingCriteria = 0;
+    int32_t cNoTotal = 0;
+    bool goodSatellite;
+    const uint8_t *pSatellite;
+
+    // 34 since that's the furthest we need to read to check on the number of satellites
+    if (bodySize > 34) {
+        // The number of satellites is at offset 34
+        svs = *(pBody + 34);
+        // The per-satellite blocks are 24 bytes long, starting at
+        // offset 44, and the last thing we need from each is the
+        // pseudorange RMS error index at offset 21 within the block
+        for (int32_t x = 0; (x < svs) && (bodySize > 44 + 21 + (x * 24)); x++) {
+            pSatellite = pBody + 44 + (x * 24);
+            // Carrier to noise ratio is at offset 2 in the block,
+            // multipath index at offset 3, pseudorange RMS error
+            // index at offset 21
+            goodSatellite = ((cNoThreshold < 0) ||
+                             (*(pSatellite + 2) >= cNoThreshold)) &&
+                            ((multipathIndexLimit < 0) ||
+                             (*(pSatellite + 3) <= multipathIndexLimit)) &&
+                            ((pseudorangeRmsErrorIndexLimit < 0) ||
+                             (*(pSatellite + 21) <= pseudorangeRmsErrorIndexLimit));
+            if (goodSatellite) {
+                numMeetingCriteria++;
+                cNoTotal += *(pSatellite + 2);
+            }
+        }
+    } else if ((svsThreshold >= 0) || (cNoThreshold >= 0) ||
+               (multipathIndexLimit >= 0) || (pseudorangeRmsErrorIndexLimit >= 0)) {
+        // Too short to tell, can't meet any criteria
+        score = -1;
+    }
+
+    if ((svsThreshold >= 0) &&
+        ((svs < svsThreshold) || (numMeetingCriteria < svsThreshold))) {
+        score = -1;
+    }
+    if (score == 0) {
+        // cNoTotal is at most 255 * 63, fits in 16 bits
+        score = (numMeetingCriteria << 16) + cNoTotal;
+    }
+    if (pSvs != NULL) {
+        *pSvs = svs;
+    }
+    if (pNumMeetingCriteria != NULL) {
+        *pNumMeetingCriteria = numMeetingCriteria;
+    }
+
+    return score;
+}
+
+// Since the Cloud Locate service expects the UBX protocol header
+// information and CRC, re-construct them around the body of a
+// UBX-RXM-MEASX message that is at U_GNSS_POS_RRLP_HEADER_SIZE_BYTES
+// into pBuffer, returning the total length.
+static int32_t rrlpAddUbxFrame(uint8_t *pBuffer, int32_t bodySize)
+{
+    int32_t ca = 0;
+    int32_t cb = 0;
+
+    *pBuffer = 0xb5;
+    *(pBuffer + 1) = 0x62;
+    *(pBuffer + 2) = 0x02;
+    *(pBuffer + 3) = 0x14;
+    // Little-endian length of the body
+    *(pBuffer + 4) = (uint8_t) bodySize;
+    *(pBuffer + 5) = (uint8_t) ((uint32_t) bodySize >> 8);
+    // Cloud Locate also needs the two-byte CRC which
+    // is across the class, ID, length and body so
+    // reconstruct that here
+    pBuffer += 2;
+    for (int32_t x = 0; x < bodySize + 4; x++) {
+        ca += *pBuffer;
+        cb += ca;
+        pBuffer++;
+    }
+    // Write in the CRC
+    *pBuffer++ = (uint8_t) (ca & 0xff);
+    *pBuffer = (uint8_t) (cb & 0xff);
+
+    return bodySize + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES;
+}
+
+// Set the rate at which UBX-RXM-MEASX is emitted on the port
+// we are connected to, 0 to switch it off.
+static int32_t setRrlpRate(uGnssPrivateInstance_t *pInstance, int32_t rate)
+{
+    int32_t errorCode;
+    // Room for the body of a UBX-CFG-VALSET message carrying
+    // a single one-byte value, also big enough for UBX-CFG-MSG
+    char message[4 + 4 + 1] = {0};
+
+    if (U_GNSS_PRIVATE_HAS(pInstance->pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
+        // UBX-CFG-VALSET, version 0, RAM layer only, no transaction;
+        // the CFG-MSGOUT-UBX_RXM_MEASX key IDs run I2C, UART1, UART2,
+        // USB and SPI, which is the same order as the port numbers
+        message[1] = 0x01;
+        *((uint32_t *) & (message[4])) = uUbxProtocolUint32Encode(U_GNSS_CFG_VAL_KEY_ID_MSGOUT_UBX_RXM_MEASX_I2C_U1 +
+                                                                  (uint32_t) pInstance->portNumber);
+        message[8] = (char) rate;
+        errorCode = uGnssPrivateSendUbxMessage(pInstance, 0x06, 0x8a,
+                                               message, sizeof(message));
+    } else {
+        // UBX-CFG-MSG, the short form which applies to the
+        // port the message is received on
+        message[0] = 0x02;
+        message[1] = 0x14;
+        message[2] = (char) rate;
+        errorCode = uGnssPrivateSendUbxMessage(pInstance, 0x06, 0x01,
+                                               message, 3);
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -479,11 +616,7 @@ int32_t uGnssPosGetRrlp(uDeviceHandle_t gnssHandle, char *pBuffer,
     int64_t startTime;
     int32_t svs;
     int32_t numBytes;
-    int32_t z;
     int32_t numMeetingCriteria;
-    bool goodSatellite;
-    int32_t ca = 0;
-    int32_t cb = 0;
     // Access the buffer as a uint8_t to avoid maths funnies with
     // chars being signed or unsigned
     uint8_t *pBufferUint8 = (uint8_t *) pBuffer;
@@ -531,88 +664,157 @@ int32_t uGnssPosGetRrlp(uDeviceHandle_t gnssHandle, char *pBuffer,
                                                              sizeBytes - U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
                 if (numBytes > 0) {
                     // Got something, is it good enough?
-                    // 34 since that's the furthest we need to read to check on the number of satellites
-                    if ((((svsThreshold >= 0) || (cNoThreshold >= 0) ||
-                          (multipathIndexLimit >= 0) || (pseudorangeRmsErrorIndexLimit >= 0)) && (numBytes >= 34))) {
-                        // The number of satellites is at offset 34
-                        svs = *(pBufferUint8 + U_GNSS_POS_RRLP_HEADER_SIZE_BYTES + 34);
-                        uPortLog("U_GNSS_POS: RRLP information for %d satellite(s).\n", svs);
-                        if ((svsThreshold >= 0) && (svs < svsThreshold)) {
-                            // Not enough satellites in the first place
+                    if (rrlpScore(pBufferUint8 + U_GNSS_POS_RRLP_HEADER_SIZE_BYTES,
+                                  numBytes, svsThreshold, cNoThreshold,
+                                  multipathIndexLimit, pseudorangeRmsErrorIndexLimit,
+                                  &svs, &numMeetingCriteria) >= 0) {
+                        // Got a good measurement!
+                        errorCodeOrLength = rrlpAddUbxFrame(pBufferUint8, numBytes);
+                    }
+                    uPortLog("U_GNSS_POS: RRLP information for %d satellite(s),"
+                             " %d meet the criteria.\n", svs, numMeetingCriteria);
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCodeOrLength;
+}
+
+// Get the best RRLP information from the GNSS chip within a time budget.
+int32_t uGnssPosGetRrlpBest(uDeviceHandle_t gnssHandle, char *pBuffer,
+                            size_t sizeBytes, int32_t svsThreshold,
+                            int32_t cNoThreshold,
+                            int32_t multipathIndexLimit,
+                            int32_t pseudorangeRmsErrorIndexLimit,
+                            int32_t timeBudgetMs,
+                            bool (*pKeepGoingCallback) (uDeviceHandle_t))
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssPrivateMessageId_t privateMessageId;
+    int64_t startTime;
+    int32_t elapsedMs;
+    int32_t waitMs;
+    bool streaming = false;
+    char *pCandidate = NULL;
+    char *pBest;
+    char *pTmp;
+    int32_t numBytes;
+    int32_t score;
+    int32_t bestScore = -1;
+    int32_t bestNumBytes = 0;
+    int32_t bestSvs = 0;
+    int32_t bestNumMeetingCriteria = 0;
+    int32_t svs;
+    int32_t numMeetingCriteria;
+    int32_t numEpochs = 0;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pBuffer != NULL) &&
+            (sizeBytes >= U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES)) {
+            errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            // Epochs are received into pCandidate and the best of
+            // them so far is held in pBest, the two being swapped
+            // when a candidate wins, so that there is at most
+            // one copy at the end
+            pCandidate = (char *) malloc(sizeBytes);
+            if (pCandidate != NULL) {
+                pBest = pBuffer;
+                // Where there is a stream, switch the periodic
+                // UBX-RXM-MEASX message on and read each epoch as it
+                // arrives rather than polling for it, which would
+                // get us the same epoch repeatedly and cost a
+                // round-trip each time; otherwise poll
+                streaming = (uGnssPrivateGetStreamType(pInstance->transportType) >= 0) &&
+                            (setRrlpRate(pInstance, 1) == 0);
+                startTime = uPortGetTickTimeMs();
+                errorCodeOrLength = (int32_t) U_ERROR_COMMON_TIMEOUT;
+                // Keep going until the time budget is used up or, if we
+                // don't yet have anything that meets the criteria,
+                // until the timeout/callback says otherwise
+                elapsedMs = 0;
+                while (((elapsedMs < timeBudgetMs) || (bestScore < 0)) &&
+                       (((pKeepGoingCallback == NULL) &&
+                         (elapsedMs / 1000 < U_GNSS_POS_TIMEOUT_SECONDS)) ||
+                        ((pKeepGoingCallback != NULL) && pKeepGoingCallback(gnssHandle)))) {
+                    if (streaming) {
+                        waitMs = timeBudgetMs - elapsedMs;
+                        if (waitMs <= 0) {
+                            waitMs = U_GNSS_POS_RRLP_STREAM_WAIT_MS;
+                        }
+                        privateMessageId.type = U_GNSS_PROTOCOL_UBX;
+                        privateMessageId.id.ubx = 0x0214;
+                        numBytes = uGnssPrivateReceiveStreamMessage(pInstance, &privateMessageId,
+                                                                    pInstance->ringBufferReadHandlePrivate,
+                                                                    &pCandidate, sizeBytes, waitMs,
+                                                                    pKeepGoingCallback);
+                        // What we got is the whole message; make sure it wasn't
+                        // truncated to fit and work out the length of the body
+                        if ((numBytes >= U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES) &&
+                            (uUbxProtocolUint16Decode(pCandidate + 4) ==
+                             numBytes - U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES)) {
+                            numBytes -= U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES;
+                        } else {
                             numBytes = -1;
                         }
-                        if ((numBytes > 0) &&
-                            ((cNoThreshold >= 0) || (multipathIndexLimit >= 0) || (pseudorangeRmsErrorIndexLimit >= 0))) {
-                            numMeetingCriteria = svs;
-                            // 65 since that's the furthest we need to check on the criteria
-                            for (int8_t x = 0; (x < svs) && (numBytes >= 65 + (x * 24)); x++) {
-                                goodSatellite = true;
-                                // Carrier to noise ratio is at offset 46 + (x * 24)
-                                if (cNoThreshold >= 0) {
-                                    z = *(pBufferUint8 + U_GNSS_POS_RRLP_HEADER_SIZE_BYTES + 46 + (x * 24));
-                                    uPortLog("U_GNSS_POS: RRLP CNo for satellite %d is %d.\n", x + 1, z);
-                                    if (z < cNoThreshold) {
-                                        goodSatellite = false;
-                                    }
-                                }
-                                // Multipath index is at offset 47 + (x * 24)
-                                if (goodSatellite && (multipathIndexLimit >= 0)) {
-                                    z = *(pBufferUint8 + U_GNSS_POS_RRLP_HEADER_SIZE_BYTES + 47 + (x * 24));
-                                    uPortLog("U_GNSS_POS: RRLP multipath for satellite %d is %d.\n", x + 1, z);
-                                    if (z > multipathIndexLimit) {
-                                        goodSatellite = false;
-                                    }
-                                }
-                                // Pseudorange RMS error index is at offset 65 + (x * 24)
-                                if (goodSatellite && (pseudorangeRmsErrorIndexLimit >= 0)) {
-                                    z = *(pBufferUint8 + U_GNSS_POS_RRLP_HEADER_SIZE_BYTES + 65 + (x * 24));
-                                    uPortLog("U_GNSS_POS: pseudorange RMS error index for satellite %d is %d.\n",
-                                             x + 1, z);
-                                    if (z > pseudorangeRmsErrorIndexLimit) {
-                                        goodSatellite = false;
-                                    }
-                                }
-                                if (!goodSatellite) {
-                                    numMeetingCriteria--;
-                                    uPortLog("U_GNSS_POS: only up to %d satellite(s) meet the criteria.\n",
-                                             numMeetingCriteria);
-                                    if (numMeetingCriteria < svsThreshold) {
-                                        // Force exit
-                                        numBytes = -1;
-                                    }
-                                }
-                            }
+                    } else {
+                        numBytes = uGnssPrivateSendReceiveUbxMessage(pInstance,
+                                                                     0x02, 0x14, NULL, 0,
+                                                                     pCandidate + U_GNSS_POS_RRLP_HEADER_SIZE_BYTES,
+                                                                     sizeBytes - U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+                    }
+                    if (numBytes > 0) {
+                        numEpochs++;
+                        score = rrlpScore((uint8_t *) pCandidate + U_GNSS_POS_RRLP_HEADER_SIZE_BYTES,
+                                          numBytes, svsThreshold, cNoThreshold,
+                                          multipathIndexLimit, pseudorangeRmsErrorIndexLimit,
+                                          &svs, &numMeetingCriteria);
+                        if (score > bestScore) {
+                            bestScore = score;
+                            bestNumBytes = numBytes;
+                            bestSvs = svs;
+                            bestNumMeetingCriteria = numMeetingCriteria;
+                            pTmp = pBest;
+                            pBest = pCandidate;
+                            pCandidate = pTmp;
                         }
                     }
+                    elapsedMs = (int32_t) (uPortGetTickTimeMs() - startTime);
                 }
 
-                if (numBytes > 0) {
-                    // Got a good measurement!
-                    // Since the Cloud Locate service expects the
-                    // UBX protocol header information we need to
-                    // re-construct that on the front of the message
-                    *pBufferUint8 = 0xb5;
-                    *(pBufferUint8 + 1) = 0x62;
-                    *(pBufferUint8 + 2) = 0x02;
-                    *(pBufferUint8 + 3) = 0x14;
-                    // Little-endian length of the body
-                    *(pBufferUint8 + 4) = (uint8_t) numBytes;
-                    *(pBufferUint8 + 5) = (uint8_t) ((uint32_t) numBytes >> 8);
-                    // Cloud Locate also needs the two-byte CRC which
-                    // is across the class, ID, length and body so
-                    // reconstruct that here
-                    pBufferUint8 += 2;
-                    for (int32_t x = 0; x < numBytes + 4; x++) {
-                        ca += *pBufferUint8;
-                        cb += ca;
-                        pBufferUint8++;
-                    }
-                    // Write in the CRC
-                    *pBufferUint8++ = (uint8_t) (ca & 0xff);
-                    *pBufferUint8 = (uint8_t) (cb & 0xff);
+                if (streaming) {
+                    setRrlpRate(pInstance, 0);
+                }
 
-                    errorCodeOrLength = numBytes + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES;
+                if (bestScore >= 0) {
+                    if (pBest != pBuffer) {
+                        memcpy(pBuffer, pBest, bestNumBytes + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+                        // pCandidate is now pBuffer; make sure we free the right thing
+                        pCandidate = pBest;
+                    }
+                    if (streaming) {
+                        // Header and CRC arrived with the message
+                        errorCodeOrLength = bestNumBytes + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES;
+                    } else {
+                        errorCodeOrLength = rrlpAddUbxFrame((uint8_t *) pBuffer, bestNumBytes);
+                    }
+                    uPortLog("U_GNSS_POS: best of %d RRLP epoch(s) has %d satellite(s),"
+                             " %d meet the criteria.\n", numEpochs, bestSvs,
+                             bestNumMeetingCriteria);
+                } else {
+                    uPortLog("U_GNSS_POS: none of %d RRLP epoch(s) met the criteria.\n",
+                             numEpochs);
                 }
+
+                free(pCandidate);
             }
         }
 
@@ -56,6 +56,8 @@
 
 #include "u_ubx_protocol.h"
 
+#include "u_spartn_crc.h" // uSpartnCrc24(), which is also RTCM CRC-24Q
+
 #include "u_device_shared.h"
 
 #include "u_network_shared.h"
@@ -78,6 +80,23 @@
                                          U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES) * 2)
 #endif
 
+#ifndef U_GNSS_AT_HEX_CHUNK_LENGTH_BYTES
+/** The number of hex characters encoded at a time, on the stack,
+ * when writing a UBX-format message to an AT interface; must
+ * be an even number.
+ */
+# define U_GNSS_AT_HEX_CHUNK_LENGTH_BYTES 64
+#endif
+
+/** The number of bytes in an RTCM 3 frame before the payload:
+ * preamble (0xD3) plus six reserved bits and ten bits of length.
+ */
+#define U_GNSS_PRIVATE_RTCM_HEADER_LENGTH_BYTES 3
+
+/** The number of bytes of CRC-24Q at the end of an RTCM 3 frame.
+ */
+#define U_GNSS_PRIVATE_RTCM_CRC_LENGTH_BYTES 3
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -111,6 +130,11 @@ uGnssPrivateInstance_t *gpUGnssPrivateInstanceList = NULL;
  */
 uPortMutexHandle_t gUGnssPrivateMutex = NULL;
 
+/** The task that runs the non-blocking message receive for all
+ * GNSS instances, only used if #U_GNSS_MSG_RECEIVE_TASK_SHARED is 1.
+ */
+uGnssPrivateMsgReceiveShared_t gUGnssPrivateMsgReceiveShared = {0};
+
 /** The characteristics of the modules supported by this driver,
  * compiled into the driver.  Order is important: uGnssModuleType_t
  * is used to index into this array.
@@ -252,6 +276,243 @@ static int32_t streamGetFromRingBuffer(uGnssPrivateInstance_t *pInstance,
     return errorCodeOrLength;
 }
 
+// Record data just read from the GNSS chip in any capture that is
+// in progress, split into records of at most 65535 bytes since the
+// length field of a record is 16 bits.
+// IMPORTANT: this function is called by uGnssPrivateStreamFillRingBuffer()
+// which may be called at any time by the message receive task.
+static void captureData(uGnssPrivateInstance_t *pInstance,
+                        const char *pData, size_t size)
+{
+    uGnssPrivateCapture_t *pCapture;
+    uGnssMsgCaptureCallback_t pCallback;
+    char header[U_GNSS_MSG_CAPTURE_HEADER_LENGTH_BYTES];
+    uint32_t timeMs;
+    uint16_t length;
+    size_t x;
+
+    if ((pInstance->captureMutex != NULL) && (size > 0)) {
+
+        U_PORT_MUTEX_LOCK(pInstance->captureMutex);
+
+        pCapture = pInstance->pCapture;
+        while ((pCapture != NULL) && (size > 0)) {
+            x = size;
+            if (x > 0xFFFF) {
+                x = 0xFFFF;
+            }
+            timeMs = uUbxProtocolUint32Encode((uint32_t) (uPortGetTickTimeMs() -
+                                                          pCapture->startTimeMs));
+            memcpy(header, &timeMs, sizeof(timeMs));
+            length = uUbxProtocolUint16Encode((uint16_t) x);
+            memcpy(header + sizeof(timeMs), &length, sizeof(length));
+            if (pCapture->pBuffer != NULL) {
+                if (pCapture->length + sizeof(header) + x <= pCapture->size) {
+                    memcpy(pCapture->pBuffer + pCapture->length, header, sizeof(header));
+                    memcpy(pCapture->pBuffer + pCapture->length + sizeof(header), pData, x);
+                    pCapture->length += sizeof(header) + x;
+                } else {
+                    pCapture->lossBytes += x;
+                }
+            }
+            pCallback = (uGnssMsgCaptureCallback_t) pCapture->pCallback;
+            if (pCallback != NULL) {
+                pCallback(pInstance->gnssHandle, header, pData, x,
+                          pCapture->pCallbackParam);
+            }
+            pData += x;
+            size -= x;
+        }
+
+        U_PORT_MUTEX_UNLOCK(pInstance->captureMutex);
+    }
+}
+
+// Feed the ring buffer, up to maxSize bytes, from the capture being
+// replayed rather than from the GNSS chip; unless the replay is at
+// maximum speed a record is only replayed once the time stamped on
+// it, relative to the start of the replay, has passed.
+// IMPORTANT: this function is called by uGnssPrivateStreamFillRingBuffer()
+// which may be called at any time by the message receive task.
+static int32_t fillRingBufferReplay(uGnssPrivateInstance_t *pInstance,
+                                    int32_t maxSize)
+{
+    int32_t length = 0;
+    uGnssPrivateReplay_t *pReplay;
+    const char *pRecord;
+    size_t recordSize;
+    size_t x;
+    size_t reservedSize;
+    char *pSpan[2];
+    size_t spanSize[2];
+
+    U_PORT_MUTEX_LOCK(pInstance->captureMutex);
+
+    pReplay = pInstance->pReplay;
+    while ((pReplay != NULL) && (length < maxSize) &&
+           (pReplay->offset + U_GNSS_MSG_CAPTURE_HEADER_LENGTH_BYTES <= pReplay->size)) {
+        pRecord = pReplay->pCapture + pReplay->offset;
+        if (!pReplay->maxSpeed &&
+            (uPortGetTickTimeMs() - pReplay->startTimeMs < (int32_t) uUbxProtocolUint32Decode(pRecord))) {
+            // Not time for this record yet
+            break;
+        }
+        recordSize = uUbxProtocolUint16Decode(pRecord + sizeof(uint32_t));
+        x = pReplay->size - pReplay->offset - U_GNSS_MSG_CAPTURE_HEADER_LENGTH_BYTES;
+        if (recordSize > x) {
+            // The capture has been truncated
+            recordSize = x;
+        }
+        pRecord += U_GNSS_MSG_CAPTURE_HEADER_LENGTH_BYTES + pReplay->recordOffset;
+        x = recordSize - pReplay->recordOffset;
+        if (x > (size_t) (maxSize - length)) {
+            x = maxSize - length;
+        }
+        reservedSize = 0;
+        if (x > 0) {
+            reservedSize = uRingBufferForceWriteReserve(&(pInstance->ringBuffer), x,
+                                                        &(pSpan[0]), &(spanSize[0]),
+                                                        &(pSpan[1]), &(spanSize[1]));
+            if (reservedSize > 0) {
+                memcpy(pSpan[0], pRecord, spanSize[0]);
+                if (spanSize[1] > 0) {
+                    memcpy(pSpan[1], pRecord + spanSize[0], spanSize[1]);
+                }
+                uRingBufferWriteCommit(&(pInstance->ringBuffer), reservedSize);
+                length += (int32_t) reservedSize;
+                pReplay->recordOffset += reservedSize;
+            }
+        }
+        if (pReplay->recordOffset >= recordSize) {
+            // Move on to the next record
+            pReplay->offset += U_GNSS_MSG_CAPTURE_HEADER_LENGTH_BYTES + recordSize;
+            pReplay->recordOffset = 0;
+        }
+        if (reservedSize < x) {
+            // No more room in the ring buffer for now
+            break;
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(pInstance->captureMutex);
+
+    return length;
+}
+
+// Read whatever a GNSS chip connected via UART has sent, up to
+// maxSize bytes, directly into the ring buffer.
+// IMPORTANT: this function is called by uGnssPrivateStreamFillRingBuffer()
+// which may be called at any time by the message receive task.
+static int32_t fillRingBufferUart(uGnssPrivateInstance_t *pInstance,
+                                  int32_t streamHandle, int32_t maxSize)
+{
+    int32_t errorCodeOrLength;
+    int32_t x;
+    char *pSpan[2];
+    size_t spanSize[2];
+
+    errorCodeOrLength = uPortUartGetReceiveSize(streamHandle);
+    if (errorCodeOrLength > maxSize) {
+        errorCodeOrLength = maxSize;
+    }
+    if ((errorCodeOrLength > 0) &&
+        (uRingBufferForceWriteReserve(&(pInstance->ringBuffer), errorCodeOrLength,
+                                      &(pSpan[0]), &(spanSize[0]),
+                                      &(pSpan[1]), &(spanSize[1])) > 0)) {
+        // Read straight into the reserved space, which may
+        // wrap around the end of the ring buffer
+        errorCodeOrLength = 0;
+        for (size_t y = 0; (y < sizeof(pSpan) / sizeof(pSpan[0])) &&
+             (spanSize[y] > 0); y++) {
+            x = uPortUartRead(streamHandle, pSpan[y], spanSize[y]);
+            if (x > 0) {
+                captureData(pInstance, pSpan[y], x);
+                errorCodeOrLength += x;
+            }
+            if (x != (int32_t) spanSize[y]) {
+                break;
+            }
+        }
+        uRingBufferWriteCommit(&(pInstance->ringBuffer), errorCodeOrLength);
+    } else {
+        // Nothing we can read or nowhere to put it
+        errorCodeOrLength = 0;
+    }
+
+    return errorCodeOrLength;
+}
+
+// Read whatever a GNSS chip connected via I2C has waiting, up to
+// maxSize bytes, directly into the ring buffer.  Only the number
+// of bytes latched in registers 0xFD/0xFE is read: anything that
+// arrives after that is picked up next time, since reading beyond
+// the latched length gets 0xFF padding which can't be told apart
+// from data.  For the same reason the length and the data are not
+// read in a single burst: the length is one bus transaction and
+// the data a second (a third if the reserved space wraps).
+// The space is reserved in the ring buffer before the length is read
+// and the reservation is held until the data has been committed:
+// since only one reservation may be outstanding, another task
+// filling the ring buffer at the same time gets nothing, and so
+// performs no I2C transactions, rather than reading a length which
+// this task's data read then makes stale.  The read pointers that
+// the reservation overlaps are only moved on by the amount
+// committed, so reserving generously costs nothing.
+// IMPORTANT: this function is called by uGnssPrivateStreamFillRingBuffer()
+// which may be called at any time by the message receive task.
+static int32_t fillRingBufferI2c(uGnssPrivateInstance_t *pInstance,
+                                 int32_t streamHandle, int32_t maxSize)
+{
+    int32_t errorCodeOrLength = 0;
+    int32_t reservedLength;
+    char *pSpan[2];
+    size_t spanSize[2];
+
+    reservedLength = (int32_t) uRingBufferForceWriteReserve(&(pInstance->ringBuffer), maxSize,
+                                                            &(pSpan[0]), &(spanSize[0]),
+                                                            &(pSpan[1]), &(spanSize[1]));
+    if (reservedLength > 0) {
+        // Reading the length leaves the register address in the GNSS
+        // chip at 0xFF, the data stream
+        errorCodeOrLength = uGnssPrivateStreamGetReceiveSize(streamHandle,
+                                                             U_GNSS_PRIVATE_STREAM_TYPE_I2C,
+                                                             pInstance->i2cAddress);
+        if (errorCodeOrLength > reservedLength) {
+            errorCodeOrLength = reservedLength;
+        }
+        if (errorCodeOrLength > 0) {
+            // Read straight into the reserved space, which may wrap
+            // around the end of the ring buffer; we need to ask for no
+            // more than we know is there since I2C drivers often don't
+            // say how much they've read, just giving back the number
+            // asked for on success
+            reservedLength = errorCodeOrLength;
+            errorCodeOrLength = 0;
+            for (size_t y = 0; (y < sizeof(pSpan) / sizeof(pSpan[0])) &&
+                 (errorCodeOrLength < reservedLength); y++) {
+                if ((int32_t) spanSize[y] > reservedLength - errorCodeOrLength) {
+                    spanSize[y] = reservedLength - errorCodeOrLength;
+                }
+                if (uPortI2cControllerSendReceive(streamHandle, pInstance->i2cAddress,
+                                                  NULL, 0, pSpan[y],
+                                                  spanSize[y]) != (int32_t) spanSize[y]) {
+                    break;
+                }
+                captureData(pInstance, pSpan[y], spanSize[y]);
+                errorCodeOrLength += (int32_t) spanSize[y];
+            }
+        }
+        if (errorCodeOrLength < 0) {
+            // Nothing to commit
+            uRingBufferWriteCommit(&(pInstance->ringBuffer), 0);
+        } else {
+            uRingBufferWriteCommit(&(pInstance->ringBuffer), errorCodeOrLength);
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
 // Send a message over UART or I2C.
 static int32_t sendMessageStream(int32_t streamHandle,
                                  uGnssPrivateStreamType_t streamType,
@@ -359,23 +620,44 @@ static int32_t receiveUbxMessageStream(uGnssPrivateInstance_t *pInstance,
  * STATIC FUNCTIONS: AT TRANSPORT ONLY
  * -------------------------------------------------------------- */
 
+// Write data hex-encoded, in quotes, as a parameter of an AT command,
+// encoding it in chunks so that no buffer the size of the whole
+// hex-encoded message is required.
+static void writeHexAt(uAtClientHandle_t atHandle, const char *pData,
+                       size_t size)
+{
+    char buffer[U_GNSS_AT_HEX_CHUNK_LENGTH_BYTES + 1]; // +1 for terminator
+    size_t x;
+
+    uAtClientWritePartialString(atHandle, true, "\"");
+    while (size > 0) {
+        x = size;
+        if (x > U_GNSS_AT_HEX_CHUNK_LENGTH_BYTES / 2) {
+            x = U_GNSS_AT_HEX_CHUNK_LENGTH_BYTES / 2;
+        }
+        *(buffer + uBinToHex(pData, x, buffer)) = 0;
+        uAtClientWritePartialString(atHandle, false, buffer);
+        pData += x;
+        size -= x;
+    }
+    uAtClientWritePartialString(atHandle, false, "\"");
+}
+
 // Send a UBX format message over an AT interface and receive
 // the response.  No matching of message ID or class for
 // the response is performed as it is not possible to get other
 // responses when using an AT command.
-static int32_t sendReceiveUbxMessageAt(const uAtClientHandle_t atHandle,
+static int32_t sendReceiveUbxMessageAt(uGnssPrivateInstance_t *pInstance,
                                        const char *pSend,
                                        size_t sendLengthBytes,
                                        uGnssPrivateUbxReceiveMessage_t *pResponse,
                                        int32_t timeoutMs,
                                        bool printIt)
 {
-    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    int32_t errorCodeOrLength;
     int32_t x;
-    size_t bytesToSend;
-    char *pBuffer;
-    bool bufferReuse = false;
-    int32_t bytesRead;
+    uAtClientHandle_t atHandle = (uAtClientHandle_t) pInstance->transportHandle.pAt;
+    char *pBuffer = NULL;
     size_t captureSize;
     int32_t clsNack = 0x05;
     int32_t idNack = 0x00;
@@ -385,104 +667,96 @@ static int32_t sendReceiveUbxMessageAt(const uAtClientHandle_t atHandle,
 
     U_ASSERT(pResponse != NULL);
 
-    // Need a buffer to hex encode the message into
-    // and receive the response into
-    x = (int32_t) (sendLengthBytes * 2) + 1; // +1 for terminator
-    if (x < U_GNSS_AT_BUFFER_LENGTH_BYTES + 1) {
-        x = U_GNSS_AT_BUFFER_LENGTH_BYTES + 1;
-    }
-    pBuffer = (char *) malloc(x);
-    if (pBuffer != NULL) {
-        errorCodeOrLength = (int32_t) U_GNSS_ERROR_TRANSPORT;
-        bytesToSend = uBinToHex(pSend, sendLengthBytes, pBuffer);
-        if (!printIt) {
-            // Switch off the AT command printing if we've been
-            // told not to print stuff; particularly important
-            // on platforms where the C library leaks memory
-            // when called from dynamically created tasks and this
-            // is being called for the GNSS asynchronous API
+    if (!printIt) {
+        // Switch off the AT command printing if we've been
+        // told not to print stuff; particularly important
+        // on platforms where the C library leaks memory
+        // when called from dynamically created tasks and this
+        // is being called for the GNSS asynchronous API
+        if (atPrintOn) {
             uAtClientPrintAtSet(atHandle, false);
-            uAtClientDebugSet(atHandle, false);
         }
-        // Add terminator
-        *(pBuffer + bytesToSend) = 0;
-        uAtClientLock(atHandle);
-        uAtClientTimeoutSet(atHandle, timeoutMs);
-        uAtClientCommandStart(atHandle, "AT+UGUBX=");
-        uAtClientWriteString(atHandle, pBuffer, true);
-        // Read the response
-        uAtClientCommandStop(atHandle);
-        if (printIt) {
-            uPortLog("U_GNSS: sent UBX command");
-            uGnssPrivatePrintBuffer(pSend, sendLengthBytes);
-            uPortLog(".\n");
+        if (atDebugPrintOn) {
+            uAtClientDebugSet(atHandle, false);
         }
-        uAtClientResponseStart(atHandle, "+UGUBX:");
-        // Read the hex-coded response back into pBuffer
-        bytesRead = uAtClientReadString(atHandle, pBuffer, x, false);
-        uAtClientResponseStop(atHandle);
-        if ((uAtClientUnlock(atHandle) == 0) && (bytesRead >= 0) &&
-            (pResponse->ppBody != NULL)) {
-            // Decode the hex into the same buffer
-            x = (int32_t) uHexToBin(pBuffer, bytesRead, pBuffer);
-            if (x > 0) {
-                // Deal with the output buffer
-                captureSize = x;
-                if (*(pResponse->ppBody) != NULL) {
-                    if (captureSize > pResponse->bodySize) {
-                        captureSize = pResponse->bodySize;
-                    }
-                } else {
-                    // We can just re-use the buffer we already have
-                    *(pResponse->ppBody) = pBuffer;
-                    bufferReuse = true;
+    }
+    if (printIt) {
+        uPortLog("U_GNSS: sending UBX command");
+        uGnssPrivatePrintBuffer(pSend, sendLengthBytes);
+        uPortLog(".\n");
+    }
+    uAtClientLock(atHandle);
+    uAtClientTimeoutSet(atHandle, timeoutMs);
+    // The response is decoded in place in the pooled AT buffer
+    x = uGnssPrivateSendReceiveAt(pInstance, pSend, sendLengthBytes,
+                                  &pBuffer, 0);
+    if (uAtClientUnlock(atHandle) != 0) {
+        x = (int32_t) U_GNSS_ERROR_TRANSPORT;
+    }
+    errorCodeOrLength = x;
+    if (x >= 0) {
+        errorCodeOrLength = (int32_t) U_GNSS_ERROR_TRANSPORT;
+        if ((x > 0) && (pResponse->ppBody != NULL)) {
+            // Deal with the output buffer
+            captureSize = x;
+            if (*(pResponse->ppBody) != NULL) {
+                if (captureSize > pResponse->bodySize) {
+                    captureSize = pResponse->bodySize;
                 }
-                errorCodeOrLength = (int32_t) captureSize;
-                if (captureSize > 0) {
-                    // First check if we received a NACK
-                    if ((uUbxProtocolDecode(pBuffer, x, &clsNack, &idNack,
-                                            ackBody, sizeof(ackBody),
-                                            NULL) == 2) &&
-                        (ackBody[0] == pResponse->cls) &&
-                        (ackBody[1] == pResponse->id)) {
-                        // We got a NACK for the message class
-                        // and ID we are monitoring
-                        errorCodeOrLength = (int32_t) U_GNSS_ERROR_NACK;
-                    } else {
-                        // No NACK, we can decode the message body, noting
-                        // that it is safe to decode back into the same buffer
-                        errorCodeOrLength = uUbxProtocolDecode(pBuffer, x,
-                                                               &(pResponse->cls),
-                                                               &(pResponse->id),
-                                                               *(pResponse->ppBody),
-                                                               captureSize, NULL);
-                        if (errorCodeOrLength > (int32_t) captureSize) {
-                            errorCodeOrLength = (int32_t) captureSize;
-                        }
+            } else {
+                // We can just hand over the pooled buffer,
+                // another will be allocated next time
+                *(pResponse->ppBody) = pBuffer;
+                pInstance->pAtBuffer = NULL;
+                pInstance->atBufferLength = 0;
+            }
+            errorCodeOrLength = (int32_t) captureSize;
+            if (captureSize > 0) {
+                // First check if we received a NACK
+                if ((uUbxProtocolDecode(pBuffer, x, &clsNack, &idNack,
+                                        ackBody, sizeof(ackBody),
+                                        NULL) == 2) &&
+                    (ackBody[0] == pResponse->cls) &&
+                    (ackBody[1] == pResponse->id)) {
+                    // We got a NACK for the message class
+                    // and ID we are monitoring
+                    errorCodeOrLength = (int32_t) U_GNSS_ERROR_NACK;
+                } else {
+                    // No NACK, we can decode the message body, noting
+                    // that it is safe to decode back into the same buffer
+                    errorCodeOrLength = uUbxProtocolDecode(pBuffer, x,
+                                                           &(pResponse->cls),
+                                                           &(pResponse->id),
+                                                           *(pResponse->ppBody),
+                                                           captureSize, NULL);
+                    if (errorCodeOrLength > (int32_t) captureSize) {
+                        errorCodeOrLength = (int32_t) captureSize;
                     }
                 }
-                if (printIt) {
-                    if (errorCodeOrLength >= 0) {
-                        uPortLog("U_GNSS: decoded UBX response 0x%02x 0x%02x",
-                                 pResponse->cls, pResponse->id);
-                        if (errorCodeOrLength > 0) {
-                            uPortLog(":");
-                            uGnssPrivatePrintBuffer(*(pResponse->ppBody), errorCodeOrLength);
-                        }
-                        uPortLog(" [body %d byte(s)].\n", errorCodeOrLength);
-                    } else if (errorCodeOrLength == (int32_t) U_GNSS_ERROR_NACK) {
-                        uPortLog("U_GNSS: got Nack for 0x%02x 0x%02x.\n",
-                                 pResponse->cls, pResponse->id);
+            }
+            if (printIt) {
+                if (errorCodeOrLength >= 0) {
+                    uPortLog("U_GNSS: decoded UBX response 0x%02x 0x%02x",
+                             pResponse->cls, pResponse->id);
+                    if (errorCodeOrLength > 0) {
+                        uPortLog(":");
+                        uGnssPrivatePrintBuffer(*(pResponse->ppBody), errorCodeOrLength);
                     }
+                    uPortLog(" [body %d byte(s)].\n", errorCodeOrLength);
+                } else if (errorCodeOrLength == (int32_t) U_GNSS_ERROR_NACK) {
+                    uPortLog("U_GNSS: got Nack for 0x%02x 0x%02x.\n",
+                             pResponse->cls, pResponse->id);
                 }
             }
         }
+    }
 
-        uAtClientPrintAtSet(atHandle, atPrintOn);
-        uAtClientDebugSet(atHandle, atDebugPrintOn);
-
-        if (!bufferReuse) {
-            free(pBuffer);
+    if (!printIt) {
+        if (atPrintOn) {
+            uAtClientPrintAtSet(atHandle, true);
+        }
+        if (atDebugPrintOn) {
+            uAtClientDebugSet(atHandle, true);
         }
     }
 
@@ -568,9 +842,7 @@ static int32_t sendReceiveUbxMessage(uGnssPrivateInstance_t *pInstance,
                         }
                         break;
                     case U_GNSS_TRANSPORT_AT:
-                        //lint -e{1773} Suppress attempt to cast away const: I'm not!
-                        errorCodeOrResponseLength = sendReceiveUbxMessageAt((const uAtClientHandle_t)
-                                                                            pInstance->transportHandle.pAt,
+                        errorCodeOrResponseLength = sendReceiveUbxMessageAt(pInstance,
                                                                             pBuffer, bytesToSend,
                                                                             pResponse, pInstance->timeoutMs,
                                                                             pInstance->printUbxMessages);
@@ -745,81 +1017,49 @@ static int32_t uGnssPrivateParseNmea(uParseHandle_t parseHandle, void *pUserPara
 static int32_t uGnssPrivateParseRtcm(uParseHandle_t parseHandle, void *pUserParam)
 {
     uGnssPrivateMessageId_t *pMsgId = (uGnssPrivateMessageId_t *) pUserParam;
-    uint8_t by;
-    if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    if (0xD3 != by) {
-        return U_ERROR_COMMON_NOT_FOUND;
-    }
-    if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
-        return U_ERROR_COMMON_TIMEOUT;
+    // Preamble, two bytes of length and the first two bytes
+    // of payload, which contain the message number
+    char header[U_GNSS_PRIVATE_RTCM_HEADER_LENGTH_BYTES + 2];
+    const char *pSpan;
+    size_t spanSize;
+    size_t length;
+    uint32_t crc;
+    for (size_t x = 0; x < sizeof(header); x++) {
+        if (!uRingBufferGetByteUnprotected(parseHandle, &(header[x]))) {
+            return U_ERROR_COMMON_TIMEOUT;
+        }
+        if ((x == 0) && (header[x] != (char) 0xD3)) {
+            return U_ERROR_COMMON_NOT_FOUND;
+        }
+        if ((x == 1) && ((header[x] & 0xFC) != 0)) {
+            // Reserved bits must be zero
+            return U_ERROR_COMMON_NOT_FOUND;
+        }
     }
-    if ((0xFC & by) != 0) {
+    length = (((size_t) header[1] & 0x03) << 8) + (uint8_t) header[2];
+    if (length < 2) {
+        // Not even enough for the message number
         return U_ERROR_COMMON_NOT_FOUND;
     }
-    uint16_t l = (by & 0x3) << 8;
-    if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    l += by + 2;
-    uint8_t idLo, idHi;
-    uint32_t crc = 0;
-    // CRC24Q check
-    const uint32_t _crc24qTable[] = {
-        /* 00 */ 0x000000, 0x864cfb, 0x8ad50d, 0x0c99f6, 0x93e6e1, 0x15aa1a, 0x1933ec, 0x9f7f17,
-        /* 08 */ 0xa18139, 0x27cdc2, 0x2b5434, 0xad18cf, 0x3267d8, 0xb42b23, 0xb8b2d5, 0x3efe2e,
-        /* 10 */ 0xc54e89, 0x430272, 0x4f9b84, 0xc9d77f, 0x56a868, 0xd0e493, 0xdc7d65, 0x5a319e,
-        /* 18 */ 0x64cfb0, 0xe2834b, 0xee1abd, 0x685646, 0xf72951, 0x7165aa, 0x7dfc5c, 0xfbb0a7,
-        /* 20 */ 0x0cd1e9, 0x8a9d12, 0x8604e4, 0x00481f, 0x9f3708, 0x197bf3, 0x15e205, 0x93aefe,
-        /* 28 */ 0xad50d0, 0x2b1c2b, 0x2785dd, 0xa1c926, 0x3eb631, 0xb8faca, 0xb4633c, 0x322fc7,
-        /* 30 */ 0xc99f60, 0x4fd39b, 0x434a6d, 0xc50696, 0x5a7981, 0xdc357a, 0xd0ac8c, 0x56e077,
-        /* 38 */ 0x681e59, 0xee52a2, 0xe2cb54, 0x6487af, 0xfbf8b8, 0x7db443, 0x712db5, 0xf7614e,
-        /* 40 */ 0x19a3d2, 0x9fef29, 0x9376df, 0x153a24, 0x8a4533, 0x0c09c8, 0x00903e, 0x86dcc5,
-        /* 48 */ 0xb822eb, 0x3e6e10, 0x32f7e6, 0xb4bb1d, 0x2bc40a, 0xad88f1, 0xa11107, 0x275dfc,
-        /* 50 */ 0xdced5b, 0x5aa1a0, 0x563856, 0xd074ad, 0x4f0bba, 0xc94741, 0xc5deb7, 0x43924c,
-        /* 58 */ 0x7d6c62, 0xfb2099, 0xf7b96f, 0x71f594, 0xee8a83, 0x68c678, 0x645f8e, 0xe21375,
-        /* 60 */ 0x15723b, 0x933ec0, 0x9fa736, 0x19ebcd, 0x8694da, 0x00d821, 0x0c41d7, 0x8a0d2c,
-        /* 68 */ 0xb4f302, 0x32bff9, 0x3e260f, 0xb86af4, 0x2715e3, 0xa15918, 0xadc0ee, 0x2b8c15,
-        /* 70 */ 0xd03cb2, 0x567049, 0x5ae9bf, 0xdca544, 0x43da53, 0xc596a8, 0xc90f5e, 0x4f43a5,
-        /* 78 */ 0x71bd8b, 0xf7f170, 0xfb6886, 0x7d247d, 0xe25b6a, 0x641791, 0x688e67, 0xeec29c,
-        /* 80 */ 0x3347a4, 0xb50b5f, 0xb992a9, 0x3fde52, 0xa0a145, 0x26edbe, 0x2a7448, 0xac38b3,
-        /* 88 */ 0x92c69d, 0x148a66, 0x181390, 0x9e5f6b, 0x01207c, 0x876c87, 0x8bf571, 0x0db98a,
-        /* 90 */ 0xf6092d, 0x7045d6, 0x7cdc20, 0xfa90db, 0x65efcc, 0xe3a337, 0xef3ac1, 0x69763a,
-        /* 98 */ 0x578814, 0xd1c4ef, 0xdd5d19, 0x5b11e2, 0xc46ef5, 0x42220e, 0x4ebbf8, 0xc8f703,
-        /* a0 */ 0x3f964d, 0xb9dab6, 0xb54340, 0x330fbb, 0xac70ac, 0x2a3c57, 0x26a5a1, 0xa0e95a,
-        /* a8 */ 0x9e1774, 0x185b8f, 0x14c279, 0x928e82, 0x0df195, 0x8bbd6e, 0x872498, 0x016863,
-        /* b0 */ 0xfad8c4, 0x7c943f, 0x700dc9, 0xf64132, 0x693e25, 0xef72de, 0xe3eb28, 0x65a7d3,
-        /* b8 */ 0x5b59fd, 0xdd1506, 0xd18cf0, 0x57c00b, 0xc8bf1c, 0x4ef3e7, 0x426a11, 0xc426ea,
-        /* c0 */ 0x2ae476, 0xaca88d, 0xa0317b, 0x267d80, 0xb90297, 0x3f4e6c, 0x33d79a, 0xb59b61,
-        /* c8 */ 0x8b654f, 0x0d29b4, 0x01b042, 0x87fcb9, 0x1883ae, 0x9ecf55, 0x9256a3, 0x141a58,
-        /* d0 */ 0xefaaff, 0x69e604, 0x657ff2, 0xe33309, 0x7c4c1e, 0xfa00e5, 0xf69913, 0x70d5e8,
-        /* d8 */ 0x4e2bc6, 0xc8673d, 0xc4fecb, 0x42b230, 0xddcd27, 0x5b81dc, 0x57182a, 0xd154d1,
-        /* e0 */ 0x26359f, 0xa07964, 0xace092, 0x2aac69, 0xb5d37e, 0x339f85, 0x3f0673, 0xb94a88,
-        /* e8 */ 0x87b4a6, 0x01f85d, 0x0d61ab, 0x8b2d50, 0x145247, 0x921ebc, 0x9e874a, 0x18cbb1,
-        /* f0 */ 0xe37b16, 0x6537ed, 0x69ae1b, 0xefe2e0, 0x709df7, 0xf6d10c, 0xfa48fa, 0x7c0401,
-        /* f8 */ 0x42fa2f, 0xc4b6d4, 0xc82f22, 0x4e63d9, 0xd11cce, 0x575035, 0x5bc9c3, 0xdd8538
-    };
-#define RTCM_CRC(crc, by) ((crc << 8) | by) ^ _crc24qTable[(crc >> 16) & 0xff]
-    if (!uRingBufferGetByteUnprotected(parseHandle, &idLo)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    crc = RTCM_CRC(crc, idLo);
-    if (!uRingBufferGetByteUnprotected(parseHandle, &idHi)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    crc = RTCM_CRC(crc, idHi);
-    pMsgId->id.rtcm = (idHi >> 4) + (idLo << 4);
-    if (l  > uRingBufferBytesAvailableUnprotected(parseHandle)) {
+    // The rest of the payload plus the CRC
+    length += U_GNSS_PRIVATE_RTCM_CRC_LENGTH_BYTES - 2;
+    if (length > uRingBufferBytesAvailableUnprotected(parseHandle)) {
         return U_ERROR_COMMON_TIMEOUT;
     }
-    while (l--) {
-        uRingBufferGetByteUnprotected(parseHandle, &by);
-        crc = RTCM_CRC(crc, by);
-    }
-    if ((crc & 0xFFFFFF) != 0x000000) {
+    // CRC-24Q covers everything from the preamble onwards; run
+    // it over the CRC bytes also and the result will be zero,
+    // taking the data directly from the ring buffer a contiguous
+    // span at a time
+    crc = uSpartnCrc24(header, sizeof(header));
+    while (length > 0) {
+        spanSize = uRingBufferGetSpanUnprotected(parseHandle, &pSpan, length);
+        crc = uSpartnCrc24Update(crc, pSpan, spanSize);
+        length -= spanSize;
+    }
+    if (crc != 0) {
         return U_ERROR_COMMON_NOT_FOUND;
     }
+    pMsgId->id.rtcm = (((uint8_t) header[4]) >> 4) + (((uint8_t) header[3]) << 4);
     pMsgId->type = U_GNSS_PROTOCOL_RTCM;
     return U_ERROR_COMMON_SUCCESS;
 }
@@ -1053,10 +1293,43 @@ void uGnssPrivateStopMsgReceive(uGnssPrivateInstance_t *pInstance)
     char queueItem[U_GNSS_MSG_RECEIVE_TASK_QUEUE_ITEM_SIZE_BYTES];
     uGnssPrivateMsgReceive_t *pMsgReceive;
     uGnssPrivateMsgReader_t *pNext;
+#if U_GNSS_MSG_RECEIVE_TASK_SHARED
+    uGnssPrivateMsgReceiveShared_t *pShared = &gUGnssPrivateMsgReceiveShared;
+    uGnssPrivateInstance_t **ppThis;
+#endif
 
     if ((pInstance != NULL) && (pInstance->pMsgReceive != NULL)) {
         pMsgReceive = pInstance->pMsgReceive;
 
+#if U_GNSS_MSG_RECEIVE_TASK_SHARED
+        // Take this instance out of the list serviced by the
+        // shared task; once we have the list mutex the task
+        // cannot be in the middle of servicing it
+        U_PORT_MUTEX_LOCK(pShared->instanceListMutexHandle);
+        ppThis = &(pShared->pInstanceList);
+        while (*ppThis != NULL) {
+            if (*ppThis == pInstance) {
+                *ppThis = pMsgReceive->pNextShared;
+            } else {
+                ppThis = &((*ppThis)->pMsgReceive->pNextShared);
+            }
+        }
+        U_PORT_MUTEX_UNLOCK(pShared->instanceListMutexHandle);
+        uRingBufferUnlockReadHandle(&(pInstance->ringBuffer),
+                                    pMsgReceive->ringBufferReadHandle);
+        if (pShared->pInstanceList == NULL) {
+            // Nothing left for the shared task to do, shut it down
+            uPortQueueSend(pShared->taskExitQueueHandle, queueItem);
+            U_PORT_MUTEX_LOCK(pShared->taskRunningMutexHandle);
+            U_PORT_MUTEX_UNLOCK(pShared->taskRunningMutexHandle);
+            uPortTaskBlock(U_CFG_OS_YIELD_MS);
+            uPortTaskDelete(pShared->taskHandle);
+            uPortMutexDelete(pShared->taskRunningMutexHandle);
+            uPortQueueDelete(pShared->taskExitQueueHandle);
+            uPortMutexDelete(pShared->instanceListMutexHandle);
+            memset(pShared, 0, sizeof(*pShared));
+        }
+#else
         // Sending the task anything will cause it to exit
         uPortQueueSend(pMsgReceive->taskExitQueueHandle, queueItem);
         U_PORT_MUTEX_LOCK(pMsgReceive->taskRunningMutexHandle);
@@ -1064,9 +1337,11 @@ void uGnssPrivateStopMsgReceive(uGnssPrivateInstance_t *pInstance)
         // Wait for the task to actually exit: the STM32F4 platform
         // needs this additional delay for some reason or it stalls here
         uPortTaskBlock(U_CFG_OS_YIELD_MS);
+#endif
 
         // Free all the readers; no need to lock the reader mutex since
-        // we've shut the task down
+        // we've shut the task down, or at least taken this instance
+        // out of its hands
         while (pMsgReceive->pReaderList != NULL) {
             pNext = pMsgReceive->pReaderList->pNext;
             free(pMsgReceive->pReaderList);
@@ -1074,9 +1349,11 @@ void uGnssPrivateStopMsgReceive(uGnssPrivateInstance_t *pInstance)
         }
 
         // Free all OS resources
+#if !U_GNSS_MSG_RECEIVE_TASK_SHARED
         uPortTaskDelete(pMsgReceive->taskHandle);
         uPortMutexDelete(pMsgReceive->taskRunningMutexHandle);
         uPortQueueDelete(pMsgReceive->taskExitQueueHandle);
+#endif
         uPortMutexDelete(pMsgReceive->readerMutexHandle);
 
         // Pause here to allow the deletions
@@ -1084,9 +1361,6 @@ void uGnssPrivateStopMsgReceive(uGnssPrivateInstance_t *pInstance)
         // required by some RTOSs (e.g. FreeRTOS)
         uPortTaskBlock(U_CFG_OS_YIELD_MS);
 
-        // Free the temporary buffer
-        free(pMsgReceive->pTemporaryBuffer);
-
         // Give the ring buffer handle back
         uRingBufferGiveReadHandle(&(pInstance->ringBuffer),
                                   pMsgReceive->ringBufferReadHandle);
@@ -1249,7 +1523,8 @@ int32_t uGnssPrivateStreamGetReceiveSize(int32_t streamHandle,
                 errorCodeOrReceiveSize = uPortI2cControllerSendReceive(streamHandle, i2cAddress,
                                                                        NULL, 0, buffer, sizeof(buffer));
                 if (errorCodeOrReceiveSize == sizeof(buffer)) {
-                    errorCodeOrReceiveSize = (int32_t) ((((uint32_t) buffer[0]) << 8) + (uint32_t) buffer[1]);
+                    errorCodeOrReceiveSize = (int32_t) ((((uint32_t) (uint8_t) buffer[0]) << 8) +
+                                                        (uint32_t) (uint8_t) buffer[1]);
                 }
             }
             break;
@@ -1344,18 +1619,8 @@ int32_t uGnssPrivateStreamFillRingBuffer(uGnssPrivateInstance_t *pInstance,
     int32_t receiveSize;
     int32_t totalReceiveSize = 0;
     int32_t ringBufferAvailableSize;
-    char *pTemporaryBuffer;
 
     if (pInstance != NULL) {
-        pTemporaryBuffer = pInstance->pTemporaryBuffer;
-        if ((pInstance->pMsgReceive != NULL) &&
-            uPortTaskIsThis(pInstance->pMsgReceive->taskHandle)) {
-            // If we're being called from the message receive task,
-            // which does not lock gUGnssPrivateMutex, we use its
-            // temporary buffer in order to avoid clashes with
-            // the main application task
-            pTemporaryBuffer = pInstance->pMsgReceive->pTemporaryBuffer;
-        }
         errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
         streamType = uGnssPrivateGetStreamType(pInstance->transportType);
         switch (streamType) {
@@ -1374,53 +1639,35 @@ int32_t uGnssPrivateStreamFillRingBuffer(uGnssPrivateInstance_t *pInstance,
             // This is constructed as a do()/while() so that
             // it always has one go even with a zero timeout
             do {
-                receiveSize = uGnssPrivateStreamGetReceiveSize(streamHandle,
-                                                               (uGnssPrivateStreamType_t) streamType,
-                                                               pInstance->i2cAddress);
-                // Don't try to read in more than uRingBufferForceAdd()
-                // can put into the ring buffer
+                // Don't try to read in more than a forced add can
+                // put into the ring buffer; the data is read directly
+                // into the ring buffer, no intermediate copy
                 ringBufferAvailableSize = uRingBufferAvailableSizeMax(&(pInstance->ringBuffer));
-                if (receiveSize > ringBufferAvailableSize) {
-                    receiveSize = ringBufferAvailableSize;
-                }
-                if (receiveSize > 0) {
-                    // Read into a temporary buffer
-                    if (receiveSize > U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES) {
-                        receiveSize = U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES;
-                    }
+                receiveSize = 0;
+                if ((ringBufferAvailableSize > 0) && (pInstance->pReplay != NULL)) {
+                    // A capture is being replayed in place of the GNSS chip
+                    receiveSize = fillRingBufferReplay(pInstance, ringBufferAvailableSize);
+                } else if (ringBufferAvailableSize > 0) {
+                    // It is up to this MCU to keep up, we don't want to block
+                    // data from the GNSS chip, after all it has no UART flow
+                    // control lines that we can stop it with
                     switch (streamType) {
                         case U_GNSS_PRIVATE_STREAM_TYPE_UART:
-                            // For UART we ask for as much data as we can, it will just
-                            // bring in more if more has arrived between the "receive
-                            // size" call above and now
-                            receiveSize = uPortUartRead(streamHandle, pTemporaryBuffer,
-                                                        U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES);
+                            receiveSize = fillRingBufferUart(pInstance, streamHandle,
+                                                             ringBufferAvailableSize);
                             break;
                         case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
-                            // For I2C we need to ask for the amount we know is there since
-                            // the I2C buffer is effectively on the GNSS chip and I2C drivers
-                            // often don't say how much they've read, just giving us back
-                            // the number we asked for on a successful read
-                            receiveSize = uPortI2cControllerSendReceive(streamHandle,
-                                                                        pInstance->i2cAddress,
-                                                                        NULL, 0,
-                                                                        pTemporaryBuffer,
-                                                                        receiveSize);
+                            receiveSize = fillRingBufferI2c(pInstance, streamHandle,
+                                                            ringBufferAvailableSize);
                             break;
                         default:
                             break;
                     }
-                    if (receiveSize >= 0) {
+                }
+                if (receiveSize != 0) {
+                    if (receiveSize > 0) {
                         totalReceiveSize += receiveSize;
                         errorCodeOrLength = totalReceiveSize;
-                        // Now stuff this into the ring buffer; we use a forced
-                        // add: it is up to this MCU to keep up, we don't want
-                        // to block data from the GNSS chip, after all it has
-                        // no UART flow control lines that we can stop it with
-                        if (!uRingBufferForceAdd(&(pInstance->ringBuffer),
-                                                 pTemporaryBuffer, receiveSize)) {
-                            errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-                        }
                     } else {
                         // Error case
                         errorCodeOrLength = receiveSize;
@@ -1674,6 +1921,85 @@ int32_t uGnssPrivateReceiveStreamMessage(uGnssPrivateInstance_t *pInstance,
     return errorCodeOrLength;
 }
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS THAT ARE PRIVATE TO GNSS: AT TRANSPORT ONLY
+ * -------------------------------------------------------------- */
+
+// Perform one AT+UGUBX exchange; the AT client must be locked.
+int32_t uGnssPrivateSendReceiveAt(uGnssPrivateInstance_t *pInstance,
+                                  const char *pSend,
+                                  size_t sendLengthBytes,
+                                  char **ppResponse,
+                                  size_t maxResponseLengthBytes)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    uAtClientHandle_t atHandle = (uAtClientHandle_t) pInstance->transportHandle.pAt;
+    size_t bufferLengthBytes = U_GNSS_AT_BUFFER_LENGTH_BYTES + 1; // +1 for terminator
+    char *pBuffer = NULL;
+    size_t readLengthBytes = 0; // Zero means read everything
+    int32_t bytesRead;
+    size_t x;
+
+    if ((ppResponse != NULL) && (*ppResponse != NULL) &&
+        (bufferLengthBytes < (maxResponseLengthBytes * 2) + 1)) {
+        bufferLengthBytes = (maxResponseLengthBytes * 2) + 1;
+    }
+    if (ppResponse != NULL) {
+        // Need a buffer to receive the hex-encoded response into,
+        // which is kept with the instance for next time; if it
+        // was enlarged for a long response, go back to the normal
+        // size once a response of normal size will do, so that one
+        // large exchange doesn't tie up the memory for good
+        if ((pInstance->pAtBuffer != NULL) &&
+            ((pInstance->atBufferLength < bufferLengthBytes) ||
+             ((pInstance->atBufferLength > bufferLengthBytes) &&
+              (pInstance->atBufferLength > U_GNSS_AT_BUFFER_LENGTH_BYTES + 1)))) {
+            free(pInstance->pAtBuffer);
+            pInstance->pAtBuffer = NULL;
+            pInstance->atBufferLength = 0;
+        }
+        if (pInstance->pAtBuffer == NULL) {
+            pInstance->pAtBuffer = (char *) malloc(bufferLengthBytes);
+            if (pInstance->pAtBuffer != NULL) {
+                pInstance->atBufferLength = bufferLengthBytes;
+            }
+        }
+        pBuffer = pInstance->pAtBuffer;
+        readLengthBytes = pInstance->atBufferLength;
+    }
+    if ((ppResponse == NULL) || (pBuffer != NULL)) {
+        errorCodeOrLength = (int32_t) U_GNSS_ERROR_TRANSPORT;
+        // Send the command, hex-encoding it as we go
+        uAtClientCommandStart(atHandle, "AT+UGUBX=");
+        writeHexAt(atHandle, pSend, sendLengthBytes);
+        uAtClientCommandStop(atHandle);
+        // Read the hex-coded response back into pBuffer,
+        // which may be NULL to throw the response away
+        uAtClientResponseStart(atHandle, "+UGUBX:");
+        bytesRead = uAtClientReadString(atHandle, pBuffer,
+                                        readLengthBytes, false);
+        uAtClientResponseStop(atHandle);
+        if ((uAtClientErrorGet(atHandle) == 0) && (bytesRead >= 0)) {
+            errorCodeOrLength = 0;
+            if (pBuffer != NULL) {
+                // Decode the hex into the same buffer
+                x = uHexToBin(pBuffer, bytesRead, pBuffer);
+                if (*ppResponse == NULL) {
+                    *ppResponse = pBuffer;
+                } else {
+                    if (x > maxResponseLengthBytes) {
+                        x = maxResponseLengthBytes;
+                    }
+                    memcpy(*ppResponse, pBuffer, x);
+                }
+                errorCodeOrLength = (int32_t) x;
+            }
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS THAT ARE PRIVATE TO GNSS: ANY TRANSPORT
  * -------------------------------------------------------------- */
@@ -164,20 +164,92 @@ typedef struct uGnssPrivateMsgReader_t {
 } uGnssPrivateMsgReader_t;
 
 /** Structure to hold the data associated with the task running
- * the non-blocking message receive utility functions.
+ * the non-blocking message receive utility functions.  If
+ * #U_GNSS_MSG_RECEIVE_TASK_SHARED is 1 the task, and hence
+ * taskHandle, is shared between all GNSS instances, in which
+ * case taskRunningMutexHandle and taskExitQueueHandle are unused.
  */
 typedef struct {
     int32_t nextHandle;
     uPortTaskHandle_t taskHandle;
-    char *pTemporaryBuffer;
     uPortMutexHandle_t taskRunningMutexHandle;
     uPortQueueHandle_t taskExitQueueHandle;
     uPortMutexHandle_t readerMutexHandle;
     int32_t ringBufferReadHandle;
     size_t msgBytesLeftToRead;
+    size_t discardSize; /**< data still to be thrown away. */
+    int32_t pollIntervalMs; /**< time to the next poll, adapted to the data rate. */
+    int32_t nextPollTimeMs; /**< only used by the shared task. */
     uGnssPrivateMsgReader_t *pReaderList;
+    struct uGnssPrivateInstance_t *pNextShared; /**< the next instance serviced
+                                                     by the shared task. */
 } uGnssPrivateMsgReceive_t;
 
+/** Structure to hold the data associated with the single task
+ * that runs the non-blocking message receive for all GNSS
+ * instances when #U_GNSS_MSG_RECEIVE_TASK_SHARED is 1.
+ */
+typedef struct {
+    uPortTaskHandle_t taskHandle;
+    uPortMutexHandle_t taskRunningMutexHandle;
+    uPortQueueHandle_t taskExitQueueHandle;
+    uPortMutexHandle_t instanceListMutexHandle; /**< held by the task while
+                                                     it services the instances. */
+    struct uGnssPrivateInstance_t *pInstanceList;
+} uGnssPrivateMsgReceiveShared_t;
+
+/** Structure to hold the state of a capture of the raw byte stream
+ * from the GNSS chip, see uGnssMsgCaptureStart().
+ */
+typedef struct {
+    char *pBuffer; /**< RAM to capture into, may be NULL. */
+    size_t size; /**< the size of pBuffer. */
+    size_t length; /**< how much of pBuffer has been used. */
+    size_t lossBytes; /**< data bytes that did not fit into pBuffer. */
+    int32_t startTimeMs; /**< the time at which the capture began. */
+    void *pCallback; /**< stored as a void * to avoid having to bring
+                          uGnssMsgCaptureCallback_t into everything. */
+    void *pCallbackParam;
+} uGnssPrivateCapture_t;
+
+/** Structure to hold the state of a replay of a capture made with
+ * uGnssMsgCaptureStart(), see uGnssMsgReplayStart().
+ */
+typedef struct {
+    const char *pCapture; /**< the capture being replayed. */
+    size_t size; /**< the size of the capture. */
+    size_t offset; /**< offset of the header of the next record to replay. */
+    size_t recordOffset; /**< how much of that record's data has been replayed. */
+    bool maxSpeed; /**< true to ignore the timestamps in the capture. */
+    int32_t startTimeMs; /**< the time at which the replay began. */
+} uGnssPrivateReplay_t;
+
+/** Structure to hold the state of one message in the automatic
+ * output-rate tuning table, see uGnssMsgReceiveSetAutoOutput().
+ */
+typedef struct {
+    uint8_t wanted; /**< the number of readers that want the message. */
+    uint8_t rate; /**< the output rate last set, 0xFF if not known. */
+    bool holdOff; /**< true if the message was last wanted by uGnssMsgReceive(),
+                       in which case it is not switched off until
+                       #U_GNSS_MSG_OUT_HOLD_OFF_TIME_MS after holdOffStartMs. */
+    int32_t holdOffStartMs; /**< when uGnssMsgReceive() stopped wanting the message. */
+} uGnssPrivateMsgOut_t;
+
+/** Structure to hold the state of automatic ring buffer sizing,
+ * see uGnssMsgReceiveSetRingBufferAutoSize().
+ */
+typedef struct {
+    size_t minSizeBytes; /**< the smallest the ring buffer may become. */
+    size_t maxSizeBytes; /**< the largest the ring buffer may become. */
+    int32_t readHandle; /**< the read handle of the message receive task
+                             that the windows apply to, -1 if none yet. */
+    int32_t windowStartTimeMs; /**< when the current assessment window began. */
+    size_t lossBytes; /**< the loss count at the start of the window. */
+    size_t quietWindowCount; /**< the number of consecutive windows in
+                                  which the ring buffer was little used. */
+} uGnssPrivateRingBufferSize_t;
+
 /** Definition of a GNSS instance.
  * Note: a pointer to this structure is passed to the asynchronous
  * "get position" function (posGetTask()) which does NOT lock the
@@ -194,7 +266,6 @@ typedef struct uGnssPrivateInstance_t {
     uGnssTransportHandle_t transportHandle; /**< the handle of the transport to use. */
     uRingBuffer_t ringBuffer; /**< the ring buffer where we put messages from the GNSS chip. */
     char *pLinearBuffer; /**< the linear buffer that will be used by ringBuffer. */
-    char *pTemporaryBuffer; /**< a temporary buffer, used to get stuff into ringBuffer. */
     int32_t ringBufferReadHandlePrivate; /**< the read handle for this code to use, -1 if there isn't one. */
     int32_t ringBufferReadHandleMsgReceive; /**< the read handle for uGnssUtilTransparentReceive(). */
     uint16_t i2cAddress; /**< the I2C address of the GNSS chip, only relevant if the transport is I2C. */
@@ -207,6 +278,11 @@ typedef struct uGnssPrivateInstance_t {
     uGnssPort_t portNumber; /**< the internal port number of the GNSS device that we are connected on. */
     uPortMutexHandle_t transportMutex; /**< mutex so that we can have an asynchronous
                                             task use the transport. */
+    char *pAtBuffer; /**< buffer for hex-encoded responses over the AT transport,
+                          kept between exchanges; protected by transportMutex;
+                          no larger than U_GNSS_AT_BUFFER_LENGTH_BYTES + 1 except
+                          while responses longer than that are being received. */
+    size_t atBufferLength; /**< the amount of storage at pAtBuffer. */
     uPortTaskHandle_t posTask; /**< handle for a task associated with
                                     non-blocking position establishment. */
     uPortMutexHandle_t posMutex; /**< handle for mutex associated with
@@ -214,6 +290,20 @@ typedef struct uGnssPrivateInstance_t {
     volatile uint8_t posTaskFlags; /**< flags to synchronisation the pos task. */
     uGnssPrivateMsgReceive_t *pMsgReceive; /**< stuff associated with the asychronous
                                                 message receive utility functions. */
+    uPortMutexHandle_t captureMutex; /**< protects pCapture and pReplay, which are
+                                          used by whichever task is filling the
+                                          ring buffer; created on first use. */
+    uGnssPrivateCapture_t *pCapture; /**< set while the stream is being captured. */
+    uGnssPrivateReplay_t *pReplay; /**< set while a capture is being replayed
+                                        in place of the stream. */
+    uGnssPrivateMsgOut_t *pMsgOut; /**< set while automatic output-rate tuning
+                                        is on, an array with an entry for each
+                                        message the tuning knows of. */
+    uPortMutexHandle_t ringBufferSizeMutex; /**< protects pRingBufferSize, which is
+                                                 used by the message receive task;
+                                                 created on first use. */
+    uGnssPrivateRingBufferSize_t *pRingBufferSize; /**< set while automatic ring
+                                                        buffer sizing is on. */
     struct uGnssPrivateInstance_t *pNext;
 } uGnssPrivateInstance_t;
 // *INDENT-ON*
@@ -239,6 +329,11 @@ extern uGnssPrivateInstance_t *gpUGnssPrivateInstanceList;
  */
 extern uPortMutexHandle_t gUGnssPrivateMutex;
 
+/** The task that runs the non-blocking message receive for all
+ * GNSS instances, only used if #U_GNSS_MSG_RECEIVE_TASK_SHARED is 1.
+ */
+extern uGnssPrivateMsgReceiveShared_t gUGnssPrivateMsgReceiveShared;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: MISC
  * -------------------------------------------------------------- */
@@ -647,6 +742,49 @@ int32_t uGnssPrivateReceiveStreamMessage(uGnssPrivateInstance_t *pInstance,
                                          int32_t timeoutMs,
                                          bool (*pKeepGoingCallback)(uDeviceHandle_t gnssHandle));
 
+/* ----------------------------------------------------------------
+ * FUNCTIONS: AT TRANSPORT ONLY
+ * -------------------------------------------------------------- */
+
+/** Perform a single AT+UGUBX exchange with a GNSS chip that is inside
+ * or connected via an intermediate (e.g. cellular) module: the message
+ * is hex-encoded as it is written to the AT interface and the
+ * hex-encoded response is decoded in place in a buffer that is kept
+ * with the instance (pAtBuffer), grown as necessary and shrunk back
+ * to U_GNSS_AT_BUFFER_LENGTH_BYTES + 1 when no longer needed.  No UBX decoding
+ * of the response is performed.  Several exchanges may be made while
+ * the AT client remains locked; if one fails the caller may call
+ * uAtClientClearError() before moving on to the next.
+ *
+ * Note: transportMutex must be locked and the AT client must be locked
+ * (with uAtClientLock()) before this is called.
+ *
+ * @param[in] pInstance          a pointer to the GNSS instance, cannot
+ *                               be NULL, transport must be
+ *                               #U_GNSS_TRANSPORT_AT.
+ * @param[in] pSend              the message to send; may be NULL.
+ * @param sendLengthBytes        the amount of data at pSend; must be
+ *                               non-zero if pSend is non-NULL.
+ * @param[in,out] ppResponse     if NULL the response is discarded;
+ *                               if it points to NULL the response is
+ *                               decoded in place and *ppResponse is
+ *                               set to point at pAtBuffer, which
+ *                               the caller may take ownership of by
+ *                               setting pAtBuffer to NULL; otherwise
+ *                               the response is copied to *ppResponse.
+ * @param maxResponseLengthBytes the amount of storage at *ppResponse,
+ *                               ignored if ppResponse or *ppResponse
+ *                               is NULL.
+ * @return                       the number of bytes of response
+ *                               (zero if ppResponse is NULL), else
+ *                               negative error code.
+ */
+int32_t uGnssPrivateSendReceiveAt(uGnssPrivateInstance_t *pInstance,
+                                  const char *pSend,
+                                  size_t sendLengthBytes,
+                                  char **ppResponse,
+                                  size_t maxResponseLengthBytes);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: ANY TRANSPORT
  * -------------------------------------------------------------- */
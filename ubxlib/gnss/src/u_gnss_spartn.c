@@ -0,0 +1,279 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the GNSS SPARTN forwarder, which writes
+ * validated SPARTN messages to a GNSS chip, gathering them into
+ * as few writes as the latency budget allows.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stdlib.h"    // malloc()/free()
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcpy(), memset(), strlen(), strncmp()
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+
+#include "u_device.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss_msg.h"
+
+#include "u_mqtt_common.h"
+#include "u_mqtt_client.h"
+
+#include "u_spartn.h"
+#include "u_gnss_spartn.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#if U_GNSS_SPARTN_FORWARD_BUFFER_LENGTH_BYTES < U_SPARTN_MESSAGE_LENGTH_MAX_BYTES
+# error U_GNSS_SPARTN_FORWARD_BUFFER_LENGTH_BYTES must be >= U_SPARTN_MESSAGE_LENGTH_MAX_BYTES.
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Write the contents of the buffer to the GNSS chip, updating the
+// statistics, and empty it; returns the number of bytes written or
+// negative error code.
+static int32_t bufferWrite(uGnssSpartnForward_t *pForward)
+{
+    int32_t sizeOrErrorCode = 0;
+    int32_t latencyMs;
+
+    if (pForward->bufferLength > 0) {
+        sizeOrErrorCode = pForward->pWrite(pForward->gnssHandle, pForward->buffer,
+                                           pForward->bufferLength);
+        pForward->statistics.writeCount++;
+        if (sizeOrErrorCode == (int32_t) pForward->bufferLength) {
+            // The oldest message has waited the longest; the others
+            // arrived, in total, bufferArrivalOffsetMs after it
+            latencyMs = uPortGetTickTimeMs() - pForward->bufferStartTimeMs;
+            if (latencyMs > pForward->statistics.latencyMaxMs) {
+                pForward->statistics.latencyMaxMs = latencyMs;
+            }
+            pForward->statistics.latencyTotalMs += ((int64_t) latencyMs) *
+                                                   pForward->bufferMessageCount -
+                                                   pForward->bufferArrivalOffsetMs;
+            pForward->statistics.messageCount += pForward->bufferMessageCount;
+            pForward->statistics.bytesWritten += sizeOrErrorCode;
+        } else {
+            pForward->statistics.writeErrorCount++;
+            if (sizeOrErrorCode >= 0) {
+                // A short write
+                sizeOrErrorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+            }
+        }
+        pForward->bufferLength = 0;
+        pForward->bufferMessageCount = 0;
+        pForward->bufferArrivalOffsetMs = 0;
+    }
+
+    return sizeOrErrorCode;
+}
+
+// Callback for the framer: add a valid message to the buffer,
+// writing the buffer first if there is no room for it.
+static void framerCallback(const uSpartnMessage_t *pMessage,
+                           void *pCallbackParam)
+{
+    uGnssSpartnForward_t *pForward = (uGnssSpartnForward_t *) pCallbackParam;
+    int32_t errorCode;
+
+    if (pMessage->size > sizeof(pForward->buffer) - pForward->bufferLength) {
+        errorCode = bufferWrite(pForward);
+        if (errorCode < 0) {
+            pForward->lastErrorCode = errorCode;
+        }
+    }
+    if (pForward->bufferLength == 0) {
+        pForward->bufferStartTimeMs = pForward->arrivalTimeMs;
+    }
+    memcpy(pForward->buffer + pForward->bufferLength, pMessage->pMessage,
+           pMessage->size);
+    pForward->bufferLength += pMessage->size;
+    pForward->bufferMessageCount++;
+    pForward->bufferArrivalOffsetMs += pForward->arrivalTimeMs - pForward->bufferStartTimeMs;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Initialise a SPARTN forwarder.
+int32_t uGnssSpartnForwardInit(uGnssSpartnForward_t *pForward,
+                               uDeviceHandle_t gnssHandle,
+                               int32_t latencyBudgetMs,
+                               uGnssSpartnForwardWrite_t pWrite)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pForward != NULL) && (latencyBudgetMs >= 0)) {
+        uSpartnFramerInit(&(pForward->framer));
+        pForward->gnssHandle = gnssHandle;
+        pForward->pWrite = pWrite;
+        if (pWrite == NULL) {
+            pForward->pWrite = uGnssMsgSend;
+        }
+        pForward->latencyBudgetMs = latencyBudgetMs;
+        pForward->bufferLength = 0;
+        pForward->bufferMessageCount = 0;
+        pForward->bufferStartTimeMs = 0;
+        pForward->bufferArrivalOffsetMs = 0;
+        pForward->arrivalTimeMs = 0;
+        pForward->lastErrorCode = 0;
+        memset(&(pForward->statistics), 0, sizeof(pForward->statistics));
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Add SPARTN data to a forwarder.
+int32_t uGnssSpartnForwardAddData(uGnssSpartnForward_t *pForward,
+                                  const char *pData, size_t size)
+{
+    int32_t countOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int32_t errorCode;
+
+    if ((pForward != NULL) && ((pData != NULL) || (size == 0))) {
+        pForward->arrivalTimeMs = uPortGetTickTimeMs();
+        pForward->lastErrorCode = 0;
+        countOrErrorCode = uSpartnFramerAddData(&(pForward->framer), pData, size,
+                                                framerCallback, pForward);
+        if (pForward->latencyBudgetMs == 0) {
+            errorCode = bufferWrite(pForward);
+        } else {
+            errorCode = uGnssSpartnForwardPoll(pForward);
+        }
+        if (pForward->lastErrorCode < 0) {
+            errorCode = pForward->lastErrorCode;
+        }
+        if ((countOrErrorCode >= 0) && (errorCode < 0)) {
+            countOrErrorCode = errorCode;
+        }
+    }
+
+    return countOrErrorCode;
+}
+
+// Write the buffer of a forwarder if the latency budget is used up.
+int32_t uGnssSpartnForwardPoll(uGnssSpartnForward_t *pForward)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pForward != NULL) {
+        sizeOrErrorCode = 0;
+        if ((pForward->bufferLength > 0) &&
+            (uPortGetTickTimeMs() - pForward->bufferStartTimeMs >= pForward->latencyBudgetMs)) {
+            sizeOrErrorCode = bufferWrite(pForward);
+        }
+    }
+
+    return sizeOrErrorCode;
+}
+
+// Write the buffer of a forwarder now.
+int32_t uGnssSpartnForwardFlush(uGnssSpartnForward_t *pForward)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pForward != NULL) {
+        sizeOrErrorCode = bufferWrite(pForward);
+    }
+
+    return sizeOrErrorCode;
+}
+
+// Read SPARTN corrections from MQTT and forward them.
+int32_t uGnssSpartnForwardMqttRead(uGnssSpartnForward_t *pForward,
+                                   uMqttClientContext_t *pMqttClientContext,
+                                   const char *pTopicPrefixStr)
+{
+    int32_t countOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int32_t errorCode;
+    char *pTopicNameStr;
+    char *pMessage;
+    size_t messageSize;
+
+    if ((pForward != NULL) && (pMqttClientContext != NULL)) {
+        countOrErrorCode = 0;
+        if (uMqttClientGetUnread(pMqttClientContext) > 0) {
+            // One allocation for both the topic name and the message
+            countOrErrorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pTopicNameStr = (char *) malloc(U_GNSS_SPARTN_FORWARD_MQTT_TOPIC_LENGTH_BYTES +
+                                            U_GNSS_SPARTN_FORWARD_MQTT_MESSAGE_LENGTH_BYTES);
+            if (pTopicNameStr != NULL) {
+                countOrErrorCode = 0;
+                pMessage = pTopicNameStr + U_GNSS_SPARTN_FORWARD_MQTT_TOPIC_LENGTH_BYTES;
+                while ((countOrErrorCode >= 0) &&
+                       (uMqttClientGetUnread(pMqttClientContext) > 0)) {
+                    messageSize = U_GNSS_SPARTN_FORWARD_MQTT_MESSAGE_LENGTH_BYTES;
+                    errorCode = uMqttClientMessageRead(pMqttClientContext, pTopicNameStr,
+                                                       U_GNSS_SPARTN_FORWARD_MQTT_TOPIC_LENGTH_BYTES,
+                                                       pMessage, &messageSize, NULL);
+                    if ((errorCode == 0) &&
+                        ((pTopicPrefixStr == NULL) ||
+                         (strncmp(pTopicNameStr, pTopicPrefixStr, strlen(pTopicPrefixStr)) == 0))) {
+                        errorCode = uGnssSpartnForwardAddData(pForward, pMessage, messageSize);
+                    }
+                    if (errorCode < 0) {
+                        countOrErrorCode = errorCode;
+                    } else {
+                        countOrErrorCode += errorCode;
+                    }
+                }
+                free(pTopicNameStr);
+            }
+        }
+        if (countOrErrorCode >= 0) {
+            errorCode = uGnssSpartnForwardPoll(pForward);
+            if (errorCode < 0) {
+                countOrErrorCode = errorCode;
+            }
+        }
+    }
+
+    return countOrErrorCode;
+}
+
+// End of file
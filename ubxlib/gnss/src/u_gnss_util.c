@@ -49,8 +49,6 @@
 
 #include "u_ubx_protocol.h"
 
-#include "u_hex_bin_convert.h"
-
 #include "u_gnss_module_type.h"
 #include "u_gnss_type.h"
 #include "u_gnss.h"
@@ -80,6 +78,166 @@
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Check the parameters of a transparent send/receive.
+static bool transparentParamsValid(const char *pCommand,
+                                   size_t commandLengthBytes,
+                                   const char *pResponse,
+                                   size_t maxResponseLengthBytes)
+{
+    return (((pCommand == NULL) && (commandLengthBytes == 0)) ||
+            (commandLengthBytes > 0)) &&
+           (((pResponse == NULL) && (maxResponseLengthBytes == 0)) ||
+            (maxResponseLengthBytes > 0));
+}
+
+// Perform one transparent send/receive over a streaming transport;
+// transportMutex must be locked.
+static int32_t transparentSendReceiveStream(uGnssPrivateInstance_t *pInstance,
+                                            int32_t streamHandle,
+                                            int32_t streamType,
+                                            const char *pCommand,
+                                            size_t commandLengthBytes,
+                                            char *pResponse,
+                                            size_t maxResponseLengthBytes)
+{
+    int32_t errorCodeOrResponseLength = (int32_t) U_GNSS_ERROR_TRANSPORT;
+    int32_t startTimeMs;
+    int32_t x = 0;
+    int32_t bytesRead = 0;
+
+    switch (streamType) {
+        case U_GNSS_PRIVATE_STREAM_TYPE_UART:
+            errorCodeOrResponseLength = uPortUartWrite(streamHandle,
+                                                       pCommand,
+                                                       commandLengthBytes);
+            break;
+        case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
+            errorCodeOrResponseLength = uPortI2cControllerSend(streamHandle, pInstance->i2cAddress,
+                                                               pCommand, commandLengthBytes, false);
+            if (errorCodeOrResponseLength == 0) {
+                errorCodeOrResponseLength = commandLengthBytes;
+            }
+            break;
+        default:
+            break;
+    }
+    if (errorCodeOrResponseLength == commandLengthBytes) {
+        if (pInstance->printUbxMessages) {
+            uPortLog("U_GNSS: sent command");
+            uGnssPrivatePrintBuffer(pCommand, commandLengthBytes);
+            uPortLog(".\n");
+        }
+        errorCodeOrResponseLength = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (pResponse != NULL) {
+            errorCodeOrResponseLength = (int32_t) U_GNSS_ERROR_TRANSPORT;
+            startTimeMs = uPortGetTickTimeMs();
+            // Wait for something to start coming back
+            while ((bytesRead < (int32_t) maxResponseLengthBytes) &&
+                   ((x = uGnssPrivateStreamGetReceiveSize(streamHandle, streamType,
+                                                          pInstance->i2cAddress)) <= 0) &&
+                   (uPortGetTickTimeMs() - startTimeMs < pInstance->timeoutMs)) {
+                // Relax a little
+                uPortTaskBlock(U_GNSS_UTIL_TRANSPARENT_RECEIVE_DELAY_MS);
+            }
+            if (x > 0) {
+                // Got something; continue receiving until nothing arrives for
+                // U_GNSS_UTIL_TRANSPARENT_RECEIVE_DELAY_MS
+                while ((bytesRead < (int32_t) maxResponseLengthBytes) &&
+                       ((x = uGnssPrivateStreamGetReceiveSize(streamHandle, streamType,
+                                                              pInstance->i2cAddress)) > 0) &&
+                       (uPortGetTickTimeMs() - startTimeMs < pInstance->timeoutMs)) {
+                    if (x > 0) {
+                        if (x > ((int32_t) maxResponseLengthBytes) - bytesRead) {
+                            x = maxResponseLengthBytes - bytesRead;
+                        }
+                        // Read the response into pResponse
+                        switch (streamType) {
+                            case U_GNSS_PRIVATE_STREAM_TYPE_UART:
+                                x = uPortUartRead(streamHandle, pResponse + bytesRead, x);
+                                break;
+                            case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
+                                x = uPortI2cControllerSendReceive(streamHandle, pInstance->i2cAddress,
+                                                                  NULL, 0, pResponse + bytesRead, x);
+                                break;
+                            default:
+                                break;
+                        }
+                        if (x > 0) {
+                            bytesRead += x;
+                        }
+                    } else {
+                        // Relax a little
+                        uPortTaskBlock(U_GNSS_UTIL_TRANSPARENT_RECEIVE_DELAY_MS);
+                    }
+                }
+                if (bytesRead > 0) {
+                    errorCodeOrResponseLength = bytesRead;
+                }
+            }
+            if (pInstance->printUbxMessages &&
+                (errorCodeOrResponseLength >= 0)) {
+                uPortLog("U_GNSS: received response");
+                uGnssPrivatePrintBuffer(pResponse, errorCodeOrResponseLength);
+                uPortLog(".\n");
+            }
+        }
+    }
+
+    return errorCodeOrResponseLength;
+}
+
+// Perform one transparent send/receive over the AT transport;
+// transportMutex and the AT client must be locked.
+static int32_t transparentSendReceiveAt(uGnssPrivateInstance_t *pInstance,
+                                        const char *pCommand,
+                                        size_t commandLengthBytes,
+                                        char *pResponse,
+                                        size_t maxResponseLengthBytes)
+{
+    int32_t errorCodeOrResponseLength;
+    char **ppResponse = NULL;
+
+    if (pResponse != NULL) {
+        ppResponse = &pResponse;
+    }
+    // The response, which may be thrown away, is decoded
+    // straight into pResponse
+    errorCodeOrResponseLength = uGnssPrivateSendReceiveAt(pInstance,
+                                                          pCommand,
+                                                          commandLengthBytes,
+                                                          ppResponse,
+                                                          maxResponseLengthBytes);
+    if ((pResponse != NULL) && (errorCodeOrResponseLength >= 0) &&
+        pInstance->printUbxMessages) {
+        uPortLog("U_GNSS: received response");
+        uGnssPrivatePrintBuffer(pResponse, errorCodeOrResponseLength);
+        uPortLog(".\n");
+    }
+
+    return errorCodeOrResponseLength;
+}
+
+// Get the stream handle for a streaming transport, -1 if
+// the transport is not a streaming one.
+static int32_t getStreamHandle(const uGnssPrivateInstance_t *pInstance,
+                               int32_t streamType)
+{
+    int32_t streamHandle = -1;
+
+    switch (streamType) {
+        case U_GNSS_PRIVATE_STREAM_TYPE_UART:
+            streamHandle = pInstance->transportHandle.uart;
+            break;
+        case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
+            streamHandle = pInstance->transportHandle.i2c;
+            break;
+        default:
+            break;
+    }
+
+    return streamHandle;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -94,13 +252,7 @@ int32_t uGnssUtilUbxTransparentSendReceive(uDeviceHandle_t gnssHandle,
     int32_t errorCodeOrResponseLength = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
     uGnssPrivateInstance_t *pInstance;
     int32_t streamType;
-    int32_t streamHandle = -1;
-    int32_t startTimeMs;
-    int32_t x = 0;
-    int32_t bytesRead = 0;
-    char *pBuffer;
-    size_t bufferLengthBytes;
-    char *pTmp = NULL;
+    int32_t streamHandle;
     uAtClientHandle_t atHandle;
 
     if (gUGnssPrivateMutex != NULL) {
@@ -110,157 +262,35 @@ int32_t uGnssUtilUbxTransparentSendReceive(uDeviceHandle_t gnssHandle,
         errorCodeOrResponseLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         pInstance = pUGnssPrivateGetInstance(gnssHandle);
         if ((pInstance != NULL) &&
-            (((pCommand == NULL) && (commandLengthBytes == 0)) ||
-             (commandLengthBytes > 0)) &&
-            (((pResponse == NULL) && (maxResponseLengthBytes == 0)) ||
-             (maxResponseLengthBytes > 0))) {
+            transparentParamsValid(pCommand, commandLengthBytes,
+                                   pResponse, maxResponseLengthBytes)) {
 
-            errorCodeOrResponseLength = (int32_t) U_GNSS_ERROR_TRANSPORT;
             streamType = uGnssPrivateGetStreamType(pInstance->transportType);
 
             U_PORT_MUTEX_LOCK(pInstance->transportMutex);
 
-            switch (streamType) {
-                case U_GNSS_PRIVATE_STREAM_TYPE_UART:
-                    streamHandle = pInstance->transportHandle.uart;
-                    break;
-                case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
-                    streamHandle = pInstance->transportHandle.i2c;
-                    break;
-                default:
-                    break;
-            }
-
+            streamHandle = getStreamHandle(pInstance, streamType);
             if (streamHandle >= 0) {
                 // Streaming transport
-                switch (streamType) {
-                    case U_GNSS_PRIVATE_STREAM_TYPE_UART:
-                        errorCodeOrResponseLength = uPortUartWrite(streamHandle,
-                                                                   pCommand,
-                                                                   commandLengthBytes);
-                        break;
-                    case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
-                        errorCodeOrResponseLength = uPortI2cControllerSend(streamHandle, pInstance->i2cAddress,
-                                                                           pCommand, commandLengthBytes, false);
-                        if (errorCodeOrResponseLength == 0) {
-                            errorCodeOrResponseLength = commandLengthBytes;
-                        }
-                        break;
-                    default:
-                        break;
-                }
-                if (errorCodeOrResponseLength == commandLengthBytes) {
-                    if (pInstance->printUbxMessages) {
-                        uPortLog("U_GNSS: sent command");
-                        uGnssPrivatePrintBuffer(pCommand, commandLengthBytes);
-                        uPortLog(".\n");
-                    }
-                    errorCodeOrResponseLength = (int32_t) U_ERROR_COMMON_SUCCESS;
-                    if (pResponse != NULL) {
-                        errorCodeOrResponseLength = (int32_t) U_GNSS_ERROR_TRANSPORT;
-                        startTimeMs = uPortGetTickTimeMs();
-                        // Wait for something to start coming back
-                        while ((bytesRead < (int32_t) maxResponseLengthBytes) &&
-                               ((x = uGnssPrivateStreamGetReceiveSize(streamHandle, streamType,
-                                                                      pInstance->i2cAddress)) <= 0) &&
-                               (uPortGetTickTimeMs() - startTimeMs < pInstance->timeoutMs)) {
-                            // Relax a little
-                            uPortTaskBlock(U_GNSS_UTIL_TRANSPARENT_RECEIVE_DELAY_MS);
-                        }
-                        if (x > 0) {
-                            // Got something; continue receiving until nothing arrives for
-                            // U_GNSS_UTIL_TRANSPARENT_RECEIVE_DELAY_MS
-                            while ((bytesRead < (int32_t) maxResponseLengthBytes) &&
-                                   ((x = uGnssPrivateStreamGetReceiveSize(streamHandle, streamType,
-                                                                          pInstance->i2cAddress)) > 0) &&
-                                   (uPortGetTickTimeMs() - startTimeMs < pInstance->timeoutMs)) {
-                                if (x > 0) {
-                                    if (x > ((int32_t) maxResponseLengthBytes) - bytesRead) {
-                                        x = maxResponseLengthBytes - bytesRead;
-                                    }
-                                    // Read the response into pResponse
-                                    switch (streamType) {
-                                        case U_GNSS_PRIVATE_STREAM_TYPE_UART:
-                                            x = uPortUartRead(streamHandle, pResponse + bytesRead, x);
-                                            break;
-                                        case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
-                                            x = uPortI2cControllerSendReceive(streamHandle, pInstance->i2cAddress,
-                                                                              NULL, 0, pResponse + bytesRead, x);
-                                            break;
-                                        default:
-                                            break;
-                                    }
-                                    if (x > 0) {
-                                        bytesRead += x;
-                                    }
-                                } else {
-                                    // Relax a little
-                                    uPortTaskBlock(U_GNSS_UTIL_TRANSPARENT_RECEIVE_DELAY_MS);
-                                }
-                            }
-                            if (bytesRead > 0) {
-                                errorCodeOrResponseLength = bytesRead;
-                            }
-                        }
-                        if (pInstance->printUbxMessages &&
-                            (errorCodeOrResponseLength >= 0)) {
-                            uPortLog("U_GNSS: received response");
-                            uGnssPrivatePrintBuffer(pResponse, errorCodeOrResponseLength);
-                            uPortLog(".\n");
-                        }
-                    }
-                }
+                errorCodeOrResponseLength = transparentSendReceiveStream(pInstance,
+                                                                         streamHandle,
+                                                                         streamType,
+                                                                         pCommand,
+                                                                         commandLengthBytes,
+                                                                         pResponse,
+                                                                         maxResponseLengthBytes);
             } else {
                 // AT transport
-                errorCodeOrResponseLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-                pTmp = NULL;
                 atHandle = pInstance->transportHandle.pAt;
-                // Need a buffer to hex encode the message into
-                // and receive the hex-encoded response into
-                bufferLengthBytes = (commandLengthBytes * 2) + 1; // +1 for terminator
-                if (bufferLengthBytes < (maxResponseLengthBytes * 2) + 1) {
-                    bufferLengthBytes = (maxResponseLengthBytes * 2) + 1;
-                }
-                pBuffer = (char *) malloc(bufferLengthBytes);
-                if (pBuffer != NULL) {
+                uAtClientLock(atHandle);
+                uAtClientTimeoutSet(atHandle, pInstance->timeoutMs);
+                errorCodeOrResponseLength = transparentSendReceiveAt(pInstance,
+                                                                     pCommand,
+                                                                     commandLengthBytes,
+                                                                     pResponse,
+                                                                     maxResponseLengthBytes);
+                if (uAtClientUnlock(atHandle) != 0) {
                     errorCodeOrResponseLength = (int32_t) U_GNSS_ERROR_TRANSPORT;
-                    if (pCommand != NULL) {
-                        x = (int32_t) uBinToHex(pCommand, commandLengthBytes, pBuffer);
-                    }
-                    // Add terminator
-                    *(pBuffer + x) = 0;
-                    uAtClientLock(atHandle);
-                    uAtClientTimeoutSet(atHandle, pInstance->timeoutMs);
-                    // Send the command
-                    uAtClientCommandStart(atHandle, "AT+UGUBX=");
-                    uAtClientWriteString(atHandle, pBuffer, true);
-                    uAtClientCommandStop(atHandle);
-                    // Read the hex-coded response back into pTmp,
-                    // which may be NULL to throw the response away
-                    uAtClientResponseStart(atHandle, "+UGUBX:");
-                    if (pResponse != NULL) {
-                        pTmp = pBuffer;
-                    }
-                    bytesRead = uAtClientReadString(atHandle, pTmp,
-                                                    bufferLengthBytes, false);
-                    uAtClientResponseStop(atHandle);
-                    if ((uAtClientUnlock(atHandle) == 0) && (bytesRead >= 0)) {
-                        if (bytesRead > (int32_t) maxResponseLengthBytes) {
-                            bytesRead = (int32_t) maxResponseLengthBytes;
-                        }
-                        errorCodeOrResponseLength = 0;
-                        if (pTmp != NULL) {
-                            // Decode the hex into pResponse
-                            errorCodeOrResponseLength = (int32_t) uHexToBin(pTmp, bytesRead, pResponse);
-                            if (pInstance->printUbxMessages) {
-                                uPortLog("U_GNSS: received response");
-                                uGnssPrivatePrintBuffer(pResponse, errorCodeOrResponseLength);
-                                uPortLog(".\n");
-                            }
-                        }
-                    }
-                    // Free memory
-                    free(pBuffer);
                 }
             }
 
@@ -273,4 +303,90 @@ int32_t uGnssUtilUbxTransparentSendReceive(uDeviceHandle_t gnssHandle,
     return errorCodeOrResponseLength;
 }
 
+// Transparently send a list of commands to the GNSS chip.
+int32_t uGnssUtilUbxTransparentSendReceiveList(uDeviceHandle_t gnssHandle,
+                                               uGnssUtilUbxTransparentTransaction_t *pList,
+                                               size_t numTransactions)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssUtilUbxTransparentTransaction_t *pTransaction;
+    int32_t streamType;
+    int32_t streamHandle;
+    uAtClientHandle_t atHandle = NULL;
+    int32_t startTimeMs;
+    bool isValid;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        isValid = (pInstance != NULL) && ((pList != NULL) || (numTransactions == 0));
+        for (size_t x = 0; isValid && (x < numTransactions); x++) {
+            pTransaction = pList + x;
+            isValid = transparentParamsValid(pTransaction->pCommand,
+                                             pTransaction->commandLengthBytes,
+                                             pTransaction->pResponse,
+                                             pTransaction->maxResponseLengthBytes);
+        }
+        if (isValid) {
+            errorCodeOrCount = 0;
+            streamType = uGnssPrivateGetStreamType(pInstance->transportType);
+
+            U_PORT_MUTEX_LOCK(pInstance->transportMutex);
+
+            streamHandle = getStreamHandle(pInstance, streamType);
+            if (streamHandle < 0) {
+                // AT transport: the whole list goes out under a single
+                // lock of the AT client
+                atHandle = pInstance->transportHandle.pAt;
+                uAtClientLock(atHandle);
+            }
+            startTimeMs = uPortGetTickTimeMs();
+            for (size_t x = 0; x < numTransactions; x++) {
+                pTransaction = pList + x;
+                if (atHandle != NULL) {
+                    // The AT timeout runs from when the AT client was
+                    // locked, so move it on to give each transaction
+                    // the full timeout
+                    uAtClientTimeoutSet(atHandle, (uPortGetTickTimeMs() - startTimeMs) +
+                                        pInstance->timeoutMs);
+                    pTransaction->errorCodeOrResponseLength = transparentSendReceiveAt(pInstance,
+                                                                                       pTransaction->pCommand,
+                                                                                       pTransaction->commandLengthBytes,
+                                                                                       pTransaction->pResponse,
+                                                                                       pTransaction->maxResponseLengthBytes);
+                    if (pTransaction->errorCodeOrResponseLength < 0) {
+                        // Clear the error so that the next
+                        // transaction can proceed
+                        uAtClientClearError(atHandle);
+                    }
+                } else {
+                    pTransaction->errorCodeOrResponseLength = transparentSendReceiveStream(pInstance,
+                                                                                           streamHandle,
+                                                                                           streamType,
+                                                                                           pTransaction->pCommand,
+                                                                                           pTransaction->commandLengthBytes,
+                                                                                           pTransaction->pResponse,
+                                                                                           pTransaction->maxResponseLengthBytes);
+                }
+                if (pTransaction->errorCodeOrResponseLength >= 0) {
+                    errorCodeOrCount++;
+                }
+            }
+            if (atHandle != NULL) {
+                uAtClientUnlock(atHandle);
+            }
+
+            U_PORT_MUTEX_UNLOCK(pInstance->transportMutex);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCodeOrCount;
+}
+
 // End of file
@@ -62,7 +62,8 @@
 #include "u_gnss_module_type.h"
 #include "u_gnss_type.h"
 #include "u_gnss.h"
-#include "u_gnss_cfg.h"   // For uGnssCfgSetProtocolOut()
+#include "u_gnss_cfg_val_key.h"
+#include "u_gnss_cfg.h"   // For uGnssCfgSetProtocolOut(), uGnssCfgValSetList()
 #include "u_gnss_info.h"  // For uGnssInfoGetFirmwareVersionStr() and uGnssInfoGetCommunicationStats()
 #include "u_gnss_pos.h"   // For uGnssPosGetStart()
 #include "u_gnss_msg.h"
@@ -131,6 +132,31 @@
 # define U_GNSS_MSG_TEST_MESSAGE_RECEIVE_NON_BLOCKING_POLL_DELAY_SECONDS 3
 #endif
 
+#ifndef U_GNSS_MSG_TEST_CAPTURE_BUFFER_SIZE_BYTES
+/** The size of buffer to capture the GNSS stream into.
+ */
+# define U_GNSS_MSG_TEST_CAPTURE_BUFFER_SIZE_BYTES (1024 * 8)
+#endif
+
+#ifndef U_GNSS_MSG_TEST_CAPTURE_SECONDS
+/** How long to capture the GNSS stream for.
+ */
+# define U_GNSS_MSG_TEST_CAPTURE_SECONDS 3
+#endif
+
+#ifndef U_GNSS_MSG_TEST_REPLAY_TIMEOUT_SECONDS
+/** How long to wait for a maximum-speed replay to complete.
+ */
+# define U_GNSS_MSG_TEST_REPLAY_TIMEOUT_SECONDS 10
+#endif
+
+#ifndef U_GNSS_MSG_TEST_AUTO_OUTPUT_SECONDS
+/** How long to count messages for at each step of the automatic
+ * output-rate tuning test.
+ */
+# define U_GNSS_MSG_TEST_AUTO_OUTPUT_SECONDS 5
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -179,6 +205,14 @@ static int32_t gCallbackErrorCode = 0;
  */
 static uGnssMsgTestReceive_t *gpMessageReceive[U_GNSS_MSG_RECEIVER_MAX_NUM] = {0};
 
+/** Count of messages received by countCallback().
+ */
+static size_t gNumCounted = 0;
+
+/** Count of data bytes passed to captureCallback().
+ */
+static size_t gNumCaptureCallbackBytes = 0;
+
 #endif // #ifndef U_CFG_TEST_USING_NRF5SDK 
 
 /* ----------------------------------------------------------------
@@ -330,6 +364,41 @@ static void messageReceiveCallback(uDeviceHandle_t gnssHandle,
     }
 }
 
+// Callback for message receive that just counts messages.
+static void countCallback(uDeviceHandle_t gnssHandle,
+                          const uGnssMessageId_t *pMessageId,
+                          int32_t errorCodeOrLength,
+                          void *pCallbackParam)
+{
+    (void) gnssHandle;
+    (void) pMessageId;
+
+    if (errorCodeOrLength > 0) {
+        if (pCallbackParam != NULL) {
+            (*((size_t *) pCallbackParam))++;
+        } else {
+            gNumCounted++;
+        }
+    }
+}
+
+// Callback for stream capture.
+static void captureCallback(uDeviceHandle_t gnssHandle,
+                            const char *pHeader,
+                            const char *pData,
+                            size_t size,
+                            void *pCallbackParam)
+{
+    (void) gnssHandle;
+    (void) pCallbackParam;
+
+    if ((pHeader == NULL) || (pData == NULL) ||
+        (uUbxProtocolUint16Decode(pHeader + sizeof(uint32_t)) != size)) {
+        gCallbackErrorCode = 1;
+    }
+    gNumCaptureCallbackBytes += size;
+}
+
 #endif // #ifndef U_CFG_TEST_USING_NRF5SDK 
 
 /* ----------------------------------------------------------------
@@ -559,6 +628,7 @@ U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgReceiveNonBlocking")
 
                 // Hook them in, passing a pointer to the entry as the callback parameter
                 gCallbackErrorCode = 0;
+                a = uPortGetHeapFree();
                 for (size_t x = 0; x < sizeof(gpMessageReceive) / sizeof(gpMessageReceive[0]); x++) {
                     pTmp = gpMessageReceive[x];
                     pTmp->asyncHandle = uGnssMsgReceiveStart(gnssHandle,
@@ -568,6 +638,13 @@ U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgReceiveNonBlocking")
                     pTmp->moduleType = pModule->moduleType;
                     U_PORT_TEST_ASSERT(pTmp->asyncHandle >= 0);
                 }
+                if (a >= 0) {
+                    // Print the RAM cost of the receive for this instance
+                    U_TEST_PRINT_LINE("%s receive task and %d reader(s) took %d byte(s) of heap.",
+                                      U_GNSS_MSG_RECEIVE_TASK_SHARED ? "shared" : "per-instance",
+                                      sizeof(gpMessageReceive) / sizeof(gpMessageReceive[0]),
+                                      a - uPortGetHeapFree());
+                }
 
                 // Messages should now start arriving at our callback
                 U_PORT_TEST_ASSERT(uUbxProtocolEncode(0x02, 0x14, NULL, 0, command) == sizeof(command));
@@ -770,6 +847,354 @@ U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgReceiveNonBlocking")
     U_PORT_TEST_ASSERT(heapUsed <= 0);
 }
 
+/** Capture the stream from the GNSS chip and replay it.
+ */
+U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgCaptureReplay")
+{
+    uDeviceHandle_t gnssHandle;
+    int32_t heapUsed;
+    char *pCapture;
+    int32_t captureLength;
+    size_t lostBytes = 0;
+    size_t numLive;
+    int32_t handle;
+    int32_t startTimeMs;
+    uGnssMessageId_t messageId = {0};
+    size_t iterations;
+    uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM_WITH_UBX];
+
+    // In case a previous test failed
+    uGnssTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    messageId.type = U_GNSS_PROTOCOL_NMEA; // pNmea left at NULL is "all"
+
+    // Repeat for all transport types except U_GNSS_TRANSPORT_AT
+    iterations = uGnssTestPrivateTransportTypesSet(transportTypes, U_CFG_APP_GNSS_UART,
+                                                   U_CFG_APP_GNSS_I2C);
+    for (size_t w = 0; w < iterations; w++) {
+        // Capture/replay is only supported on streaming transports
+        if ((transportTypes[w] == U_GNSS_TRANSPORT_UART) ||
+            (transportTypes[w] == U_GNSS_TRANSPORT_I2C)) {
+            // Do the standard preamble
+            U_TEST_PRINT_LINE("testing on transport %s...",
+                              pGnssTestPrivateTransportTypeName(transportTypes[w]));
+            U_PORT_TEST_ASSERT(uGnssTestPrivatePreamble(U_CFG_TEST_GNSS_MODULE_TYPE,
+                                                        transportTypes[w], &gHandles, true,
+                                                        U_CFG_APP_CELL_PIN_GNSS_POWER,
+                                                        U_CFG_APP_CELL_PIN_GNSS_DATA_READY) == 0);
+            gnssHandle = gHandles.gnssHandle;
+
+            // Make sure NMEA is on
+            U_PORT_TEST_ASSERT(uGnssCfgSetProtocolOut(gnssHandle, U_GNSS_PROTOCOL_NMEA, true) == 0);
+
+            pCapture = (char *) malloc(U_GNSS_MSG_TEST_CAPTURE_BUFFER_SIZE_BYTES);
+            U_PORT_TEST_ASSERT(pCapture != NULL);
+
+            // Nothing to stop yet
+            U_PORT_TEST_ASSERT(uGnssMsgCaptureStop(gnssHandle, NULL) < 0);
+            U_PORT_TEST_ASSERT(uGnssMsgReplayGetRemaining(gnssHandle) < 0);
+
+            // Count the NMEA messages received live while capturing
+            gNumCounted = 0;
+            gNumCaptureCallbackBytes = 0;
+            gCallbackErrorCode = 0;
+            U_PORT_TEST_ASSERT(uGnssMsgCaptureStart(gnssHandle, pCapture,
+                                                    U_GNSS_MSG_TEST_CAPTURE_BUFFER_SIZE_BYTES,
+                                                    captureCallback, NULL) == 0);
+            handle = uGnssMsgReceiveStart(gnssHandle, &messageId, countCallback, NULL);
+            U_PORT_TEST_ASSERT(handle >= 0);
+            U_TEST_PRINT_LINE("capturing for %d second(s)...", U_GNSS_MSG_TEST_CAPTURE_SECONDS);
+            uPortTaskBlock(U_GNSS_MSG_TEST_CAPTURE_SECONDS * 1000);
+            // Stop receiving before stopping the capture so that
+            // everything counted is in the capture
+            U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gnssHandle, handle) == 0);
+            numLive = gNumCounted;
+            captureLength = uGnssMsgCaptureStop(gnssHandle, &lostBytes);
+            U_TEST_PRINT_LINE("%d NMEA message(s) received live, %d byte(s) captured,"
+                              " %d byte(s) lost, %d byte(s) passed to the callback.",
+                              numLive, captureLength, lostBytes, gNumCaptureCallbackBytes);
+            U_PORT_TEST_ASSERT(gCallbackErrorCode == 0);
+            U_PORT_TEST_ASSERT(numLive > 0);
+            U_PORT_TEST_ASSERT(captureLength > U_GNSS_MSG_CAPTURE_HEADER_LENGTH_BYTES);
+            U_PORT_TEST_ASSERT(lostBytes == 0);
+            U_PORT_TEST_ASSERT(gNumCaptureCallbackBytes < (size_t) captureLength);
+
+            // Now replay the capture at maximum speed, what was received
+            // live should be received again,
+            // having got rid of anything already received from the GNSS chip
+            uGnssMsgReceiveFlush(gnssHandle, true);
+            U_PORT_TEST_ASSERT(uGnssMsgReplayStart(gnssHandle, pCapture, captureLength, true) == 0);
+            gNumCounted = 0;
+            handle = uGnssMsgReceiveStart(gnssHandle, &messageId, countCallback, NULL);
+            U_PORT_TEST_ASSERT(handle >= 0);
+            startTimeMs = uPortGetTickTimeMs();
+            while ((uGnssMsgReplayGetRemaining(gnssHandle) > 0) &&
+                   (uPortGetTickTimeMs() - startTimeMs < U_GNSS_MSG_TEST_REPLAY_TIMEOUT_SECONDS * 1000)) {
+                uPortTaskBlock(100);
+            }
+            U_PORT_TEST_ASSERT(uGnssMsgReplayGetRemaining(gnssHandle) == 0);
+            // Let the last messages work their way through
+            uPortTaskBlock(1000);
+            U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gnssHandle, handle) == 0);
+            U_TEST_PRINT_LINE("%d NMEA message(s) received on replay, took %d ms.",
+                              gNumCounted, uPortGetTickTimeMs() - startTimeMs);
+            // The capture may begin part-way through a message that
+            // was counted live
+            U_PORT_TEST_ASSERT(gNumCounted + 1 >= numLive);
+            U_PORT_TEST_ASSERT(uGnssMsgReplayStop(gnssHandle) == 0);
+            U_PORT_TEST_ASSERT(uGnssMsgReplayGetRemaining(gnssHandle) < 0);
+
+            free(pCapture);
+
+            // Do the standard postamble
+            uGnssTestPrivatePostamble(&gHandles, true);
+        }
+    }
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Check that automatic output-rate tuning has the GNSS chip emit
+ * only what is wanted.
+ */
+U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgAutoOutput")
+{
+    uDeviceHandle_t gnssHandle;
+    const uGnssPrivateModule_t *pModule;
+    int32_t heapUsed;
+    int32_t errorCode;
+    int32_t handleNmea;
+    int32_t handleUbx;
+    int32_t handlePvt;
+    int32_t handleGga;
+    size_t numNmea = 0;
+    size_t numUbx = 0;
+    size_t numOther = 0;
+    uGnssMessageId_t messageId;
+    uGnssPort_t portNumber;
+    // The NMEA messages that are emitted by default
+    const uint16_t defaultNmeaItem[] = {U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_NMEA_ID_GGA_I2C_U1,
+                                        U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_NMEA_ID_GLL_I2C_U1,
+                                        U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_NMEA_ID_GSA_I2C_U1,
+                                        U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_NMEA_ID_GSV_I2C_U1,
+                                        U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_NMEA_ID_RMC_I2C_U1,
+                                        U_GNSS_CFG_VAL_KEY_ITEM_MSGOUT_NMEA_ID_VTG_I2C_U1
+                                       };
+    uGnssCfgVal_t cfgVal[sizeof(defaultNmeaItem) / sizeof(defaultNmeaItem[0])];
+    size_t iterations;
+    uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM_WITH_UBX];
+
+    // In case a previous test failed
+    uGnssTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    // Repeat for all transport types except U_GNSS_TRANSPORT_AT
+    iterations = uGnssTestPrivateTransportTypesSet(transportTypes, U_CFG_APP_GNSS_UART,
+                                                   U_CFG_APP_GNSS_I2C);
+    for (size_t w = 0; w < iterations; w++) {
+        // Only do this for non-message-filtered transport since we
+        // need to see everything the GNSS chip emits
+        if ((transportTypes[w] == U_GNSS_TRANSPORT_UART) ||
+            (transportTypes[w] == U_GNSS_TRANSPORT_I2C)) {
+            // Do the standard preamble
+            U_TEST_PRINT_LINE("testing on transport %s...",
+                              pGnssTestPrivateTransportTypeName(transportTypes[w]));
+            U_PORT_TEST_ASSERT(uGnssTestPrivatePreamble(U_CFG_TEST_GNSS_MODULE_TYPE,
+                                                        transportTypes[w], &gHandles, true,
+                                                        U_CFG_APP_CELL_PIN_GNSS_POWER,
+                                                        U_CFG_APP_CELL_PIN_GNSS_DATA_READY) == 0);
+            gnssHandle = gHandles.gnssHandle;
+
+            pModule = pUGnssPrivateGetModule(gnssHandle);
+            U_PORT_TEST_ASSERT(pModule != NULL);
+            portNumber = pUGnssPrivateGetInstance(gnssHandle)->portNumber;
+
+            // Make sure NMEA and UBX are on
+            U_PORT_TEST_ASSERT(uGnssCfgSetProtocolOut(gnssHandle, U_GNSS_PROTOCOL_NMEA, true) == 0);
+            U_PORT_TEST_ASSERT(uGnssCfgSetProtocolOut(gnssHandle, U_GNSS_PROTOCOL_UBX, true) == 0);
+
+            // Start a reader for all NMEA messages and one for all UBX
+            // messages, neither of which should affect what is emitted,
+            // plus one for UBX-NAV-PVT, which should
+            gCallbackErrorCode = 0;
+            memset(&messageId, 0, sizeof(messageId));
+            messageId.type = U_GNSS_PROTOCOL_NMEA; // pNmea left at NULL is "all"
+            handleNmea = uGnssMsgReceiveStart(gnssHandle, &messageId, countCallback, &numNmea);
+            U_PORT_TEST_ASSERT(handleNmea >= 0);
+            messageId.type = U_GNSS_PROTOCOL_UBX;
+            messageId.id.ubx = (U_GNSS_UBX_MESSAGE_CLASS_ALL << 8) | U_GNSS_UBX_MESSAGE_ID_ALL;
+            handleUbx = uGnssMsgReceiveStart(gnssHandle, &messageId, countCallback, &numUbx);
+            U_PORT_TEST_ASSERT(handleUbx >= 0);
+            messageId.id.ubx = 0x0107;
+            handlePvt = uGnssMsgReceiveStart(gnssHandle, &messageId, countCallback, &numOther);
+            U_PORT_TEST_ASSERT(handlePvt >= 0);
+
+            errorCode = uGnssMsgReceiveSetAutoOutput(gnssHandle, true);
+            if (U_GNSS_PRIVATE_HAS(pModule, U_GNSS_PRIVATE_FEATURE_CFGVALXXX)) {
+                U_PORT_TEST_ASSERT(errorCode == 0);
+
+                // Let things settle and then count: only UBX-NAV-PVT
+                // should be arriving
+                uPortTaskBlock(2000);
+                numNmea = 0;
+                numUbx = 0;
+                uPortTaskBlock(U_GNSS_MSG_TEST_AUTO_OUTPUT_SECONDS * 1000);
+                U_TEST_PRINT_LINE("wanting UBX-NAV-PVT: %d NMEA and %d UBX message(s)"
+                                  " in %d second(s).", numNmea, numUbx,
+                                  U_GNSS_MSG_TEST_AUTO_OUTPUT_SECONDS);
+                U_PORT_TEST_ASSERT(numNmea == 0);
+                U_PORT_TEST_ASSERT(numUbx > 0);
+
+                // Swap UBX-NAV-PVT for NMEA GGA, from any talker
+                U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gnssHandle, handlePvt) == 0);
+                messageId.type = U_GNSS_PROTOCOL_NMEA;
+                messageId.id.pNmea = "??GGA";
+                handleGga = uGnssMsgReceiveStart(gnssHandle, &messageId, countCallback, &numOther);
+                U_PORT_TEST_ASSERT(handleGga >= 0);
+                uPortTaskBlock(2000);
+                numNmea = 0;
+                numUbx = 0;
+                numOther = 0;
+                uPortTaskBlock(U_GNSS_MSG_TEST_AUTO_OUTPUT_SECONDS * 1000);
+                U_TEST_PRINT_LINE("wanting GGA: %d NMEA (%d GGA) and %d UBX message(s)"
+                                  " in %d second(s).", numNmea, numOther, numUbx,
+                                  U_GNSS_MSG_TEST_AUTO_OUTPUT_SECONDS);
+                U_PORT_TEST_ASSERT(numOther > 0);
+                U_PORT_TEST_ASSERT(numNmea == numOther);
+                U_PORT_TEST_ASSERT(numUbx == 0);
+
+                U_PORT_TEST_ASSERT(uGnssMsgReceiveSetAutoOutput(gnssHandle, false) == 0);
+                U_PORT_TEST_ASSERT(uGnssMsgReceiveStopAll(gnssHandle) == 0);
+                U_PORT_TEST_ASSERT(gCallbackErrorCode == 0);
+
+                // Put the default NMEA output back for the tests that follow
+                for (size_t x = 0; x < sizeof(cfgVal) / sizeof(cfgVal[0]); x++) {
+                    cfgVal[x].keyId = U_GNSS_CFG_VAL_KEY(U_GNSS_CFG_VAL_KEY_GROUP_ID_MSGOUT,
+                                                         defaultNmeaItem[x] + (uint32_t) portNumber,
+                                                         U_GNSS_CFG_VAL_KEY_SIZE_ONE_BYTE);
+                    cfgVal[x].value = 1;
+                }
+                U_PORT_TEST_ASSERT(uGnssCfgValSetList(gnssHandle, cfgVal,
+                                                      sizeof(cfgVal) / sizeof(cfgVal[0]),
+                                                      U_GNSS_CFG_VAL_TRANSACTION_NONE,
+                                                      U_GNSS_CFG_VAL_LAYER_RAM) == 0);
+            } else {
+                U_TEST_PRINT_LINE("automatic output-rate tuning is not supported.");
+                U_PORT_TEST_ASSERT(errorCode == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+                U_PORT_TEST_ASSERT(uGnssMsgReceiveStopAll(gnssHandle) == 0);
+            }
+
+            // Do the standard postamble
+            uGnssTestPrivatePostamble(&gHandles, true);
+        }
+    }
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Check that automatic ring buffer sizing changes the size of the
+ * ring buffer without upsetting the message receive task.
+ */
+U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgRingBufferAutoSize")
+{
+    uDeviceHandle_t gnssHandle;
+    int32_t heapUsed;
+    int32_t handle;
+    size_t numCounted;
+    int32_t newSize = U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES * 2;
+    uGnssMessageId_t messageId = {0};
+    size_t iterations;
+    uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM_WITH_UBX];
+
+    // In case a previous test failed
+    uGnssTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    messageId.type = U_GNSS_PROTOCOL_NMEA; // pNmea left at NULL is "all"
+
+    // Repeat for all transport types
+    iterations = uGnssTestPrivateTransportTypesSet(transportTypes, U_CFG_APP_GNSS_UART,
+                                                   U_CFG_APP_GNSS_I2C);
+    for (size_t w = 0; w < iterations; w++) {
+        // Do the standard preamble
+        U_TEST_PRINT_LINE("testing on transport %s...",
+                          pGnssTestPrivateTransportTypeName(transportTypes[w]));
+        U_PORT_TEST_ASSERT(uGnssTestPrivatePreamble(U_CFG_TEST_GNSS_MODULE_TYPE,
+                                                    transportTypes[w], &gHandles, true,
+                                                    U_CFG_APP_CELL_PIN_GNSS_POWER,
+                                                    U_CFG_APP_CELL_PIN_GNSS_DATA_READY) == 0);
+        gnssHandle = gHandles.gnssHandle;
+
+        // Bad bounds
+        U_PORT_TEST_ASSERT(uGnssMsgReceiveSetRingBufferAutoSize(gnssHandle, 2, 1) < 0);
+        U_PORT_TEST_ASSERT(uGnssMsgReceiveSetRingBufferAutoSize(gnssHandle, 0, 1) < 0);
+
+        if ((transportTypes[w] == U_GNSS_TRANSPORT_UART) ||
+            (transportTypes[w] == U_GNSS_TRANSPORT_I2C)) {
+            U_PORT_TEST_ASSERT(uGnssMsgReceiveGetRingBufferSize(gnssHandle) ==
+                               U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES);
+
+            // Make sure NMEA is on
+            U_PORT_TEST_ASSERT(uGnssCfgSetProtocolOut(gnssHandle, U_GNSS_PROTOCOL_NMEA, true) == 0);
+
+            // Pin the bounds to a different size: the size should
+            // change at the end of the first full window
+            U_PORT_TEST_ASSERT(uGnssMsgReceiveSetRingBufferAutoSize(gnssHandle, newSize,
+                                                                    newSize) == 0);
+            gNumCounted = 0;
+            handle = uGnssMsgReceiveStart(gnssHandle, &messageId, countCallback, NULL);
+            U_PORT_TEST_ASSERT(handle >= 0);
+            uPortTaskBlock(U_GNSS_MSG_RING_BUFFER_AUTO_SIZE_WINDOW_MS * 2 + 1000);
+            U_TEST_PRINT_LINE("ring buffer is now %d byte(s), %d NMEA message(s) received.",
+                              uGnssMsgReceiveGetRingBufferSize(gnssHandle), gNumCounted);
+            U_PORT_TEST_ASSERT(uGnssMsgReceiveGetRingBufferSize(gnssHandle) == newSize);
+            U_PORT_TEST_ASSERT(uGnssMsgReceiveStatStreamLoss(gnssHandle) == 0);
+            U_PORT_TEST_ASSERT(uGnssMsgReceiveStatReadLoss(gnssHandle) == 0);
+
+            // Messages should continue to flow after the change
+            numCounted = gNumCounted;
+            uPortTaskBlock(3000);
+            U_PORT_TEST_ASSERT(gNumCounted > numCounted);
+
+            // Switch it off: the size stays where it is
+            U_PORT_TEST_ASSERT(uGnssMsgReceiveSetRingBufferAutoSize(gnssHandle, 0, 0) == 0);
+            U_PORT_TEST_ASSERT(uGnssMsgReceiveGetRingBufferSize(gnssHandle) == newSize);
+            U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gnssHandle, handle) == 0);
+        } else {
+            U_PORT_TEST_ASSERT(uGnssMsgReceiveSetRingBufferAutoSize(gnssHandle, newSize,
+                                                                    newSize) ==
+                               (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+        }
+
+        // Do the standard postamble
+        uGnssTestPrivatePostamble(&gHandles, true);
+    }
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
 #endif // U_CFG_TEST_USING_NRF5SDK 
 
 /** Clean-up to be run at the end of this round of tests, just
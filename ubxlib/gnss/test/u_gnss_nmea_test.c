@@ -0,0 +1,293 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the GNSS NMEA field parsing API: these should pass
+ * on all platforms, no GNSS module is required.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // strlen(), memcmp()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss.h"
+#include "u_gnss_nmea.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_GNSS_NMEA_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** GGA with a fix, as it would arrive from the ring buffer.
+ */
+static const char gGga[] = "$GNGGA,092725.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,*45\r\n";
+
+/** GGA without a fix.
+ */
+static const char gGgaNoFix[] = "$GPGGA,,,,,,0,00,99.99,,,,,,*48";
+
+/** RMC with a fix, NMEA 4.10.
+ */
+static const char gRmc[] = "$GNRMC,083559.00,A,4717.11437,N,00833.91522,E,0.004,77.52,091202,,,A,V*33\r\n";
+
+/** RMC without a fix.
+ */
+static const char gRmcNoFix[] = "$GPRMC,,V,,,,,,,,,,N*53";
+
+/** GSA with a fix, NMEA 4.10.
+ */
+static const char gGsa[] = "$GNGSA,A,3,80,71,73,79,69,,,,,,,,1.83,1.09,1.47,1*0A";
+
+/** GSA without a fix, NMEA 4.0.
+ */
+static const char gGsaNoFix[] = "$GPGSA,A,1,,,,,,,,,,,,,99.99,99.99,99.99*30";
+
+/** GSV with four satellites and a signal ID.
+ */
+static const char gGsv[] = "$GPGSV,3,1,09,09,,,17,10,,,40,12,,,49,13,,,35,1*6F";
+
+/** GSV with one satellite and no signal ID.
+ */
+static const char gGsvOne[] = "$GPGSV,3,3,09,25,60,289,42*44";
+
+/** GSV with no satellites.
+ */
+static const char gGsvNone[] = "$GLGSV,1,1,00*65";
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Make a field from a string.
+static uGnssNmeaField_t makeField(const char *pString)
+{
+    uGnssNmeaField_t field;
+
+    field.pData = pString;
+    field.size = strlen(pString);
+
+    return field;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Test the NMEA tokenizer and field decoders.
+ */
+U_PORT_TEST_FUNCTION("[gnssNmea]", "gnssNmeaFields")
+{
+    uGnssNmeaTokenizer_t tokenizer;
+    uGnssNmeaField_t fields[3];
+    uGnssNmeaField_t hemisphere;
+    size_t numFields = 0;
+    int32_t value;
+    char buffer[sizeof(gGgaNoFix)];
+
+    // Tokenizer, with and without checksum and line ending
+    U_PORT_TEST_ASSERT(uGnssNmeaTokenizerInit(&tokenizer, "$GPTXT,,a*00", 12) ==
+                       (int32_t) U_GNSS_ERROR_CRC);
+    U_PORT_TEST_ASSERT(uGnssNmeaTokenizerInit(&tokenizer, "$GPTXT,,a*4", 11) < 0);
+    U_PORT_TEST_ASSERT(uGnssNmeaTokenizerInit(&tokenizer, "GPTXT,,a", 8) < 0);
+    U_PORT_TEST_ASSERT(uGnssNmeaTokenizerInit(&tokenizer, "$GPTXT,,a\r\n", 11) == 0);
+    while ((numFields < sizeof(fields) / sizeof(fields[0])) &&
+           uGnssNmeaTokenizerNext(&tokenizer, &(fields[numFields]))) {
+        numFields++;
+    }
+    U_PORT_TEST_ASSERT(numFields == 3);
+    U_PORT_TEST_ASSERT((fields[0].size == 5) && (memcmp(fields[0].pData, "GPTXT", 5) == 0));
+    U_PORT_TEST_ASSERT(fields[1].size == 0);
+    U_PORT_TEST_ASSERT((fields[2].size == 1) && (*(fields[2].pData) == 'a'));
+    U_PORT_TEST_ASSERT(!uGnssNmeaTokenizerNext(&tokenizer, &(fields[0])));
+
+    // A corrupted sentence must fail the checksum
+    memcpy(buffer, gGgaNoFix, sizeof(buffer));
+    buffer[10] = '1';
+    U_PORT_TEST_ASSERT(uGnssNmeaTokenizerInit(&tokenizer, buffer,
+                                              sizeof(buffer) - 1) == (int32_t) U_GNSS_ERROR_CRC);
+
+    // Integers
+    fields[0] = makeField("-42");
+    U_PORT_TEST_ASSERT((uGnssNmeaFieldToInt32(&(fields[0]), &value) == 0) && (value == -42));
+    fields[0] = makeField("4.2");
+    U_PORT_TEST_ASSERT(uGnssNmeaFieldToInt32(&(fields[0]), &value) < 0);
+    fields[0] = makeField("");
+    U_PORT_TEST_ASSERT(uGnssNmeaFieldToInt32(&(fields[0]), &value) ==
+                       (int32_t) U_ERROR_COMMON_NOT_FOUND);
+
+    // Fixed point
+    fields[0] = makeField("-12.345");
+    U_PORT_TEST_ASSERT((uGnssNmeaFieldToFixed(&(fields[0]), 3, &value) == 0) && (value == -12345));
+    U_PORT_TEST_ASSERT((uGnssNmeaFieldToFixed(&(fields[0]), 1, &value) == 0) && (value == -123));
+    fields[0] = makeField("1.5");
+    U_PORT_TEST_ASSERT((uGnssNmeaFieldToFixed(&(fields[0]), 3, &value) == 0) && (value == 1500));
+    fields[0] = makeField("7");
+    U_PORT_TEST_ASSERT((uGnssNmeaFieldToFixed(&(fields[0]), 2, &value) == 0) && (value == 700));
+    fields[0] = makeField("1.2.3");
+    U_PORT_TEST_ASSERT(uGnssNmeaFieldToFixed(&(fields[0]), 2, &value) < 0);
+    fields[0] = makeField("abc");
+    U_PORT_TEST_ASSERT(uGnssNmeaFieldToFixed(&(fields[0]), 2, &value) < 0);
+    fields[0] = makeField("3000000.0");
+    U_PORT_TEST_ASSERT(uGnssNmeaFieldToFixed(&(fields[0]), 3, &value) < 0);
+
+    // Latitude/longitude
+    fields[0] = makeField("4717.11399");
+    hemisphere = makeField("S");
+    U_PORT_TEST_ASSERT((uGnssNmeaFieldToLatLong(&(fields[0]), &hemisphere, &value) == 0) &&
+                       (value == -472852332));
+    hemisphere = makeField("X");
+    U_PORT_TEST_ASSERT(uGnssNmeaFieldToLatLong(&(fields[0]), &hemisphere, &value) < 0);
+    hemisphere = makeField("");
+    U_PORT_TEST_ASSERT(uGnssNmeaFieldToLatLong(&(fields[0]), &hemisphere, &value) < 0);
+    fields[0] = makeField("4760.00000");
+    hemisphere = makeField("N");
+    U_PORT_TEST_ASSERT(uGnssNmeaFieldToLatLong(&(fields[0]), &hemisphere, &value) < 0);
+
+    // Time, including a leap second
+    fields[0] = makeField("235960.5");
+    U_PORT_TEST_ASSERT((uGnssNmeaFieldToTime(&(fields[0]), &value) == 0) && (value == 86400500));
+    fields[0] = makeField("246000");
+    U_PORT_TEST_ASSERT(uGnssNmeaFieldToTime(&(fields[0]), &value) < 0);
+}
+
+/** Test the NMEA sentence decoders.
+ */
+U_PORT_TEST_FUNCTION("[gnssNmea]", "gnssNmeaSentences")
+{
+    uGnssNmeaGga_t gga;
+    uGnssNmeaRmc_t rmc;
+    uGnssNmeaGsa_t gsa;
+    uGnssNmeaGsv_t gsv;
+
+    // GGA
+    U_PORT_TEST_ASSERT(uGnssNmeaDecodeGga(gGga, sizeof(gGga) - 1, &gga) == 0);
+    U_PORT_TEST_ASSERT(memcmp(gga.talker, "GN", sizeof(gga.talker)) == 0);
+    U_PORT_TEST_ASSERT(gga.timeOfDayMs == 34045000);
+    U_PORT_TEST_ASSERT(gga.latitudeX1e7 == 472852332);
+    U_PORT_TEST_ASSERT(gga.longitudeX1e7 == 85652650);
+    U_PORT_TEST_ASSERT(gga.quality == 1);
+    U_PORT_TEST_ASSERT(gga.numSvs == 8);
+    U_PORT_TEST_ASSERT(gga.hdopX100 == 101);
+    U_PORT_TEST_ASSERT(gga.altitudeMillimetres == 499600);
+    U_PORT_TEST_ASSERT(gga.geoidSeparationMillimetres == 48000);
+    U_PORT_TEST_ASSERT(uGnssNmeaDecodeGga(gGgaNoFix, sizeof(gGgaNoFix) - 1, &gga) == 0);
+    U_PORT_TEST_ASSERT(memcmp(gga.talker, "GP", sizeof(gga.talker)) == 0);
+    U_PORT_TEST_ASSERT(gga.timeOfDayMs == U_GNSS_NMEA_FIELD_NOT_PRESENT);
+    U_PORT_TEST_ASSERT(gga.latitudeX1e7 == U_GNSS_NMEA_FIELD_NOT_PRESENT);
+    U_PORT_TEST_ASSERT(gga.longitudeX1e7 == U_GNSS_NMEA_FIELD_NOT_PRESENT);
+    U_PORT_TEST_ASSERT(gga.quality == 0);
+    U_PORT_TEST_ASSERT(gga.numSvs == 0);
+    U_PORT_TEST_ASSERT(gga.hdopX100 == 9999);
+    U_PORT_TEST_ASSERT(gga.altitudeMillimetres == U_GNSS_NMEA_FIELD_NOT_PRESENT);
+    // Wrong sentence type
+    U_PORT_TEST_ASSERT(uGnssNmeaDecodeGga(gRmc, sizeof(gRmc) - 1, &gga) < 0);
+
+    // RMC
+    U_PORT_TEST_ASSERT(uGnssNmeaDecodeRmc(gRmc, sizeof(gRmc) - 1, &rmc) == 0);
+    U_PORT_TEST_ASSERT(rmc.timeOfDayMs == 30959000);
+    U_PORT_TEST_ASSERT(rmc.valid);
+    U_PORT_TEST_ASSERT(rmc.latitudeX1e7 == 472852395);
+    U_PORT_TEST_ASSERT(rmc.longitudeX1e7 == 85652537);
+    U_PORT_TEST_ASSERT(rmc.speedMillimetresPerSecond == 2);
+    U_PORT_TEST_ASSERT(rmc.courseDegreesX100 == 7752);
+    U_PORT_TEST_ASSERT((rmc.day == 9) && (rmc.month == 12) && (rmc.year == 2002));
+    U_PORT_TEST_ASSERT(rmc.mode == 'A');
+    U_PORT_TEST_ASSERT(uGnssNmeaDecodeRmc(gRmcNoFix, sizeof(gRmcNoFix) - 1, &rmc) == 0);
+    U_PORT_TEST_ASSERT(!rmc.valid);
+    U_PORT_TEST_ASSERT(rmc.latitudeX1e7 == U_GNSS_NMEA_FIELD_NOT_PRESENT);
+    U_PORT_TEST_ASSERT(rmc.speedMillimetresPerSecond == U_GNSS_NMEA_FIELD_NOT_PRESENT);
+    U_PORT_TEST_ASSERT(rmc.year == U_GNSS_NMEA_FIELD_NOT_PRESENT);
+    U_PORT_TEST_ASSERT(rmc.mode == 'N');
+
+    // GSA
+    U_PORT_TEST_ASSERT(uGnssNmeaDecodeGsa(gGsa, sizeof(gGsa) - 1, &gsa) == 0);
+    U_PORT_TEST_ASSERT(gsa.opMode == 'A');
+    U_PORT_TEST_ASSERT(gsa.fixType == 3);
+    U_PORT_TEST_ASSERT(gsa.numSvs == 5);
+    U_PORT_TEST_ASSERT((gsa.svId[0] == 80) && (gsa.svId[4] == 69));
+    U_PORT_TEST_ASSERT(gsa.pdopX100 == 183);
+    U_PORT_TEST_ASSERT(gsa.hdopX100 == 109);
+    U_PORT_TEST_ASSERT(gsa.vdopX100 == 147);
+    U_PORT_TEST_ASSERT(gsa.systemId == 1);
+    U_PORT_TEST_ASSERT(uGnssNmeaDecodeGsa(gGsaNoFix, sizeof(gGsaNoFix) - 1, &gsa) == 0);
+    U_PORT_TEST_ASSERT(gsa.fixType == 1);
+    U_PORT_TEST_ASSERT(gsa.numSvs == 0);
+    U_PORT_TEST_ASSERT(gsa.pdopX100 == 9999);
+    U_PORT_TEST_ASSERT(gsa.systemId == U_GNSS_NMEA_FIELD_NOT_PRESENT);
+
+    // GSV
+    U_PORT_TEST_ASSERT(uGnssNmeaDecodeGsv(gGsv, sizeof(gGsv) - 1, &gsv) == 0);
+    U_PORT_TEST_ASSERT((gsv.numMessages == 3) && (gsv.messageNumber == 1));
+    U_PORT_TEST_ASSERT(gsv.numSvsInView == 9);
+    U_PORT_TEST_ASSERT(gsv.numSatellites == 4);
+    U_PORT_TEST_ASSERT(gsv.satellite[0].svId == 9);
+    U_PORT_TEST_ASSERT(gsv.satellite[0].elevationDegrees == U_GNSS_NMEA_FIELD_NOT_PRESENT);
+    U_PORT_TEST_ASSERT(gsv.satellite[0].azimuthDegrees == U_GNSS_NMEA_FIELD_NOT_PRESENT);
+    U_PORT_TEST_ASSERT(gsv.satellite[0].cnoDbHz == 17);
+    U_PORT_TEST_ASSERT(gsv.satellite[3].cnoDbHz == 35);
+    U_PORT_TEST_ASSERT(gsv.signalId == 1);
+    U_PORT_TEST_ASSERT(uGnssNmeaDecodeGsv(gGsvOne, sizeof(gGsvOne) - 1, &gsv) == 0);
+    U_PORT_TEST_ASSERT(gsv.numSatellites == 1);
+    U_PORT_TEST_ASSERT((gsv.satellite[0].svId == 25) && (gsv.satellite[0].elevationDegrees == 60) &&
+                       (gsv.satellite[0].azimuthDegrees == 289) && (gsv.satellite[0].cnoDbHz == 42));
+    U_PORT_TEST_ASSERT(gsv.signalId == U_GNSS_NMEA_FIELD_NOT_PRESENT);
+    U_PORT_TEST_ASSERT(uGnssNmeaDecodeGsv(gGsvNone, sizeof(gGsvNone) - 1, &gsv) == 0);
+    U_PORT_TEST_ASSERT(memcmp(gsv.talker, "GL", sizeof(gsv.talker)) == 0);
+    U_PORT_TEST_ASSERT((gsv.numSvsInView == 0) && (gsv.numSatellites == 0));
+}
+
+// End of file
@@ -123,6 +123,12 @@
 #define U_GNSS_POS_TEST_RRLP_PSEUDORANGE_RMS_ERROR_INDEX_LIMIT 63
 #endif
 
+#ifndef U_GNSS_POS_TEST_RRLP_BUDGET_MS
+/** The time budget to give uGnssPosGetRrlpBest() when testing.
+ */
+#define U_GNSS_POS_TEST_RRLP_BUDGET_MS 5000
+#endif
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -465,6 +471,28 @@ U_PORT_TEST_FUNCTION("[gnssPos]", "gnssPosRrlp")
         U_PORT_TEST_ASSERT(y >= 6);
         U_PORT_TEST_ASSERT(y <= U_GNSS_POS_RRLP_SIZE_BYTES);
 
+        startTime = uPortGetTickTimeMs();
+        gStopTimeMs = startTime + U_GNSS_POS_TEST_TIMEOUT_SECONDS * 1000;
+        U_TEST_PRINT_LINE("asking for the best RRLP information over %d second(s)...",
+                          U_GNSS_POS_TEST_RRLP_BUDGET_MS / 1000);
+        y = uGnssPosGetRrlpBest(gnssHandle, pBuffer, U_GNSS_POS_RRLP_SIZE_BYTES,
+                                U_GNSS_POS_TEST_RRLP_SVS_THRESHOLD,
+                                U_GNSS_POS_TEST_RRLP_CNO_THRESHOLD,
+                                U_GNSS_POS_TEST_RRLP_MULTIPATH_INDEX_LIMIT,
+                                U_GNSS_POS_TEST_RRLP_PSEUDORANGE_RMS_ERROR_INDEX_LIMIT,
+                                U_GNSS_POS_TEST_RRLP_BUDGET_MS, keepGoingCallback);
+        U_TEST_PRINT_LINE("best RRLP took %d second(s) to arrive.",
+                          (int32_t) (uPortGetTickTimeMs() - startTime) / 1000);
+        U_TEST_PRINT_LINE("%d byte(s) of RRLP information was returned.", y);
+        U_PORT_TEST_ASSERT(y >= 6);
+        U_PORT_TEST_ASSERT(y <= U_GNSS_POS_RRLP_SIZE_BYTES);
+        // Must be a complete UBX-RXM-MEASX message
+        U_PORT_TEST_ASSERT((uint8_t) *pBuffer == 0xb5);
+        U_PORT_TEST_ASSERT(*(pBuffer + 1) == 0x62);
+        U_PORT_TEST_ASSERT(*(pBuffer + 2) == 0x02);
+        U_PORT_TEST_ASSERT(*(pBuffer + 3) == 0x14);
+        U_PORT_TEST_ASSERT(uUbxProtocolUint16Decode(pBuffer + 4) + 8 == y);
+
         // Check that we haven't dropped any incoming data
         y = uGnssMsgReceiveStatStreamLoss(gnssHandle);
         U_TEST_PRINT_LINE("%d byte(s) lost at the input to the ring-buffer during that test.", y);
@@ -0,0 +1,351 @@
+/*
+ * Copyright 2019-2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the GNSS SPARTN forwarder API: these should pass
+ * on all platforms, no GNSS module is required since the write to
+ * the GNSS chip is replaced by one which checks what is written.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stdlib.h"    // malloc()/free(), rand()
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcmp()/memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+
+#include "u_device.h"
+
+#include "u_mqtt_common.h"
+#include "u_mqtt_client.h"
+
+#include "u_spartn.h"
+#include "u_spartn_test_data.h"
+
+#include "u_gnss_spartn.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_GNSS_SPARTN_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_GNSS_SPARTN_TEST_CHUNK_MAX_BYTES
+/** The largest chunk of data to give to the SPARTN forwarder in one
+ * go; chunks are of a random length up to this.
+ */
+# define U_GNSS_SPARTN_TEST_CHUNK_MAX_BYTES 512
+#endif
+
+#ifndef U_GNSS_SPARTN_TEST_LATENCY_BUDGET_MS
+/** The latency budget to use when testing the SPARTN forwarder.
+ */
+# define U_GNSS_SPARTN_TEST_LATENCY_BUDGET_MS 100
+#endif
+
+#ifndef U_GNSS_SPARTN_TEST_CHUNK_INTERVAL_MS
+/** The interval between chunks of data when testing the SPARTN
+ * forwarder against its latency budget; uGnssSpartnForwardPoll()
+ * is called at the same interval.
+ */
+# define U_GNSS_SPARTN_TEST_CHUNK_INTERVAL_MS 10
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Context for the SPARTN forwarder test write function.
+ */
+typedef struct {
+    const char *pExpected;  /**< where the next message should be found
+                                 in the expected data. */
+    const char *pEnd;       /**< the end of the expected data. */
+    int32_t count;          /**< the number of messages written. */
+    int32_t errorCount;     /**< the number of messages that were
+                                 not as expected. */
+    int32_t writeCount;     /**< the number of writes. */
+    int32_t errorCode;      /**< if negative, the next write
+                                 will return this. */
+} uGnssSpartnTestContext_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+#ifndef __ZEPHYR__
+
+/** Context for the SPARTN forwarder test write function.
+ */
+static uGnssSpartnTestContext_t gContext;
+
+#endif // __ZEPHYR__
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#ifndef __ZEPHYR__
+
+// Write function for the SPARTN forwarder: check that what is
+// written is a whole number of the next messages in the expected
+// data.
+static int32_t forwardWrite(uDeviceHandle_t gnssHandle,
+                            const char *pBuffer, size_t size)
+{
+    int32_t sizeOrErrorCode = (int32_t) size;
+    const char *pExpected = NULL;
+    int32_t length;
+
+    gContext.writeCount++;
+    if (gnssHandle != (uDeviceHandle_t) &gContext) {
+        gContext.errorCount++;
+    }
+    if (gContext.errorCode < 0) {
+        sizeOrErrorCode = gContext.errorCode;
+        gContext.errorCode = 0;
+    } else {
+        while (size > 0) {
+            gContext.count++;
+            length = uSpartnValidate(gContext.pExpected,
+                                     gContext.pEnd - gContext.pExpected,
+                                     &pExpected);
+            if ((length > 0) && ((size_t) length <= size) &&
+                (memcmp(pBuffer, pExpected, length) == 0)) {
+                gContext.pExpected = pExpected + length;
+                pBuffer += length;
+                size -= length;
+            } else {
+                gContext.errorCount++;
+                size = 0;
+            }
+        }
+    }
+
+    return sizeOrErrorCode;
+}
+
+// Pass data to a SPARTN forwarder in chunks of random length,
+// waiting and polling in between if intervalMs is not zero.
+static int32_t forwardAddDataInChunks(uGnssSpartnForward_t *pForward,
+                                      const char *pData, size_t size,
+                                      int32_t intervalMs)
+{
+    int32_t count = 0;
+    size_t length;
+
+    while (size > 0) {
+        length = (rand() % U_GNSS_SPARTN_TEST_CHUNK_MAX_BYTES) + 1;
+        if (length > size) {
+            length = size;
+        }
+        count += uGnssSpartnForwardAddData(pForward, pData, length);
+        pData += length;
+        size -= length;
+        if (intervalMs > 0) {
+            uPortTaskBlock(intervalMs);
+            uGnssSpartnForwardPoll(pForward);
+        }
+    }
+
+    return count;
+}
+
+#endif // __ZEPHYR__
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#ifndef __ZEPHYR__
+
+/** Test the SPARTN forwarder, reporting the number of write calls
+ * it makes to the GNSS chip and the latency it adds; the GNSS chip
+ * is replaced by a write function which checks what is written.
+ *
+ * Note that, as for the SPARTN tests, this is not run on Zephyr
+ * because of the difficulty of getting a working rand() there.
+ */
+U_PORT_TEST_FUNCTION("[gnssSpartn]", "gnssSpartnForward")
+{
+    int32_t heapUsed;
+    uGnssSpartnForward_t *pForward;
+    uDeviceHandle_t gnssHandle = (uDeviceHandle_t) &gContext;
+    int32_t count;
+    size_t length;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    U_TEST_PRINT_LINE("testing SPARTN forwarder.");
+
+    pForward = (uGnssSpartnForward_t *) malloc(sizeof(*pForward));
+    U_PORT_TEST_ASSERT(pForward != NULL);
+    U_PORT_TEST_ASSERT(uGnssSpartnForwardInit(NULL, gnssHandle, 0, forwardWrite) < 0);
+    U_PORT_TEST_ASSERT(uGnssSpartnForwardInit(pForward, gnssHandle, -1, forwardWrite) < 0);
+    U_PORT_TEST_ASSERT(uGnssSpartnForwardInit(pForward, gnssHandle, 0, forwardWrite) == 0);
+    U_PORT_TEST_ASSERT(uGnssSpartnForwardAddData(NULL, gUSpartnTestData, 1) < 0);
+    U_PORT_TEST_ASSERT(uGnssSpartnForwardAddData(pForward, NULL, 1) < 0);
+    U_PORT_TEST_ASSERT(uGnssSpartnForwardAddData(pForward, NULL, 0) == 0);
+    U_PORT_TEST_ASSERT(uGnssSpartnForwardPoll(NULL) < 0);
+    U_PORT_TEST_ASSERT(uGnssSpartnForwardPoll(pForward) == 0);
+    U_PORT_TEST_ASSERT(uGnssSpartnForwardFlush(NULL) < 0);
+    U_PORT_TEST_ASSERT(uGnssSpartnForwardFlush(pForward) == 0);
+    U_PORT_TEST_ASSERT(uGnssSpartnForwardMqttRead(NULL, NULL, NULL) < 0);
+    U_PORT_TEST_ASSERT(uGnssSpartnForwardMqttRead(pForward, NULL, NULL) < 0);
+    U_PORT_TEST_ASSERT(pForward->statistics.writeCount == 0);
+
+    // All of the test data, in random chunks, with three latency
+    // budgets: zero, where only the messages in the same chunk are
+    // written together, one which the chunks arrive well within, and
+    // one so large that only a full buffer causes a write
+    for (size_t x = 0; x < 3; x++) {
+        memset(&gContext, 0, sizeof(gContext));
+        gContext.pExpected = gUSpartnTestData;
+        gContext.pEnd = gUSpartnTestData + gUSpartnTestDataSize;
+        switch (x) {
+            case 0:
+                U_PORT_TEST_ASSERT(uGnssSpartnForwardInit(pForward, gnssHandle, 0,
+                                                          forwardWrite) == 0);
+                count = forwardAddDataInChunks(pForward, gUSpartnTestData,
+                                               gUSpartnTestDataSize, 0);
+                U_PORT_TEST_ASSERT(pForward->statistics.messageCount == count);
+                break;
+            case 1:
+                U_PORT_TEST_ASSERT(uGnssSpartnForwardInit(pForward, gnssHandle,
+                                                          U_GNSS_SPARTN_TEST_LATENCY_BUDGET_MS,
+                                                          forwardWrite) == 0);
+                count = forwardAddDataInChunks(pForward, gUSpartnTestData,
+                                               gUSpartnTestDataSize,
+                                               U_GNSS_SPARTN_TEST_CHUNK_INTERVAL_MS);
+                break;
+            default:
+                U_PORT_TEST_ASSERT(uGnssSpartnForwardInit(pForward, gnssHandle, INT32_MAX,
+                                                          forwardWrite) == 0);
+                count = forwardAddDataInChunks(pForward, gUSpartnTestData,
+                                               gUSpartnTestDataSize, 0);
+                // Each write except the last must have been of a
+                // buffer too full to take another message
+                U_PORT_TEST_ASSERT(pForward->statistics.writeCount <=
+                                   (int32_t) (gUSpartnTestDataSize /
+                                              (U_GNSS_SPARTN_FORWARD_BUFFER_LENGTH_BYTES -
+                                               U_SPARTN_MESSAGE_LENGTH_MAX_BYTES)));
+                break;
+        }
+        if (x == 1) {
+            // Keep polling: anything left over should be written
+            // once the latency budget has passed
+            for (size_t y = 0; (pForward->bufferLength > 0) &&
+                 (y < (U_GNSS_SPARTN_TEST_LATENCY_BUDGET_MS * 2) /
+                  U_GNSS_SPARTN_TEST_CHUNK_INTERVAL_MS); y++) {
+                uPortTaskBlock(U_GNSS_SPARTN_TEST_CHUNK_INTERVAL_MS);
+                U_PORT_TEST_ASSERT(uGnssSpartnForwardPoll(pForward) >= 0);
+            }
+            U_PORT_TEST_ASSERT(pForward->bufferLength == 0);
+            // Generous, since the waits may be stretched on a busy platform
+            U_PORT_TEST_ASSERT(pForward->statistics.latencyMaxMs <
+                               U_GNSS_SPARTN_TEST_LATENCY_BUDGET_MS * 2);
+        }
+        U_PORT_TEST_ASSERT(uGnssSpartnForwardFlush(pForward) >= 0);
+        U_PORT_TEST_ASSERT(count == (int32_t) gUSpartnTestDataNumMessages);
+        U_PORT_TEST_ASSERT(gContext.count == count);
+        U_PORT_TEST_ASSERT(gContext.errorCount == 0);
+        U_PORT_TEST_ASSERT(gContext.pExpected == gContext.pEnd);
+        U_PORT_TEST_ASSERT(pForward->statistics.messageCount == count);
+        U_PORT_TEST_ASSERT(pForward->statistics.bytesWritten == (int32_t) gUSpartnTestDataSize);
+        U_PORT_TEST_ASSERT(pForward->statistics.writeCount == gContext.writeCount);
+        U_PORT_TEST_ASSERT(pForward->statistics.writeErrorCount == 0);
+        U_PORT_TEST_ASSERT(pForward->statistics.latencyMaxMs >= 0);
+        U_PORT_TEST_ASSERT(pForward->statistics.latencyTotalMs >= 0);
+        U_TEST_PRINT_LINE("latency budget %d ms: %d message(s), %d byte(s), in %d"
+                          " write call(s) (%d uncoalesced), latency max %d ms,"
+                          " average %d ms.", (int) pForward->latencyBudgetMs,
+                          pForward->statistics.messageCount,
+                          pForward->statistics.bytesWritten,
+                          pForward->statistics.writeCount, count,
+                          pForward->statistics.latencyMaxMs,
+                          (int) (pForward->statistics.latencyTotalMs /
+                                 pForward->statistics.messageCount));
+        U_PORT_TEST_ASSERT(pForward->statistics.writeCount < count);
+    }
+
+    // A failed write is counted and reported, and the data of that
+    // write is thrown away, but forwarding carries on afterwards
+    U_PORT_TEST_ASSERT(uGnssSpartnForwardInit(pForward, gnssHandle, 0, forwardWrite) == 0);
+    memset(&gContext, 0, sizeof(gContext));
+    length = uSpartnValidate(gUSpartnTestData, gUSpartnTestDataSize, NULL);
+    gContext.pExpected = gUSpartnTestData + length;
+    gContext.pEnd = gUSpartnTestData + gUSpartnTestDataSize;
+    gContext.errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+    U_PORT_TEST_ASSERT(uGnssSpartnForwardAddData(pForward, gUSpartnTestData,
+                                                 length) == (int32_t) U_ERROR_COMMON_PLATFORM);
+    U_PORT_TEST_ASSERT(pForward->statistics.writeErrorCount == 1);
+    U_PORT_TEST_ASSERT(pForward->statistics.messageCount == 0);
+    count = uGnssSpartnForwardAddData(pForward, gUSpartnTestData + length,
+                                      gUSpartnTestDataSize - length);
+    U_PORT_TEST_ASSERT(count == (int32_t) gUSpartnTestDataNumMessages - 1);
+    U_PORT_TEST_ASSERT(pForward->statistics.messageCount == count);
+    U_PORT_TEST_ASSERT(gContext.errorCount == 0);
+    U_PORT_TEST_ASSERT(gContext.pExpected == gContext.pEnd);
+    U_PORT_TEST_ASSERT(pForward->statistics.writeErrorCount == 1);
+
+    free(pForward);
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    U_TEST_PRINT_LINE("we have leaked %d byte(s).", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed == 0) || (heapUsed == (int32_t)U_ERROR_COMMON_NOT_SUPPORTED));
+}
+
+#endif // __ZEPHYR__
+
+// End of file
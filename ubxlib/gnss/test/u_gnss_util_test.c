@@ -86,6 +86,14 @@
 # define U_GNSS_UTIL_TEST_VERSION_SIZE_MAX_BYTES 1024
 #endif
 
+#ifndef U_GNSS_UTIL_TEST_LIST_NUM_TRANSACTIONS
+/** The number of transactions to time when comparing
+ * uGnssUtilUbxTransparentSendReceiveList() with calling
+ * uGnssUtilUbxTransparentSendReceive() repeatedly.
+ */
+# define U_GNSS_UTIL_TEST_LIST_NUM_TRANSACTIONS 5
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -114,7 +122,12 @@ U_PORT_TEST_FUNCTION("[gnssUtil]", "gnssUtilTransparent")
     int32_t heapUsed;
     char *pBuffer1;
     char *pBuffer2;
+    char *pBuffer3;
     char *pTmp;
+    uGnssUtilUbxTransparentTransaction_t *pTransactions;
+    int32_t startTimeMs;
+    int32_t singleDurationMs;
+    int32_t listDurationMs;
     int32_t y;
     int32_t x;
     size_t z;
@@ -208,6 +221,62 @@ U_PORT_TEST_FUNCTION("[gnssUtil]", "gnssUtilTransparent")
             U_TEST_PRINT_LINE("%d byte(s) returned.", x);
             U_PORT_TEST_ASSERT(x == 0);
 
+            // Now time a number of polls for the version string done
+            // one at a time against the same number done as a list,
+            // switching printing off so as not to skew the timing
+            pBuffer3 = (char *) malloc(U_GNSS_UTIL_TEST_LIST_NUM_TRANSACTIONS *
+                                       U_GNSS_UTIL_TEST_VERSION_SIZE_MAX_BYTES);
+            U_PORT_TEST_ASSERT(pBuffer3 != NULL);
+            pTransactions = (uGnssUtilUbxTransparentTransaction_t *) malloc(U_GNSS_UTIL_TEST_LIST_NUM_TRANSACTIONS *
+                                                                             sizeof(uGnssUtilUbxTransparentTransaction_t));
+            U_PORT_TEST_ASSERT(pTransactions != NULL);
+            uGnssSetUbxMessagePrint(gnssHandle, false);
+            U_TEST_PRINT_LINE("getting the version string %d time(s), one at a time...",
+                              U_GNSS_UTIL_TEST_LIST_NUM_TRANSACTIONS);
+            startTimeMs = uPortGetTickTimeMs();
+            for (z = 0; z < U_GNSS_UTIL_TEST_LIST_NUM_TRANSACTIONS; z++) {
+                x = uGnssUtilUbxTransparentSendReceive(gnssHandle,
+                                                       command, sizeof(command),
+                                                       pBuffer3 + (z * U_GNSS_UTIL_TEST_VERSION_SIZE_MAX_BYTES),
+                                                       U_GNSS_UTIL_TEST_VERSION_SIZE_MAX_BYTES);
+                U_PORT_TEST_ASSERT(x == y + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+            }
+            singleDurationMs = uPortGetTickTimeMs() - startTimeMs;
+            memset(pBuffer3, 0x66, U_GNSS_UTIL_TEST_LIST_NUM_TRANSACTIONS *
+                   U_GNSS_UTIL_TEST_VERSION_SIZE_MAX_BYTES);
+            for (z = 0; z < U_GNSS_UTIL_TEST_LIST_NUM_TRANSACTIONS; z++) {
+                (pTransactions + z)->pCommand = command;
+                (pTransactions + z)->commandLengthBytes = sizeof(command);
+                (pTransactions + z)->pResponse = pBuffer3 + (z * U_GNSS_UTIL_TEST_VERSION_SIZE_MAX_BYTES);
+                (pTransactions + z)->maxResponseLengthBytes = U_GNSS_UTIL_TEST_VERSION_SIZE_MAX_BYTES;
+                (pTransactions + z)->errorCodeOrResponseLength = -1;
+            }
+            U_TEST_PRINT_LINE("getting the version string %d time(s) as a list...",
+                              U_GNSS_UTIL_TEST_LIST_NUM_TRANSACTIONS);
+            startTimeMs = uPortGetTickTimeMs();
+            x = uGnssUtilUbxTransparentSendReceiveList(gnssHandle, pTransactions,
+                                                       U_GNSS_UTIL_TEST_LIST_NUM_TRANSACTIONS);
+            listDurationMs = uPortGetTickTimeMs() - startTimeMs;
+            uGnssSetUbxMessagePrint(gnssHandle, true);
+            U_TEST_PRINT_LINE("%d transaction(s) succeeded.", x);
+            U_PORT_TEST_ASSERT(x == U_GNSS_UTIL_TEST_LIST_NUM_TRANSACTIONS);
+            for (z = 0; z < U_GNSS_UTIL_TEST_LIST_NUM_TRANSACTIONS; z++) {
+                U_PORT_TEST_ASSERT((pTransactions + z)->errorCodeOrResponseLength ==
+                                   y + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+                U_PORT_TEST_ASSERT(memcmp(pBuffer3 + (z * U_GNSS_UTIL_TEST_VERSION_SIZE_MAX_BYTES),
+                                          pBuffer2, y + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES) == 0);
+            }
+            U_TEST_PRINT_LINE("one at a time took %d ms, as a list took %d ms.",
+                              singleDurationMs, listDurationMs);
+            if ((singleDurationMs > 0) && (listDurationMs > 0)) {
+                U_TEST_PRINT_LINE("that's %d exchange(s)/second one at a time, %d"
+                                  " exchange(s)/second as a list.",
+                                  (U_GNSS_UTIL_TEST_LIST_NUM_TRANSACTIONS * 1000) / singleDurationMs,
+                                  (U_GNSS_UTIL_TEST_LIST_NUM_TRANSACTIONS * 1000) / listDurationMs);
+            }
+            free(pTransactions);
+            free(pBuffer3);
+
             // Free memory
             free(pBuffer2);
             free(pBuffer1);
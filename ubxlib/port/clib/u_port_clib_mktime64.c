@@ -26,7 +26,7 @@
 #include "stdbool.h"
 #include "time.h"      // struct tm
 
-#include "u_time.h"    // uTimeMonthsToSecondsUtc()
+#include "u_time.h"    // uTimeDateToEpoch()
 
 #include "u_port_clib_mktime64.h"
 
@@ -54,30 +54,26 @@
 // const, need to follow function signature.
 int64_t mktime64(struct tm *pTm)
 {
-    int64_t answer = 0;
-    int32_t year;
-    int32_t months;
+    uTimeDate_t date;
 
-    // TM has years since 1900, so convert to since 1970
-    year = pTm->tm_year - 70;
-    // Months since January 0-11
-    months = pTm->tm_mon;
-    months += year * 12;
-    // Work out the number of seconds due to the year/month count
-    answer += uTimeMonthsToSecondsUtc(months);
+    // TM has years since 1900
+    date.year = pTm->tm_year + 1900;
+    // Months since January 0-11; out of range
+    // values are handled by uTimeDateToEpoch()
+    date.month = pTm->tm_mon + 1;
     // Day (1 to 31)
-    answer += (((int64_t) pTm->tm_mday) - 1) * 3600 * 24;
+    date.day = pTm->tm_mday;
     // Hours (0 to 23)
-    answer += ((int64_t) pTm->tm_hour) * 3600;
+    date.hours = pTm->tm_hour;
     // Minutes (0 to 59)
-    answer += ((int64_t) pTm->tm_min) * 60;
+    date.minutes = pTm->tm_min;
     // Seconds (0 to 59ish)
-    answer += pTm->tm_sec;
+    date.seconds = pTm->tm_sec;
     // Since this function returns local time
     // the Daylight Saving Time flag has no
     // effect on the answer.
 
-    return answer;
+    return uTimeDateToEpoch(&date);
 }
 
 // End of file
@@ -40,6 +40,8 @@
 #include "u_assert.h"
 #include "u_port_os.h"
 
+#include "u_slab.h"
+
 #include "u_port_event_queue_private.h"
 #include "u_port_event_queue.h"
 
@@ -176,11 +178,11 @@ static int32_t eventQueueClose(uEventQueue_t *pEventQueue)
     // on its own here but, as address sanitizer points out,
     // the uPortQueueSend() function must copy the required
     // length for an item on the queue so it has to be
-    // given that data size, hence we malloc() the block,
+    // given that data size, hence we allocate the block,
     // put U_EVENT_CONTROL_EXIT_NOW at the start of it and
     // then free it once it is sent
-    pControl = malloc(pEventQueue->paramMaxLengthBytes +
-                      U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES);
+    pControl = pUSlabAlloc(pEventQueue->paramMaxLengthBytes +
+                           U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES);
 
     if (pControl != NULL) {
         *((uEventQueueControlOrSize_t *) pControl) = U_EVENT_CONTROL_EXIT_NOW;
@@ -188,7 +190,7 @@ static int32_t eventQueueClose(uEventQueue_t *pEventQueue)
         while (uPortQueueSend(pEventQueue->queue, pControl) != 0) {
             uPortTaskBlock(10);
         }
-        free(pControl);
+        uSlabFree(pControl);
         U_PORT_MUTEX_LOCK(pEventQueue->taskRunningMutex);
         U_PORT_MUTEX_UNLOCK(pEventQueue->taskRunningMutex);
 
@@ -395,13 +397,14 @@ int32_t uPortEventQueueSend(int32_t handle, const void *pParam,
             ((pParam != NULL) || (paramLengthBytes == 0))) {
             queue = pEventQueue->queue;
             errorCode = U_ERROR_COMMON_NO_MEMORY;
-            // We need to add the control word to the start, so malloc
+            // We need to add the control word to the start, so allocate
             // a block that is paramMaxLengthBytes (i.e. paramMaxLengthBytes
             // of the queue, not just the paramLengthBytes passed in, since
             // uPortQueueSend() will expect to copy the full length) plus
-            // plus the control word length
-            pBlock = (char *) malloc(pEventQueue->paramMaxLengthBytes +
-                                     U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES);
+            // plus the control word length; this is done for every
+            // send, hence the slab allocator rather than the heap
+            pBlock = (char *) pUSlabAlloc(pEventQueue->paramMaxLengthBytes +
+                                          U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES);
             if (pBlock != NULL) {
                 // Copy in the control word, which is actually just
                 // the size in this case
@@ -429,7 +432,7 @@ int32_t uPortEventQueueSend(int32_t handle, const void *pParam,
                 errorCode = (uErrorCode_t) uPortQueueSend(queue, pBlock);
             }
             // Free memory again
-            free(pBlock);
+            uSlabFree(pBlock);
         }
     }
 
@@ -64,6 +64,8 @@
 #include "u_port_event_queue.h"
 #include "u_error_common.h"
 
+#include "u_slab.h"
+
 #ifdef CONFIG_IRQ_OFFLOAD
 # include <irq_offload.h> // To test semaphore from ISR in zephyr
 #endif
@@ -2845,6 +2847,7 @@ U_PORT_TEST_FUNCTION("[port]", "portCriticalSection")
 U_PORT_TEST_FUNCTION("[port]", "portCleanUp")
 {
     int32_t x;
+    uSlabStats_t slabStats;
 
     x = uPortTaskStackMinFree(NULL);
     if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
@@ -2864,6 +2867,13 @@ U_PORT_TEST_FUNCTION("[port]", "portCleanUp")
 
     uPortDeinit();
 
+    // Everything taken from the slab allocator should have been
+    // given back by now
+    for (int32_t y = 0; y < U_SLAB_NUM_SIZE_CLASSES; y++) {
+        U_PORT_TEST_ASSERT(uSlabGetStats(y, &slabStats) == 0);
+        U_PORT_TEST_ASSERT(slabStats.usedBlockCount == 0);
+    }
+
     x = uPortGetHeapMinFree();
     if (x >= 0) {
         U_TEST_PRINT_LINE("heap had a minimum of %d byte(s) free"
@@ -73,6 +73,7 @@
 #include <u_network_config_cell.h>
 #include <u_network_config_gnss.h>
 #include <u_network_config_wifi.h>
+#include <u_arena.h>
 #include <u_base64.h>
 #include <u_hex_bin_convert.h>
 #include <u_mempool.h>
@@ -124,6 +125,8 @@
 #include <u_gnss_pwr.h>
 #include <u_gnss_msg.h>
 #include <u_gnss_util.h>
+#include <u_gnss_nmea.h>
+#include <u_gnss_spartn.h>
 #include <u_wifi.h>
 #include <u_wifi_cfg.h>
 #include <u_wifi_mqtt.h>